@@ -128,6 +128,7 @@ win32:LIBS += Ole32.lib
 win32:LIBS += Shell32.lib
 win32:LIBS += Advapi32.lib										# Windows service.
 win32:LIBS += Netapi32.lib
+win32:LIBS += Iphlpapi.lib										# Network interfaces.
 
 # If this -ldl is missing, the linker on Linux complains with
 #  "sqlite3.o: undefined reference to symbol 'dlclose@@GLIBC_2.2.5'".
@@ -137,6 +138,20 @@ linux:LIBS += \
 HEADERS += \
 	../../src/c/OnOffMateMain.h \
 	../../src/c/WakeOnLAN.h \
+	../../src/c/WakeOnLANAsync.h \
+	../../src/c/WakeOnLANEther.h \
+	../../src/c/WakeOnLANHarvest.h \
+	../../src/c/WakeOnLANIfaces.h \
+	../../src/c/WakeOnLANInventory.h \
+	../../src/c/WakeOnLANListen.h \
+	../../src/c/WakeOnLANMAC.h \
+	../../src/c/WakeOnLANPlan.h \
+	../../src/c/WakeOnLANRelay.h \
+	../../src/c/WakeOnLANResolve.h \
+	../../src/c/WakeOnLANSelect.h \
+	../../src/c/WakeOnLANStress.h \
+	../../src/c/WakeOnLANVerify.h \
+	../../src/c/WinLineReader.h \
 	../../src/c/WinPowerHelpers.h \
 	../../src/c/WinRuntimeReplacements.h \
 	../../src/c/WinUTF8Console.h \
@@ -145,6 +160,20 @@ HEADERS += \
 SOURCES += \
 	../../src/c/OnOffMateMain.c \
 	../../src/c/WakeOnLAN.c \
+	../../src/c/WakeOnLANAsync.c \
+	../../src/c/WakeOnLANEther.c \
+	../../src/c/WakeOnLANHarvest.c \
+	../../src/c/WakeOnLANIfaces.c \
+	../../src/c/WakeOnLANInventory.c \
+	../../src/c/WakeOnLANListen.c \
+	../../src/c/WakeOnLANMAC.c \
+	../../src/c/WakeOnLANPlan.c \
+	../../src/c/WakeOnLANRelay.c \
+	../../src/c/WakeOnLANResolve.c \
+	../../src/c/WakeOnLANSelect.c \
+	../../src/c/WakeOnLANStress.c \
+	../../src/c/WakeOnLANVerify.c \
+	../../src/c/WinLineReader.c \
 	../../src/c/WinPowerHelpers.c \
 	../../src/c/WinRuntimeReplacements.c \
 	../../src/c/WinUTF8Console.c
@@ -0,0 +1,92 @@
+#****************************************************************************************
+#
+#	File:		liboom.pro
+#				Static library with the wake on LAN functionality of OnOffMate.
+#	Why:		Lets other C/C++ programs and services link the WOL functions directly.
+#	OS:			Qt
+#	Author:		Thomas
+#	Created:	2026-10-17
+#  
+# History
+# -------
+#
+# When			Who				What
+# ---------------------------------------------------------------------------------------
+# 2026-10-17	Thomas			Created.
+# 2026-10-17	Thomas			WakeOnLANAsync added.
+# 2026-10-17	Thomas			WakeOnLANResolve added.
+#
+#****************************************************************************************
+
+# The public interface is ../../src/c/WakeOnLAN.h. Programs that send magic packets in a
+#	loop use initWOLtarget (), initWOLsender (), sendWOLbatch (), and doneWOLsender ().
+#	Programs that must not block use openWOLasync (), submitWOLasync (), and
+#	closeWOLasync () from ../../src/c/WakeOnLANAsync.h.
+#	They have to link to Ws2_32.lib and Iphlpapi.lib themselves.
+
+# The name of this project. Makes some code further down more flexible and portable.
+PROJECTNAME=liboom
+
+# Required Qt version is 5.11.3.
+QTVERREQUIRED=5.11.3
+
+# Tell the compiler to emit warnings if deprecated Qt APIs are used.
+include (../OnOffMate/WarnDeprecated.pri)
+
+# Perform the Qt version check.
+include (../OnOffMate/CheckQtVersion.pri)
+
+# Output the build platform.
+include (../OnOffMate/OutputBuildPlatform.pri)
+
+TARGET = oom				# See http://doc.qt.io/qt-5/qmake-variable-reference.html#target .
+TEMPLATE = lib
+CONFIG += staticlib
+
+CONFIG += c99				# See http://doc.qt.io/qt-5/qmake-variable-reference.html#config .
+CONFIG += force_debug_info	# Force the generation of debug information. On Windows, this creates
+							#	a .pdb file.
+CONFIG -= app_bundle
+CONFIG -= gui
+CONFIG -= qt				# See https://doc.qt.io/qt-5/qmake-variable-reference.html#config .
+CONFIG += sdk_no_version_check
+
+# Suppresses the MSVC warnings for strcpy (), memcpy (), etc.
+DEFINES += _CRT_SECURE_NO_WARNINGS
+
+HEADERS += \
+	../../src/c/WakeOnLAN.h \
+	../../src/c/WakeOnLANAsync.h \
+	../../src/c/WakeOnLANEther.h \
+	../../src/c/WakeOnLANHarvest.h \
+	../../src/c/WakeOnLANIfaces.h \
+	../../src/c/WakeOnLANInventory.h \
+	../../src/c/WakeOnLANListen.h \
+	../../src/c/WakeOnLANMAC.h \
+	../../src/c/WakeOnLANPlan.h \
+	../../src/c/WakeOnLANRelay.h \
+	../../src/c/WakeOnLANResolve.h \
+	../../src/c/WakeOnLANSelect.h \
+	../../src/c/WakeOnLANVerify.h \
+	../../src/c/WinLineReader.h \
+	../../src/c/WinRuntimeReplacements.h \
+	../../src/c/WinUTF8Console.h \
+	../../src/c/externC.h
+
+SOURCES += \
+	../../src/c/WakeOnLAN.c \
+	../../src/c/WakeOnLANAsync.c \
+	../../src/c/WakeOnLANEther.c \
+	../../src/c/WakeOnLANHarvest.c \
+	../../src/c/WakeOnLANIfaces.c \
+	../../src/c/WakeOnLANInventory.c \
+	../../src/c/WakeOnLANListen.c \
+	../../src/c/WakeOnLANMAC.c \
+	../../src/c/WakeOnLANPlan.c \
+	../../src/c/WakeOnLANRelay.c \
+	../../src/c/WakeOnLANResolve.c \
+	../../src/c/WakeOnLANSelect.c \
+	../../src/c/WakeOnLANVerify.c \
+	../../src/c/WinLineReader.c \
+	../../src/c/WinRuntimeReplacements.c \
+	../../src/c/WinUTF8Console.c
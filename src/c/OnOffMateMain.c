@@ -11,6 +11,26 @@ History
 When		Who				What
 -----------------------------------------------------------------------------------------
 2024-04-07	Thomas			Created.
+2026-10-17	Thomas			Command WakeOnLANList added.
+2026-10-17	Thomas			Option -uso for WakeOnLANList.
+2026-10-17	Thomas			Command WakeOnLANEther added.
+2026-10-17	Thomas			Command ListenWOL added.
+2026-10-17	Thomas			Command RelayWOL added.
+2026-10-17	Thomas			Options -rate and -grouprate for WakeOnLANList.
+2026-10-17	Thomas			Broadcast target "auto" for WakeOnLAN and WakeOnLANList.
+2026-10-17	Thomas			Options -verify and -timeout for WakeOnLAN and WakeOnLANList.
+2026-10-17	Thomas			WakeOnLAN and RelayWOL accept ff02::1%<if>. Parse addresses once.
+2026-10-17	Thomas			Send policy options -ports, -copies, -spacing, -retries, -backoff.
+2026-10-17	Thomas			MAC addresses in all common notations. Command ParseMACs added.
+2026-10-17	Thomas			Command CompileInventory and host names for WakeOnLAN and lists.
+2026-10-17	Thomas			Command HarvestMACs added.
+2026-10-17	Thomas			Command WakeOnLANSelect added.
+2026-10-17	Thomas			Command WakeOnLANPlan added.
+2026-10-17	Thomas			Command WakeOnLANStress added.
+2026-10-17	Thomas			Option -async for WakeOnLANStress.
+2026-10-17	Thomas			Host names for WakeOnLAN and WakeOnLANList, resolved in parallel.
+2026-10-17	Thomas			Command table with perfect hash dispatch replaces the if/else chain.
+2026-10-17	Thomas			Command Script added.
 
 ****************************************************************************************/
 
@@ -41,6 +61,20 @@ When		Who				What
 	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
+// Must be included before Windows.h because they need Winsock 2.
+#include "./WakeOnLAN.h"
+#include "./WakeOnLANEther.h"
+#include "./WakeOnLANListen.h"
+#include "./WakeOnLANMAC.h"
+#include "./WakeOnLANInventory.h"
+#include "./WakeOnLANHarvest.h"
+#include "./WakeOnLANSelect.h"
+#include "./WakeOnLANPlan.h"
+#include "./WakeOnLANStress.h"
+#include "./WakeOnLANRelay.h"
+#include "./WakeOnLANResolve.h"
+#include "./WakeOnLANVerify.h"
+
 #include <Windows.h>
 /*
 	We're not using the standard libraries to keep the executable size small.
@@ -54,96 +88,10 @@ When		Who				What
 #include "./WinPowerHelpers.h"
 #include "./WinRuntimeReplacements.h"
 #include "./WinUTF8Console.h"
-#include "./WakeOnLAN.h"
-
-/*
-	outPutHelp
+#include "./WinLineReader.h"
 
-	Prints a list with the parameters to the standard output/console.
-*/
 void outPutHelp (void)
-{
-	consoleOutU8	(
-		"\n"
-		ONOFFMATE_VERSION_STRTOT " - Hybernation, sleep, recycle bin, and power helper\n"
-		"\n"
-		"  OnOffMate [command]\n"
-		"  oom [command]\n"
-		"\n"
-		"  Commands:\n"
-		"    ? or /? or h or -h or --help       Outputs this help.\n"
-		"    /a                                 Aborts a task with a grace period.\n"
-		"    Abort                              Aborts a task with a grace period.\n"
-		"    EmptyRecycleBin     [dir1] [...]   Empties either all recycle bins of all drives and\n"
-		"                                       folders, or for [dir1], [dir2], etc only.\n"
-		"    EmptyRecycleBinNC   [dir1] [...]   Empties recycle bins without confirmation.\n"
-		"    EmptyRecycleBinNCP  [dir1] [...]   Empties recycle bins without confirmation and\n"
-		"                                       progress bar.\n"
-		"    EmptyRecycleBinNCPS [dir1] [...]   Empties recycle bins without confirmation, progress\n"
-		"                                       bar, and sound.\n"
-		"    EmptyRecycleBinNCS  [dir1] [...]   Empties recycle bins without confirmation and\n"
-		"                                       sound.\n"
-		"    EmptyRecycleBinNP   [dir1] [...]   Empties recycle bins without progress bar.\n"
-		"    EmptyRecycleBinNPS  [dir1] [...]   Empties recycle bins without progress bar and sound.\n"
-		"    EmptyRecycleBinNS   [dir1] [...]   Empties recycle bins without sound.\n"
-		"    Hybernate                          Hybernates computer instantly.\n"
-		"    HybernateAfter <hs>                Hybernates computer after <hs> seconds.\n"
-		"    Lock                               Locks computer instantly.\n"
-		"    LockAfter <ls>                     Locks computer after <ls> seconds.\n"
-		"    Logoff                             Logs off current user.\n"
-		"    LogoffAfter <os>                   Logs off current user after <os> seconds.\n"
-		"    MonitorLowPower                    Puts the monitor(s) in low power mode.\n"
-		"    MonitorLowPowerAfter <ps>          Puts the monitor(s) in low power mode after <ps>\n"
-		"                                       seconds.\n"
-		"    MonitorOff                         Switches the monitor(s) off instantly.\n"
-		"    MonitorOffAfter <ps>               Switches the monitor(s) off after <ps> seconds.\n"
-		"    MonitorOn                          Switches the monitor(s) on instantly.\n"
-		"    MonitorOnAfter <ps>                Switches the monitor(s) on after <ps> seconds.\n"
-		"    MonitorPowerOff                    Switches the monitor(s) off instantly.\n"
-		"    MonitorPowerOffAfter <ps>          Switches the monitor(s) off after <ps> seconds.\n"
-		"    MonitorPowerOn                     Switches the monitor(s) on instantly.\n"
-		"    MonitorPowerOnAfter <ps>           Switches the monitor(s) on after <ps> seconds.\n"
-		"    PowerOff                           Shuts down and powers off computer instantly.\n"
-		"    PowerOffAfter <ps>                 Shuts down and powers off computer in <ps> seconds.\n"
-		"    PowerOffMsgAfter <ps> <msg>        Shuts down and powers off computer in <ps> seconds\n"
-		"                                       with message <msg>.\n"
-		"    QueryRecycleBin     [dir1] [...]   Queries either all recycle bins of all drives and\n"
-		"                                       folders, or for [dir1], [dir2], etc only.\n"
-		"    Reboot                             Restarts/reboots computer instantly.\n"
-		"    RebootAfter <rs>                   Restarts/reboots computer after <rs> seconds.\n"
-		"    Restart                            Restarts/reboots computer instantly.\n"
-		"    RestartAfter <rs>                  Restarts/reboots computer after <rs> seconds.\n"
-		"    Shutdown                           Shuts down and powers off computer instantly.\n"
-		"    ShutdownAfter <ds>                 Shuts down and powers off computer in <ds> seconds.\n"
-		"    ShutdownMsgAfter <ds> <msg>        Shuts down and powers off computer in <ds> seconds\n"
-		"                                       with message <msg>\n"
-		"    Sleep                              Suspends (sleeps) computer instantly.\n"
-		"    SleepAfter <ss>                    Suspends (sleeps) computer after <ss> seconds.\n"
-		"    SleepWakeupAfter <ws>              Suspends (sleeps) computer instantly and wakes it\n"
-		"                                       up again after <ws> seconds.\n"
-		"    SleepAfterWakeupAfter <ss> <ws>    Suspends (sleeps) computer in <ss> seconds and\n"
-		"                                       wakes it up again after <ws> seconds.\n"
-		"    Suspend                            Suspends (sleeps) computer instantly.\n"
-		"    SuspendAfter <ss>                  Suspends (sleeps) computer after <ss> seconds.\n"
-		"    SuspendWakeupAfter <ws>            Suspends (sleeps) computer instantly and wakes it\n"
-		"                                       up again after <ws> seconds.\n"
-		"    SuspendAfterWakeupAfter <ss> <ws>  Suspends (sleeps) computer in <ss> seconds and\n"
-		"                                       wakes it up again after <ws> seconds.\n"
-		"    Ver                                Prints the version info.\n"
-		"    Version                            Prints the version info.\n"
-		"    WakeOnLAN <brip> <mac> [-f6]       Wakes the host with broadcast IP <brip> and MAC\n"
-		"                                       address <mac>. For example, if the IP address of the\n"
-		"                                       host to wake up is 192.168.0.97 and the subnet mask\n"
-		"                                       is 255.255.255.0, use 192.168.0.255 for <brip>.\n"
-		"                                       Argument -f6 forces IPv6 even if <brip> is IPv4.\n"
-		"\n"
-		"  Note that not every hardware supports all commands, that some options can be activated/\n"
-		"  deactivated in the BIOS, and that others depend on Windows settings.\n"
-		"\n"
-		"  The original behaviour of the Shutdown... commands (shutting down without power off) has\n"
-		"  been changed to be identical to the PowerOff... commands (shutting down and power off).\n"
-					);
-}
+;
 
 const WCHAR wcActionAborting		[]	= L"Aborting shutdown/powerdown";
 const WCHAR wcActionHybernating		[]	= L"Hybernating workstation/computer";
@@ -164,24 +112,6 @@ void outputActionAborting (void)
 	consoleOutW (L"...");
 }
 
-void outputActionHybernating (void)
-{
-	consoleOutW (wcActionHybernating);
-	consoleOutW (L"...");
-}
-
-void outputActionPowerOff (void)
-{
-	consoleOutW (wcActionPowerOff);
-	consoleOutW (L"...");
-}
-
-void outputActionRestarting (void)
-{
-	consoleOutW (wcActionRestarting);
-	consoleOutW (L"...");
-}
-
 void outputActionShuttingDown (void)
 {
 	consoleOutW (wcActionShuttingDown);
@@ -194,36 +124,6 @@ void outputActionSuspending (void)
 	consoleOutW (L"...");
 }
 
-void outputActionLocking (void)
-{
-	consoleOutW (wcActionLocking);
-	consoleOutW (L"...");
-}
-
-void outputActionLoggingOff (void)
-{
-	consoleOutW (wcActionLoggingOff);
-	consoleOutW (L"...");
-}
-
-void outputActionMonitorLowPower (void)
-{
-	consoleOutW (wcActionMonitorLowPower);
-	consoleOutW (L"...");
-}
-
-void outputActionMonitorOff (void)
-{
-	consoleOutW (wcActionMonitorOff);
-	consoleOutW (L"...");
-}
-
-void outputActionMonitorOn (void)
-{
-	consoleOutW (wcActionMonitorOn);
-	consoleOutW (L"...");
-}
-
 void outputSHQUERYRBINFO (wchar_t *wc, SHQUERYRBINFO *pqi)
 {
 	wchar_t		wcNum [UBF_UINT64_SIZ];
@@ -334,497 +234,3021 @@ bool emptyRecycleBin (DWORD flags, int *cArg, int nArgs, WCHAR **wcArgs)
 	return S_OK == hr;
 }
 
-void ourmain (void)
+void outputWOLlistFailures (SWOLLIST *pl)
 {
-	// The command-line arguments.
-	int			nArgs;											// Amount of arguments.
-	WCHAR		**wcArgs = cmdLineArgsW (&nArgs);				// Array of arguments.
-	swallowExeArgW (&nArgs, &wcArgs);							// Suppress the executable.
+	char	szMAC [U_WAKEONLAN_MAC_SIZ];
+	size_t	n;
 
-	//doWeHaveInteractiveSessions ();
+	for (n = 0; n < pl->nTargets; ++ n)
+	{
+		SWOLTARGET *pt = pl->pTargets + n;
 
-	AttachConsole (ATTACH_PARENT_PROCESS);
-	SetCodePageToUTF8 ();
-	SetConsoleEnableANSI ();
+		if (wolretOk == pt->ret)
+			continue;
+		consoleOutW (L"Line ");
+		consoleOutUint64 (pt->nLine);
+		consoleOutW (L": ");
+		switch (pt->ret)
+		{
+			case wolretSyntaxHst:
+				consoleOutW (L"Syntax error: \"");
+				consoleOutU8 (pt->szHost);
+				consoleOutW (L"\" is not a valid broadcast IP address.\n");
+				break;
+			case wolretSyntaxMAC:
+				consoleOutW (L"Syntax error: Missing or invalid MAC address for \"");
+				consoleOutU8 (pt->szHost);
+				consoleOutW (L"\".\n");
+				break;
+			case wolretNoIface:
+				consoleOutW (L"No local network interface with an IPv4 broadcast address found.\n");
+				break;
+			case wolretUnresolved:
+				consoleOutW (L"Host name \"");
+				consoleOutU8 (pt->szHost);
+				consoleOutW (L"\" could not be resolved (error ");
+				consoleOutUint64 ((uint64_t) pt->iWSAerr);
+				consoleOutW (L").\n");
+				break;
+			default:
+				strMACfromOctets (szMAC, pt->ucMAC);
+				consoleOutW (L"Error ");
+				consoleOutUint64 ((uint64_t) pt->iWSAerr);
+				consoleOutW (L" sending magic WOL (Wake on LAN) packet to \"");
+				consoleOutU8 (pt->szHost);
+				consoleOutW (L"\" with MAC address \"");
+				consoleOutU8 (szMAC);
+				consoleOutW (L"\".\n");
+				break;
+		}
+	}
+}
 
-	bool			bCmdComplete						= false;
-	WCHAR			*pwc								= NULL;
-	numArg			evalArg								= enArgInvalid;
-	uint64_t		n1, n2;
+/*
+	Outputs requested and achieved rate, and jitter of a paced list.
+*/
+void outputWOLlistPacing (SWOLLIST *pl)
+{
+	uint64_t	uiRequested	= 0;
+	uint64_t	nGroups		= 0;
+	size_t		n;
 
-	wchar_t			wzIP4asIP6 [U_WAKEONLAN_IPV6_SIZ]	=	U_WAKEONLAN_IPV6V4_PFXW
-															// No idea why, but without this
-															//	MSVC generates a memset ().
-															L"\0";
-	const wchar_t	*wzIP								= wzIP4asIP6;
+	for (n = 0; n < pl->nGroups; ++ n)
+	{
+		if (pl->pGroups [n].nSent)
+			++ nGroups;
+	}
+	if (pl->uiGroupRate)
+		uiRequested = nGroups * pl->uiGroupRate;
+	if (pl->uiRate && (0 == uiRequested || pl->uiRate < uiRequested))
+		uiRequested = pl->uiRate;
+	consoleOutW (L"Requested rate: ");
+	consoleOutUint64 (uiRequested);
+	consoleOutW (L" packets/s, achieved: ");
+	if (pl->nSent > 1 && pl->uiPacedTicks)
+		consoleOutUint64 ((pl->nSent - 1) * pl->uiTicksPerSec / pl->uiPacedTicks);
+	else
+		consoleOutW (L"-");
+	consoleOutW (L" packets/s, groups: ");
+	consoleOutUint64 (nGroups);
+	consoleOutW (L".\n");
+	if (pl->nSent && pl->uiTicksPerSec)
+	{
+		consoleOutW (L"Send delay in microseconds: avg ");
+		consoleOutUint64 (pl->uiJitterTicks * 1000000 / pl->uiTicksPerSec / pl->nSent);
+		consoleOutW (L", max ");
+		consoleOutUint64 (pl->uiJitterMax * 1000000 / pl->uiTicksPerSec);
+		consoleOutW (pl->bHighResTimer ? L" (high-resolution timer).\n" : L".\n");
+	}
+}
 
-	if (!ObtainPrivilege (SE_SHUTDOWN_NAME))
+void outputWOLlistStats (SWOLLIST *pl)
+{
+	consoleOutW (L"Magic WOL (Wake on LAN) packets sent: ");
+	consoleOutUint64 (pl->nSent);
+	consoleOutW (L", send errors: ");
+	consoleOutUint64 (pl->nSendErrors);
+	consoleOutW (L", targets: ");
+	consoleOutUint64 (pl->nTargets);
+	consoleOutW (L", failed: ");
+	consoleOutUint64 (pl->nFailed);
+	consoleOutW (L".\n");
+	if (pl->nNames && pl->uiTicksPerSec)
 	{
-		consoleOutW (L"Error obtaining privilege SE_SHUTDOWN_NAME.\n");
-		ExitProcess (EXIT_FAILURE);
+		consoleOutW (L"Host names: ");
+		consoleOutUint64 (pl->nNames);
+		consoleOutW (L", not in cache: ");
+		consoleOutUint64 (pl->nLookups);
+		consoleOutW (L", resolving took ");
+		consoleOutUint64 (pl->uiResolveTicks * 1000000 / pl->uiTicksPerSec);
+		consoleOutW (L" microseconds.\n");
 	}
-	if (nArgs)
+	if (pl->uiSendTicks && pl->uiTicksPerSec)
 	{
-		int cArg = 0;
-		while (cArg < nArgs)
-		{
-			if	(
-						isArgumentW				(L"?",		wcArgs [cArg])
-					||	isArgumentW				(L"/?",		wcArgs [cArg])
-					||	isArgumentIgnoreCaseW	(L"-h",		wcArgs [cArg])
-					||	isArgumentIgnoreCaseW	(L"--h",	wcArgs [cArg])
-					||	isArgumentIgnoreCaseW	(L"--help",	wcArgs [cArg])
-					||	isArgumentIgnoreCaseW	(L"h",		wcArgs [cArg])
-					||	isArgumentIgnoreCaseW	(L"help",	wcArgs [cArg])
-				)
-			{
-				bCmdComplete = true;
-				outPutHelp ();
-			} else
-			if	(
-						isArgumentIgnoreCaseW (L"/a", wcArgs [cArg])
-					||	isArgumentIgnoreCaseW (L"Abort", wcArgs [cArg])
-				)
-			{
-				bCmdComplete = true;
-				outputActionAborting ();
-				AbortShutdownOrFail ();
-			} else
-			if	(isArgumentIgnoreCaseW (L"EmptyRecycleBin", wcArgs [cArg]))
-			{
-				bCmdComplete = true;
-				emptyRecycleBin (0, &cArg, nArgs, wcArgs);
-			} else
-			if	(isArgumentIgnoreCaseW (L"EmptyRecycleBinNC", wcArgs [cArg]))
-			{
-				bCmdComplete = true;
-				emptyRecycleBin (SHERB_NOCONFIRMATION, &cArg, nArgs, wcArgs);
-			} else
-			if	(isArgumentIgnoreCaseW (L"EmptyRecycleBinNCP", wcArgs [cArg]))
-			{
-				bCmdComplete = true;
-				emptyRecycleBin (SHERB_NOCONFIRMATION | SHERB_NOPROGRESSUI, &cArg, nArgs, wcArgs);
-			} else
-			if	(isArgumentIgnoreCaseW (L"EmptyRecycleBinNCPS", wcArgs [cArg]))
-			{
-				bCmdComplete = true;
-				emptyRecycleBin (SHERB_NOCONFIRMATION | SHERB_NOPROGRESSUI | SHERB_NOSOUND, &cArg, nArgs, wcArgs);
-			} else
-			if	(isArgumentIgnoreCaseW (L"EmptyRecycleBinNCS", wcArgs [cArg]))
-			{
-				bCmdComplete = true;
-				emptyRecycleBin (SHERB_NOCONFIRMATION | SHERB_NOSOUND, &cArg, nArgs, wcArgs);
-			} else
-			if	(isArgumentIgnoreCaseW (L"EmptyRecycleBinNP", wcArgs [cArg]))
-			{
-				bCmdComplete = true;
-				emptyRecycleBin (SHERB_NOPROGRESSUI, &cArg, nArgs, wcArgs);
-			} else
-			if	(isArgumentIgnoreCaseW (L"EmptyRecycleBinNPS", wcArgs [cArg]))
-			{
-				bCmdComplete = true;
-				emptyRecycleBin (SHERB_NOPROGRESSUI | SHERB_NOSOUND, &cArg, nArgs, wcArgs);
-			} else
-			if	(isArgumentIgnoreCaseW (L"EmptyRecycleBinNS", wcArgs [cArg]))
+		consoleOutW (L"Sending took ");
+		consoleOutUint64 (pl->uiSendTicks * 1000000 / pl->uiTicksPerSec);
+		consoleOutW (L" microseconds (");
+		consoleOutUint64 (pl->nSent * pl->uiTicksPerSec / pl->uiSendTicks);
+		consoleOutW (L" packets/s).\n");
+	}
+	consoleOutW (L"System calls: ");
+	consoleOutUint64 (pl->nSendCalls);
+	consoleOutW (L", CPU time: ");
+	consoleOutUint64 (pl->uiCPUtime / 10);
+	consoleOutW (L" microseconds");
+	if (pl->nSent)
+	{
+		consoleOutW (L" (");
+		consoleOutUint64 (pl->uiCPUtime * 1000 / pl->nSent);
+		consoleOutW (L" microseconds per 10000 packets)");
+	}
+	consoleOutW (L".\n");
+	if (pl->uiRate || pl->uiGroupRate)
+		outputWOLlistPacing (pl);
+	else
+	if (pl->bUseUSO && !pl->bUSOavailable)
+		consoleOutW (L"UDP segmentation offload not available. Packets sent individually.\n");
+}
+
+/*
+	Outputs how many magic packets the hosts that are up had been sent, and how many
+	hosts came up after the first round.
+*/
+void outputWOLcopiesToWake (SWOLVERIFY *pv, SWOLLIST *pl)
+{
+	uint64_t	uiFirst		= (uint64_t) pl->policy.uiCopies * pl->policy.nPorts;
+	uint64_t	uiMin		= 0;
+	uint64_t	uiMax		= 0;
+	uint64_t	uiSum		= 0;
+	size_t		nFirst		= 0;
+	size_t		n;
+
+	for (n = 0; n < pv->nProbes; ++ n)
+	{
+		SWOLPROBE	*pp	= pv->pProbes + n;
+		uint64_t	ui	= pp->pt->nCopiesToWake;
+		if (wolprbUp != pp->state)
+			continue;
+		if (0 == uiSum || ui < uiMin)
+			uiMin = ui;
+		if (ui > uiMax)
+			uiMax = ui;
+		uiSum += ui;
+		if (ui <= uiFirst)
+			++ nFirst;
+	}
+	consoleOutW (L"Magic packets sent until up: min ");
+	consoleOutUint64 (uiMin);
+	consoleOutW (L", avg ");
+	consoleOutUint64 (uiSum / pv->nUp);
+	consoleOutW (L", max ");
+	consoleOutUint64 (uiMax);
+	consoleOutW (L", hosts up after the first round: ");
+	consoleOutUint64 (nFirst);
+	consoleOutW (L".\n");
+}
+
+/*
+	Outputs the results of a verification.
+*/
+void outputWOLverify (SWOLVERIFY *pv, SWOLLIST *pl)
+{
+	static const uint64_t	uiBounds []	= { 1, 2, 4, 8, 16, 32, 64, 128 };
+	size_t					nBuckets	= sizeof (uiBounds) / sizeof (uiBounds [0]) + 1;
+	size_t					nCount [sizeof (uiBounds) / sizeof (uiBounds [0]) + 1];
+	size_t					nMax		= 0;
+	size_t					nNoIP		= 0;
+	size_t					n, b;
+	char					szIP [U_WAKEONLAN_IPV6_SIZ];
+	char					szMAC [U_WAKEONLAN_MAC_SIZ];
+
+	for (n = 0; n < pl->nTargets; ++ n)
+	{
+		if (wolretOk == pl->pTargets [n].ret && 0 == pl->pTargets [n].lenHost)
+			++ nNoIP;
+	}
+	consoleOutW (L"Hosts up: ");
+	consoleOutUint64 (pv->nUp);
+	consoleOutW (L" of ");
+	consoleOutUint64 (pv->nProbes);
+	consoleOutW (L", probes: ");
+	consoleOutUint64 (pv->nAttempts);
+	consoleOutW (L".\n");
+	if (nNoIP)
+	{
+		consoleOutUint64 (nNoIP);
+		consoleOutW (L" host(s) without IP address not verified.\n");
+	}
+	if (0 == pv->nUp)
+		return;
+
+	if (!isDefaultWOLpolicy (&pl->policy))
+		outputWOLcopiesToWake (pv, pl);
+	consoleOutW (L"Time to wake in milliseconds: p50 ");
+	consoleOutUint64 (percentileWOLverify (pv, 50));
+	consoleOutW (L", p95 ");
+	consoleOutUint64 (percentileWOLverify (pv, 95));
+	consoleOutW (L", p99 ");
+	consoleOutUint64 (percentileWOLverify (pv, 99));
+	consoleOutW (L", max ");
+	consoleOutUint64 (percentileWOLverify (pv, 100));
+	consoleOutW (L".\n");
+
+	// Histogram with buckets of powers of 2 seconds.
+	for (b = 0; b < nBuckets; ++ b)
+		nCount [b] = 0;
+	for (n = 0; n < pv->nUp; ++ n)
+	{
+		for (b = 0; b < nBuckets - 1 && pv->puiWakeMs [n] >= uiBounds [b] * 1000; ++ b)
+			;
+		if (++ nCount [b] > nMax)
+			nMax = nCount [b];
+	}
+	for (b = 0; b < nBuckets; ++ b)
+	{
+		size_t nBar = nCount [b] * 40 / nMax;
+		if (b < nBuckets - 1)
+		{
+			consoleOutW (L"  < ");
+			if (uiBounds [b] < 100)
+				consoleOutW (L" ");
+			if (uiBounds [b] < 10)
+				consoleOutW (L" ");
+			consoleOutUint64 (uiBounds [b]);
+		} else
+		{
+			consoleOutW (L" >= ");
+			consoleOutUint64 (uiBounds [b - 1]);
+		}
+		consoleOutW (L" s |");
+		while (nBar --)
+			consoleOutW (L"#");
+		consoleOutW (L" ");
+		consoleOutUint64 (nCount [b]);
+		consoleOutW (L"\n");
+	}
+
+	if (pv->nUp == pv->nProbes)
+		return;
+	consoleOutW (L"Hosts that did not wake up:\n");
+	for (n = 0; n < pv->nProbes; ++ n)
+	{
+		SWOLPROBE *pp = pv->pProbes + n;
+		if (wolprbUp == pp->state)
+			continue;
+		if (AF_INET == pp->pt->ssHost.ss_family)
+			inet_ntop (AF_INET, &((struct sockaddr_in *) &pp->pt->ssHost)->sin_addr, szIP, sizeof (szIP));
+		else
+			inet_ntop (AF_INET6, &((struct sockaddr_in6 *) &pp->pt->ssHost)->sin6_addr, szIP, sizeof (szIP));
+		strMACfromOctets (szMAC, pp->pt->ucMAC);
+		consoleOutW (L"  ");
+		consoleOutU8 (szIP);
+		consoleOutW (L" (");
+		consoleOutU8 (szMAC);
+		consoleOutW (L"), probes: ");
+		consoleOutUint64 (pp->nAttempts);
+		consoleOutW (L"\n");
+	}
+}
+
+/*
+	Outputs the ports and copies of the send policy pp, for instance "UDP ports 7, 9
+	(3 copies)".
+*/
+void outputWOLpolicy (const SWOLPOLICY *pp)
+{
+	size_t n;
+
+	consoleOutW (1 == pp->nPorts ? L"UDP port " : L"UDP ports ");
+	for (n = 0; n < pp->nPorts; ++ n)
+	{
+		if (n)
+			consoleOutW (L", ");
+		consoleOutUint64 (pp->uiPorts [n]);
+	}
+	if (pp->uiCopies > 1)
+	{
+		consoleOutW (L" (");
+		consoleOutUint64 (pp->uiCopies);
+		consoleOutW (L" copies)");
+	}
+}
+
+/*
+	Outputs the rounds sent if the send policy has retry rounds.
+*/
+void outputWOLlistRounds (SWOLLIST *pl)
+{
+	if (0 == pl->policy.uiRetries)
+		return;
+	consoleOutW (L"Rounds sent: ");
+	consoleOutUint64 (pl->nRounds);
+	consoleOutW (L" of ");
+	consoleOutUint64 ((uint64_t) pl->policy.uiRetries + 1);
+	consoleOutW (L", magic WOL (Wake on LAN) packets sent in total: ");
+	consoleOutUint64 (pl->nSent);
+	consoleOutW (L".\n");
+}
+
+/*
+	Verifies the list after it has been sent, if pv is not NULL.
+*/
+void verifyWakeOnLANlist (SWOLLIST *pl, SWOLVERIFY *pv)
+{
+	if (NULL == pv)
+		return;
+	consoleOutW (L"Waiting for hosts to wake up...\n");
+	if (verifyWOLlist (pv, pl))
+		outputWOLverify (pv, pl);
+	else
+		consoleOutW (L"Error setting up reachability probes.\n");
+	doneWOLverify (pv);
+	outputWOLlistRounds (pl);
+}
+
+/*
+	Returns true if wcOpt is one of the options wakeOptionsW () parses.
+*/
+bool isWakeOptionW (WCHAR *wcOpt)
+{
+	return	(
+					isArgumentIgnoreCaseW (L"-verify", wcOpt)
+				||	isArgumentIgnoreCaseW (L"-timeout", wcOpt)
+				||	isArgumentIgnoreCaseW (L"-ports", wcOpt)
+				||	isArgumentIgnoreCaseW (L"-copies", wcOpt)
+				||	isArgumentIgnoreCaseW (L"-spacing", wcOpt)
+				||	isArgumentIgnoreCaseW (L"-retries", wcOpt)
+				||	isArgumentIgnoreCaseW (L"-backoff", wcOpt)
+			);
+}
+
+/*
+	Parses the options -verify <probe>, -timeout <s>, and the send policy options -ports
+	<p1,p2,...>, -copies <n>, -spacing <ms>, -retries <n>, and -backoff <ms>, starting at
+	the argument after *pcArg. If pwcIP is not NULL, <probe> is followed by the IP address
+	of the host, which is stored at *pwcIP. The function returns false on a syntax error
+	and stores the kind of error at *pevalArg.
+*/
+bool wakeOptionsW	(
+		SWOLVERIFY *pv, SWOLPOLICY *pp, WCHAR **pwcIP, int *pcArg, int nArgs, WCHAR **wcArgs,
+		numArg *pevalArg
+					)
+{
+	WCHAR		*wcOpt;
+	uint64_t	uiSecs;
+	uint64_t	uiNum;
+
+	while ((wcOpt = nextArgumentW (pcArg, nArgs, wcArgs)))
+	{
+		if (isArgumentIgnoreCaseW (L"-ports", wcOpt))
+		{
+			WCHAR *wcPorts = nextArgumentW (pcArg, nArgs, wcArgs);
+			if (NULL == wcPorts)
 			{
-				bCmdComplete = true;
-				emptyRecycleBin (SHERB_NOSOUND, &cArg, nArgs, wcArgs);
-			} else
-			if	(isArgumentIgnoreCaseW (L"Hybernate", wcArgs [cArg]))
+				*pevalArg = enArgMissingAfter;
+				return false;
+			}
+			if (!parseWOLpolicyPortsW (pp, wcPorts))
 			{
-				bCmdComplete = true;
-				outputActionHybernating ();
-				HybernateComputerOrFail ();
-			} else
-			if	(isArgumentIgnoreCaseW (L"HybernateAfter", wcArgs [cArg]))
+				*pevalArg = enArgInvalid;
+				return false;
+			}
+		} else
+		if	(
+					isArgumentIgnoreCaseW (L"-copies", wcOpt)
+				||	isArgumentIgnoreCaseW (L"-spacing", wcOpt)
+				||	isArgumentIgnoreCaseW (L"-retries", wcOpt)
+				||	isArgumentIgnoreCaseW (L"-backoff", wcOpt)
+			)
+		{
+			*pevalArg = compulsoryNumber (&uiNum, pcArg, nArgs, wcArgs);
+			if (enArgIsNumber != *pevalArg)
+				return false;
+			if (isArgumentIgnoreCaseW (L"-copies", wcOpt))
 			{
-				if (enArgIsNumber == (evalArg = compulsoryNumber (&n1, &cArg, nArgs, wcArgs)))
+				if (0 == uiNum || uiNum > U_WAKEONLAN_POLICY_MAX_COPIES)
 				{
-					bCmdComplete = true;
-					waitForW (n1, wcActionHybernating);
-					HybernateComputerOrFail ();
+					*pevalArg = enArgInvalid;
+					return false;
 				}
+				pp->uiCopies = (uint32_t) uiNum;
 			} else
-			if	(isArgumentIgnoreCaseW (L"Logoff", wcArgs [cArg]))
-			{
-				bCmdComplete = true;
-				outputActionLoggingOff ();
-				LogoffOrFail ();
-			} else
-			if	(isArgumentIgnoreCaseW (L"LogoffAfter", wcArgs [cArg]))
+			if (isArgumentIgnoreCaseW (L"-retries", wcOpt))
 			{
-				if (enArgIsNumber == (evalArg = compulsoryNumber (&n1, &cArg, nArgs, wcArgs)))
+				if (uiNum > U_WAKEONLAN_POLICY_MAX_ROUNDS)
 				{
-					bCmdComplete = true;
-					waitForW (n1, wcActionLoggingOff);
-					LogoffOrFail ();
+					*pevalArg = enArgInvalid;
+					return false;
 				}
+				pp->uiRetries = (uint32_t) uiNum;
 			} else
-			if	(isArgumentIgnoreCaseW (L"Lock", wcArgs [cArg]))
+			if (isArgumentIgnoreCaseW (L"-spacing", wcOpt))
+				pp->uiSpacingMs = uiNum;
+			else
+				pp->uiBackoffMs = uiNum;
+		} else
+		if (isArgumentIgnoreCaseW (L"-verify", wcOpt))
+		{
+			WCHAR *wcProbe = nextArgumentW (pcArg, nArgs, wcArgs);
+			if (NULL == wcProbe)
 			{
-				bCmdComplete = true;
-				outputActionLocking ();
-				LockThisComputerOrFail ();
-			} else
-			if	(isArgumentIgnoreCaseW (L"LockAfter", wcArgs [cArg]))
+				*pevalArg = enArgMissingAfter;
+				return false;
+			}
+			if (!parseWOLprobeW (pv, wcProbe))
 			{
-				if (enArgIsNumber == (evalArg = compulsoryNumber (&n1, &cArg, nArgs, wcArgs)))
-				{
-					bCmdComplete = true;
-					waitForW (n1, wcActionLocking);
-					LockThisComputerOrFail ();
-				}
-			} else
-			if	(isArgumentIgnoreCaseW (L"MonitorLowPower", wcArgs [cArg]))
-			{
-				bCmdComplete = true;
-				outputActionMonitorLowPower ();
-				MonitorLowPower ();
-				consoleOutW (L"\nMonitor(s) switched to low power mode.\n");
-			} else
-			if	(isArgumentIgnoreCaseW (L"MonitorLowPowerAfter", wcArgs [cArg]))
-			{
-				if (enArgIsNumber == (evalArg = compulsoryNumber (&n1, &cArg, nArgs, wcArgs)))
-				{
-					bCmdComplete = true;
-					waitForW (n1, wcActionMonitorLowPower);
-					MonitorLowPower ();
-					consoleOutW (L"\nMonitor(s) switched to low power mode.\n");
-				}
-			} else
-			if	(
-						isArgumentIgnoreCaseW (L"MonitorOff", wcArgs [cArg])
-					||	isArgumentIgnoreCaseW (L"MonitorPowerOff", wcArgs [cArg])
-				)
-			{
-				bCmdComplete = true;
-				outputActionMonitorOff ();
-				MonitorPowerOff ();
-				consoleOutW (L"\nMonitor(s) powered off.\n");
-			} else
-			if	(
-						isArgumentIgnoreCaseW (L"MonitorOffAfter", wcArgs [cArg])
-					||	isArgumentIgnoreCaseW (L"MonitorPowerOffAfter", wcArgs [cArg])
-				)
-			{
-				if (enArgIsNumber == (evalArg = compulsoryNumber (&n1, &cArg, nArgs, wcArgs)))
-				{
-					bCmdComplete = true;
-					waitForW (n1, wcActionMonitorOff);
-					MonitorPowerOff ();
-					consoleOutW (L"\nMonitor(s) powered off.\n");
-				}
-			} else
-			if	(
-						isArgumentIgnoreCaseW (L"MonitorOn", wcArgs [cArg])
-					||	isArgumentIgnoreCaseW (L"MonitorPowerOn", wcArgs [cArg])
-				)
-			{
-				bCmdComplete = true;
-				outputActionMonitorOn ();
-				MonitorPowerOn ();
-				consoleOutW (L"\nMonitor(s) powered on.\n");
-			} else
-			if	(
-						isArgumentIgnoreCaseW (L"MonitorOnAfter", wcArgs [cArg])
-					||	isArgumentIgnoreCaseW (L"MonitorPowerOnAfter", wcArgs [cArg])
-				)
-			{
-				if (enArgIsNumber == (evalArg = compulsoryNumber (&n1, &cArg, nArgs, wcArgs)))
-				{
-					bCmdComplete = true;
-					waitForW (n1, wcActionMonitorOn);
-					MonitorPowerOn ();
-					consoleOutW (L"\nMonitor(s) powered on.\n");
-				}
-			} else
-			if	(isArgumentIgnoreCaseW (L"PowerOff", wcArgs [cArg]))
-			{
-				bCmdComplete = true;
-				outputActionPowerOff ();
-				PowerOffComputerOrFail ();
-			} else
-			if	(isArgumentIgnoreCaseW (L"PowerOffAfter", wcArgs [cArg]))
-			{
-				if (enArgIsNumber == (evalArg = compulsoryNumber (&n1, &cArg, nArgs, wcArgs)))
-				{
-					bCmdComplete = true;
-					waitForW (n1, wcActionPowerOff);
-					PowerOffComputerOrFail ();
-				}
-			} else
-			if	(isArgumentIgnoreCaseW (L"PowerOffMsgAfter", wcArgs [cArg]))
-			{
-				if (enArgIsNumber == (evalArg = compulsoryNumber (&n1, &cArg, nArgs, wcArgs)))
-				{
-					if (n1 <= MAXDWORD)
-					{
-						bCmdComplete = true;
-						outputActionShuttingDown ();
-						ShutdownComputerWithMsgAndGracePeriodW (nextArgumentW (&cArg, nArgs, wcArgs), (DWORD) n1);
-					} else
-						evalArg = enArgNumberTooBig;
-				}
-			} else
-			if	(isArgumentIgnoreCaseW (L"QueryRecycleBin",	wcArgs [cArg]))
-			{
-				bCmdComplete = true;
-				queryRecycleBins (&cArg, nArgs, wcArgs);
-			} else
-			if	(		isArgumentIgnoreCaseW (L"Reboot",	wcArgs [cArg])
-					||	isArgumentIgnoreCaseW (L"Restart",	wcArgs [cArg])
-				)
-			{
-				bCmdComplete = true;
-				outputActionRestarting ();
-				RestartComputerOrFail ();
-			} else
-			if	(		isArgumentIgnoreCaseW (L"RebootAfter",	wcArgs [cArg])
-					||	isArgumentIgnoreCaseW (L"RestartAfter",	wcArgs [cArg])
-				)
-			{
-				if (enArgIsNumber == (evalArg = compulsoryNumber (&n1, &cArg, nArgs, wcArgs)))
-				{
-					bCmdComplete = true;
-					waitForW (n1, wcActionRestarting);
-					RestartComputerOrFail ();
-				}
-			} else
-			if	(isArgumentIgnoreCaseW (L"Shutdown", wcArgs [cArg]))
-			{
-				bCmdComplete = true;
-				outputActionShuttingDown ();
-				ShutdownComputerOrFail ();
-			} else
-			if	(isArgumentIgnoreCaseW (L"ShutdownAfter", wcArgs [cArg]))
-			{
-				if (enArgIsNumber == (evalArg = compulsoryNumber (&n1, &cArg, nArgs, wcArgs)))
-				{
-					if (n1 <= MAXDWORD)
-					{
-						bCmdComplete = true;
-						waitForW (n1, wcActionShuttingDown);
-						ShutdownComputerOrFail ();
-					} else
-						evalArg = enArgNumberTooBig;
-				}
-			} else
-			if	(isArgumentIgnoreCaseW (L"ShutdownMsgAfter", wcArgs [cArg]))
-			{
-				if (enArgIsNumber == (evalArg = compulsoryNumber (&n1, &cArg, nArgs, wcArgs)))
-				{
-					if (n1 <= MAXDWORD)
-					{
-						bCmdComplete = true;
-						outputActionShuttingDown ();
-						ShutdownComputerWithMsgAndGracePeriodW (nextArgumentW (&cArg, nArgs, wcArgs), (DWORD) n1);
-					} else
-						evalArg = enArgNumberTooBig;
-				}
-			} else
-			if	(		isArgumentIgnoreCaseW (L"Sleep",	wcArgs [cArg])
-					||	isArgumentIgnoreCaseW (L"Suspend",	wcArgs [cArg])
-				)
-			{
-				bCmdComplete = true;
-				outputActionSuspending ();
-				SuspendComputerOrFail ();
-			} else
-			if	(		isArgumentIgnoreCaseW (L"SleepAfter",	wcArgs [cArg])
-					||	isArgumentIgnoreCaseW (L"SuspendAfter",	wcArgs [cArg])
-				)
-			{
-				if (enArgIsNumber == (evalArg = compulsoryNumber (&n1, &cArg, nArgs, wcArgs)))
-				{
-					bCmdComplete = true;
-					waitForW (n1, wcActionSuspending);
-					SuspendComputerOrFail ();
-				}
-			} else
-			if	(
-						isArgumentIgnoreCaseW (L"SleepWakeupAfter",		wcArgs [cArg])
-					||	isArgumentIgnoreCaseW (L"SuspendWakeupAfter",	wcArgs [cArg])
-				)
-			{
-				if (enArgIsNumber == (evalArg = compulsoryNumber (&n1, &cArg, nArgs, wcArgs)))
-				{
-					if (n1 <= MAXDWORD)
-					{
-						HANDLE h = StartThreadWakeupComputerAfter ((DWORD) n1);
-						if (h)
-						{
-							outputActionSuspending ();
-							consoleOutW (L" ");
-							outWaitForW (n1, wcActionWakingUp);
-							SuspendComputerOrFail ();
-							WaitForSingleObject (h, INFINITE);
-							bCmdComplete = true;
-						} else
-							evalArg = enArgTaskError;
-					} else
-						evalArg = enArgNumberTooBig;
-				}
-			} else
-			if	(
-						isArgumentIgnoreCaseW (L"SleepAfterWakeupAfter",	wcArgs [cArg])
-					||	isArgumentIgnoreCaseW (L"SuspendAfterWakeupAfter",	wcArgs [cArg])
-				)
+				*pevalArg = enArgInvalid;
+				return false;
+			}
+			if (pwcIP && NULL == (*pwcIP = nextArgumentW (pcArg, nArgs, wcArgs)))
 			{
-				if (enArgIsNumber == (evalArg = compulsoryNumber (&n1, &cArg, nArgs, wcArgs)))
-				{
-					if (n1 <= MAXDWORD)
-					{
-						if (enArgIsNumber == (evalArg = compulsoryNumber (&n2, &cArg, nArgs, wcArgs)))
-						{
-							if (n1 <= MAXDWORD)
-							{
-								waitForW (n1, wcActionSuspending);
-								HANDLE h = StartThreadWakeupComputerAfter ((DWORD) n2);
-								if (h)
-								{
-									consoleOutW (L" ");
-									outWaitForW (n2, wcActionWakingUp);
-									SuspendComputerOrFail ();
-									WaitForSingleObject (h, INFINITE);
-									bCmdComplete = true;
-								} else
-									evalArg = enArgTaskError;
-							} else
-								evalArg = enArgNumberTooBig;
-						}
-					} else
-						evalArg = enArgNumberTooBig;
-				}
-			} else
-			if	(
-						isArgumentIgnoreCaseW (L"Ver",		wcArgs [cArg])
-					||	isArgumentIgnoreCaseW (L"Version",	wcArgs [cArg])
-				)
+				*pevalArg = enArgMissingAfter;
+				return false;
+			}
+		} else
+		if (isArgumentIgnoreCaseW (L"-timeout", wcOpt))
+		{
+			*pevalArg = compulsoryNumber (&uiSecs, pcArg, nArgs, wcArgs);
+			if (enArgIsNumber != *pevalArg)
+				return false;
+			pv->uiTimeoutMs = uiSecs * 1000;
+		} else
+		{
+			-- *pcArg;
+			break;
+		}
+	}
+	return true;
+}
+
+/*
+	Adds the host with broadcast IP wcHost and MAC address wcMAC to the list pl and sends
+	the first round of the list's send policy. If wcIP is not NULL, it is set as the
+	address of the host for verification. See verifyWakeOnLANlist ().
+*/
+enum eWOLret wakeOnLANhost	(
+				SWOLLIST *pl, const wchar_t *wcHost, const wchar_t *wcMAC, bool bForceV6,
+				const wchar_t *wcIP
+							)
+{
+	char			szHost [U_WAKEONLAN_DEF_U8_SIZE];
+	char			szMAC [U_WAKEONLAN_DEF_U8_SIZE];
+	char			szIP [U_WAKEONLAN_IPV6_SIZ];
+	enum eWOLret	ret;
+	size_t			n;
+
+	UTF8_from_WinU16 (szHost, sizeof (szHost), wcHost);
+	UTF8_from_WinU16 (szMAC, sizeof (szMAC), wcMAC);
+	ret = addWOLlistTargetU8 (pl, szHost, szMAC, bForceV6, 0, NULL);
+	if (pl->nUnresolved)
+		resolveWOLlist (pl);
+	if (0 == pl->nTargets)
+		return ret;
+	if (wolretOk != pl->pTargets [0].ret)
+		return pl->pTargets [0].ret;
+	if (wcIP)
+	{
+		UTF8_from_WinU16 (szIP, sizeof (szIP), wcIP);
+		// A broadcast IP of "auto" results in several targets for the same host.
+		for (n = 0; n < pl->nTargets; ++ n)
+		{
+			if (!setWOLtargetHostU8 (pl->pTargets + n, szIP))
 			{
-				consoleOutU8 (ONOFFMATE_VERSION_STRTOT);
-				consoleOutU8 ("\n");
-				bCmdComplete = true;
+				consoleOutW (L"Syntax error: \"");
+				consoleOutW (wcIP);
+				consoleOutW (L"\" is not a valid IP address.\n");
+				return wolretMissing;
 			}
-			if (isArgumentIgnoreCaseW (L"WakeOnLAN", wcArgs [cArg]))
+		}
+	}
+	sendWOLlist (pl);
+	return pl->nSent ? wolretOk : wolretErrSend;
+}
+
+/*
+	Returns true if wcHost and wcMAC are not a broadcast IP and a MAC address, in which
+	case wcHost is the name of a host in the inventory. wcMAC can be NULL.
+*/
+bool isInventoryNameW (WCHAR *wcHost, const wchar_t *wcMAC)
+{
+	unsigned char ucMAC [6];
+
+	return		!isArgumentIgnoreCaseW (L"auto", wcHost)
+			&&	!isGoodWOLpeerStringW (wcHost)
+			&&	(NULL == wcMAC || !parseWOLmacW (ucMAC, wcMAC, strlenW (wcMAC)));
+}
+
+/*
+	Looks up the host wcName in the default inventory database, adds it to the list pl, and
+	sends the first round of the list's send policy. The MAC address of the host is written
+	to wcMAC, which has space for U_WAKEONLAN_MAC_SIZ characters. If the host or the
+	database doesn't exist, the function outputs an error and returns wolretMissing.
+*/
+enum eWOLret wakeOnLANname (SWOLLIST *pl, const wchar_t *wcName, wchar_t *wcMAC)
+{
+	SWOLINVENTORY		inv;
+	const SWOLINVRECORD	*pr;
+	wchar_t				wcDB [MAX_PATH];
+	char				szName [U_WAKEONLAN_DEF_U8_SIZE];
+	char				szMAC [U_WAKEONLAN_MAC_SIZ];
+	enum eWOLret		ret;
+	size_t				n;
+
+	wcDB [0] = L'\0';
+	if (!defaultWOLinventoryW (wcDB, MAX_PATH) || !openWOLinventoryW (&inv, wcDB))
+	{
+		consoleOutW (L"Error opening inventory database \"");
+		consoleOutW (wcDB);
+		consoleOutW (L"\" to look up \"");
+		consoleOutW (wcName);
+		consoleOutW (L"\".");
+		consoleOutWinErrorText (GetLastError ());
+		return wolretMissing;
+	}
+	UTF8_from_WinU16 (szName, sizeof (szName), wcName);
+	pr = findWOLinventoryU8 (&inv, szName, strlenU (szName));
+	if (NULL == pr)
+	{
+		consoleOutW (L"Host \"");
+		consoleOutW (wcName);
+		consoleOutW (L"\" not found in inventory database \"");
+		consoleOutW (wcDB);
+		consoleOutW (L"\".\n");
+		closeWOLinventory (&inv);
+		return wolretMissing;
+	}
+	strMACfromOctets (szMAC, pr->ucMAC);
+	for (n = 0; n < U_WAKEONLAN_MAC_SIZ; ++ n)
+		wcMAC [n] = (unsigned char) szMAC [n];
+	ret = addWOLinventoryTarget (pl, &inv, pr, 0, NULL);
+	closeWOLinventory (&inv);
+	if (0 == pl->nTargets)
+		return ret;
+	if (wolretOk != pl->pTargets [0].ret)
+		return pl->pTargets [0].ret;
+	sendWOLlist (pl);
+	return pl->nSent ? wolretOk : wolretErrSend;
+}
+
+/*
+	Compiles the inventory wcCSV into the database wcDB, or into the default database if
+	wcDB is NULL, and outputs the result.
+*/
+bool compileInventory (const wchar_t *wcCSV, const wchar_t *wcDB)
+{
+	SWOLINVSTATS	st;
+	wchar_t			wcDefault [MAX_PATH];
+	enum eWOLinvRet	ret;
+
+	if (NULL == wcDB)
+	{
+		if (!defaultWOLinventoryW (wcDefault, MAX_PATH))
+		{
+			consoleOutW (L"The path of the default inventory database is too long.\n");
+			return false;
+		}
+		wcDB = wcDefault;
+	}
+	ret = compileWOLinventoryW (wcCSV, wcDB, &st);
+	switch (ret)
+	{
+		case wolinvOk:
+			consoleOutW (L"Inventory database \"");
+			consoleOutW (wcDB);
+			consoleOutW (L"\" written with ");
+			consoleOutUint64 (st.nRecords);
+			consoleOutW (L" hosts, ");
+			consoleOutUint64 (st.uiFileSize);
+			consoleOutW (L" octets, in ");
+			consoleOutUint64 (st.uiTicks * 1000000 / st.uiTicksPerSec);
+			consoleOutW (L" microseconds. Largest displacement: ");
+			consoleOutUint64 (st.uiMaxDisplacement);
+			consoleOutW (L".\n");
+			return true;
+		case wolinvErrRead:
+			consoleOutW (L"Error reading inventory \"");
+			consoleOutW (wcCSV);
+			consoleOutW (L"\".");
+			consoleOutWinErrorText (GetLastError ());
+			return false;
+		case wolinvErrWrite:
+			consoleOutW (L"Error writing inventory database \"");
+			consoleOutW (wcDB);
+			consoleOutW (L"\".");
+			consoleOutWinErrorText (GetLastError ());
+			return false;
+		case wolinvErrMemory:
+			consoleOutW (L"Out of memory.\n");
+			return false;
+		case wolinvTooBig:
+			consoleOutW (L"The inventory is too big.\n");
+			return false;
+		default:
+			break;
+	}
+	consoleOutW (L"Line ");
+	consoleOutUint64 (st.nLine);
+	consoleOutW (L": ");
+	switch (ret)
+	{
+		case wolinvSyntaxMAC:
+			consoleOutW (L"Syntax error: Missing or invalid MAC address.\n");
+			break;
+		case wolinvSyntaxHst:
+			consoleOutW (L"Syntax error: Missing or invalid broadcast IP address.\n");
+			break;
+		case wolinvSyntaxPort:
+			consoleOutW (L"Syntax error: Invalid port.\n");
+			break;
+		case wolinvSyntaxIP:
+			consoleOutW (L"Syntax error: Invalid IP address.\n");
+			break;
+		case wolinvMissingName:
+			consoleOutW (L"Syntax error: Missing host name.\n");
+			break;
+		case wolinvDuplicate:
+			consoleOutW (L"The host name is not unique.\n");
+			break;
+		default:
+			break;
+	}
+	return false;
+}
+
+/*
+	Outputs the source wcSrc and an error if bOk is false.
+*/
+bool harvestMACsSourceResult (const wchar_t *wcSrc, bool bOk)
+{
+	if (!bOk)
+	{
+		consoleOutW (L"Error reading MAC addresses from ");
+		consoleOutW (wcSrc);
+		consoleOutW (L".");
+		consoleOutWinErrorText (GetLastError ());
+	}
+	return bOk;
+}
+
+/*
+	Reads the sources and options of the command HarvestMACs, starting at the argument
+	after *pcArg, harvests their MAC addresses, merges them into the inventory wcCSV, and
+	outputs the results. The function returns false on a syntax error and stores the kind
+	of error at *pevalArg.
+*/
+bool harvestMACs (const wchar_t *wcCSV, int *pcArg, int nArgs, WCHAR **wcArgs, numArg *pevalArg)
+{
+	SWOLHARVEST	h;
+	WCHAR		*wcSrc;
+	char		szBrIP [U_WAKEONLAN_DEF_U8_SIZE];
+	bool		bBrIP	= false;
+	bool		bOk		= true;
+	size_t		nSrcs	= 0;
+
+	initWOLharvest (&h);
+	while (bOk && (wcSrc = nextArgumentW (pcArg, nArgs, wcArgs)))
+	{
+		if (isArgumentIgnoreCaseW (L"-neighbours", wcSrc))
+		{
+			++ nSrcs;
+			bOk = harvestMACsSourceResult (L"the neighbour table", harvestWOLneighbours (&h));
+		} else
+		if (isArgumentIgnoreCaseW (L"-brip", wcSrc))
+		{
+			WCHAR *wcBrIP = nextArgumentW (pcArg, nArgs, wcArgs);
+			if (NULL == wcBrIP)
 			{
-				callWSAStartup ();
-				evalArg = enArgMissingAfter;
-				enum eWOLret wol = wolretSyntaxHst;
-				wchar_t wcMAC [U_WAKEONLAN_MAC_SIZ];
-				wchar_t *maca = NULL;
-				wchar_t *host = nextArgumentW (&cArg, nArgs, wcArgs);
-				if (host)
-				{
-					if (isGoodIPv4stringW (host) || isGoodIPv6stringW (host))
-					{
-						wol = wolretMissing;
-						maca = nextArgumentW (&cArg, nArgs, wcArgs);
-						if (maca)
-						{
-							bool bForceV6 = false;
-							wchar_t *wcForceV6 = nextArgumentW (&cArg, nArgs, wcArgs);
-							if (wcForceV6)
-							{
-								if	(
-											isArgumentIgnoreCaseW (L"-f6", wcForceV6)
-										&&	isGoodIPv4stringW (host)
-									)
-								{
-									memcpyU (wzIP4asIP6 + U_WAKEONLAN_IPV6V4_PFX_LEN, host, sizeof (wchar_t) * (1 + strlenW (host)));
-									bForceV6 = true;
-								} else
-								{
-									wzIP = host;
-									-- cArg;
-								}
-							} else
-								wzIP = host;
-							char *szErrPosition;
-							wol = wakeOnLAN_W (wzIP, maca, bForceV6, &szErrPosition);
-							makeUnifiedMACaddress (wcMAC, maca);
-							bCmdComplete = true;
-						}
-					}
-					switch (wol)
-					{
-						case wolretOk:
-							consoleOutW (L"Magic WOL (Wake on LAN) packet sent to \"");
-							consoleOutW (wzIP);
-							consoleOutW (L"\" with MAC address \"");
-							consoleOutW (wcMAC);
-							consoleOutW (L"\" on UDP port 9.\n");
-							break;
-						case wolretSyntaxMAC:
-							consoleOutW (L"Syntax error: \"");
-							consoleOutW (maca);
-							consoleOutW (L"\" is not a valid MAC address.\n");
-							bCmdComplete = true;
-							break;
-						case wolretSyntaxHst:
-							consoleOutW (L"Syntax error: \"");
-							consoleOutW (host);
-							consoleOutW (L"\" is not a valid broadcast IP address.\n");
-							bCmdComplete = true;
-							break;
-						case wolretErrSend:
-							consoleOutW (L"Error sending magic WOL (Wake on LAN) packet to \"");
-							consoleOutW (wzIP);
-							consoleOutW (L"\" with MAC address \"");
-							makeUnifiedMACaddress (wcMAC, maca);
-							consoleOutW (wcMAC);
-							consoleOutW (L"\" on UDP port 9.\n");
-							break;
-						case wolretMissing:
-							break;
-					}
-				}
+				*pevalArg = enArgMissingAfter;
+				doneWOLharvest (&h);
+				return false;
 			}
-			if (bCmdComplete)
+			if (!isArgumentIgnoreCaseW (L"auto", wcBrIP) && !isGoodWOLpeerStringW (wcBrIP))
 			{
-				++ cArg;
-				if (cArg < nArgs)
-				{
-					consoleOutW (L"\nIgnored argument(s):");
-					while (cArg < nArgs)
-					{
-						consoleOutW (L" \"");
-						consoleOutW (wcArgs [cArg]);
-						consoleOutW (L"\"");
-						++ cArg;
-					}
-					consoleOutW (L"\n");
-				}
-			} else
+				*pevalArg = enArgInvalid;
+				doneWOLharvest (&h);
+				return false;
+			}
+			UTF8_from_WinU16 (szBrIP, sizeof (szBrIP), wcBrIP);
+			bBrIP = true;
+		} else
+		{
+			++ nSrcs;
+			bOk = harvestMACsSourceResult (wcSrc, harvestWOLfileW (&h, wcSrc));
+		}
+	}
+	if (0 == nSrcs)
+	{
+		*pevalArg = enArgMissingAfter;
+		doneWOLharvest (&h);
+		return false;
+	}
+	if (bOk)
+	{
+		consoleOutW (L"Lines: ");
+		consoleOutUint64 (h.nLines);
+		consoleOutW (L", MAC addresses: ");
+		consoleOutUint64 (h.nEntries);
+		consoleOutW (L", duplicates: ");
+		consoleOutUint64 (h.nDuplicates);
+		consoleOutW (L", lines without MAC address: ");
+		consoleOutUint64 (h.nIgnored);
+		if (h.uiTicks)
+		{
+			consoleOutW (L", ");
+			consoleOutUint64 (h.nOctets * h.uiTicksPerSec / h.uiTicks / 1000);
+			consoleOutW (L" kB/s");
+		}
+		consoleOutW (L".\n");
+		bOk = mergeWOLharvestW (&h, wcCSV, bBrIP ? szBrIP : NULL);
+		if (bOk)
+		{
+			consoleOutW (L"Inventory \"");
+			consoleOutW (wcCSV);
+			consoleOutW (L"\": ");
+			consoleOutUint64 (h.nUnchanged);
+			consoleOutW (L" unchanged, ");
+			consoleOutUint64 (h.nUpdated);
+			consoleOutW (L" updated, ");
+			consoleOutUint64 (h.nAdded);
+			consoleOutW (L" added");
+			if (h.bRewritten)
+				consoleOutW (L", rewritten");
+			else
+			if (h.bAppended)
+				consoleOutW (L", appended");
+			consoleOutW (L".\n");
+		} else
+		{
+			consoleOutW (L"Error merging into inventory \"");
+			consoleOutW (wcCSV);
+			consoleOutW (L"\".");
+			consoleOutWinErrorText (GetLastError ());
+		}
+	}
+	doneWOLharvest (&h);
+	return true;
+}
+
+/*
+	Parses the options of a WOL list, starting at the argument after *pcArg, up to the
+	first argument that isn't one. These are -f6 if pbForceV6 is not NULL, -show if pbShow
+	is not NULL, -uso, -rate <n>, -grouprate <n>, and the options of wakeOptionsW (). The
+	function returns false on a syntax error and stores the kind of error at *pevalArg.
+*/
+bool listOptionsW	(
+		bool *pbForceV6, bool *pbUSO, uint64_t *puiRate, uint64_t *puiGroupRate, bool *pbShow,
+		SWOLPOLICY *pp, SWOLVERIFY *pv, int *pcArg, int nArgs, WCHAR **wcArgs, numArg *pevalArg
+					)
+{
+	wchar_t		*wcOpt;
+	uint64_t	uiNum;
+
+	while ((wcOpt = nextArgumentW (pcArg, nArgs, wcArgs)))
+	{
+		if (isWakeOptionW (wcOpt))
+		{
+			-- *pcArg;
+			if (!wakeOptionsW (pv, pp, NULL, pcArg, nArgs, wcArgs, pevalArg))
+				return false;
+		} else
+		if (pbForceV6 && isArgumentIgnoreCaseW (L"-f6", wcOpt))
+			*pbForceV6 = true;
+		else
+		if (pbShow && isArgumentIgnoreCaseW (L"-show", wcOpt))
+			*pbShow = true;
+		else
+		if (isArgumentIgnoreCaseW (L"-uso", wcOpt))
+			*pbUSO = true;
+		else
+		if	(
+					isArgumentIgnoreCaseW (L"-rate", wcOpt)
+				||	isArgumentIgnoreCaseW (L"-grouprate", wcOpt)
+			)
+		{
+			if (enArgIsNumber != (*pevalArg = compulsoryNumber (&uiNum, pcArg, nArgs, wcArgs)))
+				return false;
+			if (isArgumentIgnoreCaseW (L"-rate", wcOpt))
+				*puiRate = uiNum;
+			else
+				*puiGroupRate = uiNum;
+		} else
+		{
+			-- *pcArg;
+			break;
+		}
+	}
+	return true;
+}
+
+/*
+	Sends the targets of the list pl their magic packets, retries or verifies them, and
+	outputs the results. The function returns true if no target failed.
+*/
+bool sendWakeOnLANlist (SWOLLIST *pl, SWOLVERIFY *pv)
+{
+	sendWOLlist (pl);
+	if (NULL == pv)
+		retryWOLlist (pl);
+	outputWOLlistFailures (pl);
+	outputWOLlistStats (pl);
+	verifyWakeOnLANlist (pl, pv);
+	return 0 == pl->nFailed;
+}
+
+/*
+	wakeOnLANlist
+
+	Reads the targets from the file wcFile, sends them their magic packets with the send
+	policy pp, and outputs the results. If bUSO is true, targets with the same broadcast
+	address are woken with UDP segmentation offload.
+*/
+bool wakeOnLANlist	(
+		const wchar_t *wcFile, bool bForceV6, bool bUSO, uint64_t uiRate, uint64_t uiGroupRate,
+		const SWOLPOLICY *pp, SWOLVERIFY *pv
+					)
+{
+	SWOLLIST		wl;
+	SWOLINVENTORY	inv;
+	bool			bRet;
+
+	initWOLlist (&wl);
+	wl.bUseUSO		= bUSO;
+	wl.uiRate		= uiRate;
+	wl.uiGroupRate	= uiGroupRate;
+	memcpyU (&wl.policy, pp, sizeof (SWOLPOLICY));
+	// Lines can contain host names if there's an inventory.
+	if (openWOLinventoryDefault (&inv))
+		wl.pInventory = &inv;
+	bRet = readWOLlistW (&wl, wcFile, bForceV6);
+	closeWOLinventory (&inv);
+	wl.pInventory = NULL;
+	if (bRet)
+		bRet = sendWakeOnLANlist (&wl, pv);
+	else
+	{
+		consoleOutW (L"Error reading WOL list \"");
+		consoleOutW (wcFile);
+		consoleOutW (L"\".");
+		consoleOutWinErrorText (GetLastError ());
+	}
+	doneWOLlist (&wl);
+	return bRet;
+}
+
+/*
+	Outputs the error ret of addWOLselectorW () for the selector wcSel.
+*/
+void outputWOLselectorError (enum eWOLselRet ret, const wchar_t *wcSel)
+{
+	switch (ret)
+	{
+		case wolselOk:
+			return;
+		case wolselSyntaxCIDR:
+			consoleOutW (L"Syntax error: invalid CIDR prefix in \"");
+			break;
+		case wolselSyntaxPattern:
+			consoleOutW (L"Syntax error: invalid pattern in \"");
+			break;
+		case wolselTooLong:
+			consoleOutW (L"Pattern too long in \"");
+			break;
+		case wolselTooMany:
+			consoleOutW (L"Too many selector terms in \"");
+			break;
+		case wolselErrMemory:
+			consoleOutW (L"Out of memory parsing \"");
+			break;
+	}
+	consoleOutW (wcSel);
+	consoleOutW (L"\".\n");
+}
+
+/*
+	wakeOnLANselect
+
+	Reads the selectors and options of the command WakeOnLANSelect, starting at the
+	argument after *pcArg, selects the hosts of the default inventory database, and wakes
+	them like a WOL list, or lists them with the option -show. The function returns false
+	on a syntax error and stores the kind of error at *pevalArg.
+*/
+bool wakeOnLANselect (int *pcArg, int nArgs, WCHAR **wcArgs, numArg *pevalArg)
+{
+	SWOLSELECTOR	*ps;
+	SWOLSELECTION	sel;
+	SWOLINVENTORY	inv;
+	SWOLPOLICY		policy;
+	SWOLVERIFY		wv;
+	SWOLLIST		wl;
+	wchar_t			wcDB [MAX_PATH];
+	wchar_t			*wcSel;
+	enum eWOLselRet	ret			= wolselOk;
+	bool			bShow		= false;
+	bool			bUSO		= false;
+	uint64_t		uiRate		= 0;
+	uint64_t		uiGroupRate	= 0;
+	uint32_t		n;
+
+	// Too big for the stack.
+	ps = HeapAlloc (GetProcessHeap (), 0, sizeof (SWOLSELECTOR));
+	if (NULL == ps)
+	{
+		consoleOutW (L"Out of memory.\n");
+		return true;
+	}
+	initWOLselector (ps);
+	while (wolselOk == ret && (wcSel = nextArgumentW (pcArg, nArgs, wcArgs)))
+	{
+		if (L'-' == wcSel [0])
+		{
+			-- *pcArg;
+			break;
+		}
+		ret = addWOLselectorW (ps, wcSel);
+		outputWOLselectorError (ret, wcSel);
+	}
+	if (0 == ps->nTerms)
+	{
+		// The command requires at least one selector.
+		HeapFree (GetProcessHeap (), 0, ps);
+		return wolselOk != ret;
+	}
+	initWOLpolicy (&policy);
+	initWOLverify (&wv);
+	if	(
+				!listOptionsW	(
+					NULL, &bUSO, &uiRate, &uiGroupRate, &bShow, &policy, &wv, pcArg, nArgs,
+					wcArgs, pevalArg
+								)
+		)
+	{
+		HeapFree (GetProcessHeap (), 0, ps);
+		return false;
+	}
+	if (wolselOk != ret)
+	{
+		HeapFree (GetProcessHeap (), 0, ps);
+		return true;
+	}
+
+	wcDB [0] = L'\0';
+	if (!defaultWOLinventoryW (wcDB, MAX_PATH) || !openWOLinventoryW (&inv, wcDB))
+	{
+		consoleOutW (L"Error opening inventory database \"");
+		consoleOutW (wcDB);
+		consoleOutW (L"\".");
+		consoleOutWinErrorText (GetLastError ());
+		HeapFree (GetProcessHeap (), 0, ps);
+		return true;
+	}
+	if (!selectWOLinventory (&sel, ps, &inv))
+	{
+		consoleOutW (L"Out of memory.\n");
+		closeWOLinventory (&inv);
+		HeapFree (GetProcessHeap (), 0, ps);
+		return true;
+	}
+	HeapFree (GetProcessHeap (), 0, ps);
+	consoleOutW (L"Selected ");
+	consoleOutUint64 (sel.nSelected);
+	consoleOutW (L" of ");
+	consoleOutUint64 (sel.nRecords);
+	consoleOutW (L" hosts in ");
+	consoleOutUint64 (sel.uiTicks * 1000000 / sel.uiTicksPerSec);
+	consoleOutW (L" microseconds.\n");
+	if (bShow)
+	{
+		for (n = 0; n < sel.nSelected; ++ n)
+		{
+			consoleOutU8 (strWOLinventory (&inv, inv.pRecs [sel.puiSlots [n]].ofsName));
+			consoleOutU8 ("\n");
+		}
+	} else
+	if (sel.nSelected)
+	{
+		callWSAStartup ();
+		initWOLlist (&wl);
+		wl.bUseUSO		= bUSO;
+		wl.uiRate		= uiRate;
+		wl.uiGroupRate	= uiGroupRate;
+		memcpyU (&wl.policy, &policy, sizeof (SWOLPOLICY));
+		for (n = 0; n < sel.nSelected; ++ n)
+		{
+			if (wolretErrMemory == addWOLinventoryTarget (&wl, &inv, inv.pRecs + sel.puiSlots [n], 0, NULL))
 			{
-				switch (evalArg)
-				{
-					case enArgInvalid:
-						consoleOutU8 ("Syntax error. Unknown argument/parameter: \"");
-						break;
-					case enArgNoArg:
-						consoleOutU8 ("Syntax error. Argument/parameter missing for \"");
-						break;
-					case enArgNumberTooBig:
-						consoleOutU8 ("Syntax error. Number too big: \"");
-						break;
-					case enArgNotNumber:
-						consoleOutU8 ("Syntax error. Argument/parameter is not a valid number: \"");
-						break;
-					case enArgTaskError:
-						consoleOutU8 ("Error performing task.");
-						break;
-					case enArgMissingAfter:
-						consoleOutU8 ("Syntax error. Argument/parameter missing after: \"");
-						break;
-					default:
-						consoleOutU8 ("Syntax error. Argument/parameter missing for \"");
-				}
-				consoleOutW (wcArgs [cArg]);
-				consoleOutU8 ("\".\n");
+				consoleOutW (L"Out of memory.\n");
 				break;
 			}
-			++ cArg;
 		}
+		if (n == sel.nSelected)
+			sendWakeOnLANlist (&wl, wolprobeNone == wv.probe ? NULL : &wv);
+		doneWOLlist (&wl);
+	}
+	doneWOLselection (&sel);
+	closeWOLinventory (&inv);
+	return true;
+}
+
+/*
+	Outputs the uiTicks performance counter ticks as seconds with 3 decimals, like
+	"12.345 s". If bPad is true, the seconds are right-aligned in 5 digits.
+*/
+void outputWOLplanSeconds (uint64_t uiTicks, uint64_t uiTicksPerSec, bool bPad)
+{
+	uint64_t uiMs	= uiTicks * 1000 / uiTicksPerSec;
+	uint64_t ui		= 10000;
+
+	while (bPad && ui > 1 && uiMs / 1000 < ui)
+	{
+		consoleOutW (L" ");
+		ui /= 10;
+	}
+	consoleOutUint64 (uiMs / 1000);
+	consoleOutW (L".");
+	if (uiMs % 1000 < 100)
+		consoleOutW (L"0");
+	if (uiMs % 1000 < 10)
+		consoleOutW (L"0");
+	consoleOutUint64 (uiMs % 1000);
+	consoleOutW (L" s");
+}
+
+/*
+	Outputs the hosts up of the stage ps, like "3 of 4 hosts up".
+*/
+void outputWOLstageHosts (const SWOLSTAGE *ps)
+{
+	if (ps->bVerify)
+	{
+		consoleOutUint64 (ps->wv.nUp);
+		consoleOutW (L" of ");
+		consoleOutUint64 (ps->wv.nProbes);
+		consoleOutW (L" hosts up");
+	} else
+	{
+		consoleOutUint64 (ps->wl.nTargets);
+		consoleOutW (L" hosts, not verified");
+	}
+}
+
+/*
+	Called by runWOLplan () when a stage starts or ends.
+*/
+void onWOLplanEvent (const SWOLPLAN *pp, const SWOLSTAGE *ps)
+{
+	consoleOutW (L"[");
+	outputWOLplanSeconds	(
+		wolstgRunning == ps->state ? ps->uiStart : ps->uiEnd, pp->uiTicksPerSec, true
+							);
+	consoleOutW (L"] Stage \"");
+	consoleOutU8 (ps->szName);
+	switch (ps->state)
+	{
+		case wolstgRunning:
+			consoleOutW (L"\" started with ");
+			consoleOutUint64 (ps->wl.nTargets);
+			consoleOutW (L" hosts.\n");
+			return;
+		case wolstgDone:
+			consoleOutW (L"\" done: ");
+			break;
+		case wolstgTimedOut:
+			consoleOutW (L"\" timed out: ");
+			break;
+		case wolstgSkipped:
+			consoleOutW (L"\" skipped because a required stage failed.\n");
+			return;
+		case wolstgWaiting:
+			return;
+	}
+	outputWOLstageHosts (ps);
+	consoleOutW (L".\n");
+}
+
+/*
+	Outputs the error ret of readWOLplanW ().
+*/
+void outputWOLplanError (enum eWOLplanRet ret, const SWOLPLAN *pp, const wchar_t *wcFile)
+{
+	if (wolplanErrRead == ret)
+	{
+		consoleOutW (L"Error reading wake plan \"");
+		consoleOutW (wcFile);
+		consoleOutW (L"\".");
+		consoleOutWinErrorText (GetLastError ());
+		return;
+	}
+	consoleOutW (L"Line ");
+	consoleOutUint64 (pp->nLine);
+	consoleOutW (L": ");
+	switch (ret)
+	{
+		case wolplanErrMemory:
+			consoleOutW (L"Out of memory.\n");
+			break;
+		case wolplanSyntax:
+			consoleOutW (L"Syntax error.\n");
+			break;
+		case wolplanSelector:
+			consoleOutW (L"Invalid selector.\n");
+			break;
+		case wolplanDuplicate:
+			consoleOutW (L"Stage already defined.\n");
+			break;
+		case wolplanUnknownStage:
+			consoleOutW (L"Unknown stage in after=.\n");
+			break;
+		case wolplanTooManyAfter:
+			consoleOutW (L"Too many stages in after=.\n");
+			break;
+		case wolplanCycle:
+			consoleOutW (L"The stage depends on itself through after=.\n");
+			break;
+		case wolplanOk:
+		case wolplanErrRead:
+		case wolplanErrIOCP:
+			break;
+	}
+}
+
+/*
+	wakeOnLANplan
+
+	Reads the wake plan wcFile, which selects its hosts from the default inventory
+	database, runs it, and outputs the stages and the critical path. The list template pl
+	provides the send policy and pacing of all stages, pv the default verification.
+*/
+bool wakeOnLANplan (const wchar_t *wcFile, const SWOLLIST *pl, const SWOLVERIFY *pv)
+{
+	SWOLPLAN			plan;
+	SWOLINVENTORY		inv;
+	wchar_t				wcDB [MAX_PATH];
+	enum eWOLplanRet	ret;
+	uint32_t			*puiPath;
+	uint32_t			n, s;
+
+	wcDB [0] = L'\0';
+	if (!defaultWOLinventoryW (wcDB, MAX_PATH) || !openWOLinventoryW (&inv, wcDB))
+	{
+		consoleOutW (L"Error opening inventory database \"");
+		consoleOutW (wcDB);
+		consoleOutW (L"\".");
+		consoleOutWinErrorText (GetLastError ());
+		return false;
+	}
+	initWOLplan (&plan);
+	ret = readWOLplanW (&plan, wcFile, &inv, pl, pv);
+	closeWOLinventory (&inv);
+	if (wolplanOk != ret)
+	{
+		outputWOLplanError (ret, &plan, wcFile);
+		doneWOLplan (&plan);
+		return false;
+	}
+	plan.pfnEvent = onWOLplanEvent;
+	if (wolplanOk != runWOLplan (&plan))
+	{
+		consoleOutW (L"Error running wake plan.");
+		consoleOutWinErrorText (GetLastError ());
+		doneWOLplan (&plan);
+		return false;
+	}
+
+	consoleOutW (L"\nStage                Start        End          Duration     Hosts\n");
+	for (s = 0; s < plan.nStages; ++ s)
+	{
+		const SWOLSTAGE *ps = plan.pStages + s;
+		size_t len = strlenU (ps->szName);
+		consoleOutU8 (ps->szName);
+		while (len ++ < 21)
+			consoleOutW (L" ");
+		outputWOLplanSeconds (ps->uiStart, plan.uiTicksPerSec, true);
+		consoleOutW (L"  ");
+		outputWOLplanSeconds (ps->uiEnd, plan.uiTicksPerSec, true);
+		consoleOutW (L"  ");
+		outputWOLplanSeconds (ps->uiEnd - ps->uiStart, plan.uiTicksPerSec, true);
+		consoleOutW (L"  ");
+		if (wolstgSkipped == ps->state)
+			consoleOutW (L"skipped");
+		else
+			outputWOLstageHosts (ps);
+		consoleOutW (L"\n");
+	}
+
+	puiPath = HeapAlloc (GetProcessHeap (), 0, ((size_t) plan.nStages + 1) * sizeof (uint32_t));
+	if (puiPath)
+	{
+		n = criticalWOLplan (&plan, puiPath);
+		consoleOutW (L"Critical path (");
+		outputWOLplanSeconds (plan.uiEnd, plan.uiTicksPerSec, false);
+		consoleOutW (L"):");
+		for (s = 0; s < n; ++ s)
+		{
+			const SWOLSTAGE *ps = plan.pStages + puiPath [s];
+			consoleOutW (s ? L" -> " : L" ");
+			consoleOutU8 (ps->szName);
+			consoleOutW (L" (");
+			outputWOLplanSeconds (ps->uiEnd - ps->uiStart, plan.uiTicksPerSec, false);
+			consoleOutW (L")");
+		}
+		consoleOutW (L".\n");
+		HeapFree (GetProcessHeap (), 0, puiPath);
+	}
+	doneWOLplan (&plan);
+	return true;
+}
+
+/*
+	Converts the MAC address in wcMAC to its octets.
+*/
+/*
+	wakeOnLANstress
+
+	Sends uiPackets magic packets from each of uiThreads threads to a receiver on the
+	loopback port uiPort, and outputs lost packets and leaked handles. See runWOLstress ().
+	If bAsync is true, the threads submit their packets asynchronously, and the
+	submit-to-wire latencies are output too.
+*/
+bool wakeOnLANstress (uint64_t uiThreads, uint64_t uiPackets, uint16_t uiPort, bool bAsync)
+{
+	// Too big for the stack.
+	SWOLSTRESS			*ps	= HeapAlloc (GetProcessHeap (), HEAP_ZERO_MEMORY, sizeof (SWOLSTRESS));
+	SWOLASYNC			*pa	= NULL;
+	enum eWOLstressRet	ret;
+
+	if (bAsync && ps)
+	{
+		pa = HeapAlloc (GetProcessHeap (), HEAP_ZERO_MEMORY, sizeof (SWOLASYNC));
+		if (NULL == pa)
+		{
+			HeapFree (GetProcessHeap (), 0, ps);
+			ps = NULL;
+		}
+	}
+	if (NULL == ps)
+	{
+		consoleOutW (L"Out of memory.\n");
+		return false;
+	}
+	ps->pAsync		= pa;
+	ps->nThreads	= uiThreads > U_WOLSTRESS_MAX_THREADS ? U_WOLSTRESS_MAX_THREADS : (uint32_t) uiThreads;
+	ps->nPackets	= uiPackets;
+	ps->uiPort		= uiPort;
+	ret = runWOLstress (ps);
+	switch (ret)
+	{
+		case wolstressErrWSA:
+			consoleOutW (L"Error initialising Winsock.\n");
+			break;
+		case wolstressErrListen:
+			consoleOutW (L"Error opening loopback port ");
+			consoleOutUint64 (uiPort);
+			consoleOutW (L".\n");
+			break;
+		case wolstressErrThread:
+			consoleOutW (L"Error creating threads.");
+			consoleOutWinErrorText (GetLastError ());
+			break;
+		case wolstressOk:
+		case wolstressLost:
+		case wolstressLeak:
+			break;
+	}
+	if (wolstressErrWSA != ret && wolstressErrListen != ret)
+	{
+		consoleOutW (L"Threads: ");
+		consoleOutUint64 (ps->nThreads);
+		consoleOutW (L", magic packets sent: ");
+		consoleOutUint64 (ps->nSent);
+		consoleOutW (L", send errors: ");
+		consoleOutUint64 (ps->nFailed);
+		consoleOutW (L", received: ");
+		consoleOutUint64 ((uint64_t) ps->nReceived);
+		consoleOutW (L", lost: ");
+		consoleOutUint64 (ps->nLost);
+		consoleOutW (L", duplicates: ");
+		consoleOutUint64 (ps->nDuplicates);
+		consoleOutW (L".\n");
+		consoleOutW (L"Handles before: ");
+		consoleOutUint64 (ps->dwHandlesBefore);
+		consoleOutW (L", after: ");
+		consoleOutUint64 (ps->dwHandlesAfter);
+		consoleOutW (L".\n");
+		if (ps->uiTicks)
+		{
+			consoleOutW (L"Sending took ");
+			consoleOutUint64 (ps->uiTicks * 1000000 / ps->uiTicksPerSec);
+			consoleOutW (L" microseconds (");
+			consoleOutUint64 (ps->nSent * ps->uiTicksPerSec / ps->uiTicks);
+			consoleOutW (L" magic packets/s).\n");
+		}
+		if (pa && pa->nCompleted)
+		{
+			consoleOutW (L"Submit to wire in microseconds: p50 ");
+			consoleOutUint64 (percentileWOLasyncUs (pa, 50));
+			consoleOutW (L", p99 ");
+			consoleOutUint64 (percentileWOLasyncUs (pa, 99));
+			consoleOutW (L", max ");
+			consoleOutUint64 (pa->uiLatencyMax * 1000000 / pa->uiTicksPerSec);
+			consoleOutW (L". Queue drains: ");
+			consoleOutUint64 (pa->nDrains);
+			consoleOutW (L", largest: ");
+			consoleOutUint64 (pa->nMaxDrain);
+			consoleOutW (L".\n");
+		}
+		consoleOutW (wolstressOk == ret ? L"Passed.\n" : L"Failed.\n");
+	}
+	if (pa)
+		HeapFree (GetProcessHeap (), 0, pa);
+	HeapFree (GetProcessHeap (), 0, ps);
+	return wolstressOk == ret;
+}
+
+bool octetsFromMACargW (unsigned char ucMAC [6], const wchar_t *wcMAC)
+{
+	return parseWOLmacW (ucMAC, wcMAC, strlenW (wcMAC));
+}
+
+/*
+	parseMACs
+
+	Parses the first MAC address of every line of the file wcFile, or of standard input
+	if wcFile is "-", and outputs how many lines contained one, and how fast they were
+	parsed. Reading and tokenising the file is timed separately from parsing.
+*/
+bool parseMACs (const wchar_t *wcFile)
+{
+	SLINEREADER		lr;
+	LARGE_INTEGER	liFreq, liStart, liEnd, li1, li2;
+	uint64_t		uiParseTicks	= 0;
+	uint64_t		nLines			= 0;
+	uint64_t		nMACs			= 0;
+	char			*szLine;
+	char			*szTok;
+	unsigned char	ucMAC [6];
+
+	if (!openLineReaderW (&lr, wcFile))
+	{
+		consoleOutW (L"Error opening \"");
+		consoleOutW (wcFile);
+		consoleOutW (L"\".");
+		consoleOutWinErrorText (GetLastError ());
+		return false;
+	}
+	QueryPerformanceFrequency (&liFreq);
+	QueryPerformanceCounter (&liStart);
+	while ((szLine = nextLineU8 (&lr, NULL)))
+	{
+		bool bMAC = false;
+		++ nLines;
+		while (!bMAC && (szTok = nextWOLlistTokenU8 (&szLine)))
+		{
+			size_t len = strlenU (szTok);
+			QueryPerformanceCounter (&li1);
+			bMAC = parseWOLmacU8 (ucMAC, szTok, len);
+			QueryPerformanceCounter (&li2);
+			uiParseTicks += (uint64_t) (li2.QuadPart - li1.QuadPart);
+		}
+		if (bMAC)
+			++ nMACs;
+	}
+	QueryPerformanceCounter (&liEnd);
+	closeLineReader (&lr);
+
+	uint64_t uiTotal = (uint64_t) (liEnd.QuadPart - liStart.QuadPart);
+	consoleOutW (L"Lines: ");
+	consoleOutUint64 (nLines);
+	consoleOutW (L", MAC addresses: ");
+	consoleOutUint64 (nMACs);
+	consoleOutW (L", lines without MAC address: ");
+	consoleOutUint64 (nLines - nMACs);
+	consoleOutW (L".\n");
+	consoleOutW (L"Total time: ");
+	consoleOutUint64 (uiTotal * 1000000 / (uint64_t) liFreq.QuadPart);
+	consoleOutW (L" microseconds, parsing (including timer overhead): ");
+	consoleOutUint64 (uiParseTicks * 1000000 / (uint64_t) liFreq.QuadPart);
+	consoleOutW (L" microseconds");
+	if (uiParseTicks)
+	{
+		consoleOutW (L" (");
+		consoleOutUint64 (nMACs * (uint64_t) liFreq.QuadPart / uiParseTicks);
+		consoleOutW (L" MAC addresses/s)");
+	}
+	consoleOutW (L".\n");
+	return true;
+}
+
+/*
+	wakeOnLANether
+
+	Wakes the host with the MAC address wcTarget, or all hosts listed in the file wcTarget,
+	with Ethernet magic packets sent out on interface wcIf.
+*/
+bool wakeOnLANether (const wchar_t *wcIf, const wchar_t *wcTarget, uint16_t uiVLAN)
+{
+	SWOLETHER			we;
+	enum eWOLetherRet	ret;
+	unsigned char		ucMAC [6];
+	size_t				nBad	= 0;
+	LARGE_INTEGER		liFreq, liStart, liEnd;
+
+	ret = openWOLether (&we, wcIf, uiVLAN);
+	switch (ret)
+	{
+		case wolethOk:
+			break;
+		case wolethNoNpcap:
+			consoleOutW (L"Npcap not available. See https://npcap.com .\n");
+			return false;
+		case wolethNoInterface:
+			consoleOutW (L"Network interface \"");
+			consoleOutW (wcIf);
+			consoleOutW (L"\" not found.\n");
+			return false;
+		default:
+			consoleOutW (L"Error opening network interface \"");
+			consoleOutW (wcIf);
+			consoleOutW (L"\" with Npcap.\n");
+			return false;
+	}
+
+	QueryPerformanceFrequency (&liFreq);
+	QueryPerformanceCounter (&liStart);
+	if (octetsFromMACargW (ucMAC, wcTarget))
+		queueWOLether (&we, ucMAC);
+	else
+	if (!queueWOLetherListW (&we, wcTarget, &nBad))
+	{
+		consoleOutW (L"\"");
+		consoleOutW (wcTarget);
+		consoleOutW (L"\" is neither a valid MAC address nor a readable WOL list.\n");
+	}
+	closeWOLether (&we);
+	QueryPerformanceCounter (&liEnd);
+
+	uint64_t uiTicks = (uint64_t) (liEnd.QuadPart - liStart.QuadPart);
+	consoleOutW (L"Ethernet magic WOL (Wake on LAN) frames sent: ");
+	consoleOutUint64 (we.nSent);
+	consoleOutW (L", failed: ");
+	consoleOutUint64 (we.nFailed);
+	consoleOutW (L", invalid lines: ");
+	consoleOutUint64 (nBad);
+	consoleOutW (L", queue flushes: ");
+	consoleOutUint64 (we.nFlushes);
+	consoleOutW (L".\n");
+	if (we.nSent && uiTicks)
+	{
+		consoleOutW (L"Sending took ");
+		consoleOutUint64 (uiTicks * 1000000 / (uint64_t) liFreq.QuadPart);
+		consoleOutW (L" microseconds (");
+		consoleOutUint64 (we.nSent * (uint64_t) liFreq.QuadPart / uiTicks);
+		consoleOutW (L" frames/s).\n");
+	}
+	return we.nSent && 0 == we.nFailed && 0 == nBad;
+}
+
+/*
+	Outputs the time in pst as "YYYY-MM-DD hh:mm:ss.mmm".
+*/
+void outputSYSTEMTIME (const SYSTEMTIME *pst)
+{
+	WCHAR	wc [24];
+	WORD	w [7]	=	{
+							pst->wYear, pst->wMonth, pst->wDay, pst->wHour, pst->wMinute,
+							pst->wSecond, pst->wMilliseconds
+						};
+	int		dig [7]	= { 4, 2, 2, 2, 2, 2, 3 };
+	WCHAR	sep [7]	= { L'-', L'-', L' ', L':', L':', L'.', L'\0' };
+	int		n, d;
+	WCHAR	*p		= wc;
+
+	for (n = 0; n < 7; ++ n)
+	{
+		WORD v = w [n];
+		for (d = dig [n]; d; -- d)
+		{
+			p [d - 1]	= (WCHAR) (L'0' + v % 10);
+			v			/= 10;
+		}
+		p		+= dig [n];
+		*p ++	= sep [n];
+	}
+	consoleOutW (wc);
+}
+
+/*
+	Outputs the IP address and port in pss.
+*/
+void outputSockaddr (const struct sockaddr_storage *pss)
+{
+	char szIP [U_WAKEONLAN_IPV6_SIZ + 16];
+
+	if (AF_INET == pss->ss_family)
+	{
+		const struct sockaddr_in *psi = (const struct sockaddr_in *) pss;
+		inet_ntop (AF_INET, &psi->sin_addr, szIP, sizeof (szIP));
+		consoleOutU8 (szIP);
+		consoleOutW (L":");
+		consoleOutUint64 (ntohs (psi->sin_port));
+	} else
+	{
+		const struct sockaddr_in6 *psi6 = (const struct sockaddr_in6 *) pss;
+		inet_ntop (AF_INET6, &psi6->sin6_addr, szIP, sizeof (szIP));
+		consoleOutW (L"[");
+		consoleOutU8 (szIP);
+		consoleOutW (L"]:");
+		consoleOutUint64 (ntohs (psi6->sin6_port));
+	}
+}
+
+void outputWOLrecv (SWOLRECV *pr, void *pCustom)
+{
+	char szMAC [U_WAKEONLAN_MAC_SIZ];
+
+	UNREFERENCED_PARAMETER (pCustom);
+	strMACfromOctets (szMAC, pr->ucMAC);
+	outputSYSTEMTIME (&pr->stReceived);
+	consoleOutW (L"  ");
+	consoleOutU8 (szMAC);
+	consoleOutW (L"  port ");
+	consoleOutUint64 (pr->uiPort);
+	consoleOutW (L"  from ");
+	outputSockaddr (&pr->ssSource);
+	consoleOutW (L"\n");
+}
+
+SWOLLISTENER	*pWOLlistener;
+
+BOOL WINAPI listenWOLctrlHandler (DWORD dwCtrlType)
+{
+	if ((CTRL_C_EVENT == dwCtrlType || CTRL_BREAK_EVENT == dwCtrlType) && pWOLlistener)
+	{
+		stopWOLlistener (pWOLlistener);
+		return TRUE;
+	}
+	return FALSE;
+}
+
+/*
+	Outputs the receive statistics of a listener.
+*/
+void outputWOLlistenerStats (SWOLLISTENER *pl)
+{
+	consoleOutW (L"\nDatagrams received: ");
+	consoleOutUint64 (pl->nDatagrams);
+	consoleOutW (L", magic packets: ");
+	consoleOutUint64 (pl->nMagic);
+	consoleOutW (L", octets: ");
+	consoleOutUint64 (pl->nOctets);
+	consoleOutW (L", receive calls: ");
+	consoleOutUint64 (pl->nRecvCalls);
+	consoleOutW (L".\n");
+	if (pl->uiScanTicks)
+	{
+		consoleOutW (L"Scanning took ");
+		consoleOutUint64 (pl->uiScanTicks * 1000000 / pl->uiTicksPerSec);
+		consoleOutW (L" microseconds (");
+		consoleOutUint64 (pl->nDatagrams * pl->uiTicksPerSec / pl->uiScanTicks);
+		consoleOutW (L" datagrams/s scanned).\n");
+	}
+	if (pl->uiRunTicks)
+	{
+		consoleOutW (L"Received ");
+		consoleOutUint64 (pl->nDatagrams * pl->uiTicksPerSec / pl->uiRunTicks);
+		consoleOutW (L" datagrams/s on average.\n");
+	}
+}
+
+/*
+	listenWOL
+
+	Listens for magic packets on nPorts UDP ports until Ctrl+C is pressed.
+*/
+bool listenWOL (const uint16_t *puiPorts, size_t nPorts, bool bQuiet)
+{
+	SWOLLISTENER	wl;
+
+	if (!openWOLlistener (&wl, puiPorts, nPorts))
+	{
+		consoleOutW (L"Error opening UDP port(s) for listening.\n");
+		return false;
+	}
+	consoleOutW (L"Listening for magic WOL (Wake on LAN) packets. Press Ctrl+C to end.\n");
+	pWOLlistener = &wl;
+	SetConsoleCtrlHandler (listenWOLctrlHandler, TRUE);
+	runWOLlistener (&wl, bQuiet ? NULL : outputWOLrecv, NULL);
+	SetConsoleCtrlHandler (listenWOLctrlHandler, FALSE);
+	pWOLlistener = NULL;
+
+	outputWOLlistenerStats (&wl);
+	closeWOLlistener (&wl);
+	return true;
+}
+
+/*
+	relayWOL
+
+	Relays magic packets received on nPorts UDP ports to nBrips broadcast IPs until Ctrl+C
+	is pressed.
+*/
+bool relayWOL	(
+		const uint16_t *puiPorts, size_t nPorts, WCHAR **wcBrips, size_t nBrips, bool bQuiet
+				)
+{
+	SWOLRELAY	wr;
+	char		szIP [U_WAKEONLAN_IPV6_SIZ];
+	size_t		n;
+
+	if (!openWOLrelay (&wr, puiPorts, nPorts))
+	{
+		consoleOutW (L"Error opening UDP port(s) for relaying.\n");
+		return false;
+	}
+	for (n = 0; n < nBrips; ++ n)
+	{
+		UTF8_from_WinU16 (szIP, U_WAKEONLAN_IPV6_SIZ, wcBrips [n]);
+		if (!addWOLrelayEgressU8 (&wr, szIP))
+		{
+			consoleOutW (L"Cannot relay to \"");
+			consoleOutW (wcBrips [n]);
+			consoleOutW (L"\".\n");
+			closeWOLrelay (&wr);
+			return false;
+		}
+	}
+	consoleOutW (L"Relaying magic WOL (Wake on LAN) packets. Press Ctrl+C to end.\n");
+	pWOLlistener = &wr.listener;
+	SetConsoleCtrlHandler (listenWOLctrlHandler, TRUE);
+	runWOLrelay (&wr, bQuiet ? NULL : outputWOLrecv, NULL);
+	SetConsoleCtrlHandler (listenWOLctrlHandler, FALSE);
+	pWOLlistener = NULL;
+
+	outputWOLlistenerStats (&wr.listener);
+	consoleOutW (L"Magic packets relayed: ");
+	consoleOutUint64 (wr.nRelayed);
+	consoleOutW (L", own packets ignored: ");
+	consoleOutUint64 (wr.nLooped);
+	consoleOutW (L", send calls: ");
+	consoleOutUint64 (wr.nSendCalls);
+	consoleOutW (L".\n");
+	for (n = 0; n < wr.nEgress; ++ n)
+	{
+		consoleOutW (L"  ");
+		consoleOutW (wcBrips [n]);
+		consoleOutW (L": ");
+		consoleOutUint64 (wr.egress [n].nSent);
+		consoleOutW (L" sent, ");
+		consoleOutUint64 (wr.egress [n].nFailed);
+		consoleOutW (L" failed.\n");
+	}
+	if (wr.nRelayed)
+	{
+		uint64_t uiFreq = wr.listener.uiTicksPerSec;
+		consoleOutW (L"Relay latency in microseconds: min ");
+		consoleOutUint64 (wr.uiLatencyMin * 1000000 / uiFreq);
+		consoleOutW (L", avg ");
+		consoleOutUint64 (wr.uiLatencyTicks * 1000000 / uiFreq / wr.nRelayed);
+		consoleOutW (L", max ");
+		consoleOutUint64 (wr.uiLatencyMax * 1000000 / uiFreq);
+		consoleOutW (L".\n");
+	}
+	if (wr.listener.uiRunTicks)
+	{
+		consoleOutW (L"Relayed ");
+		consoleOutUint64 (wr.nRelayed * wr.listener.uiTicksPerSec / wr.listener.uiRunTicks);
+		consoleOutW (L" magic packets/s on average.\n");
+	}
+	closeWOLrelay (&wr);
+	return true;
+}
+
+/*
+	The command table.
+
+	Every command is a handler that gets the arguments in an SOOMARGS structure, with cArg
+	at the command itself, and its own table entry. A handler advances cArg to the last
+	argument it consumed, sets evalArg if the arguments are not valid, and returns true
+	if the command is complete. The dispatcher has already ensured that at least arity
+	arguments follow the command.
+*/
+typedef struct soomargs
+{
+	int							cArg;						// Index of the current argument.
+	int							nArgs;
+	WCHAR						**wcArgs;
+	numArg						evalArg;
+} SOOMARGS;
+
+struct soomcmd;
+typedef bool (*pfnOOMcmd) (SOOMARGS *pa, const struct soomcmd *pc);
+
+/*
+	An action that shuts down, suspends, locks, etc. the computer, for cmdAction () and
+	cmdActionAfter ().
+*/
+typedef struct soomaction
+{
+	const WCHAR					*wcAction;					// Output before the action.
+	bool						(*pfnAction) (void);
+	const WCHAR					*wcDone;					// Output afterwards, or NULL.
+	bool						bMaxDWORD;					// Seconds must fit in a DWORD.
+} SOOMACTION;
+
+typedef struct soomcmd
+{
+	const WCHAR					*wcName;					// Compared ignoring case.
+	pfnOOMcmd					pfnCmd;
+	unsigned int				arity;						// Compulsory arguments.
+	const SOOMACTION			*pAction;					// For cmdAction[After] ().
+	DWORD						dwParam;					// SHERB_ flags.
+	const char					*ccHelp;					// For outPutHelp (), or NULL.
+} SOOMCMD;
+
+bool runOOMcmd (SOOMARGS *pa)
+;
+
+static const SOOMACTION oaHybernate			=
+	{wcActionHybernating,		HybernateComputerOrFail,	NULL,											false};
+static const SOOMACTION oaLock				=
+	{wcActionLocking,			LockThisComputerOrFail,		NULL,											false};
+static const SOOMACTION oaLogoff			=
+	{wcActionLoggingOff,		LogoffOrFail,				NULL,											false};
+static const SOOMACTION oaMonitorLowPower	=
+	{wcActionMonitorLowPower,	MonitorLowPower,			L"\nMonitor(s) switched to low power mode.\n",	false};
+static const SOOMACTION oaMonitorOff		=
+	{wcActionMonitorOff,		MonitorPowerOff,			L"\nMonitor(s) powered off.\n",					false};
+static const SOOMACTION oaMonitorOn			=
+	{wcActionMonitorOn,			MonitorPowerOn,				L"\nMonitor(s) powered on.\n",					false};
+static const SOOMACTION oaPowerOff			=
+	{wcActionPowerOff,			PowerOffComputerOrFail,		NULL,											false};
+static const SOOMACTION oaRestart			=
+	{wcActionRestarting,		RestartComputerOrFail,		NULL,											false};
+static const SOOMACTION oaShutdown			=
+	{wcActionShuttingDown,		ShutdownComputerOrFail,		NULL,											true};
+static const SOOMACTION oaSuspend			=
+	{wcActionSuspending,		SuspendComputerOrFail,		NULL,											false};
+
+static bool cmdHelp (SOOMARGS *pa, const SOOMCMD *pc)
+{
+	UNREFERENCED_PARAMETER (pa);
+	UNREFERENCED_PARAMETER (pc);
+
+	outPutHelp ();
+	return true;
+}
+
+static bool cmdAbort (SOOMARGS *pa, const SOOMCMD *pc)
+{
+	UNREFERENCED_PARAMETER (pa);
+	UNREFERENCED_PARAMETER (pc);
+
+	outputActionAborting ();
+	AbortShutdownOrFail ();
+	return true;
+}
+
+static bool cmdAction (SOOMARGS *pa, const SOOMCMD *pc)
+{
+	UNREFERENCED_PARAMETER (pa);
+
+	consoleOutW (pc->pAction->wcAction);
+	consoleOutW (L"...");
+	pc->pAction->pfnAction ();
+	if (pc->pAction->wcDone)
+		consoleOutW (pc->pAction->wcDone);
+	return true;
+}
+
+static bool cmdActionAfter (SOOMARGS *pa, const SOOMCMD *pc)
+{
+	uint64_t	n1;
+
+	if (enArgIsNumber == (pa->evalArg = compulsoryNumber (&n1, &pa->cArg, pa->nArgs, pa->wcArgs)))
+	{
+		if (pc->pAction->bMaxDWORD && n1 > MAXDWORD)
+		{
+			pa->evalArg = enArgNumberTooBig;
+			return false;
+		}
+		waitForW (n1, pc->pAction->wcAction);
+		pc->pAction->pfnAction ();
+		if (pc->pAction->wcDone)
+			consoleOutW (pc->pAction->wcDone);
+		return true;
+	}
+	return false;
+}
+
+static bool cmdActionMsgAfter (SOOMARGS *pa, const SOOMCMD *pc)
+{
+	uint64_t	n1;
+
+	UNREFERENCED_PARAMETER (pc);
+
+	if (enArgIsNumber == (pa->evalArg = compulsoryNumber (&n1, &pa->cArg, pa->nArgs, pa->wcArgs)))
+	{
+		if (n1 <= MAXDWORD)
+		{
+			outputActionShuttingDown ();
+			ShutdownComputerWithMsgAndGracePeriodW	(
+				nextArgumentW (&pa->cArg, pa->nArgs, pa->wcArgs), (DWORD) n1
+													);
+			return true;
+		}
+		pa->evalArg = enArgNumberTooBig;
+	}
+	return false;
+}
+
+static bool cmdSuspendWakeupAfter (SOOMARGS *pa, const SOOMCMD *pc)
+{
+	uint64_t	n1;
+
+	UNREFERENCED_PARAMETER (pc);
+
+	if (enArgIsNumber == (pa->evalArg = compulsoryNumber (&n1, &pa->cArg, pa->nArgs, pa->wcArgs)))
+	{
+		if (n1 <= MAXDWORD)
+		{
+			HANDLE h = StartThreadWakeupComputerAfter ((DWORD) n1);
+			if (h)
+			{
+				outputActionSuspending ();
+				consoleOutW (L" ");
+				outWaitForW (n1, wcActionWakingUp);
+				SuspendComputerOrFail ();
+				WaitForSingleObject (h, INFINITE);
+				return true;
+			}
+			pa->evalArg = enArgTaskError;
+		} else
+			pa->evalArg = enArgNumberTooBig;
+	}
+	return false;
+}
+
+static bool cmdSuspendAfterWakeupAfter (SOOMARGS *pa, const SOOMCMD *pc)
+{
+	uint64_t	n1, n2;
+
+	UNREFERENCED_PARAMETER (pc);
+
+	if	(
+				enArgIsNumber == (pa->evalArg = compulsoryNumber (&n1, &pa->cArg, pa->nArgs, pa->wcArgs))
+			&&	enArgIsNumber == (pa->evalArg = compulsoryNumber (&n2, &pa->cArg, pa->nArgs, pa->wcArgs))
+		)
+	{
+		if (n1 <= MAXDWORD && n2 <= MAXDWORD)
+		{
+			waitForW (n1, wcActionSuspending);
+			HANDLE h = StartThreadWakeupComputerAfter ((DWORD) n2);
+			if (h)
+			{
+				consoleOutW (L" ");
+				outWaitForW (n2, wcActionWakingUp);
+				SuspendComputerOrFail ();
+				WaitForSingleObject (h, INFINITE);
+				return true;
+			}
+			pa->evalArg = enArgTaskError;
+		} else
+			pa->evalArg = enArgNumberTooBig;
+	}
+	return false;
+}
+
+static bool cmdCompileInventory (SOOMARGS *pa, const SOOMCMD *pc)
+{
+	UNREFERENCED_PARAMETER (pc);
+
+	wchar_t *wcCSV = nextArgumentW (&pa->cArg, pa->nArgs, pa->wcArgs);
+	compileInventory (wcCSV, nextArgumentW (&pa->cArg, pa->nArgs, pa->wcArgs));
+	return true;
+}
+
+static bool cmdEmptyRecycleBin (SOOMARGS *pa, const SOOMCMD *pc)
+{
+	emptyRecycleBin (pc->dwParam, &pa->cArg, pa->nArgs, pa->wcArgs);
+	return true;
+}
+
+static bool cmdQueryRecycleBin (SOOMARGS *pa, const SOOMCMD *pc)
+{
+	UNREFERENCED_PARAMETER (pc);
+
+	queryRecycleBins (&pa->cArg, pa->nArgs, pa->wcArgs);
+	return true;
+}
+
+static bool cmdHarvestMACs (SOOMARGS *pa, const SOOMCMD *pc)
+{
+	UNREFERENCED_PARAMETER (pc);
+
+	pa->evalArg = enArgMissingAfter;
+	wchar_t *wcCSV = nextArgumentW (&pa->cArg, pa->nArgs, pa->wcArgs);
+	callWSAStartup ();
+	return harvestMACs (wcCSV, &pa->cArg, pa->nArgs, pa->wcArgs, &pa->evalArg);
+}
+
+static bool cmdParseMACs (SOOMARGS *pa, const SOOMCMD *pc)
+{
+	UNREFERENCED_PARAMETER (pc);
+
+	parseMACs (nextArgumentW (&pa->cArg, pa->nArgs, pa->wcArgs));
+	return true;
+}
+
+static bool cmdListenWOL (SOOMARGS *pa, const SOOMCMD *pc)
+{
+	uint16_t	uiPorts [U_WAKEONLAN_LISTEN_MAX_PORTS];
+	size_t		nPorts	= 0;
+	bool		bQuiet	= false;
+	uint64_t	n1;
+	WCHAR		*wcOpt;
+
+	UNREFERENCED_PARAMETER (pc);
+
+	while ((wcOpt = nextArgumentW (&pa->cArg, pa->nArgs, pa->wcArgs)))
+	{
+		if (isArgumentIgnoreCaseW (L"-q", wcOpt))
+			bQuiet = true;
+		else
+		if (numberArgumentW (&n1, wcOpt) && n1 && n1 <= 0xFFFF)
+		{
+			if (nPorts < U_WAKEONLAN_LISTEN_MAX_PORTS)
+				uiPorts [nPorts ++] = (uint16_t) n1;
+		} else
+		{
+			-- pa->cArg;
+			break;
+		}
+	}
+	if (0 == nPorts)
+		uiPorts [nPorts ++] = U_WAKEONLAN_MAGIC_PACKET_PORT;
+	callWSAStartup ();
+	listenWOL (uiPorts, nPorts, bQuiet);
+	return true;
+}
+
+static bool cmdRelayWOL (SOOMARGS *pa, const SOOMCMD *pc)
+{
+	uint16_t	uiPorts [U_WAKEONLAN_LISTEN_MAX_PORTS];
+	WCHAR		*wcBrips [U_WAKEONLAN_RELAY_MAX_EGRESS];
+	size_t		nPorts	= 0;
+	size_t		nBrips	= 0;
+	bool		bTo		= false;
+	bool		bQuiet	= false;
+	uint64_t	n1;
+	WCHAR		*wcOpt;
+
+	UNREFERENCED_PARAMETER (pc);
+
+	while ((wcOpt = nextArgumentW (&pa->cArg, pa->nArgs, pa->wcArgs)))
+	{
+		if (isArgumentIgnoreCaseW (L"-q", wcOpt))
+			bQuiet = true;
+		else
+		if (isArgumentIgnoreCaseW (L"-to", wcOpt))
+			bTo = true;
+		else
+		if (bTo && isGoodWOLpeerStringW (wcOpt))
+		{
+			if (nBrips < U_WAKEONLAN_RELAY_MAX_EGRESS)
+				wcBrips [nBrips ++] = wcOpt;
+		} else
+		if (!bTo && numberArgumentW (&n1, wcOpt) && n1 && n1 <= 0xFFFF)
+		{
+			if (nPorts < U_WAKEONLAN_LISTEN_MAX_PORTS)
+				uiPorts [nPorts ++] = (uint16_t) n1;
+		} else
+		{
+			-- pa->cArg;
+			break;
+		}
+	}
+	if (0 == nPorts)
+		uiPorts [nPorts ++] = U_WAKEONLAN_MAGIC_PACKET_PORT;
+	if (nBrips)
+	{
+		callWSAStartup ();
+		relayWOL (uiPorts, nPorts, wcBrips, nBrips, bQuiet);
+	} else
+		consoleOutW (L"RelayWOL requires at least one broadcast IP after -to.\n");
+	return true;
+}
+
+static bool cmdVersion (SOOMARGS *pa, const SOOMCMD *pc)
+{
+	UNREFERENCED_PARAMETER (pa);
+	UNREFERENCED_PARAMETER (pc);
+
+	consoleOutU8 (ONOFFMATE_VERSION_STRTOT);
+	consoleOutU8 ("\n");
+	return true;
+}
+
+static bool cmdWakeOnLAN (SOOMARGS *pa, const SOOMCMD *pc)
+{
+	bool			bCmdComplete	= false;
+	enum eWOLret	wol				= wolretMissing;
+	wchar_t			wcMAC [U_WAKEONLAN_MAC_SIZ];
+	wchar_t			*maca			= NULL;
+	wchar_t			*wcVerifyIP		= NULL;
+	bool			bForceV6		= false;
+	bool			bVerify			= false;
+	SWOLVERIFY		wv;
+	SWOLLIST		wl;
+
+	UNREFERENCED_PARAMETER (pc);
+
+	callWSAStartup ();
+	pa->evalArg = enArgMissingAfter;
+	initWOLverify (&wv);
+	initWOLlist (&wl);
+	// The address is only parsed by addWOLlistTargetU8 ().
+	wchar_t *host = nextArgumentW (&pa->cArg, pa->nArgs, pa->wcArgs);
+	maca = nextArgumentW (&pa->cArg, pa->nArgs, pa->wcArgs);
+	if (isInventoryNameW (host, maca))
+	{
+		if (maca)
+			-- pa->cArg;
+		maca = NULL;
+		if (wakeOptionsW (&wv, &wl.policy, NULL, &pa->cArg, pa->nArgs, pa->wcArgs, &pa->evalArg))
+		{
+			wol = wakeOnLANname (&wl, host, wcMAC);
+			bVerify = wolprobeNone != wv.probe;
+			bCmdComplete = true;
+		}
+	} else
+	if (maca)
+	{
+		wchar_t *wcForceV6 = nextArgumentW (&pa->cArg, pa->nArgs, pa->wcArgs);
+		if (wcForceV6)
+		{
+			if (isArgumentIgnoreCaseW (L"-f6", wcForceV6))
+				bForceV6 = true;
+			else
+				-- pa->cArg;
+		}
+		if (wakeOptionsW (&wv, &wl.policy, &wcVerifyIP, &pa->cArg, pa->nArgs, pa->wcArgs, &pa->evalArg))
+		{
+			wol = wakeOnLANhost (&wl, host, maca, bForceV6, wcVerifyIP);
+			makeUnifiedMACaddress (wcMAC, maca);
+			bVerify = NULL != wcVerifyIP;
+			bCmdComplete = true;
+		}
+	}
+	switch (wol)
+	{
+		case wolretOk:
+			consoleOutW (L"Magic WOL (Wake on LAN) packet sent to \"");
+			consoleOutW (host);
+			consoleOutW (L"\" with MAC address \"");
+			consoleOutW (wcMAC);
+			consoleOutW (L"\" on ");
+			outputWOLpolicy (&wl.policy);
+			consoleOutW (L".\n");
+			break;
+		case wolretSyntaxMAC:
+			consoleOutW (L"Syntax error: \"");
+			consoleOutW (maca);
+			consoleOutW (L"\" is not a valid MAC address.\n");
+			bCmdComplete = true;
+			break;
+		case wolretSyntaxHst:
+			consoleOutW (L"Syntax error: \"");
+			consoleOutW (host);
+			consoleOutW (L"\" is not a valid broadcast IP address.\n");
+			bCmdComplete = true;
+			break;
+		case wolretErrSend:
+			consoleOutW (L"Error sending magic WOL (Wake on LAN) packet to \"");
+			consoleOutW (host);
+			consoleOutW (L"\" with MAC address \"");
+			consoleOutW (wcMAC);
+			consoleOutW (L"\" on ");
+			outputWOLpolicy (&wl.policy);
+			consoleOutW (L".\n");
+			break;
+		case wolretNoIface:
+			consoleOutW (L"No local network interface with an IPv4 broadcast address found.\n");
+			break;
+		case wolretUnresolved:
+			consoleOutW (L"Host name \"");
+			consoleOutW (host);
+			consoleOutW (L"\" could not be resolved (error ");
+			consoleOutUint64 ((uint64_t) wl.pTargets [0].iWSAerr);
+			consoleOutW (L").\n");
+			bCmdComplete = true;
+			break;
+		case wolretMissing:
+		case wolretErrMemory:
+			break;
+	}
+	if (wolretOk == wol && bVerify)
+		verifyWakeOnLANlist (&wl, &wv);
+	else
+	if (wolretOk == wol && wl.policy.uiRetries)
+	{
+		retryWOLlist (&wl);
+		outputWOLlistRounds (&wl);
+	}
+	doneWOLlist (&wl);
+	return bCmdComplete;
+}
+
+static bool cmdWakeOnLANList (SOOMARGS *pa, const SOOMCMD *pc)
+{
+	bool		bForceV6	= false;
+	bool		bUSO		= false;
+	uint64_t	uiRate		= 0;
+	uint64_t	uiGroupRate	= 0;
+	SWOLPOLICY	policy;
+	SWOLVERIFY	wv;
+
+	UNREFERENCED_PARAMETER (pc);
+
+	pa->evalArg = enArgMissingAfter;
+	wchar_t *wcFile = nextArgumentW (&pa->cArg, pa->nArgs, pa->wcArgs);
+	initWOLpolicy (&policy);
+	initWOLverify (&wv);
+	if	(
+			listOptionsW	(
+				&bForceV6, &bUSO, &uiRate, &uiGroupRate, NULL, &policy,
+				&wv, &pa->cArg, pa->nArgs, pa->wcArgs, &pa->evalArg
+							)
+		)
+	{
+		callWSAStartup ();
+		wakeOnLANlist	(
+			wcFile, bForceV6, bUSO, uiRate, uiGroupRate, &policy,
+			wolprobeNone == wv.probe ? NULL : &wv
+						);
+		return true;
+	}
+	return false;
+}
+
+static bool cmdWakeOnLANSelect (SOOMARGS *pa, const SOOMCMD *pc)
+{
+	UNREFERENCED_PARAMETER (pc);
+
+	pa->evalArg = enArgMissingAfter;
+	return wakeOnLANselect (&pa->cArg, pa->nArgs, pa->wcArgs, &pa->evalArg);
+}
+
+static bool cmdWakeOnLANPlan (SOOMARGS *pa, const SOOMCMD *pc)
+{
+	bool		bCmdComplete;
+	SWOLLIST	wl;
+	SWOLVERIFY	wv;
+
+	UNREFERENCED_PARAMETER (pc);
+
+	pa->evalArg = enArgMissingAfter;
+	wchar_t *wcFile = nextArgumentW (&pa->cArg, pa->nArgs, pa->wcArgs);
+	initWOLlist (&wl);
+	initWOLverify (&wv);
+	bCmdComplete = listOptionsW	(
+						NULL, &wl.bUseUSO, &wl.uiRate, &wl.uiGroupRate, NULL,
+						&wl.policy, &wv, &pa->cArg, pa->nArgs, pa->wcArgs, &pa->evalArg
+								);
+	if (bCmdComplete)
+	{
+		callWSAStartup ();
+		wakeOnLANplan (wcFile, &wl, &wv);
+	}
+	doneWOLlist (&wl);
+	return bCmdComplete;
+}
+
+static bool cmdWakeOnLANStress (SOOMARGS *pa, const SOOMCMD *pc)
+{
+	uint64_t	uiThreads;
+	uint64_t	uiPackets;
+	uint64_t	n1;
+	uint16_t	uiPort	= U_WOLSTRESS_DEF_PORT;
+	bool		bAsync	= false;
+	wchar_t		*wcOpt;
+
+	UNREFERENCED_PARAMETER (pc);
+
+	if	(
+				enArgIsNumber != (pa->evalArg = compulsoryNumber (&uiThreads, &pa->cArg, pa->nArgs, pa->wcArgs))
+			||	enArgIsNumber != (pa->evalArg = compulsoryNumber (&uiPackets, &pa->cArg, pa->nArgs, pa->wcArgs))
+		)
+		return false;
+	while ((wcOpt = nextArgumentW (&pa->cArg, pa->nArgs, pa->wcArgs)))
+	{
+		if (isArgumentIgnoreCaseW (L"-async", wcOpt))
+			bAsync = true;
+		else
+		if (isArgumentIgnoreCaseW (L"-port", wcOpt))
+		{
+			if (enArgIsNumber != (pa->evalArg = compulsoryNumber (&n1, &pa->cArg, pa->nArgs, pa->wcArgs)))
+				return false;
+			if (0 == n1 || n1 > 0xFFFF)
+			{
+				pa->evalArg = enArgNumberTooBig;
+				return false;
+			}
+			uiPort = (uint16_t) n1;
+		} else
+		{
+			-- pa->cArg;
+			break;
+		}
+	}
+	wakeOnLANstress (uiThreads, uiPackets, uiPort, bAsync);
+	return true;
+}
+
+static bool cmdWakeOnLANEther (SOOMARGS *pa, const SOOMCMD *pc)
+{
+	uint16_t	uiVLAN	= U_WAKEONLAN_ETHER_NO_VLAN;
+	uint64_t	n1;
+
+	UNREFERENCED_PARAMETER (pc);
+
+	wchar_t *wcIf		= nextArgumentW (&pa->cArg, pa->nArgs, pa->wcArgs);
+	wchar_t *wcTarget	= nextArgumentW (&pa->cArg, pa->nArgs, pa->wcArgs);
+	wchar_t *wcOpt		= nextArgumentW (&pa->cArg, pa->nArgs, pa->wcArgs);
+	if (wcOpt && isArgumentIgnoreCaseW (L"-vlan", wcOpt))
+	{
+		if (enArgIsNumber != (pa->evalArg = compulsoryNumber (&n1, &pa->cArg, pa->nArgs, pa->wcArgs)))
+			return false;
+		if (0 == n1 || n1 > U_WAKEONLAN_ETHER_MAX_VLAN)
+		{
+			pa->evalArg = enArgNumberTooBig;
+			return false;
+		}
+		uiVLAN = (uint16_t) n1;
+	} else
+	if (wcOpt)
+		-- pa->cArg;
+	wakeOnLANether (wcIf, wcTarget, uiVLAN);
+	return true;
+}
+
+/*
+	Script support.
+
+	A script line is converted to UTF-16 into a buffer on the stack and split into
+	arguments in place, hence no memory is allocated per line. Arguments are separated by
+	white space. Double quotes group white space into an argument and are removed, like on
+	the command line.
+*/
+#ifndef U_OOMSCRIPT_LINE_SIZ
+#define U_OOMSCRIPT_LINE_SIZ		(4096)
+#endif
+#ifndef U_OOMSCRIPT_MAX_ARGS
+#define U_OOMSCRIPT_MAX_ARGS		(256)
+#endif
+
+static bool	bOOMscript;											// A script is running.
+
+static WCHAR *nextScriptArgW (WCHAR **ppwc)
+{
+	WCHAR	*pr			= *ppwc;
+	WCHAR	*pw;
+	WCHAR	*wcArg;
+	bool	bQuoted		= false;
+
+	while (isWhiteSpaceW (*pr))
+		++ pr;
+	if (L'\0' == *pr)
+		return NULL;
+	wcArg = pw = pr;
+	while (*pr && (bQuoted || !isWhiteSpaceW (*pr)))
+	{
+		if (L'"' == *pr)
+			bQuoted = !bQuoted;
+		else
+			*pw ++ = *pr;
+		++ pr;
+	}
+	if (*pr)
+		++ pr;
+	*pw = L'\0';
+	*ppwc = pr;
+	return wcArg;
+}
+
+static void outputScriptLineNumber (uint64_t nLine)
+{
+	consoleOutW (L"Line ");
+	consoleOutUint64 (nLine);
+	consoleOutW (L": ");
+}
+
+/*
+	runScriptLine
+
+	Runs the command in the UTF-8 script line szLine. Returns false if the line is not
+	a command, like an empty line or a comment. Otherwise it stores at pbComplete whether
+	the command was complete and returns true.
+*/
+static bool runScriptLine (const char *szLine, uint64_t nLine, bool *pbComplete)
+{
+	WCHAR		wcLine [U_OOMSCRIPT_LINE_SIZ];
+	WCHAR		*wcArgs [U_OOMSCRIPT_MAX_ARGS];
+	WCHAR		*pwc		= wcLine;
+	WCHAR		*wcArg;
+	SOOMARGS	oa;
+
+	*pbComplete = false;
+	if (U16_from_UTF8 (wcLine, U_OOMSCRIPT_LINE_SIZ, szLine, USE_STRLEN, NULL) > U_OOMSCRIPT_LINE_SIZ)
+	{
+		outputScriptLineNumber (nLine);
+		consoleOutW (L"Line too long.\n");
+		return true;
+	}
+	oa.cArg		= 0;
+	oa.nArgs	= 0;
+	oa.wcArgs	= wcArgs;
+	while ((wcArg = nextScriptArgW (&pwc)))
+	{
+		// Lines copied from a batch file may still start with the name of the executable.
+		if	(
+					0 == oa.nArgs
+				&&	(isArgumentIgnoreCaseW (L"oom", wcArg) || isArgumentIgnoreCaseW (L"OnOffMate", wcArg))
+			)
+			continue;
+		if (U_OOMSCRIPT_MAX_ARGS == oa.nArgs)
+		{
+			outputScriptLineNumber (nLine);
+			consoleOutW (L"Too many arguments.\n");
+			return true;
+		}
+		wcArgs [oa.nArgs ++] = wcArg;
+	}
+	if (0 == oa.nArgs || L'#' == wcArgs [0][0])
+		return false;
+	outputScriptLineNumber (nLine);
+	consoleOutU8 (szLine);
+	consoleOutW (L"\n");
+	*pbComplete = runOOMcmd (&oa);
+	return true;
+}
+
+/*
+	runScript
+
+	Runs the commands in the file wcFile, or in standard input if wcFile is "-", one per
+	line, and outputs how many of them were complete. The function returns true if the
+	file could be read and all of its commands were complete.
+*/
+bool runScript (const wchar_t *wcFile)
+{
+	SLINEREADER		lr;
+	LARGE_INTEGER	liFreq, liStart, liEnd;
+	uint64_t		nCmds			= 0;
+	uint64_t		nFailed			= 0;
+	uint64_t		nFirstFailed	= 0;
+	char			*szLine;
+	bool			bComplete;
+
+	if (!openLineReaderW (&lr, wcFile))
+	{
+		consoleOutW (L"Error opening \"");
+		consoleOutW (wcFile);
+		consoleOutW (L"\".");
+		consoleOutWinErrorText (GetLastError ());
+		return false;
+	}
+	QueryPerformanceFrequency (&liFreq);
+	QueryPerformanceCounter (&liStart);
+	bOOMscript = true;
+	while ((szLine = nextLineU8 (&lr, NULL)))
+	{
+		if (runScriptLine (szLine, lr.nLine, &bComplete))
+		{
+			++ nCmds;
+			if (!bComplete)
+			{
+				if (0 == nFailed ++)
+					nFirstFailed = lr.nLine;
+			}
+		}
+	}
+	bOOMscript = false;
+	QueryPerformanceCounter (&liEnd);
+	closeLineReader (&lr);
+
+	consoleOutW (L"Script \"");
+	consoleOutW (wcFile);
+	consoleOutW (L"\": ");
+	consoleOutUint64 (nCmds);
+	consoleOutW (L" command(s), ");
+	consoleOutUint64 (nCmds - nFailed);
+	consoleOutW (L" complete, ");
+	consoleOutUint64 (nFailed);
+	consoleOutW (L" failed");
+	if (nFailed)
+	{
+		consoleOutW (L" (first in line ");
+		consoleOutUint64 (nFirstFailed);
+		consoleOutW (L")");
+	}
+	consoleOutW (L", ");
+	consoleOutUint64 ((uint64_t) (liEnd.QuadPart - liStart.QuadPart) * 1000000 / (uint64_t) liFreq.QuadPart);
+	consoleOutW (L" microseconds.\n");
+	return 0 == nFailed;
+}
+
+static bool cmdScript (SOOMARGS *pa, const SOOMCMD *pc)
+{
+	UNREFERENCED_PARAMETER (pc);
+
+	pa->evalArg = enArgTaskError;
+	if (bOOMscript)
+	{
+		consoleOutW (L"Scripts cannot run scripts.\n");
+		return false;
+	}
+	// Not complete if the script couldn't be read or one of its commands failed.
+	return runScript (nextArgumentW (&pa->cArg, pa->nArgs, pa->wcArgs));
+}
+
+/*
+	ourCmds
+
+	The commands in the order of outPutHelp (). Entries without help text are aliases that
+	are covered by the text of a neighbouring entry.
+*/
+static const SOOMCMD ourCmds [] =
+{
+	{
+		L"?",						cmdHelp,					0,	NULL,	0,
+		"    ? or /? or h or -h or --help       Outputs this help.\n"
+	},
+	{L"/?",							cmdHelp,					0,	NULL,	0,	NULL},
+	{L"h",							cmdHelp,					0,	NULL,	0,	NULL},
+	{L"help",						cmdHelp,					0,	NULL,	0,	NULL},
+	{L"-h",							cmdHelp,					0,	NULL,	0,	NULL},
+	{L"--h",						cmdHelp,					0,	NULL,	0,	NULL},
+	{L"--help",						cmdHelp,					0,	NULL,	0,	NULL},
+	{
+		L"/a",						cmdAbort,					0,	NULL,	0,
+		"    /a                                 Aborts a task with a grace period.\n"
+	},
+	{
+		L"Abort",					cmdAbort,					0,	NULL,	0,
+		"    Abort                              Aborts a task with a grace period.\n"
+	},
+	{
+		L"CompileInventory",		cmdCompileInventory,		1,	NULL,	0,
+		"    CompileInventory <csv> [db]        Compiles the host inventory <csv>, or standard\n"
+		"                                       input if <csv> is \"-\", into the database [db],\n"
+		"                                       or into the default database. Each line contains\n"
+		"                                       name,mac,brip[,group[,port[,ip]]]. The hosts can\n"
+		"                                       then be woken by name. The default database is\n"
+		"                                       the executable with extension .oomdb, or the file\n"
+		"                                       in the environment variable ONOFFMATE_INVENTORY.\n"
+	},
+	{
+		L"EmptyRecycleBin",			cmdEmptyRecycleBin,			0,	NULL,	0,
+		"    EmptyRecycleBin     [dir1] [...]   Empties either all recycle bins of all drives and\n"
+		"                                       folders, or for [dir1], [dir2], etc only.\n"
+	},
+	{
+		L"EmptyRecycleBinNC",		cmdEmptyRecycleBin,			0,	NULL,
+		SHERB_NOCONFIRMATION,
+		"    EmptyRecycleBinNC   [dir1] [...]   Empties recycle bins without confirmation.\n"
+	},
+	{
+		L"EmptyRecycleBinNCP",		cmdEmptyRecycleBin,			0,	NULL,
+		SHERB_NOCONFIRMATION | SHERB_NOPROGRESSUI,
+		"    EmptyRecycleBinNCP  [dir1] [...]   Empties recycle bins without confirmation and\n"
+		"                                       progress bar.\n"
+	},
+	{
+		L"EmptyRecycleBinNCPS",		cmdEmptyRecycleBin,			0,	NULL,
+		SHERB_NOCONFIRMATION | SHERB_NOPROGRESSUI | SHERB_NOSOUND,
+		"    EmptyRecycleBinNCPS [dir1] [...]   Empties recycle bins without confirmation, progress\n"
+		"                                       bar, and sound.\n"
+	},
+	{
+		L"EmptyRecycleBinNCS",		cmdEmptyRecycleBin,			0,	NULL,
+		SHERB_NOCONFIRMATION | SHERB_NOSOUND,
+		"    EmptyRecycleBinNCS  [dir1] [...]   Empties recycle bins without confirmation and\n"
+		"                                       sound.\n"
+	},
+	{
+		L"EmptyRecycleBinNP",		cmdEmptyRecycleBin,			0,	NULL,
+		SHERB_NOPROGRESSUI,
+		"    EmptyRecycleBinNP   [dir1] [...]   Empties recycle bins without progress bar.\n"
+	},
+	{
+		L"EmptyRecycleBinNPS",		cmdEmptyRecycleBin,			0,	NULL,
+		SHERB_NOPROGRESSUI | SHERB_NOSOUND,
+		"    EmptyRecycleBinNPS  [dir1] [...]   Empties recycle bins without progress bar and sound.\n"
+	},
+	{
+		L"EmptyRecycleBinNS",		cmdEmptyRecycleBin,			0,	NULL,
+		SHERB_NOSOUND,
+		"    EmptyRecycleBinNS   [dir1] [...]   Empties recycle bins without sound.\n"
+	},
+	{
+		L"HarvestMACs",				cmdHarvestMACs,				1,	NULL,	0,
+		"    HarvestMACs <csv> [src1] [...] [-neighbours] [-brip <brip>]\n"
+		"                                       Reads MAC addresses from the files [src1], [src2],\n"
+		"                                       etc., or standard input for \"-\", in /etc/ethers,\n"
+		"                                       /proc/net/arp, ip neigh, or arp -a format, and\n"
+		"                                       with -neighbours from the local ARP/NDP table, and\n"
+		"                                       merges them into the inventory <csv>. Changed\n"
+		"                                       hosts are updated, new ones added with broadcast\n"
+		"                                       IP <brip> (default auto) if it's unknown. See\n"
+		"                                       CompileInventory.\n"
+	},
+	{
+		L"Hybernate",				cmdAction,					0,	&oaHybernate,	0,
+		"    Hybernate                          Hybernates computer instantly.\n"
+	},
+	{
+		L"HybernateAfter",			cmdActionAfter,				1,	&oaHybernate,	0,
+		"    HybernateAfter <hs>                Hybernates computer after <hs> seconds.\n"
+	},
+	{
+		L"ListenWOL",				cmdListenWOL,				0,	NULL,	0,
+		"    ListenWOL [port1] [...] [-q]       Listens for magic WOL (Wake on LAN) packets on UDP\n"
+		"                                       ports [port1], [port2], etc., or on port 9, and\n"
+		"                                       outputs time, MAC address, and sender. Argument\n"
+		"                                       -q only outputs statistics. Ctrl+C ends it.\n"
+	},
+	{
+		L"Lock",					cmdAction,					0,	&oaLock,	0,
+		"    Lock                               Locks computer instantly.\n"
+	},
+	{
+		L"LockAfter",				cmdActionAfter,				1,	&oaLock,	0,
+		"    LockAfter <ls>                     Locks computer after <ls> seconds.\n"
+	},
+	{
+		L"Logoff",					cmdAction,					0,	&oaLogoff,	0,
+		"    Logoff                             Logs off current user.\n"
+	},
+	{
+		L"LogoffAfter",				cmdActionAfter,				1,	&oaLogoff,	0,
+		"    LogoffAfter <os>                   Logs off current user after <os> seconds.\n"
+	},
+	{
+		L"MonitorLowPower",			cmdAction,					0,	&oaMonitorLowPower,	0,
+		"    MonitorLowPower                    Puts the monitor(s) in low power mode.\n"
+	},
+	{
+		L"MonitorLowPowerAfter",	cmdActionAfter,				1,	&oaMonitorLowPower,	0,
+		"    MonitorLowPowerAfter <ps>          Puts the monitor(s) in low power mode after <ps>\n"
+		"                                       seconds.\n"
+	},
+	{
+		L"MonitorOff",				cmdAction,					0,	&oaMonitorOff,	0,
+		"    MonitorOff                         Switches the monitor(s) off instantly.\n"
+	},
+	{
+		L"MonitorOffAfter",			cmdActionAfter,				1,	&oaMonitorOff,	0,
+		"    MonitorOffAfter <ps>               Switches the monitor(s) off after <ps> seconds.\n"
+	},
+	{
+		L"MonitorOn",				cmdAction,					0,	&oaMonitorOn,	0,
+		"    MonitorOn                          Switches the monitor(s) on instantly.\n"
+	},
+	{
+		L"MonitorOnAfter",			cmdActionAfter,				1,	&oaMonitorOn,	0,
+		"    MonitorOnAfter <ps>                Switches the monitor(s) on after <ps> seconds.\n"
+	},
+	{
+		L"MonitorPowerOff",			cmdAction,					0,	&oaMonitorOff,	0,
+		"    MonitorPowerOff                    Switches the monitor(s) off instantly.\n"
+	},
+	{
+		L"MonitorPowerOffAfter",	cmdActionAfter,				1,	&oaMonitorOff,	0,
+		"    MonitorPowerOffAfter <ps>          Switches the monitor(s) off after <ps> seconds.\n"
+	},
+	{
+		L"MonitorPowerOn",			cmdAction,					0,	&oaMonitorOn,	0,
+		"    MonitorPowerOn                     Switches the monitor(s) on instantly.\n"
+	},
+	{
+		L"MonitorPowerOnAfter",		cmdActionAfter,				1,	&oaMonitorOn,	0,
+		"    MonitorPowerOnAfter <ps>           Switches the monitor(s) on after <ps> seconds.\n"
+	},
+	{
+		L"ParseMACs",				cmdParseMACs,				1,	NULL,	0,
+		"    ParseMACs <file>                   Parses the first MAC address of every line of\n"
+		"                                       <file>, or of standard input if <file> is \"-\",\n"
+		"                                       and outputs the parse rate. Notations are\n"
+		"                                       00-11-22-33-44-55, 0:11:2:33:4:55, 0011.2233.4455,\n"
+		"                                       and 001122334455.\n"
+	},
+	{
+		L"PowerOff",				cmdAction,					0,	&oaPowerOff,	0,
+		"    PowerOff                           Shuts down and powers off computer instantly.\n"
+	},
+	{
+		L"PowerOffAfter",			cmdActionAfter,				1,	&oaPowerOff,	0,
+		"    PowerOffAfter <ps>                 Shuts down and powers off computer in <ps> seconds.\n"
+	},
+	{
+		L"PowerOffMsgAfter",		cmdActionMsgAfter,			1,	NULL,	0,
+		"    PowerOffMsgAfter <ps> <msg>        Shuts down and powers off computer in <ps> seconds\n"
+		"                                       with message <msg>.\n"
+	},
+	{
+		L"QueryRecycleBin",			cmdQueryRecycleBin,			0,	NULL,	0,
+		"    QueryRecycleBin     [dir1] [...]   Queries either all recycle bins of all drives and\n"
+		"                                       folders, or for [dir1], [dir2], etc only.\n"
+	},
+	{
+		L"Reboot",					cmdAction,					0,	&oaRestart,	0,
+		"    Reboot                             Restarts/reboots computer instantly.\n"
+	},
+	{
+		L"RebootAfter",				cmdActionAfter,				1,	&oaRestart,	0,
+		"    RebootAfter <rs>                   Restarts/reboots computer after <rs> seconds.\n"
+	},
+	{
+		L"RelayWOL",				cmdRelayWOL,				0,	NULL,	0,
+		"    RelayWOL [port1] [...] -to <brip1> [...] [-q]\n"
+		"                                       Listens for magic WOL (Wake on LAN) packets like\n"
+		"                                       ListenWOL and sends them on to port 9 of the\n"
+		"                                       broadcast IPs <brip1>, [brip2], etc. Argument -q\n"
+		"                                       only outputs statistics. Ctrl+C ends it.\n"
+	},
+	{
+		L"Restart",					cmdAction,					0,	&oaRestart,	0,
+		"    Restart                            Restarts/reboots computer instantly.\n"
+	},
+	{
+		L"RestartAfter",			cmdActionAfter,				1,	&oaRestart,	0,
+		"    RestartAfter <rs>                  Restarts/reboots computer after <rs> seconds.\n"
+	},
+	{
+		L"Script",					cmdScript,					1,	NULL,	0,
+		"    Script <file>                      Runs the commands in <file>, or in standard input\n"
+		"                                       if <file> is \"-\", one per line, in a single\n"
+		"                                       process. Arguments with spaces are enclosed in\n"
+		"                                       double quotes. Lines starting with # are\n"
+		"                                       comments. Each command is output with its line\n"
+		"                                       number before it runs, and the amount of\n"
+		"                                       complete and failed commands at the end.\n"
+	},
+	{
+		L"Shutdown",				cmdAction,					0,	&oaShutdown,	0,
+		"    Shutdown                           Shuts down and powers off computer instantly.\n"
+	},
+	{
+		L"ShutdownAfter",			cmdActionAfter,				1,	&oaShutdown,	0,
+		"    ShutdownAfter <ds>                 Shuts down and powers off computer in <ds> seconds.\n"
+	},
+	{
+		L"ShutdownMsgAfter",		cmdActionMsgAfter,			1,	NULL,	0,
+		"    ShutdownMsgAfter <ds> <msg>        Shuts down and powers off computer in <ds> seconds\n"
+		"                                       with message <msg>\n"
+	},
+	{
+		L"Sleep",					cmdAction,					0,	&oaSuspend,	0,
+		"    Sleep                              Suspends (sleeps) computer instantly.\n"
+	},
+	{
+		L"SleepAfter",				cmdActionAfter,				1,	&oaSuspend,	0,
+		"    SleepAfter <ss>                    Suspends (sleeps) computer after <ss> seconds.\n"
+	},
+	{
+		L"SleepWakeupAfter",		cmdSuspendWakeupAfter,		1,	NULL,	0,
+		"    SleepWakeupAfter <ws>              Suspends (sleeps) computer instantly and wakes it\n"
+		"                                       up again after <ws> seconds.\n"
+	},
+	{
+		L"SleepAfterWakeupAfter",	cmdSuspendAfterWakeupAfter,	2,	NULL,	0,
+		"    SleepAfterWakeupAfter <ss> <ws>    Suspends (sleeps) computer in <ss> seconds and\n"
+		"                                       wakes it up again after <ws> seconds.\n"
+	},
+	{
+		L"Suspend",					cmdAction,					0,	&oaSuspend,	0,
+		"    Suspend                            Suspends (sleeps) computer instantly.\n"
+	},
+	{
+		L"SuspendAfter",			cmdActionAfter,				1,	&oaSuspend,	0,
+		"    SuspendAfter <ss>                  Suspends (sleeps) computer after <ss> seconds.\n"
+	},
+	{
+		L"SuspendWakeupAfter",		cmdSuspendWakeupAfter,		1,	NULL,	0,
+		"    SuspendWakeupAfter <ws>            Suspends (sleeps) computer instantly and wakes it\n"
+		"                                       up again after <ws> seconds.\n"
+	},
+	{
+		L"SuspendAfterWakeupAfter",	cmdSuspendAfterWakeupAfter,	2,	NULL,	0,
+		"    SuspendAfterWakeupAfter <ss> <ws>  Suspends (sleeps) computer in <ss> seconds and\n"
+		"                                       wakes it up again after <ws> seconds.\n"
+	},
+	{
+		L"Ver",						cmdVersion,					0,	NULL,	0,
+		"    Ver                                Prints the version info.\n"
+	},
+	{
+		L"Version",					cmdVersion,					0,	NULL,	0,
+		"    Version                            Prints the version info.\n"
+	},
+	{
+		L"WakeOnLAN",				cmdWakeOnLAN,				1,	NULL,	0,
+		"    WakeOnLAN <brip> <mac> [-f6] [-verify <probe> <ip>] [-timeout <s>] [<policy>]\n"
+		"    WakeOnLAN <name> [-verify <probe>] [-timeout <s>] [<policy>]\n"
+		"                                       Wakes the host with broadcast IP <brip> and MAC\n"
+		"                                       address <mac>. For example, if the IP address of the\n"
+		"                                       host to wake up is 192.168.0.97 and the subnet mask\n"
+		"                                       is 255.255.255.0, use 192.168.0.255 for <brip>.\n"
+		"                                       Argument -f6 forces IPv6 even if <brip> is IPv4.\n"
+		"                                       If <brip> is \"auto\", the packet is sent to the\n"
+		"                                       broadcast IPs of all local IPv4 interfaces.\n"
+		"                                       For IPv6 use the all-nodes multicast address with\n"
+		"                                       the interface as scope, like ff02::1%Ethernet or\n"
+		"                                       ff02::1%12. <brip> can also be a host name, like\n"
+		"                                       rack12-bcast.lab, which is resolved via DNS or\n"
+		"                                       the hosts file.\n"
+		"                                       Argument -verify waits until the host with IP\n"
+		"                                       <ip> is reachable. <probe> is tcp:<port> or icmp.\n"
+		"                                       Argument -timeout sets the maximum time to wait\n"
+		"                                       in seconds (default 120). See below for <policy>.\n"
+		"                                       Instead of <brip> and <mac> the <name> of a host\n"
+		"                                       in the default database can be given. See\n"
+		"                                       CompileInventory.\n"
+	},
+	{
+		L"WakeOnLANList",			cmdWakeOnLANList,			1,	NULL,	0,
+		"    WakeOnLANList <file> [-f6] [-uso] [-rate <pps>] [-grouprate <pps>]\n"
+		"                  [-verify <probe>] [-timeout <s>] [<policy>]\n"
+		"                                       Wakes all hosts listed in <file>, or in standard\n"
+		"                                       input if <file> is \"-\". Each line contains a\n"
+		"                                       broadcast IP, host name, or \"auto\" and a MAC\n"
+		"                                       address, and optionally -f6, group=<name>, and\n"
+		"                                       ip=<ip>, or the name of a host in the default\n"
+		"                                       database. Lines starting with # are comments.\n"
+		"                                       Host names are resolved in parallel, and each\n"
+		"                                       name only once. Argument -uso sends\n"
+		"                                       the packets for hosts with identical broadcast\n"
+		"                                       IPs with UDP segmentation offload. Argument -rate\n"
+		"                                       limits the packets per second in total,\n"
+		"                                       -grouprate per group, for instance per rack PDU.\n"
+		"                                       Packets are then evenly spaced, and -uso is\n"
+		"                                       ignored. Argument -verify waits until the hosts\n"
+		"                                       with an ip=<ip> are reachable, and outputs the\n"
+		"                                       time to wake (p50/p95/p99) and the hosts that\n"
+		"                                       did not wake up.\n"
+		"      <policy>: [-ports <p1,p2,...>] [-copies <n>] [-spacing <ms>] [-retries <n>]\n"
+		"                [-backoff <ms>]\n"
+		"                                       Sends <n> copies of each packet to each of the\n"
+		"                                       ports (default 9, 7 and 9 are common), <ms> apart,\n"
+		"                                       interleaved across all hosts. Up to -retries\n"
+		"                                       more rounds follow after -backoff ms (default\n"
+		"                                       1000, doubling). With -verify, retries only go\n"
+		"                                       to hosts not up yet.\n"
+	},
+	{
+		L"WakeOnLANSelect",			cmdWakeOnLANSelect,			1,	NULL,	0,
+		"    WakeOnLANSelect <selector> [<selector> ...] [-show] [-uso] [-rate <pps>]\n"
+		"                    [-grouprate <pps>] [-verify <probe>] [-timeout <s>] [<policy>]\n"
+		"                                       Wakes the hosts of the default database that\n"
+		"                                       match the selectors, like WakeOnLANList. A\n"
+		"                                       selector is one or more comma-separated terms\n"
+		"                                       cidr:<prefix>/<bits>, group:<pattern>, or\n"
+		"                                       <pattern> for host names. Patterns can contain\n"
+		"                                       *, ?, and [...]. Terms starting with ! exclude\n"
+		"                                       hosts, for instance cidr:10.20.0.0/16\n"
+		"                                       !group:storage. Argument -show only lists the\n"
+		"                                       hosts.\n"
+	},
+	{
+		L"WakeOnLANPlan",			cmdWakeOnLANPlan,			1,	NULL,	0,
+		"    WakeOnLANPlan <file> [-uso] [-rate <pps>] [-grouprate <pps>] [-verify <probe>]\n"
+		"                  [-timeout <s>] [<policy>]\n"
+		"                                       Wakes the hosts of the default database in the\n"
+		"                                       stages of the wake plan <file>. Each line is\n"
+		"                                       <stage> <selector> [after=<stage>,...]\n"
+		"                                       [verify=<probe>|none] [timeout=<s>] [wait=<s>]\n"
+		"                                       [required]. See WakeOnLANSelect for <selector>.\n"
+		"                                       Stages start as soon as the stages in after=\n"
+		"                                       have ended, in parallel, and end when their\n"
+		"                                       hosts are up or after timeout=, or after wait=\n"
+		"                                       without verification. Dependents of a required\n"
+		"                                       stage that timed out are skipped. Outputs the\n"
+		"                                       timing of each stage and the critical path.\n"
+	},
+	{
+		L"WakeOnLANStress",			cmdWakeOnLANStress,			2,	NULL,	0,
+		"    WakeOnLANStress <threads> <packets> [-port <p>] [-async]\n"
+		"                                       Sends <packets> magic packets from each of\n"
+		"                                       <threads> threads (max. 64) at the same time\n"
+		"                                       to loopback port <p> (default 40009), and\n"
+		"                                       reports lost packets and leaked handles. With\n"
+		"                                       -async the threads submit to a single I/O\n"
+		"                                       thread, and submit-to-wire latencies are\n"
+		"                                       reported.\n"
+	},
+	{
+		L"WakeOnLANEther",			cmdWakeOnLANEther,			2,	NULL,	0,
+		"    WakeOnLANEther <if> <mac> [-vlan <id>]\n"
+		"                                       Wakes the host with MAC address <mac> with an\n"
+		"                                       Ethernet frame (EtherType 0x0842) sent out on\n"
+		"                                       interface <if>, optionally with VLAN tag <id>.\n"
+		"                                       <if> is the interface name or index. Instead of\n"
+		"                                       <mac> a list file or \"-\" can be given. Requires\n"
+		"                                       Npcap (https://npcap.com).\n"
+	}
+};
+#define N_OOMCMDS	(sizeof (ourCmds) / sizeof (ourCmds [0]))
+
+/*
+	Command lookup.
+
+	The hash is built from the length and four characters of a command, with the ASCII
+	letters folded to lower case, and spread over U_OOMCMD_SLOTS slots with a multiplicative
+	hash. U_OOMCMD_HASH_MUL has been chosen so that no two commands in ourCmds share a
+	slot. A lookup is therefore one hash and one comparison. A command added later that
+	collides still works, as the slots are probed linearly, but the multiplier should then
+	be searched for again.
+*/
+#define U_OOMCMD_SLOTS_BITS		(8)
+#define U_OOMCMD_SLOTS			(1 << U_OOMCMD_SLOTS_BITS)
+#define U_OOMCMD_HASH_MUL		(0x817B892CA025F02Bull)
+
+static uint8_t	uiOOMcmdSlots [U_OOMCMD_SLOTS];						// Index + 1, or 0.
+static bool		bOOMcmdSlots;
+
+static inline uint64_t foldOOMcmdW (WCHAR wc)
+{
+	return ((uint64_t) wc | 0x20) & 0xFF;
+}
+
+static inline unsigned int hashOOMcmdW (const WCHAR *wcCmd, size_t len)
+{
+	uint64_t x	=	(uint64_t) (len & 0xFF)
+				|	foldOOMcmdW (wcCmd [0])									<< 8
+				|	foldOOMcmdW (wcCmd [len - 1])							<< 16
+				|	foldOOMcmdW (wcCmd [len > 1 ? len - 2 : 0])				<< 24
+				|	foldOOMcmdW (wcCmd [len / 2])							<< 32;
+	return (unsigned int) ((x * U_OOMCMD_HASH_MUL) >> (64 - U_OOMCMD_SLOTS_BITS));
+}
+
+static void hashOOMcmds (void)
+{
+	size_t			n;
+	unsigned int	h;
+
+	for (n = 0; n < N_OOMCMDS; ++ n)
+	{
+		h = hashOOMcmdW (ourCmds [n].wcName, strlenW (ourCmds [n].wcName));
+		while (uiOOMcmdSlots [h])
+			h = (h + 1) & (U_OOMCMD_SLOTS - 1);
+		uiOOMcmdSlots [h] = (uint8_t) (n + 1);
+	}
+	bOOMcmdSlots = true;
+}
+
+const SOOMCMD *findOOMcmdW (const WCHAR *wcCmd)
+{
+	size_t			len	= strlenW (wcCmd);
+	unsigned int	h;
+
+	if (!bOOMcmdSlots)
+		hashOOMcmds ();
+	if (0 == len)
+		return NULL;
+	h = hashOOMcmdW (wcCmd, len);
+	while (uiOOMcmdSlots [h])
+	{
+		const SOOMCMD *pc = &ourCmds [uiOOMcmdSlots [h] - 1];
+		if (isEqualIgnoreCaseW (pc->wcName, wcCmd))
+			return pc;
+		h = (h + 1) & (U_OOMCMD_SLOTS - 1);
+	}
+	return NULL;
+}
+
+/*
+	outPutHelp
+
+	Prints a list with the parameters to the standard output/console.
+*/
+void outPutHelp (void)
+{
+	size_t		n;
+
+	consoleOutU8	(
+		"\n"
+		ONOFFMATE_VERSION_STRTOT " - Hybernation, sleep, recycle bin, and power helper\n"
+		"\n"
+		"  OnOffMate [command]\n"
+		"  oom [command]\n"
+		"\n"
+		"  Commands:\n"
+					);
+	for (n = 0; n < N_OOMCMDS; ++ n)
+	{
+		if (ourCmds [n].ccHelp)
+			consoleOutU8 (ourCmds [n].ccHelp);
+	}
+	consoleOutU8	(
+		"\n"
+		"  Note that not every hardware supports all commands, that some options can be activated/\n"
+		"  deactivated in the BIOS, and that others depend on Windows settings.\n"
+		"\n"
+		"  The original behaviour of the Shutdown... commands (shutting down without power off) has\n"
+		"  been changed to be identical to the PowerOff... commands (shutting down and power off).\n"
+					);
+}
+
+/*
+	runOOMcmd
+
+	Runs the command at pa->wcArgs [pa->cArg] and outputs the arguments it ignored, or a
+	syntax error. Returns true if the command was complete.
+*/
+bool runOOMcmd (SOOMARGS *pa)
+{
+	const SOOMCMD	*pc				= findOOMcmdW (pa->wcArgs [pa->cArg]);
+	bool			bCmdComplete	= false;
+
+	pa->evalArg = enArgInvalid;
+	if (pc)
+	{
+		if ((unsigned int) (pa->nArgs - pa->cArg - 1) < pc->arity)
+			pa->evalArg = enArgMissingAfter;
+		else
+			bCmdComplete = pc->pfnCmd (pa, pc);
+	}
+	if (bCmdComplete)
+	{
+		++ pa->cArg;
+		if (pa->cArg < pa->nArgs)
+		{
+			consoleOutW (L"\nIgnored argument(s):");
+			while (pa->cArg < pa->nArgs)
+			{
+				consoleOutW (L" \"");
+				consoleOutW (pa->wcArgs [pa->cArg]);
+				consoleOutW (L"\"");
+				++ pa->cArg;
+			}
+			consoleOutW (L"\n");
+		}
+	} else
+	{
+		switch (pa->evalArg)
+		{
+			case enArgInvalid:
+				consoleOutU8 ("Syntax error. Unknown argument/parameter: \"");
+				break;
+			case enArgNoArg:
+				consoleOutU8 ("Syntax error. Argument/parameter missing for \"");
+				break;
+			case enArgNumberTooBig:
+				consoleOutU8 ("Syntax error. Number too big: \"");
+				break;
+			case enArgNotNumber:
+				consoleOutU8 ("Syntax error. Argument/parameter is not a valid number: \"");
+				break;
+			case enArgTaskError:
+				consoleOutU8 ("Error performing task: \"");
+				break;
+			case enArgMissingAfter:
+				consoleOutU8 ("Syntax error. Argument/parameter missing after: \"");
+				break;
+			default:
+				consoleOutU8 ("Syntax error. Argument/parameter missing for \"");
+		}
+		consoleOutW (pa->wcArgs [pa->cArg]);
+		consoleOutU8 ("\".\n");
+	}
+	return bCmdComplete;
+}
+
+void ourmain (void)
+{
+	// The command-line arguments.
+	int			nArgs;											// Amount of arguments.
+	WCHAR		**wcArgs = cmdLineArgsW (&nArgs);				// Array of arguments.
+	swallowExeArgW (&nArgs, &wcArgs);							// Suppress the executable.
+
+	//doWeHaveInteractiveSessions ();
+
+	AttachConsole (ATTACH_PARENT_PROCESS);
+	SetCodePageToUTF8 ();
+	SetConsoleEnableANSI ();
+
+	if (!ObtainPrivilege (SE_SHUTDOWN_NAME))
+	{
+		consoleOutW (L"Error obtaining privilege SE_SHUTDOWN_NAME.\n");
+		ExitProcess (EXIT_FAILURE);
+	}
+	if (nArgs)
+	{
+		SOOMARGS	oa;
+
+		oa.cArg		= 0;
+		oa.nArgs	= nArgs;
+		oa.wcArgs	= wcArgs;
+		runOOMcmd (&oa);
 	} else
 	{
 		outPutHelp ();
@@ -55,10 +55,10 @@ When		Who				What
 #include "./externC.h"
 
 #ifndef ONOFFMATE_VERSION_STRING
-#define ONOFFMATE_VERSION_STRING		"1.004"
+#define ONOFFMATE_VERSION_STRING		"1.005"
 #endif
 #ifndef ONOFFMATE_VERSION_DATEST
-#define ONOFFMATE_VERSION_DATEST		"2025-07-12"
+#define ONOFFMATE_VERSION_DATEST		"2026-10-17"
 #endif
 #ifndef ONOFFMATE_VERSION_STRTOT
 #define ONOFFMATE_VERSION_STRTOT		"OnOffMate (oom) - Ver. " ONOFFMATE_VERSION_STRING " (" ONOFFMATE_VERSION_DATEST ")"
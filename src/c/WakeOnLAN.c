@@ -11,6 +11,20 @@ History
 When		Who				What
 -----------------------------------------------------------------------------------------
 2025-05-17	Thomas			Created.
+2026-10-17	Thomas			Lists of targets sent over one socket per address family.
+2026-10-17	Thomas			UDP segmentation offload (USO) for lists.
+2026-10-17	Thomas			Function findWOLmagicPacket () added.
+2026-10-17	Thomas			Paced sending of lists with groups.
+2026-10-17	Thomas			Broadcast target "auto".
+2026-10-17	Thomas			Host addresses of targets for verification.
+2026-10-17	Thomas			Addresses parsed once, with IPv6 scope ids and multicast.
+2026-10-17	Thomas			Send policy with ports, copies, and retry rounds.
+2026-10-17	Thomas			MAC addresses in all common notations. See parseWOLmacU8 ().
+2026-10-17	Thomas			Targets of lists can be names from an inventory database.
+2026-10-17	Thomas			Functions initWOLtarget () and sendWOLbatch () added.
+2026-10-17	Thomas			WSAStartup () via InitOnceExecuteOnce (). Interface table locked.
+2026-10-17	Thomas			Host names as targets, resolved in parallel by resolveWOLlist ().
+2026-10-17	Thomas			Strings converted in a single pass by UTF8_from_U16 ().
 
 ****************************************************************************************/
 
@@ -48,15 +62,35 @@ When		Who				What
 #include <Winsock2.h>
 #include <ws2tcpip.h>
 #include <Windows.h>
+#include <iphlpapi.h>
 #pragma comment (lib, "Ws2_32.lib")
+#pragma comment (lib, "Iphlpapi.lib")
+
+/*
+	UDP segmentation offload (USO) is available from Windows 10 version 2004 onwards. Older
+	SDKs don't know about it.
+*/
+#ifndef UDP_SEND_MSG_SIZE
+#define UDP_SEND_MSG_SIZE	(2)
+#endif
+
+// Windows 10 1803 and later.
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION	(0x00000002)
+#endif
 
 #include "./WakeOnLAN.h"
+#include "./WinLineReader.h"
+#include "./WakeOnLANIfaces.h"
+#include "./WakeOnLANMAC.h"
+#include "./WakeOnLANInventory.h"
+#include "./WakeOnLANResolve.h"
+#include "./WinRuntimeReplacements.h"
 
 #ifdef THIS_IS_ONOFFMATE
-	#include "./WinRuntimeReplacements.h"
-
 	#define memcpy(d, s, l)		memcpyU (d, s, l)
 	#define memset(d, c, l)		memsetU (d, c, l)
+	#define memcmp(a, b, l)		memcmpU (a, b, l)
 #else
 	#include <stdio.h>
 #endif
@@ -71,53 +105,169 @@ When		Who				What
 */
 void initWOLmagicPacket (char *szMagicPacket, const unsigned char cucMAC [6])
 {
-	memset (szMagicPacket, 0xFF, 6);
+	char	*p		= szMagicPacket + 6;
+	size_t	len		= 6;
 
-	size_t offs = 6;
-	while (offs < U_WAKEONLAN_MAGIC_PACKET_LEN)
+	memset (szMagicPacket, 0xFF, 6);
+	memcpy (p, cucMAC, 6);
+	// Every copy doubles the repetitions. 6 + 12 + 24 + 48 octets make 16 of them.
+	while (len < U_WAKEONLAN_MAGIC_PACKET_LEN - 6)
 	{
-		memcpy (szMagicPacket + offs, cucMAC, 6);
-		offs += 6;
+		memcpy (p + len, p, len);
+		len *= 2;
 	}
 }
 
-static bool bWSAStartupComplete;
-
 /*
-	See
-	https://learn.microsoft.com/en-us/windows/win32/api/winsock/nf-winsock-wsastartup .
+	Returns true if the 102 octets at p are a magic packet.
 */
-bool callWSAStartup (void)
+static bool isWOLmagicPacketAt (const unsigned char *p)
 {
-	WSADATA		wsa;
-	int			iws;
+	if (0xFF != p [0] || 0xFF != p [1] || 0xFF != p [2] || 0xFF != p [3] || 0xFF != p [4] || 0xFF != p [5])
+		return false;
 
-	if (!bWSAStartupComplete)
-	{
-		iws = WSAStartup (MAKEWORD (2, 2), &wsa);
+	/*
+		The 16 repetitions of the MAC address are periodic with a period of 6 octets, i.e.
+		x [j] == x [j + 6] for j = 0...89.
+	*/
+	const unsigned char *x = p + 6;
+	#ifdef U_WINRUNTIME_SSE2
+		// Six overlapping 16 octet comparisons cover j = 0...89.
+		static const size_t	offs []	= { 0, 16, 32, 48, 64, 74 };
+		int					n;
 
-		/*
-		switch (iws)
+		for (n = 0; n < 6; ++ n)
 		{
-			case WSASYSNOTREADY:		break;
-			case WSAVERNOTSUPPORTED:	break;
-			case WSAEINPROGRESS:		break;
-			case WSAEPROCLIM:			break;
-			case WSAEFAULT:				break;
-			case 0:
-				bWSAStartupComplete = true;
-				return true;
+			__m128i a = _mm_loadu_si128 ((const __m128i *) (x + offs [n]));
+			__m128i b = _mm_loadu_si128 ((const __m128i *) (x + offs [n] + 6));
+			if (0xFFFF != _mm_movemask_epi8 (_mm_cmpeq_epi8 (a, b)))
+				return false;
 		}
+		return true;
+	#else
+		size_t j;
+
+		for (j = 0; j < U_WAKEONLAN_MAGIC_PACKET_LEN - 12; ++ j)
+		{
+			if (x [j] != x [j + 6])
+				return false;
+		}
+		return true;
+	#endif
+}
+
+const unsigned char *findWOLmagicPacket (const unsigned char *pData, size_t lenData, unsigned char ucMAC [6])
+{
+	size_t i	= 0;
+
+	if (lenData < U_WAKEONLAN_MAGIC_PACKET_LEN)
+		return NULL;
+	size_t last	= lenData - U_WAKEONLAN_MAGIC_PACKET_LEN;			// Last possible start.
+
+	#ifdef U_WINRUNTIME_SSE2
+		/*
+			Every bit of the 32 bit mask m tells whether the octet at this position is 0xFF.
+			A run of six of them starts where m & (m >> 1) & ... & (m >> 5) has a bit set.
+			The second 16 octets are only required to find runs that cross the boundary, which
+			is why we advance by 16 octets only.
 		*/
+		const __m128i ff = _mm_set1_epi8 ((char) 0xFF);
+		while (i + 32 <= lenData && i <= last)
+		{
+			uint32_t m =			(uint32_t) _mm_movemask_epi8 (_mm_cmpeq_epi8 (_mm_loadu_si128 ((const __m128i *) (pData + i)), ff))
+						|	(		(uint32_t) _mm_movemask_epi8 (_mm_cmpeq_epi8 (_mm_loadu_si128 ((const __m128i *) (pData + i + 16)), ff))
+								<<	16
+							);
+			uint32_t r = m & (m >> 1) & (m >> 2) & (m >> 3) & (m >> 4) & (m >> 5) & 0xFFFF;
+			while (r)
+			{
+				unsigned long b;
+				_BitScanForward (&b, r);
+				if (i + b > last)
+					return NULL;
+				if (isWOLmagicPacketAt (pData + i + b))
+				{
+					memcpy (ucMAC, pData + i + b + 6, 6);
+					return pData + i + b;
+				}
+				r &= r - 1;
+			}
+			i += 16;
+		}
+	#endif
+	for (; i <= last; ++ i)
+	{
+		if (isWOLmagicPacketAt (pData + i))
+		{
+			memcpy (ucMAC, pData + i + 6, 6);
+			return pData + i;
+		}
+	}
+	return NULL;
+}
 
-		bWSAStartupComplete = 0 == iws;
+const char *octetsFromMACU8 (unsigned char ucMAC [6], const char *szMAC)
+{
+	int s = 0;
+	int n;
+	for (n = 0; n < 6; ++ n)
+	{
+		size_t l = ubf_octet_from_hex (ucMAC + n, szMAC + s);
+		if (2 != l)
+			return szMAC + s;
+		s += 3;
 	}
-	return bWSAStartupComplete;
+	return NULL;
+}
+
+/*
+	WSAStartup () is called once per process, no matter how many threads call
+	callWSAStartup () at the same time. INIT_ONCE makes all of them wait for the first one.
+	The result is published through the context of the INIT_ONCE structure, hence there's
+	no other state to protect.
+*/
+static INIT_ONCE		ioWSAStartup	= INIT_ONCE_STATIC_INIT;
+static volatile LONG	lWSACleanup;
+
+static BOOL CALLBACK initOnceWSAStartup (PINIT_ONCE pio, PVOID pParam, PVOID *ppCtx)
+{
+	WSADATA		wsa;
+
+	UNREFERENCED_PARAMETER (pio);
+	UNREFERENCED_PARAMETER (pParam);
+	/*
+		The possible errors are WSASYSNOTREADY, WSAVERNOTSUPPORTED, WSAEINPROGRESS,
+		WSAEPROCLIM, and WSAEFAULT. See
+		https://learn.microsoft.com/en-us/windows/win32/api/winsock/nf-winsock-wsastartup .
+		None of them goes away by trying again. The low INIT_ONCE_CTX_RESERVED_BITS of the
+		context must be 0, hence success is any aligned address, not 1.
+	*/
+	*ppCtx = 0 == WSAStartup (MAKEWORD (2, 2), &wsa) ? (PVOID) &ioWSAStartup : NULL;
+	return TRUE;
+}
+
+static bool isWSAStartupComplete (void)
+{
+	PVOID	pCtx;
+	BOOL	bPending;
+
+	if (!InitOnceBeginInitialize (&ioWSAStartup, INIT_ONCE_CHECK_ONLY, &bPending, &pCtx))
+		return false;
+	return !bPending && NULL != pCtx;
+}
+
+bool callWSAStartup (void)
+{
+	PVOID pCtx = NULL;
+
+	if (!InitOnceExecuteOnce (&ioWSAStartup, initOnceWSAStartup, NULL, &pCtx))
+		return false;
+	return NULL != pCtx && 0 == lWSACleanup;
 }
 
 void CallWSACleanup (void)
 {
-	if (bWSAStartupComplete)
+	if (isWSAStartupComplete () && 0 == InterlockedExchange (&lWSACleanup, 1))
 		WSACleanup ();
 }
 
@@ -131,11 +281,9 @@ bool isGoodIPv4string (const char *strip)
 bool isGoodIPv4stringW (const wchar_t *wstrip)
 {
 	char	strip [U_WAKEONLAN_IPV4_SIZ];
-	int		iReq = reqUTF8size (wstrip);
-	if (iReq <= U_WAKEONLAN_IPV4_SIZ)
+
+	if (UTF8_from_U16 (strip, U_WAKEONLAN_IPV4_SIZ, wstrip, USE_STRLEN, NULL) <= U_WAKEONLAN_IPV4_SIZ)
 	{
-		UTF8_from_WinU16 (strip, U_WAKEONLAN_IPV4_SIZ, wstrip);
-		
 		struct in_addr addr;
 		return 1 == inet_pton (AF_INET, strip, &addr);
 	}
@@ -152,167 +300,1202 @@ bool isGoodIPv6string (const char *strip)
 bool isGoodIPv6stringW (const wchar_t *wstrip)
 {
 	char	strip [U_WAKEONLAN_IPV6_SIZ];
-	int		iReq = reqUTF8size (wstrip);
-	if (iReq <= U_WAKEONLAN_IPV6_SIZ)
-	{
-		UTF8_from_WinU16 (strip, U_WAKEONLAN_IPV6_SIZ, wstrip);
 
+	if (UTF8_from_U16 (strip, U_WAKEONLAN_IPV6_SIZ, wstrip, USE_STRLEN, NULL) <= U_WAKEONLAN_IPV6_SIZ)
+	{
 		struct in6_addr addr;
 		return 1 == inet_pton (AF_INET6, strip, &addr);
 	}
 	return false;
 }
 
-/*
-	Note that ccPeerIP should be a broadcast IP, i.e. if the peer's IP is
-	192.168.0.201 and the subnet mask is 255.255.255.0, use 192.168.0.255.
+bool isGoodWOLpeerStringW (const wchar_t *wstrip)
+{
+	char	strip [U_WAKEONLAN_DEF_U8_SIZE];
+
+	if (UTF8_from_U16 (strip, U_WAKEONLAN_DEF_U8_SIZE, wstrip, USE_STRLEN, NULL) <= U_WAKEONLAN_DEF_U8_SIZE)
+	{
+		struct sockaddr_storage	ss;
+		int						len;
+		return parseWOLpeerU8 (&ss, &len, strip, false);
+	}
+	return false;
+}
 
-	If bForceIPv4 is true, we send an IPv4 packet. Otherwise an IPv4 address
-	is converted to IPv6 first.
+/*
+	Returns the interface index of the scope id szScope, which is either a number or the
+	name of an interface, or 0 if there's no such interface.
 */
-bool sendWOLmagicPacket (const char *ccPeerIP, const char *szMagicPacket, bool bForceIPv6)
+static ULONG scopeIdFromU8 (const char *szScope)
 {
-	SOCKET	sUDP;
-	int		iso;
-	bool	bRet		= false;
-	int		iErr		= 0;
-	int		ipo;
+	uint64_t	uiIdx	= 0;
+	const char	*sz		= szScope;
+	WCHAR		wcAlias [IF_MAX_STRING_SIZE + 1];
+	NET_LUID	luid;
+	NET_IFINDEX	idx;
 
-	if (!bForceIPv6 && isGoodIPv4string (ccPeerIP))
-	{
-		/*
-			See
-			https://learn.microsoft.com/en-us/windows/win32/api/winsock2/nf-winsock2-socket .
-		*/
-		sUDP = socket (AF_INET, SOCK_DGRAM, IPPROTO_UDP);
-		if (INVALID_SOCKET == sUDP)
-			return bRet;
+	while (*sz >= '0' && *sz <= '9' && uiIdx <= 0xFFFFFFFF)
+		uiIdx = uiIdx * 10 + (uint64_t) (*sz ++ - '0');
+	if (sz != szScope && '\0' == *sz)
+		return uiIdx <= 0xFFFFFFFF ? (ULONG) uiIdx : 0;
+	// Friendly name ("Ethernet") first, then interface name ("ethernet_32769").
+	if	(
+				U16_from_UTF8 (wcAlias, IF_MAX_STRING_SIZE + 1, szScope, USE_STRLEN, NULL) <= IF_MAX_STRING_SIZE + 1
+			&&	NO_ERROR == ConvertInterfaceAliasToLuid (wcAlias, &luid)
+			&&	NO_ERROR == ConvertInterfaceLuidToIndex (&luid, &idx)
+		)
+		return idx;
+	return if_nametoindex (szScope);
+}
 
-		struct sockaddr_in si_peer;
-		si_peer.sin_family			= AF_INET;
-		si_peer.sin_addr.s_addr		= inet_addr (ccPeerIP);
-		si_peer.sin_port			= htons (U_WAKEONLAN_MAGIC_PACKET_PORT);
+bool parseWOLpeerU8 (struct sockaddr_storage *pss, int *plen, const char *szIP, bool bForceIPv6)
+{
+	struct sockaddr_in	*psi	= (struct sockaddr_in *) pss;
+	struct sockaddr_in6	*psi6	= (struct sockaddr_in6 *) pss;
+	char				szAddr [INET6_ADDRSTRLEN];
+	const char			*szScope;
+	size_t				len;
 
-		/*
-			See
-			https://learn.microsoft.com/en-us/windows/win32/api/winsock/nf-winsock-setsockopt .
-		*/
-		BOOL so_broadcast	= true;
-		iso = setsockopt (sUDP, SOL_SOCKET, SO_BROADCAST, (char *) &so_broadcast, sizeof (BOOL));
-		if (0 != iso)
-			return bRet;
+	memset (pss, 0, sizeof (struct sockaddr_storage));
+	for (szScope = szIP; *szScope && '%' != *szScope; ++ szScope)
+		;
+	len = (size_t) (szScope - szIP);
+	if (len >= INET6_ADDRSTRLEN)
+		return false;
+	memcpy (szAddr, szIP, len);
+	szAddr [len] = '\0';
 
-		/*
-			Must be sendto () instead of send (). See
-			https://stackoverflow.com/questions/66554581/difference-between-send-and-sendto-in-c-for-a-udp-network-implementation .
-		*/
-		iErr = sendto (sUDP, szMagicPacket, U_WAKEONLAN_MAGIC_PACKET_LEN, 0, (struct sockaddr*) &si_peer, sizeof (si_peer));
+	if (1 == inet_pton (AF_INET, szAddr, &psi->sin_addr))
+	{
+		if (*szScope)
+			return false;
+		if (!bForceIPv6)
+		{
+			psi->sin_family	= AF_INET;
+			psi->sin_port	= htons (U_WAKEONLAN_MAGIC_PACKET_PORT);
+			*plen			= sizeof (struct sockaddr_in);
+			return true;
+		}
+		// The IPv4-mapped IPv6 address ::FFFF:a.b.c.d, built from the octets.
+		struct in_addr a4 = psi->sin_addr;
+		memset (pss, 0, sizeof (struct sockaddr_storage));
+		psi6->sin6_addr.s6_addr [10]	= 0xFF;
+		psi6->sin6_addr.s6_addr [11]	= 0xFF;
+		memcpy (&psi6->sin6_addr.s6_addr [12], &a4, 4);
 	} else
-	if (isGoodIPv4string (ccPeerIP) || isGoodIPv6string (ccPeerIP))
+	if (1 != inet_pton (AF_INET6, szAddr, &psi6->sin6_addr))
+		return false;
+	if (*szScope)
 	{
-		sUDP = socket (AF_INET6, SOCK_DGRAM, IPPROTO_UDP);
-		if (INVALID_SOCKET == sUDP)
-			return bRet;
+		psi6->sin6_scope_id = scopeIdFromU8 (szScope + 1);
+		if (0 == psi6->sin6_scope_id)
+			return false;
+	}
+	psi6->sin6_family	= AF_INET6;
+	psi6->sin6_port		= htons (U_WAKEONLAN_MAGIC_PACKET_PORT);
+	*plen				= sizeof (struct sockaddr_in6);
+	return true;
+}
 
-		/*
-			See
-			https://learn.microsoft.com/en-us/windows/win32/api/winsock/nf-winsock-setsockopt .
-		*/
-		BOOL so_broadcast	= true;
-		iso = setsockopt (sUDP, SOL_SOCKET, SO_BROADCAST, (char *) &so_broadcast, sizeof (BOOL));
-		if (0 != iso)
-			return bRet;
-		DWORD so_v6only = 0;
-		iso = setsockopt (sUDP, IPPROTO_IPV6, IPV6_V6ONLY, (char *) &so_v6only, sizeof (DWORD));
-		if (0 != iso)
-			return bRet;
-
-		char		szIP4asIP6 [U_WAKEONLAN_IPV6_SIZ]	= U_WAKEONLAN_IPV6V4_PFX;
-		const char	*szIP								= szIP4asIP6;
-		if (isGoodIPv4string (ccPeerIP))
-			memcpy (szIP4asIP6 + U_WAKEONLAN_IPV6V4_PFX_LEN, ccPeerIP, strlenU (ccPeerIP) + 1);
-		else
-			szIP = ccPeerIP;
+/*
+	Returns a UDP socket for the address family iFamily, or INVALID_SOCKET. The socket can
+	send broadcasts, and an IPv6 socket also accepts IPv4-mapped addresses.
+*/
+static SOCKET createWOLsocket (int iFamily)
+{
+	SOCKET	s		= socket (iFamily, SOCK_DGRAM, IPPROTO_UDP);
+	BOOL	bBrc	= true;
+	DWORD	dwV6	= 0;
 
-		struct sockaddr_in6 si_peer;
-		memset (&si_peer, 0, sizeof (si_peer));
-		si_peer.sin6_family			= AF_INET6;
-		si_peer.sin6_port			= htons (U_WAKEONLAN_MAGIC_PACKET_PORT);
-		ipo = inet_pton (AF_INET6, szIP, &si_peer.sin6_addr);
+	if (INVALID_SOCKET == s)
+		return s;
+	if	(
+			0 != setsockopt (s, SOL_SOCKET, SO_BROADCAST, (char *) &bBrc, sizeof (BOOL))
+		||	(
+					AF_INET6 == iFamily
+				&&	0 != setsockopt (s, IPPROTO_IPV6, IPV6_V6ONLY, (char *) &dwV6, sizeof (DWORD))
+			)
+		)
+	{
+		closesocket (s);
+		return INVALID_SOCKET;
+	}
+	return s;
+}
 
-		/*
-			Must be sendto () instead of send (). See
-			https://stackoverflow.com/questions/66554581/difference-between-send-and-sendto-in-c-for-a-udp-network-implementation .
-		*/
-		iErr = sendto (sUDP, szMagicPacket, U_WAKEONLAN_MAGIC_PACKET_LEN, 0, (struct sockaddr*) &si_peer, sizeof (si_peer));
-	} else
+bool setWOLmulticastIf (SOCKET s, const struct sockaddr_storage *pss, ULONG *pulIf)
+{
+	const struct sockaddr_in6 *psi6 = (const struct sockaddr_in6 *) pss;
+
+	if	(
+				AF_INET6 != pss->ss_family || !IN6_IS_ADDR_MULTICAST (&psi6->sin6_addr)
+			||	0 == psi6->sin6_scope_id || *pulIf == psi6->sin6_scope_id
+		)
+		return true;
+	DWORD dwIf = psi6->sin6_scope_id;
+	if (0 != setsockopt (s, IPPROTO_IPV6, IPV6_MULTICAST_IF, (char *) &dwIf, sizeof (DWORD)))
 		return false;
+	*pulIf = psi6->sin6_scope_id;
+	return true;
+}
+
+/*
+	Sends the magic packet for ucMAC to the broadcast address of every local interface.
+*/
+static enum eWOLret wakeOnLANauto (const unsigned char ucMAC [6])
+{
+	SWOLLIST		wl;
+	enum eWOLret	ret;
+	char			szMAC [U_WAKEONLAN_MAC_SIZ];
 
-	bRet = U_WAKEONLAN_MAGIC_PACKET_LEN == iErr;
-	closesocket (sUDP);
-	return bRet;
+	strMACfromOctets (szMAC, ucMAC);
+	initWOLlist (&wl);
+	ret = addWOLlistTargetU8 (&wl, "auto", szMAC, false, 0, NULL);
+	if (wolretOk == ret)
+	{
+		sendWOLlist (&wl);
+		ret = wl.nSent ? wolretOk : wolretErrSend;
+	}
+	doneWOLlist (&wl);
+	return ret;
+}
+
+bool initWOLtarget	(
+		SWOLTARGET *pt, const unsigned char ucMAC [6], const struct sockaddr *pPeer,
+		int lenPeer
+					)
+{
+	memset (pt, 0, sizeof (SWOLTARGET));
+	memcpy (pt->ucMAC, ucMAC, 6);
+	initWOLmagicPacket (pt->cMagicPacket, ucMAC);
+	if	(
+				lenPeer <= 0 || lenPeer > (int) sizeof (pt->ssPeer)
+			||	(AF_INET != pPeer->sa_family && AF_INET6 != pPeer->sa_family)
+		)
+	{
+		pt->ret = wolretSyntaxHst;
+		return false;
+	}
+	memcpy (&pt->ssPeer, pPeer, (size_t) lenPeer);
+	pt->lenPeer	= lenPeer;
+	pt->ret		= wolretOk;
+	return true;
 }
 
 enum eWOLret wakeOnLAN_W (const wchar_t *wzHost, const wchar_t *wzMAC, bool bForceIPv6, char **szErr)
 {
-	char			szMACu8	[U_WAKEONLAN_MAC_SIZ];
-	char			szHstu8	[U_WAKEONLAN_DEF_U8_SIZE];
-	unsigned char	ucMAC	[6];
+	char					szHstu8	[U_WAKEONLAN_DEF_U8_SIZE];
+	unsigned char			ucMAC [6];
+	struct sockaddr_storage	ss;
+	int						len;
+	SWOLTARGET				wt;
+
+	// The parser reads UTF-16 directly and reports no error position.
+	if (szErr)
+		*szErr = NULL;
+	if (!parseWOLmacW (ucMAC, wzMAC, strlenW (wzMAC)))
+		return wolretSyntaxMAC;
+	if (4 == strlenW (wzHost) && 0 == stricmpW (wzHost, L"auto", 4))
+		return wakeOnLANauto (ucMAC);
 
-	int iRequ = reqUTF8size (wzHost);
-	if (iRequ < U_WAKEONLAN_MIN_IP_LEN)
+	size_t nRequ = UTF8_from_U16 (szHstu8, U_WAKEONLAN_DEF_U8_SIZE, wzHost, USE_STRLEN, NULL);
+	if (nRequ < U_WAKEONLAN_MIN_IP_LEN || nRequ >= U_WAKEONLAN_DEF_U8_SIZE)
 		return wolretSyntaxHst;
-	if (iRequ < U_WAKEONLAN_DEF_U8_SIZE)
+	if (!parseWOLpeerU8 (&ss, &len, szHstu8, bForceIPv6))
 	{
-		UTF8_from_WinU16 (szHstu8, U_WAKEONLAN_DEF_U8_SIZE, wzHost);
+		SWOLRESOLVED res;
+		if (!isWOLhostNameU8 (szHstu8))
+			return wolretSyntaxHst;
+		if (!resolveWOLnameU8 (&res, szHstu8, NULL))
+			return wolretUnresolved;
+		peerWOLresolved (&ss, &len, &res, bForceIPv6);
+	}
+	// From here on it's the binary API. Nothing on the way to sendto () looks at text.
+	initWOLtarget (&wt, ucMAC, (struct sockaddr *) &ss, len);
+	return sendWOLtarget (&wt) ? wolretOk : wolretErrSend;
+}
 
-		// A MAC address has exactly 17 characters (18 when NUL is included).
-		size_t lenMAC = strlenW (wzMAC);
-		if (U_WAKEONLAN_MAC_LEN != lenMAC)
-			return wolretSyntaxMAC;
-		UTF8_from_WinU16l (szMACu8, U_WAKEONLAN_MAC_SIZ, wzMAC, U_WAKEONLAN_MAC_SIZ);
-		int s = 0;
-		int n;
-		for (n = 0; n < 6; ++ n)
+bool makeUnifiedMACaddress (wchar_t *wzOut, const wchar_t *wzMAC)
+{
+	static const wchar_t	wcHex []	= L"0123456789ABCDEF";
+	unsigned char			ucMAC [6];
+	int						n;
+
+	if (!parseWOLmacW (ucMAC, wzMAC, strlenW (wzMAC)))
+		return false;
+	for (n = 0; n < 6; ++ n)
+	{
+		wzOut [3 * n]		= wcHex [ucMAC [n] >> 4];
+		wzOut [3 * n + 1]	= wcHex [ucMAC [n] & 0x0F];
+		wzOut [3 * n + 2]	= 5 == n ? L'\0' : L'-';
+	}
+	return true;
+}
+
+void initWOLpolicy (SWOLPOLICY *pp)
+{
+	memset (pp, 0, sizeof (SWOLPOLICY));
+	pp->uiPorts [0]		= U_WAKEONLAN_MAGIC_PACKET_PORT;
+	pp->nPorts			= 1;
+	pp->uiCopies		= 1;
+	pp->uiBackoffMs		= U_WAKEONLAN_POLICY_BACKOFF_MS;
+	pp->uiBackoffMaxMs	= U_WAKEONLAN_POLICY_BACKOFF_MAX_MS;
+}
+
+bool parseWOLpolicyPortsW (SWOLPOLICY *pp, const wchar_t *wzPorts)
+{
+	uint16_t		uiPorts [U_WAKEONLAN_POLICY_MAX_PORTS];
+	size_t			nPorts	= 0;
+	const wchar_t	*wc		= wzPorts;
+
+	for (;;)
+	{
+		uint64_t uiPort = 0;
+		if (*wc < L'0' || *wc > L'9' || U_WAKEONLAN_POLICY_MAX_PORTS == nPorts)
+			return false;
+		while (*wc >= L'0' && *wc <= L'9')
 		{
-			size_t l = ubf_octet_from_hex (ucMAC + n, szMACu8 + s);
-			if (2 != l)
+			uiPort = uiPort * 10 + (uint64_t) (*wc ++ - L'0');
+			if (uiPort > 0xFFFF)
+				return false;
+		}
+		if (0 == uiPort)
+			return false;
+		uiPorts [nPorts ++] = (uint16_t) uiPort;
+		if (L'\0' == *wc)
+			break;
+		if (L',' != *wc ++)
+			return false;
+	}
+	memcpy (pp->uiPorts, uiPorts, nPorts * sizeof (uint16_t));
+	pp->nPorts = nPorts;
+	return true;
+}
+
+bool isDefaultWOLpolicy (const SWOLPOLICY *pp)
+{
+	return	(
+					1 == pp->nPorts && U_WAKEONLAN_MAGIC_PACKET_PORT == pp->uiPorts [0]
+				&&	1 == pp->uiCopies && 0 == pp->uiRetries
+			);
+}
+
+uint64_t backoffWOLpolicyMs (const SWOLPOLICY *pp, uint32_t uiRound)
+{
+	uint64_t uiMs = pp->uiBackoffMs;
+
+	while (-- uiRound && uiMs < pp->uiBackoffMaxMs)
+		uiMs *= 2;
+	return uiMs < pp->uiBackoffMaxMs ? uiMs : pp->uiBackoffMaxMs;
+}
+
+void initWOLlist (SWOLLIST *pl)
+{
+	memset (pl, 0, sizeof (SWOLLIST));
+	initWOLpolicy (&pl->policy);
+}
+
+/*
+	Makes sure the list has space for at least one more target.
+*/
+static bool growWOLlist (SWOLLIST *pl)
+{
+	if (pl->nTargets < pl->nAlloc)
+		return true;
+
+	size_t		nNew	= pl->nAlloc ? 2 * pl->nAlloc : U_WAKEONLAN_LIST_INITIAL;
+	SWOLTARGET	*pt;
+	if (pl->pTargets)
+		pt = HeapReAlloc (GetProcessHeap (), 0, pl->pTargets, nNew * sizeof (SWOLTARGET));
+	else
+		pt = HeapAlloc (GetProcessHeap (), 0, nNew * sizeof (SWOLTARGET));
+	if (NULL == pt)
+		return false;
+	pl->pTargets	= pt;
+	pl->nAlloc		= nNew;
+	return true;
+}
+
+#define U_WOL_NO_TARGET	((size_t) -1)
+
+/*
+	Makes sure the list has space for at least one more group.
+*/
+static bool growWOLlistGroups (SWOLLIST *pl)
+{
+	if (pl->nGroups < pl->nGroupAlloc)
+		return true;
+
+	size_t		nNew	= pl->nGroupAlloc ? 2 * pl->nGroupAlloc : 16;
+	SWOLGROUP	*pg;
+	if (pl->pGroups)
+		pg = HeapReAlloc (GetProcessHeap (), 0, pl->pGroups, nNew * sizeof (SWOLGROUP));
+	else
+		pg = HeapAlloc (GetProcessHeap (), 0, nNew * sizeof (SWOLGROUP));
+	if (NULL == pg)
+		return false;
+	pl->pGroups		= pg;
+	pl->nGroupAlloc	= nNew;
+	return true;
+}
+
+/*
+	Returns the index of the group szGroup, which is added to the list if it doesn't exist
+	yet, or U_WOL_NO_TARGET if the list couldn't be extended. Lists have only a few groups,
+	hence a linear search is sufficient.
+*/
+static size_t indexWOLlistGroupU8 (SWOLLIST *pl, const char *szGroup)
+{
+	char	szName [U_WAKEONLAN_GROUP_SIZ];
+	size_t	len		= strlenU (szGroup);
+	size_t	n;
+
+	if (len >= U_WAKEONLAN_GROUP_SIZ)
+		len = U_WAKEONLAN_GROUP_SIZ - 1;
+	memcpy (szName, szGroup, len);
+	szName [len] = '\0';
+	for (n = 0; n < pl->nGroups; ++ n)
+	{
+		if (0 == memcmp (pl->pGroups [n].szName, szName, len + 1))
+			return n;
+	}
+	if (!growWOLlistGroups (pl))
+		return U_WOL_NO_TARGET;
+	SWOLGROUP *pg = pl->pGroups + pl->nGroups;
+	memset (pg, 0, sizeof (SWOLGROUP));
+	memcpy (pg->szName, szName, len + 1);
+	return pl->nGroups ++;
+}
+
+/*
+	Returns true if szHost is "auto", in any case.
+*/
+static bool isWOLautoHostU8 (const char *szHost)
+{
+	return		4 == strlenU (szHost)
+			&&	'a' == (szHost [0] | 0x20) && 'u' == (szHost [1] | 0x20)
+			&&	't' == (szHost [2] | 0x20) && 'o' == (szHost [3] | 0x20);
+}
+
+/*
+	Turns the target at the end of the list, which has not been counted yet, into one
+	target per local interface.
+*/
+static enum eWOLret addWOLlistAutoTargets (SWOLLIST *pl)
+{
+	size_t			nIfaces;
+	const SWOLIFACE	*pi		= getWOLifaces (&nIfaces);
+	SWOLTARGET		*pt		= pl->pTargets + pl->nTargets;
+	size_t			n;
+
+	if (0 == nIfaces)
+	{
+		releaseWOLifaces ();
+		pt->ret = wolretNoIface;
+		++ pl->nFailed;
+		++ pl->nTargets;
+		return pt->ret;
+	}
+	for (n = 0; n < nIfaces; ++ n)
+	{
+		if (n)
+		{
+			if (!growWOLlist (pl))
 			{
-				*szErr = szMACu8 + s;
-				return wolretSyntaxMAC;
+				releaseWOLifaces ();
+				return wolretErrMemory;
 			}
-			s += 3;
+			pt = pl->pTargets + pl->nTargets;
+			memcpy (pt, pt - 1, sizeof (SWOLTARGET));
+			++ pl->pGroups [pt->uiGroup].nTargets;
 		}
+		struct sockaddr_in *psi = (struct sockaddr_in *) &pt->ssPeer;
+		memset (&pt->ssPeer, 0, sizeof (pt->ssPeer));
+		psi->sin_family		= AF_INET;
+		psi->sin_addr		= pi [n].inBroadcast;
+		psi->sin_port		= htons (U_WAKEONLAN_MAGIC_PACKET_PORT);
+		pt->lenPeer			= sizeof (struct sockaddr_in);
+		pt->uiIfIndex		= pi [n].uiIfIndex;
+		pt->inLocal			= pi [n].inLocal;
+		inet_ntop (AF_INET, &pi [n].inBroadcast, pt->szHost, sizeof (pt->szHost));
+		++ pl->nTargets;
+	}
+	releaseWOLifaces ();
+	return wolretOk;
+}
 
-		/*
-			Magic packet. See https://en.wikipedia.org/wiki/Wake-on-LAN#Magic_packet .
+/*
+	Appends a new target with the host szHost, which is only kept for output and name
+	resolution, to the group szGroup of the list, and returns it. The target is not
+	counted yet. The function returns NULL if the list couldn't be extended.
+*/
+static SWOLTARGET *newWOLlistTarget	(
+						SWOLLIST *pl, const char *szHost, uint64_t nLine,
+						const char *szGroup
+									)
+{
+	if (!growWOLlist (pl))
+		return NULL;
+	size_t uiGroup = indexWOLlistGroupU8 (pl, szGroup ? szGroup : "");
+	if (U_WOL_NO_TARGET == uiGroup)
+		return NULL;
 
-			  6 =  1 * 6 for FF FF FF FF FF FF
-			 96 = 16 * 6 for MAC address
-			---
-			102
-		*/
-		unsigned char ucWOLmagicPacket [U_WAKEONLAN_MAGIC_PACKET_LEN];
-		initWOLmagicPacket (ucWOLmagicPacket, ucMAC);
-		bool bSent = sendWOLmagicPacket (szHstu8, ucWOLmagicPacket, bForceIPv6);
-		if (bSent)
-			return wolretOk;
-		return wolretErrSend;
+	SWOLTARGET	*pt		= pl->pTargets + pl->nTargets;
+	size_t		lenHst	= strlenU (szHost);
+
+	memset (pt, 0, sizeof (SWOLTARGET));
+	pt->nLine	= nLine;
+	pt->uiGroup	= uiGroup;
+	++ pl->pGroups [uiGroup].nTargets;
+	// Truncate the host if it's too long. A host name can't be that long.
+	if (lenHst >= U_WAKEONLAN_HOST_SIZ)
+		lenHst = U_WAKEONLAN_HOST_SIZ - 1;
+	memcpy (pt->szHost, szHost, lenHst);
+	pt->szHost [lenHst] = '\0';
+	return pt;
+}
+
+enum eWOLret addWOLlistTargetU8	(
+				SWOLLIST *pl, const char *szHost, const char *szMAC, bool bForceIPv6,
+				uint64_t nLine, const char *szGroup
+								)
+{
+	SWOLTARGET *pt = newWOLlistTarget (pl, szHost, nLine, szGroup);
+	if (NULL == pt)
+		return wolretErrMemory;
+
+	bool bAuto = isWOLautoHostU8 (szHost);
+	bool bName = !bAuto && !parseWOLpeerU8 (&pt->ssPeer, &pt->lenPeer, szHost, bForceIPv6);
+	if (bName && !isWOLhostNameU8 (szHost))
+		pt->ret = wolretSyntaxHst;
+	else
+	if (!parseWOLmacU8 (pt->ucMAC, szMAC, strlenU (szMAC)))
+		pt->ret = wolretSyntaxMAC;
+	else
+	{
+		initWOLmagicPacket (pt->cMagicPacket, pt->ucMAC);
+		pt->ret = bName ? wolretUnresolved : wolretOk;
 	}
-	return wolretSyntaxHst;
+	if (bAuto && wolretOk == pt->ret)
+		return addWOLlistAutoTargets (pl);
+	if (wolretUnresolved == pt->ret)
+	{
+		// Resolved later, together with the names of all other targets.
+		pt->bForceIPv6 = bForceIPv6;
+		++ pl->nUnresolved;
+	} else
+	if (wolretOk != pt->ret)
+		++ pl->nFailed;
+	++ pl->nTargets;
+	return pt->ret;
 }
 
-bool makeUnifiedMACaddress (wchar_t *wzOut, const wchar_t *wzMAC)
+enum eWOLret addWOLlistTargetPeer	(
+				SWOLLIST *pl, const struct sockaddr *pPeer, int lenPeer,
+				const unsigned char ucMAC [6], const char *szHost, uint64_t nLine,
+				const char *szGroup
+									)
+{
+	SWOLTARGET *pt = newWOLlistTarget (pl, szHost, nLine, szGroup);
+	if (NULL == pt)
+		return wolretErrMemory;
+
+	memcpy (pt->ucMAC, ucMAC, 6);
+	initWOLmagicPacket (pt->cMagicPacket, pt->ucMAC);
+	pt->ret = wolretOk;
+	if (NULL == pPeer)
+		return addWOLlistAutoTargets (pl);
+	if (lenPeer <= 0 || lenPeer > (int) sizeof (pt->ssPeer))
+	{
+		pt->ret = wolretSyntaxHst;
+		++ pl->nFailed;
+	} else
+	{
+		memcpy (&pt->ssPeer, pPeer, (size_t) lenPeer);
+		pt->lenPeer = lenPeer;
+	}
+	++ pl->nTargets;
+	return pt->ret;
+}
+
+bool setWOLtargetHostU8 (SWOLTARGET *pt, const char *szIP)
+{
+	struct sockaddr_in	*psi	= (struct sockaddr_in *) &pt->ssHost;
+	struct sockaddr_in6	*psi6	= (struct sockaddr_in6 *) &pt->ssHost;
+
+	memset (&pt->ssHost, 0, sizeof (pt->ssHost));
+	pt->lenHost = 0;
+	if (1 == inet_pton (AF_INET, szIP, &psi->sin_addr))
+	{
+		psi->sin_family	= AF_INET;
+		pt->lenHost		= sizeof (struct sockaddr_in);
+	} else
+	if (1 == inet_pton (AF_INET6, szIP, &psi6->sin6_addr))
+	{
+		psi6->sin6_family	= AF_INET6;
+		pt->lenHost			= sizeof (struct sockaddr_in6);
+	}
+	return 0 != pt->lenHost;
+}
+
+static bool isWOLlistSeparator (char c)
+{
+	return ' ' == c || '\t' == c || ',' == c || ';' == c;
+}
+
+char *nextWOLlistTokenU8 (char **sz)
 {
-	size_t lenMAC = strlenW (wzMAC);
-	if (U_WAKEONLAN_MAC_LEN != lenMAC)
+	char *p = *sz;
+
+	while (isWOLlistSeparator (*p))
+		++ p;
+	if ('\0' == *p)
+		return NULL;
+	char *t = p;
+	while (*p && !isWOLlistSeparator (*p))
+		++ p;
+	if (*p)
+		*p ++ = '\0';
+	*sz = p;
+	return t;
+}
+
+bool readWOLlistW (SWOLLIST *pl, const wchar_t *wzFile, bool bForceIPv6)
+{
+	SLINEREADER	lr;
+	char		*szLine;
+
+	if (!openLineReaderW (&lr, wzFile))
 		return false;
-	memcpy (wzOut, wzMAC, 2 * U_WAKEONLAN_MAC_SIZ);
-	int n = 2;
-	while (n < U_WAKEONLAN_MAC_LEN)
+	while ((szLine = nextLineU8 (&lr, NULL)))
 	{
-		wzOut [n] = L'-';
-		n += 3;
+		char *szHost = nextWOLlistTokenU8 (&szLine);
+		if (NULL == szHost || '#' == szHost [0] || ';' == szHost [0])
+			continue;
+		const SWOLINVRECORD *pr = NULL;
+		if (pl->pInventory)
+			pr = findWOLinventoryU8 (pl->pInventory, szHost, strlenU (szHost));
+		char *szMAC		= pr ? NULL : nextWOLlistTokenU8 (&szLine);
+		char *szGroup	= NULL;
+		char *szIP		= NULL;
+		bool bLineV6	= bForceIPv6;
+		char *szOpt;
+		while ((szOpt = nextWOLlistTokenU8 (&szLine)))
+		{
+			size_t lenOpt = strlenU (szOpt);
+			if	(
+						3 == lenOpt && '-' == szOpt [0]
+					&&	('f' == szOpt [1] || 'F' == szOpt [1]) && '6' == szOpt [2]
+				)
+				bLineV6 = true;
+			else
+			if (lenOpt > 6 && 0 == memcmp (szOpt, "group=", 6))
+				szGroup = szOpt + 6;
+			else
+			if (lenOpt > 3 && 0 == memcmp (szOpt, "ip=", 3))
+				szIP = szOpt + 3;
+		}
+		size_t			nFirst	= pl->nTargets;
+		enum eWOLret	ret;
+		if (pr)
+			ret = addWOLinventoryTarget (pl, pl->pInventory, pr, lr.nLine, szGroup);
+		else
+			ret = addWOLlistTargetU8	(
+						pl, szHost, szMAC ? szMAC : "", bLineV6, lr.nLine, szGroup
+										);
+		if (wolretErrMemory == ret)
+		{
+			closeLineReader (&lr);
+			return false;
+		}
+		// An "auto" line adds several targets, which all wake the same host.
+		while (szIP && nFirst < pl->nTargets)
+			setWOLtargetHostU8 (pl->pTargets + nFirst ++, szIP);
 	}
+	closeLineReader (&lr);
+	if (pl->nUnresolved)
+		resolveWOLlist (pl);
 	return true;
 }
+
+static SWOLSOCK *getWOLsock (SWOLSOCK ws [2], int iFamily, bool bUSO)
+{
+	SWOLSOCK *pws = AF_INET == iFamily ? &ws [0] : &ws [1];
+
+	if (INVALID_SOCKET == pws->s && 0 == pws->iErr)
+	{
+		pws->s = createWOLsocket (iFamily);
+		if (INVALID_SOCKET == pws->s)
+		{
+			pws->iErr = WSAGetLastError ();
+			return pws;
+		}
+		/*
+			UDP segmentation offload. The stack splits a send buffer into datagrams of
+			this size. Windows versions without USO fail the call, in which case we
+			send every magic packet on its own.
+		*/
+		if (bUSO)
+		{
+			DWORD dwSegSize = U_WAKEONLAN_MAGIC_PACKET_LEN;
+			pws->bUSO = 0 == setsockopt	(
+									pws->s, IPPROTO_UDP, UDP_SEND_MSG_SIZE,
+									(char *) &dwSegSize, sizeof (DWORD)
+										);
+		}
+	}
+	return pws;
+}
+
+/*
+	Sends the magic packet of pt out of the interface pt->uiIfIndex with the source
+	address pt->inLocal. The interface and address travel as IP_PKTINFO control data,
+	hence this needs no additional system call.
+*/
+static int sendWOLtargetPktInfo (SOCKET s, SWOLTARGET *pt)
+{
+	WSAMSG		msg;
+	WSABUF		wb;
+	DWORD		dwSent	= 0;
+	WSACMSGHDR	*pc;
+	IN_PKTINFO	*ppi;
+	union
+	{
+		WSACMSGHDR	hdr;
+		char		c [WSA_CMSG_SPACE (sizeof (IN_PKTINFO))];
+	} ctl;
+
+	memset (&ctl, 0, sizeof (ctl));
+	wb.buf				= pt->cMagicPacket;
+	wb.len				= U_WAKEONLAN_MAGIC_PACKET_LEN;
+	msg.name			= (struct sockaddr *) &pt->ssPeer;
+	msg.namelen			= pt->lenPeer;
+	msg.lpBuffers		= &wb;
+	msg.dwBufferCount	= 1;
+	msg.Control.buf		= ctl.c;
+	msg.Control.len		= sizeof (ctl.c);
+	msg.dwFlags			= 0;
+	pc					= WSA_CMSG_FIRSTHDR (&msg);
+	pc->cmsg_level		= IPPROTO_IP;
+	pc->cmsg_type		= IP_PKTINFO;
+	pc->cmsg_len		= WSA_CMSG_LEN (sizeof (IN_PKTINFO));
+	ppi					= (IN_PKTINFO *) WSA_CMSG_DATA (pc);
+	ppi->ipi_addr		= pt->inLocal;
+	ppi->ipi_ifindex	= pt->uiIfIndex;
+	if (0 != WSASendMsg (s, &msg, 0, &dwSent, NULL, NULL))
+		return SOCKET_ERROR;
+	return (int) dwSent;
+}
+
+/*
+	Returns true if the current round sends to pt. A send error in an earlier round or
+	copy doesn't exclude a target, only a syntax error does.
+*/
+static bool isWOLtargetDue (const SWOLTARGET *pt)
+{
+	return (wolretOk == pt->ret || wolretErrSend == pt->ret) && !pt->bAwake;
+}
+
+/*
+	Sends the magic packet of pt over the socket pws points to and returns true if it went
+	out. The function sets the iWSAerr member of pt on failure, but leaves its ret member
+	alone.
+*/
+static bool sendWOLsockTarget (SWOLSOCK *pws, SWOLTARGET *pt)
+{
+	int iSent = SOCKET_ERROR;
+
+	if (INVALID_SOCKET != pws->s)
+	{
+		if (pt->uiIfIndex && AF_INET == pt->ssPeer.ss_family)
+			iSent = sendWOLtargetPktInfo (pws->s, pt);
+		else
+		if (setWOLmulticastIf (pws->s, &pt->ssPeer, &pws->ulMcastIf))
+			iSent = sendto	(
+						pws->s, pt->cMagicPacket, U_WAKEONLAN_MAGIC_PACKET_LEN, 0,
+						(struct sockaddr *) &pt->ssPeer, pt->lenPeer
+							);
+	}
+	if (U_WAKEONLAN_MAGIC_PACKET_LEN == iSent)
+	{
+		++ pt->nCopies;
+		return true;
+	}
+	pt->iWSAerr	= INVALID_SOCKET == pws->s ? pws->iErr : WSAGetLastError ();
+	return false;
+}
+
+static void sendWOLlistTarget (SWOLLIST *pl, SWOLTARGET *pt, SWOLSOCK *pws)
+{
+	if (INVALID_SOCKET != pws->s)
+		++ pl->nSendCalls;
+	// The round decides about pt->ret. See sendWOLlist ().
+	if (sendWOLsockTarget (pws, pt))
+		++ pl->nSent;
+	else
+		++ pl->nSendErrors;
+}
+
+void initWOLsender (SWOLSENDER *ps)
+{
+	ps->ws [0].s			= INVALID_SOCKET;
+	ps->ws [0].iErr			= 0;
+	ps->ws [0].bUSO			= false;
+	ps->ws [0].ulMcastIf	= 0;
+	ps->ws [1].s			= INVALID_SOCKET;
+	ps->ws [1].iErr			= 0;
+	ps->ws [1].bUSO			= false;
+	ps->ws [1].ulMcastIf	= 0;
+	ps->nSendCalls			= 0;
+}
+
+size_t sendWOLbatch (SWOLSENDER *ps, SWOLTARGET *pts, size_t n)
+{
+	size_t nSent = 0;
+	size_t i;
+
+	for (i = 0; i < n; ++ i)
+	{
+		SWOLTARGET *pt = pts + i;
+		if (!isWOLtargetDue (pt))
+			continue;
+		SWOLSOCK *pws = getWOLsock (ps->ws, pt->ssPeer.ss_family, false);
+		if (INVALID_SOCKET != pws->s)
+			++ ps->nSendCalls;
+		if (sendWOLsockTarget (pws, pt))
+		{
+			pt->ret = wolretOk;
+			++ nSent;
+		} else
+			pt->ret = wolretErrSend;
+	}
+	return nSent;
+}
+
+void doneWOLsender (SWOLSENDER *ps)
+{
+	if (INVALID_SOCKET != ps->ws [0].s)
+		closesocket (ps->ws [0].s);
+	if (INVALID_SOCKET != ps->ws [1].s)
+		closesocket (ps->ws [1].s);
+	initWOLsender (ps);
+}
+
+bool sendWOLtarget (SWOLTARGET *pt)
+{
+	SWOLSENDER	sd;
+	bool		bSent;
+
+	initWOLsender (&sd);
+	bSent = 1 == sendWOLbatch (&sd, pt, 1);
+	doneWOLsender (&sd);
+	return bSent;
+}
+
+static int cmpWOLpeers (const SWOLTARGET *pt1, const SWOLTARGET *pt2)
+{
+	if (pt1->lenPeer != pt2->lenPeer)
+		return pt1->lenPeer < pt2->lenPeer ? -1 : 1;
+	// The peer addresses are zero-padded. See parseWOLpeerU8 ().
+	return memcmp (&pt1->ssPeer, &pt2->ssPeer, pt1->lenPeer);
+}
+
+static void siftDownWOLtargets (SWOLTARGET **ppt, size_t root, size_t n)
+{
+	size_t child;
+
+	while ((child = 2 * root + 1) < n)
+	{
+		if (child + 1 < n && cmpWOLpeers (ppt [child], ppt [child + 1]) < 0)
+			++ child;
+		if (cmpWOLpeers (ppt [root], ppt [child]) >= 0)
+			return;
+		SWOLTARGET *pt	= ppt [root];
+		ppt [root]		= ppt [child];
+		ppt [child]		= pt;
+		root			= child;
+	}
+}
+
+/*
+	Heapsort. We have no qsort () without the runtime library, and heapsort doesn't require
+	any additional memory.
+*/
+static void sortWOLtargetsByPeer (SWOLTARGET **ppt, size_t n)
+{
+	size_t i;
+
+	if (n < 2)
+		return;
+	i = n / 2;
+	while (i --)
+		siftDownWOLtargets (ppt, i, n);
+	while (-- n)
+	{
+		SWOLTARGET *pt	= ppt [0];
+		ppt [0]			= ppt [n];
+		ppt [n]			= pt;
+		siftDownWOLtargets (ppt, 0, n);
+	}
+}
+
+/*
+	Sends the magic packets of n targets that all share the same peer address with a single
+	call. The stack cuts the buffer into datagrams of U_WAKEONLAN_MAGIC_PACKET_LEN octets.
+	Targets whose packets weren't sent by this call are sent one by one.
+*/
+static void sendWOLlistGroupUSO (SWOLLIST *pl, SWOLTARGET **ppt, size_t n, SWOLSOCK *pws)
+{
+	WSABUF	wb [U_WAKEONLAN_USO_MAX_SEGS];
+	DWORD	dwSent	= 0;
+	size_t	i;
+
+	for (i = 0; i < n; ++ i)
+	{
+		wb [i].len	= U_WAKEONLAN_MAGIC_PACKET_LEN;
+		wb [i].buf	= ppt [i]->cMagicPacket;
+	}
+	if (!setWOLmulticastIf (pws->s, &ppt [0]->ssPeer, &pws->ulMcastIf))
+	{
+		for (i = 0; i < n; ++ i)
+			sendWOLlistTarget (pl, ppt [i], pws);
+		return;
+	}
+	int iRet = WSASendTo	(
+					pws->s, wb, (DWORD) n, &dwSent, 0,
+					(struct sockaddr *) &ppt [0]->ssPeer, ppt [0]->lenPeer, NULL, NULL
+							);
+	++ pl->nSendCalls;
+	// The stack may have sent only the first datagrams.
+	size_t nDone = 0 == iRet ? dwSent / U_WAKEONLAN_MAGIC_PACKET_LEN : 0;
+	if (nDone > n)
+		nDone = n;
+	for (i = 0; i < nDone; ++ i)
+		++ ppt [i]->nCopies;
+	pl->nSent += nDone;
+	// Fall back to one datagram per target for the rest.
+	for (i = nDone; i < n; ++ i)
+		sendWOLlistTarget (pl, ppt [i], pws);
+}
+
+static void sendWOLlistUSO (SWOLLIST *pl, SWOLSOCK ws [2])
+{
+	SWOLTARGET	**ppt;
+	size_t		nGood	= 0;
+	size_t		n;
+
+	ppt = HeapAlloc (GetProcessHeap (), 0, (pl->nTargets + 1) * sizeof (SWOLTARGET *));
+	if (NULL == ppt)
+	{	// Not enough memory for grouping. Send the packets one by one.
+		for (n = 0; n < pl->nTargets; ++ n)
+		{
+			SWOLTARGET *pt = pl->pTargets + n;
+			if (isWOLtargetDue (pt))
+				sendWOLlistTarget (pl, pt, getWOLsock (ws, pt->ssPeer.ss_family, false));
+		}
+		return;
+	}
+	for (n = 0; n < pl->nTargets; ++ n)
+	{
+		if (isWOLtargetDue (pl->pTargets + n))
+			ppt [nGood ++] = pl->pTargets + n;
+	}
+	sortWOLtargetsByPeer (ppt, nGood);
+
+	n = 0;
+	while (n < nGood)
+	{
+		// Targets with the same peer address form a group.
+		size_t nGroup = 1;
+		while	(
+						n + nGroup < nGood
+					&&	nGroup < U_WAKEONLAN_USO_MAX_SEGS
+					&&	0 == cmpWOLpeers (ppt [n], ppt [n + nGroup])
+				)
+			++ nGroup;
+		SWOLSOCK *pws = getWOLsock (ws, ppt [n]->ssPeer.ss_family, true);
+		// Targets bound to an interface ("auto") need their own control data.
+		if (nGroup > 1 && pws->bUSO && 0 == ppt [n]->uiIfIndex)
+			sendWOLlistGroupUSO (pl, ppt + n, nGroup, pws);
+		else
+		{
+			size_t i;
+			for (i = 0; i < nGroup; ++ i)
+				sendWOLlistTarget (pl, ppt [n + i], pws);
+		}
+		n += nGroup;
+	}
+	HeapFree (GetProcessHeap (), 0, ppt);
+}
+
+static uint64_t threadCPUtime (void)
+{
+	FILETIME ftCreation, ftExit, ftKernel, ftUser;
+
+	if (GetThreadTimes (GetCurrentThread (), &ftCreation, &ftExit, &ftKernel, &ftUser))
+		return		(((uint64_t) ftKernel.dwHighDateTime << 32) | ftKernel.dwLowDateTime)
+				+	(((uint64_t) ftUser.dwHighDateTime << 32) | ftUser.dwLowDateTime);
+	return 0;
+}
+
+/*
+	Returns a waitable timer for pacing, or NULL. *pbHighRes tells whether the timer is a
+	high-resolution timer.
+*/
+static HANDLE createWOLpaceTimer (bool *pbHighRes)
+{
+	HANDLE h = CreateWaitableTimerExW	(
+					NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS
+										);
+	*pbHighRes = NULL != h;
+	if (NULL == h)
+		h = CreateWaitableTimerW (NULL, TRUE, NULL);
+	return h;
+}
+
+/*
+	Waits until the performance counter reaches uiDue, and returns the counter. The
+	function waits on the timer hTimer until uiSpin ticks before uiDue, and then spins.
+*/
+static uint64_t waitWOLpaceTick (HANDLE hTimer, uint64_t uiDue, uint64_t uiSpin, uint64_t uiFreq)
+{
+	LARGE_INTEGER	li;
+	uint64_t		uiNow;
+
+	QueryPerformanceCounter (&li);
+	uiNow = (uint64_t) li.QuadPart;
+	if (hTimer && uiNow + uiSpin < uiDue)
+	{
+		LARGE_INTEGER liDue;
+		// Negative due times are relative, in 100 ns units.
+		liDue.QuadPart = - (LONGLONG) ((uiDue - uiSpin - uiNow) * 10000000 / uiFreq);
+		if (SetWaitableTimer (hTimer, &liDue, 0, NULL, NULL, FALSE))
+			WaitForSingleObject (hTimer, INFINITE);
+	}
+	while (uiNow < uiDue)
+	{
+		YieldProcessor ();
+		QueryPerformanceCounter (&li);
+		uiNow = (uint64_t) li.QuadPart;
+	}
+	return uiNow;
+}
+
+/*
+	Returns when the next packet of a token bucket with the interval uiIv is due, after
+	a packet due at uiDue has been sent at uiNow. Packets stay evenly spaced on the
+	schedule. If the sender fell behind by more than an interval, the schedule restarts
+	from uiNow, which means the bucket never bursts to catch up.
+*/
+static uint64_t nextWOLpaceTick (uint64_t uiDue, uint64_t uiNow, uint64_t uiIv)
+{
+	return uiNow - uiDue > uiIv ? uiNow + uiIv : uiDue + uiIv;
+}
+
+/*
+	Sends the list paced. See sendWOLlist ().
+*/
+static void sendWOLlistPaced (SWOLLIST *pl, SWOLSOCK ws [2], uint64_t uiFreq)
+{
+	uint64_t		uiRateIv	= pl->uiRate ? uiFreq / pl->uiRate : 0;
+	uint64_t		uiGroupIv	= pl->uiGroupRate ? uiFreq / pl->uiGroupRate : 0;
+	uint64_t		uiFirst		= 0;
+	uint64_t		uiLast		= 0;
+	uint64_t		uiNext;
+	HANDLE			hTimer		= createWOLpaceTimer (&pl->bHighResTimer);
+	uint64_t		uiSpin		= pl->bHighResTimer
+									? U_WAKEONLAN_PACE_SPIN_US * uiFreq / 1000000
+									: U_WAKEONLAN_PACE_SPIN_US_LOWRES * uiFreq / 1000000;
+	LARGE_INTEGER	liNow;
+	size_t			n;
+
+	// Queue the targets of each group in list order.
+	for (n = 0; n < pl->nGroups; ++ n)
+	{
+		pl->pGroups [n].iHead = U_WOL_NO_TARGET;
+		pl->pGroups [n].iTail = U_WOL_NO_TARGET;
+	}
+	for (n = 0; n < pl->nTargets; ++ n)
+	{
+		SWOLTARGET	*pt	= pl->pTargets + n;
+		SWOLGROUP	*pg	= pl->pGroups + pt->uiGroup;
+		if (!isWOLtargetDue (pt))
+			continue;
+		pt->iNextInGroup = U_WOL_NO_TARGET;
+		if (U_WOL_NO_TARGET == pg->iTail)
+			pg->iHead = n;
+		else
+			pl->pTargets [pg->iTail].iNextInGroup = n;
+		pg->iTail = n;
+	}
+
+	QueryPerformanceCounter (&liNow);
+	uiNext = (uint64_t) liNow.QuadPart;
+	for (n = 0; n < pl->nGroups; ++ n)
+		pl->pGroups [n].uiNext = uiNext;
+	for (;;)
+	{
+		// The group whose next packet is due first.
+		SWOLGROUP *pg = NULL;
+		for (n = 0; n < pl->nGroups; ++ n)
+		{
+			SWOLGROUP *pgn = pl->pGroups + n;
+			if (U_WOL_NO_TARGET != pgn->iHead && (NULL == pg || pgn->uiNext < pg->uiNext))
+				pg = pgn;
+		}
+		if (NULL == pg)
+			break;
+
+		uint64_t	uiDue	= pg->uiNext > uiNext ? pg->uiNext : uiNext;
+		uint64_t	uiNow	= waitWOLpaceTick (hTimer, uiDue, uiSpin, uiFreq);
+		uint64_t	uiLate	= uiNow - uiDue;
+		SWOLTARGET	*pt		= pl->pTargets + pg->iHead;
+		size_t		nSent	= pl->nSent;
+
+		pg->iHead = pt->iNextInGroup;
+		sendWOLlistTarget (pl, pt, getWOLsock (ws, pt->ssPeer.ss_family, false));
+		if (nSent != pl->nSent)
+			++ pg->nSent;
+		pl->uiJitterTicks += uiLate;
+		if (uiLate > pl->uiJitterMax)
+			pl->uiJitterMax = uiLate;
+		if (0 == uiFirst)
+			uiFirst = uiNow;
+		uiLast = uiNow;
+		pg->uiNext	= nextWOLpaceTick (uiDue, uiNow, uiGroupIv);
+		uiNext		= nextWOLpaceTick (uiDue, uiNow, uiRateIv);
+	}
+	pl->uiPacedTicks += uiLast - uiFirst;
+	if (hTimer)
+		CloseHandle (hTimer);
+}
+
+/*
+	Sets the port of the peer address of every target the current round sends to.
+*/
+static void setWOLlistPort (SWOLLIST *pl, uint16_t uiPort)
+{
+	size_t n;
+
+	for (n = 0; n < pl->nTargets; ++ n)
+	{
+		SWOLTARGET *pt = pl->pTargets + n;
+		// sin_port and sin6_port are at the same offset.
+		if (isWOLtargetDue (pt))
+			((struct sockaddr_in *) &pt->ssPeer)->sin_port = htons (pt->uiPort ? pt->uiPort : uiPort);
+	}
+}
+
+/*
+	Sends a single copy of the magic packets to all targets of the current round.
+*/
+static void sendWOLlistPass (SWOLLIST *pl, SWOLSOCK ws [2], uint64_t uiFreq)
+{
+	size_t n;
+
+	if (pl->uiRate || pl->uiGroupRate)
+		sendWOLlistPaced (pl, ws, uiFreq);
+	else
+	if (pl->bUseUSO)
+		sendWOLlistUSO (pl, ws);
+	else
+	for (n = 0; n < pl->nTargets; ++ n)
+	{
+		SWOLTARGET *pt = pl->pTargets + n;
+		if (isWOLtargetDue (pt))
+			sendWOLlistTarget (pl, pt, getWOLsock (ws, pt->ssPeer.ss_family, false));
+	}
+}
+
+size_t sendWOLlist (SWOLLIST *pl)
+{
+	SWOLPOLICY		*pp			= &pl->policy;
+	SWOLSENDER		sd;
+	LARGE_INTEGER	liFreq, liStart, liEnd;
+	HANDLE			hTimer		= NULL;
+	bool			bHighRes;
+	uint64_t		uiCPU;
+	uint64_t		uiCopy		= 0;
+	uint32_t		c;
+	size_t			n, p;
+
+	if (pl->nUnresolved)
+		resolveWOLlist (pl);
+	initWOLsender (&sd);
+	uiCPU = threadCPUtime ();
+	QueryPerformanceFrequency (&liFreq);
+	if (pp->uiCopies > 1 && pp->uiSpacingMs)
+		hTimer = createWOLpaceTimer (&bHighRes);
+	// Every copy is a full pass over the list, which interleaves the copies of all targets.
+	for (c = 0; c < pp->uiCopies; ++ c)
+	{
+		if (c && pp->uiSpacingMs)
+		{
+			uint64_t uiFreq = (uint64_t) liFreq.QuadPart;
+			waitWOLpaceTick	(
+				hTimer, uiCopy + pp->uiSpacingMs * uiFreq / 1000,
+				U_WAKEONLAN_PACE_SPIN_US_LOWRES * uiFreq / 1000000, uiFreq
+							);
+		}
+		for (p = 0; p < pp->nPorts; ++ p)
+		{
+			setWOLlistPort (pl, pp->uiPorts [p]);
+			QueryPerformanceCounter (&liStart);
+			if (0 == p)
+				uiCopy = (uint64_t) liStart.QuadPart;
+			sendWOLlistPass (pl, sd.ws, (uint64_t) liFreq.QuadPart);
+			QueryPerformanceCounter (&liEnd);
+			pl->uiSendTicks += (uint64_t) (liEnd.QuadPart - liStart.QuadPart);
+		}
+	}
+	// A target failed only if not a single copy of any round went out.
+	pl->nFailed = 0;
+	for (n = 0; n < pl->nTargets; ++ n)
+	{
+		SWOLTARGET *pt = pl->pTargets + n;
+		if (isWOLtargetDue (pt))
+			pt->ret = pt->nCopies ? wolretOk : wolretErrSend;
+		if (wolretOk != pt->ret)
+			++ pl->nFailed;
+	}
+	++ pl->nRounds;
+	pl->uiTicksPerSec	= (uint64_t) liFreq.QuadPart;
+	pl->uiCPUtime		+= threadCPUtime () - uiCPU;
+	pl->bUSOavailable	= pl->bUSOavailable || sd.ws [0].bUSO || sd.ws [1].bUSO;
+
+	if (hTimer)
+		CloseHandle (hTimer);
+	doneWOLsender (&sd);
+	return pl->nSent;
+}
+
+void retryWOLlist (SWOLLIST *pl)
+{
+	while (pl->nRounds && pl->nRounds <= pl->policy.uiRetries)
+	{
+		Sleep ((DWORD) backoffWOLpolicyMs (&pl->policy, pl->nRounds));
+		sendWOLlist (pl);
+	}
+}
+
+void doneWOLlist (SWOLLIST *pl)
+{
+	if (pl->pTargets)
+		HeapFree (GetProcessHeap (), 0, pl->pTargets);
+	if (pl->pGroups)
+		HeapFree (GetProcessHeap (), 0, pl->pGroups);
+	memset (pl, 0, sizeof (SWOLLIST));
+}
+
+void strMACfromOctets (char *szOut, const unsigned char ucMAC [6])
+{
+	static const char	cHex []	= "0123456789ABCDEF";
+	int					n;
+
+	for (n = 0; n < 6; ++ n)
+	{
+		*szOut ++ = cHex [ucMAC [n] >> 4];
+		*szOut ++ = cHex [ucMAC [n] & 0x0F];
+		*szOut ++ = n < 5 ? '-' : '\0';
+	}
+}
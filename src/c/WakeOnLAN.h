@@ -11,6 +11,19 @@ History
 When		Who				What
 -----------------------------------------------------------------------------------------
 2025-05-17	Thomas			Created.
+2026-10-17	Thomas			Lists of targets sent over one socket per address family.
+2026-10-17	Thomas			UDP segmentation offload (USO) for lists.
+2026-10-17	Thomas			Function findWOLmagicPacket () added.
+2026-10-17	Thomas			Paced sending of lists with groups.
+2026-10-17	Thomas			Broadcast target "auto".
+2026-10-17	Thomas			Host addresses of targets for verification.
+2026-10-17	Thomas			Functions parseWOLpeerU8 () and sendWOLtarget () added.
+2026-10-17	Thomas			Send policy with ports, copies, and retry rounds.
+2026-10-17	Thomas			MAC addresses in all common notations. See WakeOnLANMAC.h.
+2026-10-17	Thomas			Inventory names in lists. See WakeOnLANInventory.h.
+2026-10-17	Thomas			Binary API: initWOLtarget () and senders. See SWOLSENDER.
+2026-10-17	Thomas			Function callWSAStartup () is thread-safe.
+2026-10-17	Thomas			Host names as targets. See WakeOnLANResolve.h.
 
 ****************************************************************************************/
 
@@ -44,6 +57,16 @@ When		Who				What
 #ifndef U_WAKEONLAN_H
 #define U_WAKEONLAN_H
 
+/*
+	This header needs the Winsock 2 definitions. Since Windows.h pulls in the old Winsock
+	header, this header must be included before Windows.h.
+*/
+#ifndef _WINSOCK_DEPRECATED_NO_WARNINGS
+#define _WINSOCK_DEPRECATED_NO_WARNINGS
+#endif
+#include <Winsock2.h>
+#include <ws2tcpip.h>
+
 #include <stdbool.h>
 #include <inttypes.h>
 #include "./externC.h"
@@ -88,6 +111,12 @@ When		Who				What
 #define U_WAKEONLAN_IPV6_LEN			(8 * 4 + 7)
 #define U_WAKEONLAN_IPV6_SIZ			(U_WAKEONLAN_IPV6_LEN + 1)
 
+/*
+	Max length and size of a DNS host name. See RFC 1035.
+*/
+#define U_WAKEONLAN_HOST_LEN			(253)
+#define U_WAKEONLAN_HOST_SIZ			(U_WAKEONLAN_HOST_LEN + 1)
+
 /*
 */
 #define U_WAKEONLAN_IPV6V4_PFX			"::FFFF:"
@@ -117,11 +146,72 @@ When		Who				What
 #define	U_WAKEONLAN_DEF_U8_SIZE			(4096)
 #endif
 
+/*
+	Limits of the send policy. See SWOLPOLICY. The ports of a policy are usually a subset
+	of 0, 7, and 9 (see above).
+*/
+#ifndef U_WAKEONLAN_POLICY_MAX_PORTS
+#define U_WAKEONLAN_POLICY_MAX_PORTS	(4)
+#endif
+#ifndef U_WAKEONLAN_POLICY_MAX_COPIES
+#define U_WAKEONLAN_POLICY_MAX_COPIES	(16)
+#endif
+#ifndef U_WAKEONLAN_POLICY_MAX_ROUNDS
+#define U_WAKEONLAN_POLICY_MAX_ROUNDS	(16)
+#endif
+#ifndef U_WAKEONLAN_POLICY_BACKOFF_MS
+#define U_WAKEONLAN_POLICY_BACKOFF_MS	(1000)
+#endif
+#ifndef U_WAKEONLAN_POLICY_BACKOFF_MAX_MS
+#define U_WAKEONLAN_POLICY_BACKOFF_MAX_MS	(30000)
+#endif
+
+/*
+	The amount of targets a WOL list reserves space for initially. The list grows
+	as required.
+*/
+#ifndef U_WAKEONLAN_LIST_INITIAL
+#define U_WAKEONLAN_LIST_INITIAL		(256)
+#endif
+
+/*
+	The maximum amount of magic packets sent with a single call when UDP segmentation
+	offload (USO) is used. 64 * 102 octets stay well below the maximum size of a UDP
+	datagram.
+*/
+#ifndef U_WAKEONLAN_USO_MAX_SEGS
+#define U_WAKEONLAN_USO_MAX_SEGS		(64)
+#endif
+
+/*
+	The maximum length of a group name in a WOL list, including the NUL terminator. Longer
+	names are truncated.
+*/
+#ifndef U_WAKEONLAN_GROUP_SIZ
+#define U_WAKEONLAN_GROUP_SIZ			(32)
+#endif
+
+/*
+	When paced, the sender waits on a waitable timer until this many microseconds before
+	a packet is due, and spins for the remainder. A high-resolution timer is used where
+	available (Windows 10 1803 and later), otherwise the remainder is longer.
+*/
+#ifndef U_WAKEONLAN_PACE_SPIN_US
+#define U_WAKEONLAN_PACE_SPIN_US		(250)
+#endif
+#ifndef U_WAKEONLAN_PACE_SPIN_US_LOWRES
+#define U_WAKEONLAN_PACE_SPIN_US_LOWRES	(2000)
+#endif
+
 EXTERN_C_BEGIN
 
 /*
-	See
+	callWSAStartup
+
+	Calls WSAStartup () once per process and returns true if it succeeded. See
 	https://learn.microsoft.com/en-us/windows/win32/api/winsock/nf-winsock-wsastartup .
+	Any thread can call the function any time. Concurrent callers wait for the first one.
+	After CallWSACleanup () the function returns false.
 */
 bool callWSAStartup (void)
 ;
@@ -129,6 +219,8 @@ bool callWSAStartup (void)
 /*
 	CallWSACleanup
 
+	Calls WSACleanup () once if callWSAStartup () succeeded. Call it when no other thread
+	uses sockets anymore, usually right before the process exits.
 */
 void CallWSACleanup (void)
 ;
@@ -141,18 +233,87 @@ bool isGoodIPv4stringW (const wchar_t *wstrip);
 bool isGoodIPv6string (const char *strip);
 bool isGoodIPv6stringW (const wchar_t *wstrip);
 
+/*
+	Returns true if the given IP address is valid for parseWOLpeerU8 (), which means it
+	can also have an IPv6 scope id.
+*/
+bool isGoodWOLpeerStringW (const wchar_t *wstrip);
+
 enum eWOLret
 {
 	wolretOk,
 	wolretSyntaxMAC,
 	wolretSyntaxHst,
 	wolretErrSend,
-	wolretMissing
+	wolretMissing,
+	wolretErrMemory,
+	wolretNoIface,
+	wolretUnresolved
 };
 
+/*
+	initWOLmagicPacket
+
+	Writes the 102 octets (U_WAKEONLAN_MAGIC_PACKET_LEN) of the magic packet for the MAC
+	address cucMAC to szMagicPacket.
+*/
+void initWOLmagicPacket (char *szMagicPacket, const unsigned char cucMAC [6])
+;
+
+/*
+	findWOLmagicPacket
+
+	Searches the lenData octets at pData for a magic packet, which is 6 octets of 0xFF
+	followed by 16 repetitions of the same MAC address, anywhere within the data. The
+	function returns a pointer to the start of the magic packet and stores the MAC address
+	at ucMAC, or returns NULL if pData does not contain a magic packet.
+
+	On x64 the search uses SSE2.
+*/
+const unsigned char *findWOLmagicPacket (const unsigned char *pData, size_t lenData, unsigned char ucMAC [6])
+;
+
+/*
+	octetsFromMACU8
+
+	Reads the 6 octets of the MAC address szMAC, which must be in the form
+	"00-11-22-33-44-55", with any character as separator. The function returns NULL on
+	success, or a pointer to the first character that is not a valid octet. The caller
+	is responsible for checking that szMAC is U_WAKEONLAN_MAC_LEN characters long.
+	parseWOLmacU8 () accepts other notations too.
+*/
+const char *octetsFromMACU8 (unsigned char ucMAC [6], const char *szMAC)
+;
+
+/*
+	nextWOLlistTokenU8
+
+	Returns the next token of a line of a WOL list and NUL-terminates it in place. Tokens
+	are separated by white space, commas, or semicolons. The pointer sz points to is
+	advanced to the character after the token. The function returns NULL if there are no
+	more tokens.
+*/
+char *nextWOLlistTokenU8 (char **sz)
+;
+
 /*
 	wakeOnLAN_W
 
+	Sends a magic packet for the MAC address wzMAC, in any notation parseWOLmacW ()
+	accepts, to the broadcast IP wzHost. If wzMAC is invalid, the function returns
+	wolretSyntaxMAC. The parameter szErr is only kept for compatibility. If it's not NULL,
+	*szErr is always set to NULL.
+
+	The function is a wrapper for parseWOLmacW (), parseWOLpeerU8 (), initWOLtarget (),
+	and sendWOLtarget (). Callers that already have the MAC address and the peer address
+	in binary form should use these functions, or a sender (see SWOLSENDER), directly.
+
+	If wzHost is "auto" the magic packet is sent to the broadcast address of every local
+	IPv4 interface. See getWOLifaces (). The function then returns wolretNoIface if there
+	is no such interface.
+
+	If wzHost is a host name, it's resolved through the cache of resolveWOLnameU8 (). The
+	function returns wolretUnresolved if the name doesn't resolve.
 */
 enum eWOLret wakeOnLAN_W (const wchar_t *wzHost, const wchar_t *wzMAC, bool bForceIPv6, char **szErr)
 ;
@@ -160,10 +321,443 @@ enum eWOLret wakeOnLAN_W (const wchar_t *wzHost, const wchar_t *wzMAC, bool bFor
 /*
 	makeUnifiedMACaddress
 
+	Writes the MAC address wzMAC, which can be in any notation parseWOLmacW () accepts,
+	as "00-11-22-AA-BB-CC" to wzOut, which must have space for U_WAKEONLAN_MAC_SIZ
+	characters. The function returns false if wzMAC is not a valid MAC address.
 */
 bool makeUnifiedMACaddress (wchar_t *wzOut, const wchar_t *wzMAC)
 ;
 
+/*
+	SWOLTARGET
+
+	A single target of a WOL list. Its peer address and its magic packet are built when
+	the target is added to the list. Sending the list therefore doesn't need to parse
+	anything anymore.
+*/
+typedef struct swoltarget
+{
+	struct sockaddr_storage	ssPeer;							// Parsed (broadcast) address.
+	int						lenPeer;						// Length of ssPeer.
+	enum eWOLret			ret;							// Syntax check or send result.
+	int						iWSAerr;						// WSAGetLastError () on failure.
+	uint64_t				nLine;							// Line within the list file.
+	size_t					uiGroup;						// Index into the list's groups.
+	size_t					iNextInGroup;					// Used by the pacing scheduler.
+	ULONG					uiIfIndex;						// Outgoing interface, or 0.
+	struct in_addr			inLocal;						// Source address if uiIfIndex.
+	struct sockaddr_storage	ssHost;							// Host address for probing.
+	int						lenHost;						// Length of ssHost, or 0.
+	bool					bAwake;							// Skipped by further rounds.
+	uint32_t				nCopies;						// Magic packets sent.
+	uint32_t				nCopiesToWake;					// nCopies when found up, or 0.
+	uint16_t				uiPort;							// Replaces the policy's ports if not 0.
+	bool					bForceIPv6;						// For a name resolved later.
+	unsigned char			ucMAC [6];
+	char					szHost [U_WAKEONLAN_HOST_SIZ];	// Output, or name to resolve.
+	char					cMagicPacket [U_WAKEONLAN_MAGIC_PACKET_LEN];
+} SWOLTARGET;
+
+/*
+	parseWOLpeerU8
+
+	Parses the broadcast or multicast IP address szIP into the socket address pss points to,
+	with the magic packet port, and stores its length at plen. If bForceIPv6 is true, an
+	IPv4 address is mapped to IPv6 (::FFFF:a.b.c.d).
+
+	An IPv6 address can have a scope id, which is either an interface index or the name of
+	an interface, for instance "ff02::1%12" or "ff02::1%Ethernet". The link-local multicast
+	address ff02::1 reaches all nodes of the link, which makes it the IPv6 replacement
+	for a broadcast address.
+
+	The function returns false if szIP is not a valid address or if its interface does
+	not exist.
+*/
+bool parseWOLpeerU8 (struct sockaddr_storage *pss, int *plen, const char *szIP, bool bForceIPv6)
+;
+
+/*
+	setWOLmulticastIf
+
+	If pss is an IPv6 multicast address with a scope id, the function makes the IPv6
+	socket s send multicasts out of the interface of this scope id. The interface last set
+	is cached in the ULONG pulIf points to, which must be 0 for a new socket, so that a
+	run of packets to the same interface needs a single system call only. The function
+	returns false if the socket option cannot be set.
+*/
+bool setWOLmulticastIf (SOCKET s, const struct sockaddr_storage *pss, ULONG *pulIf)
+;
+
+/*
+	initWOLtarget
+
+	Initialises the target pt points to for the MAC address ucMAC and the peer address
+	pPeer, whose lenPeer octets are copied, and builds its magic packet. The port of pPeer
+	is used as is. parseWOLpeerU8 () sets it to U_WAKEONLAN_MAGIC_PACKET_PORT. Neither the
+	MAC address nor the peer address is converted to or from text, and no memory is
+	allocated. The member szHost stays empty.
+
+	The function returns false and sets the ret member of the target to wolretSyntaxHst if
+	pPeer is neither an IPv4 nor an IPv6 address.
+*/
+bool initWOLtarget	(
+		SWOLTARGET *pt, const unsigned char ucMAC [6], const struct sockaddr *pPeer,
+		int lenPeer
+					)
+;
+
+/*
+	sendWOLtarget
+
+	Sends the magic packet of pt, which must have been set up by initWOLtarget () or added
+	to a list, over a socket of its own. A multicast packet goes out of the interface of
+	the scope id. The function sets the ret and iWSAerr members of pt and returns true if
+	the packet was sent. To send many targets, or to send repeatedly, use a sender instead.
+	See SWOLSENDER.
+*/
+bool sendWOLtarget (SWOLTARGET *pt)
+;
+
+/*
+	SWOLSOCK
+
+	A UDP socket magic packets are sent over. It's created the first time it's required.
+*/
+typedef struct swolsock
+{
+	SOCKET	s;
+	int		iErr;											// Error when creating s.
+	bool	bUSO;											// UDP_SEND_MSG_SIZE is set.
+	ULONG	ulMcastIf;										// Last IPV6_MULTICAST_IF set.
+} SWOLSOCK;
+
+/*
+	SWOLSENDER
+
+	The sockets targets are sent over, one for IPv4 (index 0) and one for IPv6 (index 1).
+	The sockets stay open between calls to sendWOLbatch (), which makes a sender suitable
+	for services that wake hosts in a loop. A sender belongs to a single thread. Threads
+	that send concurrently each use a sender of their own. Apart from that, senders share
+	nothing, and no lock is taken on the way to sendto ().
+
+	Initialise a sender with initWOLsender (), and close its sockets with doneWOLsender ()
+	when done. WSAStartup () must have been called before. See callWSAStartup ().
+*/
+typedef struct swolsender
+{
+	SWOLSOCK				ws [2];
+	uint64_t				nSendCalls;						// Calls to sendto ()/WSASendMsg ().
+} SWOLSENDER;
+
+/*
+	initWOLsender
+
+	Initialises the sender ps points to. The sockets are created by the first call to
+	sendWOLbatch () that needs them.
+*/
+void initWOLsender (SWOLSENDER *ps)
+;
+
+/*
+	sendWOLbatch
+
+	Sends the magic packets of the n targets at pts, which must have been set up by
+	initWOLtarget () or added to a list, over the sockets of the sender ps points to.
+	Targets with a syntax error and targets whose bAwake member is set are skipped.
+
+	The function neither allocates memory nor looks at any text. Sending a target costs a
+	single system call. Its ret, iWSAerr, and nCopies members are updated. The function
+	returns the amount of magic packets sent.
+*/
+size_t sendWOLbatch (SWOLSENDER *ps, SWOLTARGET *pts, size_t n)
+;
+
+/*
+	doneWOLsender
+
+	Closes the sockets of the sender ps points to. The sender can be used again afterwards.
+*/
+void doneWOLsender (SWOLSENDER *ps)
+;
+
+/*
+	SWOLGROUP
+
+	A group of targets of a WOL list, for instance all hosts connected to the same rack
+	PDU. When the list is paced, each group has its own rate limit. Targets without a
+	group belong to the default group, which has an empty name.
+*/
+typedef struct swolgroup
+{
+	char					szName [U_WAKEONLAN_GROUP_SIZ];
+	size_t					nTargets;
+	uint64_t				nSent;
+	size_t					iHead;							// Used by the pacing scheduler.
+	size_t					iTail;
+	uint64_t				uiNext;							// Tick the next packet is due.
+} SWOLGROUP;
+
+/*
+	SWOLPOLICY
+
+	How a list is sent. Every round sends uiCopies copies of each magic packet to each of
+	the nPorts ports in uiPorts, and waits uiSpacingMs milliseconds between copies. The
+	copies of a round are interleaved across all targets: each copy is a full pass over
+	the list, so that a single lost datagram or a short link outage doesn't cost any host
+	all its copies.
+
+	A target whose uiPort member is not 0 gets its copies on this port instead.
+
+	After the first round, up to uiRetries retry rounds follow. The delay before the first
+	retry round is uiBackoffMs, and it doubles with every round up to uiBackoffMaxMs.
+	Targets whose bAwake member is set are skipped. See retryWOLlist () and
+	verifyWOLlist ().
+
+	initWOLpolicy () sets the defaults, which is a single copy to port
+	U_WAKEONLAN_MAGIC_PACKET_PORT without retries.
+*/
+typedef struct swolpolicy
+{
+	uint16_t				uiPorts [U_WAKEONLAN_POLICY_MAX_PORTS];
+	size_t					nPorts;
+	uint32_t				uiCopies;						// Per port and round.
+	uint64_t				uiSpacingMs;					// Between copies.
+	uint32_t				uiRetries;						// Rounds after the first one.
+	uint64_t				uiBackoffMs;					// Before the first retry round.
+	uint64_t				uiBackoffMaxMs;
+} SWOLPOLICY;
+
+/*
+	initWOLpolicy
+
+	Initialises the SWOLPOLICY structure pp points to with the defaults.
+*/
+void initWOLpolicy (SWOLPOLICY *pp)
+;
+
+/*
+	parseWOLpolicyPortsW
+
+	Sets the ports of the policy pp points to from wzPorts, which is a list of port
+	numbers separated by commas, for instance "7,9". The function returns false if
+	wzPorts is not such a list, has more than U_WAKEONLAN_POLICY_MAX_PORTS ports, or
+	contains port 0, which Windows doesn't send to.
+*/
+bool parseWOLpolicyPortsW (SWOLPOLICY *pp, const wchar_t *wzPorts)
+;
+
+/*
+	isDefaultWOLpolicy
+
+	Returns true if the policy pp points to sends a single magic packet to port
+	U_WAKEONLAN_MAGIC_PACKET_PORT.
+*/
+bool isDefaultWOLpolicy (const SWOLPOLICY *pp)
+;
+
+/*
+	backoffWOLpolicyMs
+
+	Returns the delay in milliseconds before the retry round uiRound, which starts at 1.
+*/
+uint64_t backoffWOLpolicyMs (const SWOLPOLICY *pp, uint32_t uiRound)
+;
+
+struct swolinventory;
+
+/*
+	SWOLLIST
+
+	A list of WOL targets. Initialise it with initWOLlist () and release its resources with
+	doneWOLlist () when done.
+*/
+typedef struct swollist
+{
+	SWOLTARGET				*pTargets;
+	size_t					nTargets;						// Targets in the list.
+	size_t					nAlloc;							// Targets space is allocated for.
+	size_t					nSent;							// Magic packets sent.
+	size_t					nFailed;						// Targets that failed.
+	size_t					nSendErrors;					// Failed sends, all rounds.
+	uint64_t				nSendCalls;						// Calls to sendto ()/WSASendTo ().
+	uint64_t				uiSendTicks;					// Performance counter ticks sending.
+	uint64_t				uiTicksPerSec;					// Performance counter frequency.
+	uint64_t				uiCPUtime;						// Kernel + user, in 100 ns.
+	bool					bUseUSO;						// Set by caller. See sendWOLlist ().
+	bool					bUSOavailable;					// UDP_SEND_MSG_SIZE succeeded.
+	SWOLGROUP				*pGroups;
+	size_t					nGroups;
+	size_t					nGroupAlloc;
+	uint64_t				uiRate;							// Set by caller. Packets/s, or 0.
+	uint64_t				uiGroupRate;					// Set by caller. Packets/s, or 0.
+	bool					bHighResTimer;					// High-resolution timer used.
+	uint64_t				uiPacedTicks;					// First to last paced packet.
+	uint64_t				uiJitterTicks;					// Sum of send delays.
+	uint64_t				uiJitterMax;					// Maximum send delay.
+	SWOLPOLICY				policy;							// Set by caller. See initWOLlist ().
+	uint32_t				nRounds;						// Rounds sent so far.
+	const struct swolinventory	*pInventory;				// Set by caller. See readWOLlistW ().
+	size_t					nUnresolved;					// Targets with a name to resolve.
+	uint64_t				nNames;							// Distinct names resolved.
+	uint64_t				nLookups;						// Names not found in the cache.
+	uint64_t				uiResolveTicks;					// Performance counter ticks resolving.
+} SWOLLIST;
+
+/*
+	initWOLlist
+
+	Initialises the WOL list pl points to. Its send policy is set to the defaults. See
+	initWOLpolicy ().
+*/
+void initWOLlist (SWOLLIST *pl)
+;
+
+/*
+	addWOLlistTargetU8
+
+	Parses the broadcast IP address szHost and the MAC address szMAC, builds the magic packet,
+	and adds the target to the list. The value of nLine is only stored for reporting and can
+	be 0. The target is added to the group szGroup, which is created if the list doesn't
+	have it yet. If szGroup is NULL the target is added to the default group.
+
+	If szHost is "auto" one target is added for every local IPv4 interface, with the
+	broadcast address of the interface's subnet. The packet of each of these targets is
+	sent out of its interface. See getWOLifaces (). If there is no such interface, a
+	single target with a ret member of wolretNoIface is added.
+
+	If szHost is a host name, like "rack12-bcast.lab", the target gets a ret member of
+	wolretUnresolved, and its name is resolved later by resolveWOLlist (), together with
+	the names of all other targets. The function doesn't block.
+
+	A target is also added if szHost or szMAC contain a syntax error. Its ret member then
+	tells which error occurred. The function returns wolretErrMemory if the list couldn't
+	be extended.
+*/
+enum eWOLret addWOLlistTargetU8	(
+				SWOLLIST *pl, const char *szHost, const char *szMAC, bool bForceIPv6,
+				uint64_t nLine, const char *szGroup
+								)
+;
+
+/*
+	addWOLlistTargetPeer
+
+	Adds a target whose peer address has already been parsed, for instance by
+	compileWOLinventoryW (), to the list. The lenPeer octets at pPeer are copied. If pPeer
+	is NULL, one target is added for every local interface, like addWOLlistTargetU8 ()
+	does for a broadcast IP of "auto". szHost is only stored for output.
+*/
+enum eWOLret addWOLlistTargetPeer	(
+				SWOLLIST *pl, const struct sockaddr *pPeer, int lenPeer,
+				const unsigned char ucMAC [6], const char *szHost, uint64_t nLine,
+				const char *szGroup
+									)
+;
+
+/*
+	setWOLtargetHostU8
+
+	Sets the address of the host itself, which is required to verify that it woke up,
+	to szIP. The function returns false if szIP is neither an IPv4 nor an IPv6 address.
+*/
+bool setWOLtargetHostU8 (SWOLTARGET *pt, const char *szIP)
+;
+
+/*
+	readWOLlistW
+
+	Reads a list of targets from the file wzFile, or from standard input if wzFile is "-",
+	and adds them to the list pl points to.
+
+	Each line consists of a broadcast IP address, a host name, or "auto", a MAC address,
+	and optionally the argument -f6 to force IPv6 for this line, group=<name> to add the
+	target to the group <name>, and ip=<addr> to set the address of the host for
+	verification. See setWOLtargetHostU8 (). The fields are separated by white space,
+	commas, or semicolons. Empty lines and lines that start with '#' or ';' are ignored.
+
+	If the member pInventory of the list is not NULL, a line can also start with the name
+	of a host in this inventory, which replaces the broadcast IP and the MAC address. The
+	options group=<name> and ip=<addr> override the inventory's values. See
+	findWOLinventoryU8 ().
+
+	Example:
+	# brip			mac
+	192.168.0.255	00-11-22-33-44-55	group=rack1		ip=192.168.0.97
+	10.4.12.255		00:11:22:33:44:66	-f6				group=rack2
+	build-07
+
+	Host names of all lines are resolved in parallel after the file has been read. See
+	resolveWOLlist ().
+
+	The function returns false if the file cannot be opened or if an out of memory
+	condition occurs.
+*/
+bool readWOLlistW (SWOLLIST *pl, const wchar_t *wzFile, bool bForceIPv6)
+;
+
+/*
+	sendWOLlist
+
+	Sends a round of the list's send policy (see SWOLPOLICY) to all syntactically correct
+	targets that are not awake. The first call sends the first round, and every further
+	call a retry round. The function uses one socket per address family for the entire
+	list. It updates the ret, iWSAerr, and nCopies members of every target, and the
+	counters of the list. The ports of the targets' peer addresses are changed in place.
+	A target only fails if none of its copies went out in any round so far. The member
+	nFailed is the amount of such targets after the round, while nSendErrors counts every
+	single send that failed.
+
+	If the member bUseUSO of the list is true, targets are grouped by their peer address,
+	and the magic packets of a group are sent with a single call by utilising UDP
+	segmentation offload (USO). If the socket option UDP_SEND_MSG_SIZE is not supported,
+	the function falls back to one call per magic packet. The member bUSOavailable tells
+	whether USO could be used.
+
+	If the member uiRate or uiGroupRate of the list is not 0, sending is paced instead, and
+	bUseUSO is ignored. uiRate limits the packets per second of the entire list, and
+	uiGroupRate the packets per second of each group. Each limit is a token bucket that
+	holds a single token, which spaces packets evenly. The groups take turns in the order
+	their next packet is due, hence a group at its limit doesn't hold up the others. The
+	sender waits on a waitable timer, not Sleep (), and the members uiJitterTicks and
+	uiJitterMax record how late packets were sent compared to their schedule.
+
+	Targets whose host names have not been resolved yet are resolved first. See
+	resolveWOLlist ().
+
+	The function returns the amount of magic packets sent.
+*/
+size_t sendWOLlist (SWOLLIST *pl)
+;
+
+/*
+	retryWOLlist
+
+	Sends the retry rounds of the list's send policy, with the backoff delays in between,
+	after sendWOLlist () sent the first one. Use this function if the hosts aren't
+	verified. verifyWOLlist () sends the retry rounds itself, and only to hosts that are
+	not up yet.
+*/
+void retryWOLlist (SWOLLIST *pl)
+;
+
+/*
+	doneWOLlist
+
+	Deallocates the resources of the list pl points to.
+*/
+void doneWOLlist (SWOLLIST *pl)
+;
+
+/*
+	strMACfromOctets
+
+	Writes the MAC address in ucMAC as text in the form "00-11-22-33-44-55" to szOut. The
+	buffer szOut points to must be at least U_WAKEONLAN_MAC_SIZ octets long. The string
+	is NUL-terminated.
+*/
+void strMACfromOctets (char *szOut, const unsigned char ucMAC [6])
+;
+
 EXTERN_C_END
 
 #endif														// Of #ifndef U_WAKEONLAN_H.
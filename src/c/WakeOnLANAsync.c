@@ -0,0 +1,241 @@
+/****************************************************************************************
+
+File		WakeOnLANAsync.c
+Why:		Asynchronous submission of magic packets with completion callbacks.
+OS:			Windows
+Created:	2026-10-17
+
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2026-10-17	Thomas			Created.
+
+****************************************************************************************/
+
+/*
+	This file is maintained as part of OnOffMate. See https://github.com/ThomasPGH/OnOffMate .
+*/
+
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Copyright (c) 2024, 2025, 2026 Thomas
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+#include "./WakeOnLANAsync.h"
+#include <Windows.h>
+#include "./WinRuntimeReplacements.h"
+
+static uint64_t nowWOLasync (void)
+{
+	LARGE_INTEGER li;
+
+	QueryPerformanceCounter (&li);
+	return (uint64_t) li.QuadPart;
+}
+
+/*
+	Takes the entire queue and returns it in submission order.
+*/
+static SWOLASYNCREQ *takeWOLasyncQueue (SWOLASYNC *pa)
+{
+	SWOLASYNCREQ *pr	=	InterlockedExchangePointer	(
+								(PVOID volatile *) &pa->pQueue, NULL
+														);
+	SWOLASYNCREQ *pFifo	= NULL;
+
+	while (pr)
+	{
+		SWOLASYNCREQ *pNext = pr->pNext;
+		pr->pNext	= pFifo;
+		pFifo		= pr;
+		pr			= pNext;
+	}
+	return pFifo;
+}
+
+/*
+	Returns the histogram bucket of uiUs microseconds. See U_WOLASYNC_LAT_BUCKETS.
+*/
+static size_t bucketWOLasyncUs (uint64_t uiUs)
+{
+	unsigned int uiExp = 4;
+
+	if (uiUs < U_WOLASYNC_LAT_SUBBUCKETS)
+		return (size_t) uiUs;
+	while (uiExp < 63 && uiUs >> (uiExp + 1))
+		++ uiExp;
+	return	(uiExp - 3) * U_WOLASYNC_LAT_SUBBUCKETS
+		+	(size_t) ((uiUs >> (uiExp - 4)) & (U_WOLASYNC_LAT_SUBBUCKETS - 1));
+}
+
+/*
+	Returns the smallest latency in microseconds of the histogram bucket b.
+*/
+static uint64_t usWOLasyncBucket (size_t b)
+{
+	size_t uiExp = b / U_WOLASYNC_LAT_SUBBUCKETS + 3;
+
+	if (b < U_WOLASYNC_LAT_SUBBUCKETS)
+		return b;
+	return (U_WOLASYNC_LAT_SUBBUCKETS + b % U_WOLASYNC_LAT_SUBBUCKETS) << (uiExp - 4);
+}
+
+static void countWOLasyncLatency (SWOLASYNC *pa, uint64_t uiTicks)
+{
+	pa->uiLatencyTicks += uiTicks;
+	if (uiTicks > pa->uiLatencyMax)
+		pa->uiLatencyMax = uiTicks;
+	++ pa->uiLatencyUs [bucketWOLasyncUs (uiTicks * 1000000 / pa->uiTicksPerSec)];
+}
+
+/*
+	Sends all requests of the list pr, then completes them. The completions come after
+	the sends, so that a slow callback doesn't delay the packets of the same drain.
+*/
+static void drainWOLasync (SWOLASYNC *pa, SWOLASYNCREQ *pr)
+{
+	SWOLASYNCREQ	*p;
+	uint64_t		n	= 0;
+
+	for (p = pr; p; p = p->pNext)
+	{
+		if (sendWOLbatch (&pa->sender, &p->target, 1))
+			++ pa->nSent;
+		else
+			++ pa->nFailed;
+		p->uiWireTick = nowWOLasync ();
+		countWOLasyncLatency (pa, p->uiWireTick - p->uiSubmitTick);
+		++ n;
+	}
+	++ pa->nDrains;
+	if (n > pa->nMaxDrain)
+		pa->nMaxDrain = n;
+	while (pr)
+	{
+		// The callback may reuse the request, including its pNext member.
+		p	= pr;
+		pr	= pr->pNext;
+		++ pa->nCompleted;
+		if (pa->hIOCP)
+			PostQueuedCompletionStatus (pa->hIOCP, 0, (ULONG_PTR) pa, &p->ov);
+		if (pa->fnc)
+			pa->fnc (p, pa->pCustom);
+	}
+}
+
+static DWORD WINAPI runWOLasync (LPVOID pParam)
+{
+	SWOLASYNC		*pa		= pParam;
+	SWOLASYNCREQ	*pr;
+
+	for (;;)
+	{
+		WaitForSingleObject (pa->hWake, INFINITE);
+		while ((pr = takeWOLasyncQueue (pa)))
+			drainWOLasync (pa, pr);
+		if (pa->lStop)
+			break;
+	}
+	return 0;
+}
+
+bool openWOLasync (SWOLASYNC *pa, pfnWOLasyncDone fnc, void *pCustom, HANDLE hIOCP)
+{
+	LARGE_INTEGER	liFreq;
+
+	memsetU (pa, 0, sizeof (SWOLASYNC));
+	QueryPerformanceFrequency (&liFreq);
+	pa->uiTicksPerSec	= (uint64_t) liFreq.QuadPart;
+	pa->fnc				= fnc;
+	pa->pCustom			= pCustom;
+	pa->hIOCP			= hIOCP;
+	initWOLsender (&pa->sender);
+	pa->hWake = CreateEventW (NULL, FALSE, FALSE, NULL);
+	if (NULL == pa->hWake)
+		return false;
+	pa->hThread = CreateThread (NULL, 0, runWOLasync, pa, 0, NULL);
+	if (NULL == pa->hThread)
+	{
+		CloseHandle (pa->hWake);
+		pa->hWake = NULL;
+		return false;
+	}
+	return true;
+}
+
+void submitWOLasync (SWOLASYNC *pa, SWOLASYNCREQ *pr)
+{
+	SWOLASYNCREQ *pHead;
+
+	pr->uiSubmitTick = nowWOLasync ();
+	InterlockedIncrement64 (&pa->nSubmitted);
+	do
+	{
+		pHead		= pa->pQueue;
+		pr->pNext	= pHead;
+	} while	(
+				pHead != InterlockedCompareExchangePointer	(
+							(PVOID volatile *) &pa->pQueue, pr, pHead
+															)
+			);
+	// Only the submission that makes the queue non-empty needs to wake the I/O thread.
+	if (NULL == pHead)
+		SetEvent (pa->hWake);
+}
+
+uint64_t percentileWOLasyncUs (const SWOLASYNC *pa, unsigned int uiPercent)
+{
+	uint64_t	nRank	= (pa->nCompleted * uiPercent + 99) / 100;
+	uint64_t	nSeen	= 0;
+	size_t		b;
+
+	if (0 == pa->nCompleted)
+		return 0;
+	if (0 == nRank)
+		nRank = 1;
+	for (b = 0; b < U_WOLASYNC_LAT_BUCKETS - 1; ++ b)
+	{
+		nSeen += pa->uiLatencyUs [b];
+		if (nSeen >= nRank)
+			break;
+	}
+	return usWOLasyncBucket (b);
+}
+
+void closeWOLasync (SWOLASYNC *pa)
+{
+	if (pa->hThread)
+	{
+		InterlockedExchange (&pa->lStop, 1);
+		SetEvent (pa->hWake);
+		WaitForSingleObject (pa->hThread, INFINITE);
+		CloseHandle (pa->hThread);
+		pa->hThread = NULL;
+	}
+	if (pa->hWake)
+		CloseHandle (pa->hWake);
+	pa->hWake = NULL;
+	doneWOLsender (&pa->sender);
+}
@@ -0,0 +1,170 @@
+/****************************************************************************************
+
+File		WakeOnLANAsync.h
+Why:		Asynchronous submission of magic packets with completion callbacks.
+OS:			Windows
+Created:	2026-10-17
+
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2026-10-17	Thomas			Created.
+
+****************************************************************************************/
+
+/*
+	This file is maintained as part of OnOffMate. See https://github.com/ThomasPGH/OnOffMate .
+*/
+
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Copyright (c) 2024, 2025, 2026 Thomas
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+#ifndef U_WAKEONLANASYNC_H
+#define U_WAKEONLANASYNC_H
+
+#include <stdbool.h>
+#include <inttypes.h>
+#include "./WakeOnLAN.h"
+#include "./externC.h"
+
+/*
+	The submit-to-wire latency histogram is log-linear in microseconds: latencies below 16
+	microseconds get a bucket each, and every further power of two is split into 16
+	buckets. A percentile is therefore at most 1/16 below the actual latency, for any
+	latency a uint64_t can hold.
+*/
+#define U_WOLASYNC_LAT_SUBBUCKETS			(16)
+#define U_WOLASYNC_LAT_BUCKETS				(61 * U_WOLASYNC_LAT_SUBBUCKETS)
+
+EXTERN_C_BEGIN
+
+/*
+	SWOLASYNCREQ
+
+	A wake request. The caller sets up its target with initWOLtarget () and owns its
+	memory, which must stay valid and untouched from submitWOLasync () until the
+	request has completed. No memory is allocated per request.
+*/
+typedef struct swolasyncreq
+{
+	SWOLTARGET					target;						// Set by caller.
+	void						*pCustom;					// Set by caller.
+	uint64_t					uiSubmitTick;				// Performance counter.
+	uint64_t					uiWireTick;					// After sendto () returned.
+	OVERLAPPED					ov;							// See openWOLasync ().
+	struct swolasyncreq			*pNext;						// Submission queue.
+} SWOLASYNCREQ;
+
+/*
+	Completion callback. It is called on the I/O thread, hence it must not block. The
+	ret member of the target tells whether the magic packet was sent. The request belongs
+	to the caller again when the callback is called.
+*/
+typedef void (*pfnWOLasyncDone) (SWOLASYNCREQ *pr, void *pCustom);
+
+/*
+	SWOLASYNC
+
+	The submission queue, the I/O thread, and its counters. The queue is a lock-free
+	intrusive stack any thread can push onto. The I/O thread takes the entire stack at
+	once, restores submission order, and sends all its requests over a single sender
+	before it completes them. See SWOLSENDER.
+
+	The structure is larger than a page. Allocate it on the heap.
+*/
+typedef struct swolasync
+{
+	SWOLASYNCREQ * volatile		pQueue;						// Newest request first.
+	HANDLE						hWake;						// Auto-reset event.
+	HANDLE						hThread;
+	volatile LONG				lStop;
+	pfnWOLasyncDone				fnc;
+	void						*pCustom;
+	HANDLE						hIOCP;						// Completions are posted to.
+	SWOLSENDER					sender;
+	volatile LONG64				nSubmitted;
+	uint64_t					nCompleted;					// Counters of the I/O thread.
+	uint64_t					nSent;
+	uint64_t					nFailed;
+	uint64_t					nDrains;					// Queue takeovers.
+	uint64_t					nMaxDrain;					// Largest takeover.
+	uint64_t					uiLatencyTicks;				// Sum of submit-to-wire times.
+	uint64_t					uiLatencyMax;
+	uint64_t					uiTicksPerSec;
+	uint64_t					uiLatencyUs [U_WOLASYNC_LAT_BUCKETS];
+} SWOLASYNC;
+
+/*
+	openWOLasync
+
+	Starts the I/O thread of pa. Completed requests are passed to the callback fnc, with
+	pCustom, if fnc is not NULL. If hIOCP is not NULL, each completed request is also
+	posted to the I/O completion port hIOCP, with pa as completion key and the ov member
+	of the request as OVERLAPPED, which lets an event loop built on
+	GetQueuedCompletionStatusEx () pick up completions without a callback. The ov member
+	is not used otherwise. Use CONTAINING_RECORD () to get from the OVERLAPPED to the
+	request.
+
+	callWSAStartup () must have been called before. The function returns false if the
+	event or the thread cannot be created.
+*/
+bool openWOLasync (SWOLASYNC *pa, pfnWOLasyncDone fnc, void *pCustom, HANDLE hIOCP)
+;
+
+/*
+	submitWOLasync
+
+	Queues the request pr and returns without blocking. Any thread can call it. The
+	function stamps the submit time and wakes the I/O thread only if the queue was empty,
+	hence a burst of submissions costs a single SetEvent ().
+*/
+void submitWOLasync (SWOLASYNC *pa, SWOLASYNCREQ *pr)
+;
+
+/*
+	percentileWOLasyncUs
+
+	Returns the uiPercent percentile of the submit-to-wire latencies in microseconds, which
+	is the lower bound of its histogram bucket. Call it after closeWOLasync (), or from
+	the completion callback.
+*/
+uint64_t percentileWOLasyncUs (const SWOLASYNC *pa, unsigned int uiPercent)
+;
+
+/*
+	closeWOLasync
+
+	Sends and completes all requests submitted before, stops the I/O thread, and closes
+	the sender's sockets. Requests must not be submitted anymore while the function runs.
+	The counters stay valid.
+*/
+void closeWOLasync (SWOLASYNC *pa)
+;
+
+EXTERN_C_END
+
+#endif														// Of #ifndef U_WAKEONLANASYNC_H.
@@ -0,0 +1,362 @@
+/****************************************************************************************
+
+File		WakeOnLANEther.c
+Why:		Sends magic packets directly over Ethernet (EtherType 0x0842).
+OS:			Windows
+Created:	2026-10-17
+
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2026-10-17	Thomas			Created.
+2026-10-17	Thomas			List files accept MAC addresses in all common notations.
+
+****************************************************************************************/
+
+/*
+	This file is maintained as part of OnOffMate. See https://github.com/ThomasPGH/OnOffMate .
+*/
+
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Copyright (c) 2024, 2025, 2026 Thomas
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "./WakeOnLANEther.h"
+
+#include <Windows.h>
+#include <iphlpapi.h>
+#pragma comment (lib, "Iphlpapi.lib")
+
+#include "./WinRuntimeReplacements.h"
+#include "./WinLineReader.h"
+#include "./WakeOnLANMAC.h"
+
+/*
+	The parts of the Npcap API we need. See https://npcap.com/guide/wpcap/pcap.html .
+	We don't include the Npcap SDK headers because the library is loaded at runtime.
+*/
+#define WOLPCAP_ERRBUF_SIZE			(256)
+
+typedef struct wolpcap_pkthdr
+{
+	struct timeval	ts;
+	uint32_t		caplen;
+	uint32_t		len;
+} WOLPCAP_PKTHDR;
+
+typedef struct wolpcap_send_queue
+{
+	unsigned int	maxlen;
+	unsigned int	len;
+	char			*buffer;
+} WOLPCAP_SEND_QUEUE;
+
+typedef void				*(*pfn_pcap_open_live)			(const char *, int, int, int, char *);
+typedef void				(*pfn_pcap_close)				(void *);
+typedef WOLPCAP_SEND_QUEUE	*(*pfn_pcap_sendqueue_alloc)	(unsigned int);
+typedef void				(*pfn_pcap_sendqueue_destroy)	(WOLPCAP_SEND_QUEUE *);
+typedef int					(*pfn_pcap_sendqueue_queue)		(WOLPCAP_SEND_QUEUE *, const WOLPCAP_PKTHDR *, const unsigned char *);
+typedef unsigned int		(*pfn_pcap_sendqueue_transmit)	(void *, WOLPCAP_SEND_QUEUE *, int);
+
+typedef struct swolnpcap
+{
+	HMODULE						hWpcap;
+	pfn_pcap_open_live			open_live;
+	pfn_pcap_close				close;
+	pfn_pcap_sendqueue_alloc	sq_alloc;
+	pfn_pcap_sendqueue_destroy	sq_destroy;
+	pfn_pcap_sendqueue_queue	sq_queue;
+	pfn_pcap_sendqueue_transmit	sq_transmit;
+} SWOLNPCAP;
+
+/*
+	Npcap is loaded once per process, like callWSAStartup () calls WSAStartup () once.
+	The function pointers are only copied to npcap when all of them have been found, and
+	INIT_ONCE publishes them to all threads. The DLL is never unloaded while in use.
+*/
+static SWOLNPCAP	npcap;
+static INIT_ONCE	ioNpcap	= INIT_ONCE_STATIC_INIT;
+
+/*
+	Npcap installs its DLLs in System32\Npcap, which is not in the DLL search path. See
+	https://npcap.com/guide/npcap-devguide.html#npcap-feature-native-dll-implicitly .
+*/
+static BOOL CALLBACK initOnceNpcap (PINIT_ONCE pio, PVOID pParam, PVOID *ppCtx)
+{
+	WCHAR		wcDLL [MAX_PATH + 32];
+	UINT		len;
+	SWOLNPCAP	np;
+
+	UNREFERENCED_PARAMETER (pio);
+	UNREFERENCED_PARAMETER (pParam);
+
+	// The low INIT_ONCE_CTX_RESERVED_BITS of the context must be 0. See callWSAStartup ().
+	*ppCtx = NULL;
+	len = GetSystemDirectoryW (wcDLL, MAX_PATH);
+	if (0 == len || len >= MAX_PATH)
+		return TRUE;
+	memcpyU (wcDLL + len, L"\\Npcap\\wpcap.dll", sizeof (L"\\Npcap\\wpcap.dll"));
+	np.hWpcap = LoadLibraryExW (wcDLL, NULL, LOAD_WITH_ALTERED_SEARCH_PATH);
+	if (NULL == np.hWpcap)
+		return TRUE;
+
+	np.open_live	= (pfn_pcap_open_live)			GetProcAddress (np.hWpcap, "pcap_open_live");
+	np.close		= (pfn_pcap_close)				GetProcAddress (np.hWpcap, "pcap_close");
+	np.sq_alloc		= (pfn_pcap_sendqueue_alloc)	GetProcAddress (np.hWpcap, "pcap_sendqueue_alloc");
+	np.sq_destroy	= (pfn_pcap_sendqueue_destroy)	GetProcAddress (np.hWpcap, "pcap_sendqueue_destroy");
+	np.sq_queue		= (pfn_pcap_sendqueue_queue)	GetProcAddress (np.hWpcap, "pcap_sendqueue_queue");
+	np.sq_transmit	= (pfn_pcap_sendqueue_transmit)	GetProcAddress (np.hWpcap, "pcap_sendqueue_transmit");
+	if	(
+				np.open_live && np.close && np.sq_alloc && np.sq_destroy
+			&&	np.sq_queue && np.sq_transmit
+		)
+	{
+		npcap	= np;
+		*ppCtx	= &npcap;
+	} else
+		FreeLibrary (np.hWpcap);
+	return TRUE;
+}
+
+static bool loadNpcap (void)
+{
+	PVOID pCtx = NULL;
+
+	if (!InitOnceExecuteOnce (&ioNpcap, initOnceNpcap, NULL, &pCtx))
+		return false;
+	return NULL != pCtx;
+}
+
+static bool isInterfaceIndexW (const wchar_t *wz)
+{
+	if (L'\0' == *wz)
+		return false;
+	while (*wz)
+	{
+		if (isNotDigitW (*wz))
+			return false;
+		++ wz;
+	}
+	return true;
+}
+
+static bool isAdapterNameW (const char *szAdapter, const wchar_t *wz)
+{
+	while (*szAdapter && *wz)
+	{
+		if (toupperW ((WCHAR) (unsigned char) *szAdapter) != toupperW (*wz))
+			return false;
+		++ szAdapter;
+		++ wz;
+	}
+	return *szAdapter == *wz;
+}
+
+/*
+	Finds the interface wzInterface and writes its Npcap device name to szDevice and its
+	MAC address to ucMAC.
+*/
+static bool findWOLetherInterface (char *szDevice, size_t sizDevice, unsigned char ucMAC [6], const wchar_t *wzInterface)
+{
+	PIP_ADAPTER_ADDRESSES	paa		= NULL;
+	ULONG					ulSize	= 16 * 1024;
+	ULONG					ulRet;
+	uint64_t				uiIdx	= 0;
+	bool					bIdx	= isInterfaceIndexW (wzInterface);
+	bool					bRet	= false;
+	size_t					lenIf	= strlenW (wzInterface);
+
+	if (bIdx)
+		ubf_uint64_from_strW (&uiIdx, wzInterface);
+	do
+	{
+		if (paa)
+			HeapFree (GetProcessHeap (), 0, paa);
+		paa = HeapAlloc (GetProcessHeap (), 0, ulSize);
+		if (NULL == paa)
+			return false;
+		ulRet = GetAdaptersAddresses	(
+					AF_UNSPEC,
+						GAA_FLAG_SKIP_UNICAST | GAA_FLAG_SKIP_ANYCAST
+					|	GAA_FLAG_SKIP_MULTICAST | GAA_FLAG_SKIP_DNS_SERVER,
+					NULL, paa, &ulSize
+										);
+	} while (ERROR_BUFFER_OVERFLOW == ulRet);
+
+	if (ERROR_SUCCESS == ulRet)
+	{
+		PIP_ADAPTER_ADDRESSES pa;
+		for (pa = paa; pa; pa = pa->Next)
+		{
+			if	(
+						6 != pa->PhysicalAddressLength
+					||	!	(
+									(bIdx && uiIdx == pa->IfIndex)
+								||	(
+											lenIf == strlenW (pa->FriendlyName)
+										&&	0 == stricmpW (wzInterface, pa->FriendlyName, lenIf)
+									)
+								||	isAdapterNameW (pa->AdapterName, wzInterface)
+							)
+				)
+				continue;
+			static const char	cNPF []	= "\\Device\\NPF_";
+			size_t				lenAdp	= strlenU (pa->AdapterName);
+			if (sizeof (cNPF) + lenAdp <= sizDevice)
+			{
+				memcpyU (szDevice, cNPF, sizeof (cNPF) - 1);
+				memcpyU (szDevice + sizeof (cNPF) - 1, pa->AdapterName, lenAdp + 1);
+				memcpyU (ucMAC, pa->PhysicalAddress, 6);
+				bRet = true;
+			}
+			break;
+		}
+	}
+	HeapFree (GetProcessHeap (), 0, paa);
+	return bRet;
+}
+
+enum eWOLetherRet openWOLether (SWOLETHER *pe, const wchar_t *wzInterface, uint16_t uiVLAN)
+{
+	char	szDevice [256];
+	char	szErr [WOLPCAP_ERRBUF_SIZE];
+
+	memsetU (pe, 0, sizeof (SWOLETHER));
+	if (!loadNpcap ())
+		return wolethNoNpcap;
+	if (!findWOLetherInterface (szDevice, sizeof (szDevice), pe->ucSrcMAC, wzInterface))
+		return wolethNoInterface;
+	pe->uiVLAN	= uiVLAN & 0x0FFF;
+	// We only send. The snapshot length and the timeout don't matter.
+	pe->pcap	= npcap.open_live (szDevice, 64, 0, 1000, szErr);
+	if (NULL == pe->pcap)
+		return wolethErrOpen;
+	pe->queue	= npcap.sq_alloc	(
+						U_WAKEONLAN_ETHER_QUEUE_FRAMES
+					*	(sizeof (WOLPCAP_PKTHDR) + U_WAKEONLAN_ETHER_FRAME_MAX)
+									);
+	if (NULL == pe->queue)
+	{
+		npcap.close (pe->pcap);
+		pe->pcap = NULL;
+		return wolethErrMemory;
+	}
+	return wolethOk;
+}
+
+size_t flushWOLether (SWOLETHER *pe)
+{
+	WOLPCAP_SEND_QUEUE	*psq	= pe->queue;
+
+	if (NULL == psq || 0 == pe->nQueued)
+		return 0;
+
+	size_t			nQueued	= pe->nQueued;
+	// Npcap returns the amount of octets sent. Frames are not sent synchronised.
+	unsigned int	uiSent	= npcap.sq_transmit (pe->pcap, psq, 0);
+	bool			bSent	= uiSent == psq->len;
+
+	++ pe->nFlushes;
+	if (bSent)
+		pe->nSent	+= nQueued;
+	else
+		pe->nFailed	+= nQueued;
+	// Empties the queue. Its buffer is reused.
+	psq->len		= 0;
+	pe->nQueued		= 0;
+	return bSent ? nQueued : 0;
+}
+
+enum eWOLetherRet queueWOLether (SWOLETHER *pe, const unsigned char ucMAC [6])
+{
+	unsigned char	ucFrame [U_WAKEONLAN_ETHER_FRAME_MAX];
+	WOLPCAP_PKTHDR	hdr;
+	size_t			o		= 12;
+
+	if (NULL == pe->queue)
+		return wolethErrSend;
+	if (U_WAKEONLAN_ETHER_QUEUE_FRAMES == pe->nQueued)
+		flushWOLether (pe);
+
+	memsetU (ucFrame, 0xFF, 6);
+	memcpyU (ucFrame + 6, pe->ucSrcMAC, 6);
+	if (pe->uiVLAN)
+	{	// 802.1Q tag: TPID, then priority 0 and the VLAN ID.
+		ucFrame [o ++]	= (unsigned char) (U_WAKEONLAN_ETHERTYPE_VLAN >> 8);
+		ucFrame [o ++]	= (unsigned char) (U_WAKEONLAN_ETHERTYPE_VLAN & 0xFF);
+		ucFrame [o ++]	= (unsigned char) (pe->uiVLAN >> 8);
+		ucFrame [o ++]	= (unsigned char) (pe->uiVLAN & 0xFF);
+	}
+	ucFrame [o ++]	= (unsigned char) (U_WAKEONLAN_ETHERTYPE_WOL >> 8);
+	ucFrame [o ++]	= (unsigned char) (U_WAKEONLAN_ETHERTYPE_WOL & 0xFF);
+	initWOLmagicPacket ((char *) ucFrame + o, ucMAC);
+
+	memsetU (&hdr, 0, sizeof (hdr));
+	hdr.caplen	= (uint32_t) (o + U_WAKEONLAN_MAGIC_PACKET_LEN);
+	hdr.len		= hdr.caplen;
+	if (0 != npcap.sq_queue (pe->queue, &hdr, ucFrame))
+		return wolethErrMemory;
+	++ pe->nQueued;
+	return wolethOk;
+}
+
+bool queueWOLetherListW (SWOLETHER *pe, const wchar_t *wzFile, size_t *pnBad)
+{
+	SLINEREADER		lr;
+	char			*szLine;
+	char			*szTok;
+	unsigned char	ucMAC [6];
+
+	*pnBad = 0;
+	if (!openLineReaderW (&lr, wzFile))
+		return false;
+	while ((szLine = nextLineU8 (&lr, NULL)))
+	{
+		bool bMAC = false;
+		szTok = nextWOLlistTokenU8 (&szLine);
+		if (NULL == szTok || '#' == szTok [0] || ';' == szTok [0])
+			continue;
+		do
+		{
+			bMAC = parseWOLmacU8 (ucMAC, szTok, strlenU (szTok));
+		} while (!bMAC && (szTok = nextWOLlistTokenU8 (&szLine)));
+		if (bMAC)
+			queueWOLether (pe, ucMAC);
+		else
+			++ *pnBad;
+	}
+	closeLineReader (&lr);
+	return true;
+}
+
+void closeWOLether (SWOLETHER *pe)
+{
+	flushWOLether (pe);
+	if (pe->queue)
+		npcap.sq_destroy (pe->queue);
+	if (pe->pcap)
+		npcap.close (pe->pcap);
+	pe->queue	= NULL;
+	pe->pcap	= NULL;
+}
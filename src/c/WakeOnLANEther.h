@@ -0,0 +1,184 @@
+/****************************************************************************************
+
+File		WakeOnLANEther.h
+Why:		Sends magic packets directly over Ethernet (EtherType 0x0842).
+OS:			Windows
+Created:	2026-10-17
+
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2026-10-17	Thomas			Created.
+
+****************************************************************************************/
+
+/*
+	This file is maintained as part of OnOffMate. See https://github.com/ThomasPGH/OnOffMate .
+*/
+
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Copyright (c) 2024, 2025, 2026 Thomas
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	Windows doesn't allow user mode applications to send raw Ethernet frames. This module
+	therefore utilises Npcap (see https://npcap.com ), which provides send queues: Frames
+	are written into a queue buffer and then handed to the driver with a single call. The
+	Npcap library (wpcap.dll) is loaded at runtime. OnOffMate does not link to it and runs
+	fine without Npcap installed, only these functions fail then.
+
+	Ethernet magic packets don't go through the IP stack. Nothing is routed and there's no
+	need for a broadcast IP address, which helps when switches or routers drop directed
+	broadcasts. The frames are sent to the Ethernet broadcast address FF-FF-FF-FF-FF-FF,
+	optionally with an 802.1Q VLAN tag.
+*/
+
+#ifndef U_WAKEONLANETHER_H
+#define U_WAKEONLANETHER_H
+
+#include <stdbool.h>
+#include <inttypes.h>
+#include "./WakeOnLAN.h"
+#include "./externC.h"
+
+/*
+	See https://en.wikipedia.org/wiki/EtherType .
+*/
+#define U_WAKEONLAN_ETHERTYPE_WOL		(0x0842)
+#define U_WAKEONLAN_ETHERTYPE_VLAN		(0x8100)
+
+/*
+	Frame length without and with 802.1Q tag:
+
+	  6 destination MAC
+	  6 source MAC
+	 (4 802.1Q tag)
+	  2 EtherType
+	102 magic packet
+	---
+	116 (120)
+*/
+#define U_WAKEONLAN_ETHER_HDR_LEN		(6 + 6 + 2)
+#define U_WAKEONLAN_ETHER_VLAN_LEN		(4)
+#define U_WAKEONLAN_ETHER_FRAME_MAX		\
+	(U_WAKEONLAN_ETHER_HDR_LEN + U_WAKEONLAN_ETHER_VLAN_LEN + U_WAKEONLAN_MAGIC_PACKET_LEN)
+
+/*
+	No VLAN tag. Valid VLAN IDs are 1 to 4094.
+*/
+#define U_WAKEONLAN_ETHER_NO_VLAN		(0)
+#define U_WAKEONLAN_ETHER_MAX_VLAN		(4094)
+
+/*
+	The amount of frames the send queue can hold. The queue is flushed automatically when
+	it's full.
+*/
+#ifndef U_WAKEONLAN_ETHER_QUEUE_FRAMES
+#define U_WAKEONLAN_ETHER_QUEUE_FRAMES	(1024)
+#endif
+
+EXTERN_C_BEGIN
+
+enum eWOLetherRet
+{
+	wolethOk,
+	wolethNoNpcap,											// wpcap.dll couldn't be loaded.
+	wolethNoInterface,										// Interface not found.
+	wolethErrOpen,											// Npcap can't open interface.
+	wolethErrMemory,
+	wolethErrSend
+};
+
+/*
+	SWOLETHER
+
+	A raw Ethernet sender bound to a single interface. Its members are private.
+*/
+typedef struct swolether
+{
+	void			*pcap;									// pcap_t *
+	void			*queue;									// pcap_send_queue *
+	unsigned char	ucSrcMAC [6];							// MAC address of interface.
+	uint16_t		uiVLAN;
+	size_t			nQueued;								// Frames in the queue.
+	size_t			nSent;									// Frames sent.
+	size_t			nFailed;								// Frames not sent.
+	uint64_t		nFlushes;								// Calls to transmit queue.
+} SWOLETHER;
+
+/*
+	openWOLether
+
+	Opens the network interface wzInterface for sending Ethernet magic packets. The
+	interface can be given by its friendly name (for instance "Ethernet"), its adapter
+	name (a GUID like "{0B5B3D0A-...}"), or its interface index.
+
+	If uiVLAN is not U_WAKEONLAN_ETHER_NO_VLAN, every frame gets an 802.1Q tag with this
+	VLAN ID.
+*/
+enum eWOLetherRet openWOLether (SWOLETHER *pe, const wchar_t *wzInterface, uint16_t uiVLAN)
+;
+
+/*
+	queueWOLether
+
+	Writes a magic packet frame for the MAC address ucMAC into the send queue. The queue
+	is flushed first if it's full.
+*/
+enum eWOLetherRet queueWOLether (SWOLETHER *pe, const unsigned char ucMAC [6])
+;
+
+/*
+	queueWOLetherListW
+
+	Reads the file wzFile, or standard input if wzFile is "-", and queues a magic packet
+	frame for the first MAC address on each line. This means the same list files as for
+	readWOLlistW () can be used. Empty lines and lines that start with '#' or ';' are
+	ignored. The amount of lines without valid MAC address is stored at pnBad.
+
+	The function returns false if the file can't be read.
+*/
+bool queueWOLetherListW (SWOLETHER *pe, const wchar_t *wzFile, size_t *pnBad)
+;
+
+/*
+	flushWOLether
+
+	Hands all frames in the send queue to the driver with a single call. The function
+	returns the amount of frames sent.
+*/
+size_t flushWOLether (SWOLETHER *pe)
+;
+
+/*
+	closeWOLether
+
+	Flushes the send queue and closes the interface.
+*/
+void closeWOLether (SWOLETHER *pe)
+;
+
+EXTERN_C_END
+
+#endif														// Of #ifndef U_WAKEONLANETHER_H.
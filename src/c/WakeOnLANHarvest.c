@@ -0,0 +1,1005 @@
+/****************************************************************************************
+
+File		WakeOnLANHarvest.c
+Why:		Harvests MAC addresses from ethers files and neighbour tables into the inventory.
+OS:			Windows
+Created:	2026-10-17
+
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2026-10-17	Thomas			Created.
+2026-10-17	Thomas			Releases the interface table. See releaseWOLifaces ().
+
+****************************************************************************************/
+
+/*
+	This file is maintained as part of OnOffMate. See https://github.com/ThomasPGH/OnOffMate .
+*/
+
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Copyright (c) 2024, 2025, 2026 Thomas
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#ifndef _WINSOCK_DEPRECATED_NO_WARNINGS
+#define _WINSOCK_DEPRECATED_NO_WARNINGS
+#endif
+
+#include "./WakeOnLANHarvest.h"
+#include <Windows.h>
+#include <iphlpapi.h>
+#include "./WinRuntimeReplacements.h"
+#include "./WinLineReader.h"
+#include "./WakeOnLAN.h"
+#include "./WakeOnLANMAC.h"
+#include "./WakeOnLANIfaces.h"
+
+#pragma comment (lib, "Iphlpapi.lib")
+
+/*
+	The amount of entries, string pool octets, and hash set slots reserved initially.
+*/
+#ifndef U_WOLHARV_INITIAL_ENTRIES
+#define U_WOLHARV_INITIAL_ENTRIES		(1024)
+#endif
+#ifndef U_WOLHARV_INITIAL_STRINGS
+#define U_WOLHARV_INITIAL_STRINGS		(16384)
+#endif
+#ifndef U_WOLHSET_INITIAL
+#define U_WOLHSET_INITIAL				(2048)
+#endif
+
+/*
+	The maximum amount of tokens of a line of a source that are looked at. The MAC
+	address is within the first few tokens in all formats.
+*/
+#ifndef U_WOLHARV_MAX_TOKENS
+#define U_WOLHARV_MAX_TOKENS			(8)
+#endif
+
+/*
+	The fields of a line of the inventory. See compileWOLinventoryW ().
+*/
+#define U_WOLHARV_FIELDS				(6)
+#define U_WOLHARV_FIELD_NAME			(0)
+#define U_WOLHARV_FIELD_MAC				(1)
+#define U_WOLHARV_FIELD_BRIP			(2)
+#define U_WOLHARV_FIELD_IP				(5)
+
+static void *reallocWOLharv (void *p, size_t size)
+{
+	if (p)
+		return HeapReAlloc (GetProcessHeap (), 0, p, size);
+	return HeapAlloc (GetProcessHeap (), 0, size);
+}
+
+static void freeWOLharv (void *p)
+{
+	if (p)
+		HeapFree (GetProcessHeap (), 0, p);
+}
+
+static inline unsigned char lowerWOLharvChar (unsigned char c)
+{
+	return c >= 'A' && c <= 'Z' ? c | 0x20 : c;
+}
+
+/*
+	Fibonacci hashing of the key to a slot.
+*/
+static inline uint32_t slotWOLhkey (uint64_t uiKey, uint32_t uiMask)
+{
+	return (uint32_t) ((uiKey * 0x9E3779B97F4A7C15ull) >> 32) & uiMask;
+}
+
+static void putWOLhset (SWOLHSET *ps, uint64_t uiKey, uint32_t uiIdx)
+{
+	uint32_t s = slotWOLhkey (uiKey, ps->uiMask);
+
+	while (U_WOLHSET_EMPTY != ps->pSlots [s].uiIdx)
+		s = (s + 1) & ps->uiMask;
+	ps->pSlots [s].uiKey	= uiKey;
+	ps->pSlots [s].uiIdx	= uiIdx;
+	++ ps->nUsed;
+}
+
+/*
+	Makes sure the set has space for one more key, and keeps it at most half full.
+*/
+static bool growWOLhset (SWOLHSET *ps)
+{
+	if (ps->pSlots && (uint64_t) (ps->nUsed + 1) * 2 <= (uint64_t) ps->uiMask + 1)
+		return true;
+
+	uint64_t	nOld	= ps->pSlots ? (uint64_t) ps->uiMask + 1 : 0;
+	uint64_t	nNew	= nOld ? 2 * nOld : U_WOLHSET_INITIAL;
+	SWOLHSLOT	*pOld	= ps->pSlots;
+	uint64_t	n;
+
+	if (nNew > 0x80000000)
+		return false;
+	ps->pSlots = HeapAlloc (GetProcessHeap (), 0, (size_t) nNew * sizeof (SWOLHSLOT));
+	if (NULL == ps->pSlots)
+	{
+		ps->pSlots = pOld;
+		return false;
+	}
+	for (n = 0; n < nNew; ++ n)
+		ps->pSlots [n].uiIdx = U_WOLHSET_EMPTY;
+	ps->uiMask	= (uint32_t) (nNew - 1);
+	ps->nUsed	= 0;
+	for (n = 0; n < nOld; ++ n)
+	{
+		if (U_WOLHSET_EMPTY != pOld [n].uiIdx)
+			putWOLhset (ps, pOld [n].uiKey, pOld [n].uiIdx);
+	}
+	freeWOLharv (pOld);
+	return true;
+}
+
+/*
+	Returns the index stored with the key uiKey, or U_WOLHSET_EMPTY. Keys can occur more
+	than once. *puiPos must be U_WOLHSET_EMPTY for the first call, and the search continues
+	after the previous match for further calls with the same puiPos.
+*/
+static uint32_t findWOLhset (const SWOLHSET *ps, uint64_t uiKey, uint32_t *puiPos)
+{
+	if (NULL == ps->pSlots)
+		return U_WOLHSET_EMPTY;
+
+	uint32_t s;
+	if (U_WOLHSET_EMPTY == *puiPos)
+		s = slotWOLhkey (uiKey, ps->uiMask);
+	else
+		s = (*puiPos + 1) & ps->uiMask;
+	while (U_WOLHSET_EMPTY != ps->pSlots [s].uiIdx)
+	{
+		if (uiKey == ps->pSlots [s].uiKey)
+		{
+			*puiPos = s;
+			return ps->pSlots [s].uiIdx;
+		}
+		s = (s + 1) & ps->uiMask;
+	}
+	return U_WOLHSET_EMPTY;
+}
+
+static void doneWOLhset (SWOLHSET *ps)
+{
+	freeWOLharv (ps->pSlots);
+	memsetU (ps, 0, sizeof (SWOLHSET));
+}
+
+static inline uint64_t keyWOLmac (const unsigned char ucMAC [6])
+{
+	return		(uint64_t) ucMAC [0] << 40 | (uint64_t) ucMAC [1] << 32
+			|	(uint64_t) ucMAC [2] << 24 | (uint64_t) ucMAC [3] << 16
+			|	(uint64_t) ucMAC [4] << 8  | (uint64_t) ucMAC [5];
+}
+
+/*
+	FNV-1a (64 bit) of the ASCII lowercase name.
+*/
+static uint64_t keyWOLname (const char *szName, size_t lenName)
+{
+	uint64_t	h	= 0xCBF29CE484222325ull;
+	size_t		n;
+
+	for (n = 0; n < lenName; ++ n)
+	{
+		h ^= lowerWOLharvChar ((unsigned char) szName [n]);
+		h *= 0x00000100000001B3ull;
+	}
+	return h;
+}
+
+static bool isSameWOLname (const char *sz1, size_t len1, const char *sz2, size_t len2)
+{
+	size_t n;
+
+	if (len1 != len2)
+		return false;
+	for (n = 0; n < len1; ++ n)
+	{
+		if (lowerWOLharvChar ((unsigned char) sz1 [n]) != lowerWOLharvChar ((unsigned char) sz2 [n]))
+			return false;
+	}
+	return true;
+}
+
+/*
+	Adds the len octets at sz as a NUL-terminated string to the string pool and stores its
+	offset at pofs.
+*/
+static bool addWOLharvString (SWOLHARVEST *ph, uint32_t *pofs, const char *sz, size_t len)
+{
+	if (0 == ph->lenStrings)
+	{	// Offset 0 is the empty string.
+		ph->pStrings = HeapAlloc (GetProcessHeap (), 0, U_WOLHARV_INITIAL_STRINGS);
+		if (NULL == ph->pStrings)
+			return false;
+		ph->nStrAlloc		= U_WOLHARV_INITIAL_STRINGS;
+		ph->pStrings [0]	= '\0';
+		ph->lenStrings		= 1;
+	}
+	if ((uint64_t) ph->lenStrings + len + 1 > 0x7FFFFFFF)
+		return false;
+	if (ph->lenStrings + len + 1 > ph->nStrAlloc)
+	{
+		uint32_t nNew = ph->nStrAlloc;
+		while (nNew < ph->lenStrings + len + 1)
+			nNew *= 2;
+		char *p = reallocWOLharv (ph->pStrings, nNew);
+		if (NULL == p)
+			return false;
+		ph->pStrings	= p;
+		ph->nStrAlloc	= nNew;
+	}
+	*pofs = ph->lenStrings;
+	memcpyU (ph->pStrings + ph->lenStrings, sz, len);
+	ph->pStrings [ph->lenStrings + len] = '\0';
+	ph->lenStrings += (uint32_t) (len + 1);
+	return true;
+}
+
+/*
+	Adds the MAC address ucMAC with its name, IP, and broadcast IP, each of which can be
+	NULL, to the harvest. If the MAC address is already in the harvest, only the strings it
+	doesn't have yet are added.
+*/
+static bool addWOLharvEntry	(
+				SWOLHARVEST *ph, const unsigned char ucMAC [6], const char *szName,
+				const char *szIP, const char *szBrIP
+							)
+{
+	uint64_t		uiKey	= keyWOLmac (ucMAC);
+	uint32_t		uiPos	= U_WOLHSET_EMPTY;
+	uint32_t		i		= findWOLhset (&ph->setMACs, uiKey, &uiPos);
+	SWOLHARVENTRY	*pe;
+
+	if (U_WOLHSET_EMPTY != i)
+		++ ph->nDuplicates;
+	else
+	{
+		if (ph->nEntries == ph->nAlloc)
+		{
+			if (ph->nAlloc >= 0x40000000)
+				return false;
+			uint32_t nNew	= ph->nAlloc ? 2 * ph->nAlloc : U_WOLHARV_INITIAL_ENTRIES;
+			pe				= reallocWOLharv (ph->pEntries, (size_t) nNew * sizeof (SWOLHARVENTRY));
+			if (NULL == pe)
+				return false;
+			ph->pEntries	= pe;
+			ph->nAlloc		= nNew;
+		}
+		if (!growWOLhset (&ph->setMACs))
+			return false;
+		i = ph->nEntries ++;
+		pe = ph->pEntries + i;
+		memsetU (pe, 0, sizeof (SWOLHARVENTRY));
+		memcpyU (pe->ucMAC, ucMAC, 6);
+		putWOLhset (&ph->setMACs, uiKey, i);
+	}
+	pe = ph->pEntries + i;
+	if (szName && 0 == pe->ofsName && !addWOLharvString (ph, &pe->ofsName, szName, strlenU (szName)))
+		return false;
+	if (szIP && 0 == pe->ofsIP && !addWOLharvString (ph, &pe->ofsIP, szIP, strlenU (szIP)))
+		return false;
+	if (szBrIP && 0 == pe->ofsBrIP && !addWOLharvString (ph, &pe->ofsBrIP, szBrIP, strlenU (szBrIP)))
+		return false;
+	return true;
+}
+
+/*
+	Returns true if ucMAC is a unicast address other than 00-00-00-00-00-00. Incomplete
+	ARP entries have the latter.
+*/
+static bool isWOLharvUnicast (const unsigned char ucMAC [6])
+{
+	return 0 == (ucMAC [0] & 1) && 0 != keyWOLmac (ucMAC);
+}
+
+/*
+	Returns the IP address in the token szTok, NUL-terminated in place, or NULL if szTok
+	is not an IP address. Parentheses around the address are removed. An IPv6 address can
+	have a scope id.
+*/
+static char *ipWOLharvToken (char *szTok)
+{
+	char	sz [U_WAKEONLAN_IPV6_SIZ];
+	char	ucAddr [sizeof (struct in6_addr)];
+	size_t	len;
+	size_t	n;
+
+	if ('(' == szTok [0])
+		++ szTok;
+	len = strlenU (szTok);
+	if (len && ')' == szTok [len - 1])
+		-- len;
+	if (len < 2 || len >= U_WAKEONLAN_IPV6_SIZ)
+		return NULL;
+	for (n = 0; n < len && '%' != szTok [n]; ++ n)
+		sz [n] = szTok [n];
+	sz [n] = '\0';
+	if (1 != inet_pton (AF_INET, sz, ucAddr) && 1 != inet_pton (AF_INET6, sz, ucAddr))
+		return NULL;
+	szTok [len] = '\0';
+	return szTok;
+}
+
+/*
+	Harvests a single line of a source. See harvestWOLfileW () for the formats.
+*/
+static bool harvestWOLlineU8 (SWOLHARVEST *ph, char *szLine)
+{
+	char			*szTok [U_WOLHARV_MAX_TOKENS];
+	unsigned char	ucMAC [6];
+	size_t			nTok	= 0;
+	size_t			iMAC;
+	size_t			len;
+	char			*szName	= NULL;
+	char			*szIP	= NULL;
+
+	while (nTok < U_WOLHARV_MAX_TOKENS && (szTok [nTok] = nextWOLlistTokenU8 (&szLine)))
+		++ nTok;
+	if (0 == nTok || '#' == szTok [0][0])
+		return true;
+	for (iMAC = 0; iMAC < nTok; ++ iMAC)
+	{
+		len = strlenU (szTok [iMAC]);
+		if	(
+					len >= U_WAKEONLAN_MAC_MIN_LEN && len <= U_WAKEONLAN_MAC_MAX_LEN
+				&&	parseWOLmacU8 (ucMAC, szTok [iMAC], len)
+			)
+			break;
+	}
+	if (iMAC == nTok || !isWOLharvUnicast (ucMAC))
+	{	// Headers, incomplete entries, and multicast addresses.
+		++ ph->nIgnored;
+		return true;
+	}
+	if (0 == iMAC)
+	{	// /etc/ethers: the MAC address is followed by a name or an IP address.
+		if (nTok > 1 && NULL == (szIP = ipWOLharvToken (szTok [1])))
+			szName = szTok [1];
+	} else
+	{
+		// arp -a on Linux and BSD: "name (ip) at mac", with "?" if there's no name.
+		bool	bParen	= nTok > 2 && '(' == szTok [1][0];
+		size_t	n;
+		for (n = 0; n < iMAC && NULL == szIP; ++ n)
+			szIP = ipWOLharvToken (szTok [n]);
+		if (bParen && szIP != szTok [0] && '?' != szTok [0][0])
+			szName = szTok [0];
+	}
+	if (szName && '#' == szName [0])
+		szName = NULL;
+	return addWOLharvEntry (ph, ucMAC, szName, szIP, NULL);
+}
+
+void initWOLharvest (SWOLHARVEST *ph)
+{
+	memsetU (ph, 0, sizeof (SWOLHARVEST));
+}
+
+bool harvestWOLfileW (SWOLHARVEST *ph, const wchar_t *wzFile)
+{
+	SLINEREADER		lr;
+	LARGE_INTEGER	liFreq, liStart, liEnd;
+	char			*szLine;
+	size_t			len;
+	bool			bRet	= true;
+
+	if (!openLineReaderW (&lr, wzFile))
+		return false;
+	QueryPerformanceFrequency (&liFreq);
+	QueryPerformanceCounter (&liStart);
+	while (bRet && (szLine = nextLineU8 (&lr, &len)))
+	{
+		ph->nOctets += len + 1;
+		++ ph->nLines;
+		bRet = harvestWOLlineU8 (ph, szLine);
+	}
+	closeLineReader (&lr);
+	QueryPerformanceCounter (&liEnd);
+	ph->uiTicks			+= (uint64_t) (liEnd.QuadPart - liStart.QuadPart);
+	ph->uiTicksPerSec	= (uint64_t) liFreq.QuadPart;
+	if (!bRet)
+		SetLastError (ERROR_NOT_ENOUGH_MEMORY);
+	return bRet;
+}
+
+/*
+	Writes the decimal number ui to sz, which must have space for 11 characters.
+*/
+static void strWOLharvUint32 (char *sz, uint32_t ui)
+{
+	char	c [10];
+	size_t	n	= 0;
+
+	do
+	{
+		c [n ++] = (char) ('0' + ui % 10);
+		ui /= 10;
+	} while (ui);
+	while (n)
+		*sz ++ = c [-- n];
+	*sz = '\0';
+}
+
+bool harvestWOLneighbours (SWOLHARVEST *ph)
+{
+	PMIB_IPNET_TABLE2	pTable	= NULL;
+	size_t				nIfaces;
+	const SWOLIFACE		*pif	= getWOLifaces (&nIfaces);
+	char				szIP [U_WAKEONLAN_IPV6_SIZ];
+	char				szBrIP [U_WAKEONLAN_IPV6_SIZ];
+	bool				bRet	= true;
+	ULONG				n;
+	size_t				i;
+
+	if (NO_ERROR != GetIpNetTable2 (AF_UNSPEC, &pTable))
+	{
+		releaseWOLifaces ();
+		return false;
+	}
+	for (n = 0; bRet && n < pTable->NumEntries; ++ n)
+	{
+		const MIB_IPNET_ROW2 *pr = pTable->Table + n;
+		++ ph->nLines;
+		if	(
+					6 != pr->PhysicalAddressLength
+				||	NlnsUnreachable == pr->State || NlnsIncomplete == pr->State
+				||	!isWOLharvUnicast (pr->PhysicalAddress)
+			)
+		{
+			++ ph->nIgnored;
+			continue;
+		}
+		szBrIP [0] = '\0';
+		if (AF_INET == pr->Address.si_family)
+		{
+			inet_ntop (AF_INET, &pr->Address.Ipv4.sin_addr, szIP, sizeof (szIP));
+			for (i = 0; i < nIfaces; ++ i)
+			{
+				if (pif [i].uiIfIndex == pr->InterfaceIndex)
+				{
+					inet_ntop (AF_INET, &pif [i].inBroadcast, szBrIP, sizeof (szBrIP));
+					break;
+				}
+			}
+		} else
+		if (AF_INET6 == pr->Address.si_family)
+		{
+			inet_ntop (AF_INET6, &pr->Address.Ipv6.sin6_addr, szIP, sizeof (szIP));
+			memcpyU (szBrIP, "ff02::1%", 8);
+			strWOLharvUint32 (szBrIP + 8, pr->InterfaceIndex);
+		} else
+			continue;
+		bRet = addWOLharvEntry (ph, pr->PhysicalAddress, NULL, szIP, szBrIP [0] ? szBrIP : NULL);
+	}
+	releaseWOLifaces ();
+	FreeMibTable (pTable);
+	if (!bRet)
+		SetLastError (ERROR_NOT_ENOUGH_MEMORY);
+	return bRet;
+}
+
+/*
+	A line of the inventory while merging. The fields are relative to ofs. Missing fields
+	are empty.
+*/
+typedef struct swolinvline
+{
+	uint32_t			ofs;								// Into the file.
+	uint32_t			len;								// Without line ending.
+	uint32_t			lenEOL;
+	bool				bRecord;
+	bool				bChanged;
+	bool				bNewMAC;
+	unsigned char		ucNewMAC [6];
+	uint32_t			ofsNewIP;							// Harvest string, or 0.
+	uint32_t			ofsField [U_WOLHARV_FIELDS];
+	uint32_t			lenField [U_WOLHARV_FIELDS];
+} SWOLINVLINE;
+
+/*
+	The inventory file while merging.
+*/
+typedef struct swolharvmerge
+{
+	char				*pFile;
+	uint32_t			lenFile;
+	uint32_t			ofsStart;							// After a UTF-8 BOM.
+	SWOLINVLINE			*pLines;
+	uint32_t			nLines;
+	uint32_t			nLineAlloc;
+	SWOLHSET			setMACs;
+	SWOLHSET			setNames;							// Index nLines + n is entry n.
+	char				*pOut;
+	uint32_t			lenOut;
+	uint32_t			nOutAlloc;
+} SWOLHARVMERGE;
+
+/*
+	Splits a line of the inventory into its fields the same way compileWOLinventoryW ()
+	does, without modifying it.
+*/
+static void splitWOLinvLine (const char *p, SWOLINVLINE *pl)
+{
+	uint32_t i = 0;
+	uint32_t f;
+
+	for (f = 0; f < U_WOLHARV_FIELDS; ++ f)
+	{
+		pl->ofsField [f] = pl->len;
+		pl->lenField [f] = 0;
+		if (i > pl->len)
+			continue;
+		while (i < pl->len && ' ' == p [i])
+			++ i;
+		uint32_t s = i;
+		while (i < pl->len && ',' != p [i] && ';' != p [i] && '\t' != p [i])
+			++ i;
+		uint32_t e = i;
+		while (e > s && ' ' == p [e - 1])
+			-- e;
+		pl->ofsField [f] = s;
+		pl->lenField [f] = e - s;
+		++ i;
+	}
+}
+
+static const char *fieldWOLinvLine (const SWOLHARVMERGE *pm, const SWOLINVLINE *pl, uint32_t f)
+{
+	return pm->pFile + pl->ofs + pl->ofsField [f];
+}
+
+/*
+	Reads the entire inventory file. A file that doesn't exist is empty.
+*/
+static bool readWOLharvInventory (SWOLHARVMERGE *pm, const wchar_t *wzCSV)
+{
+	LARGE_INTEGER	liSize;
+	HANDLE			hFile;
+	DWORD			dwRead;
+	uint32_t		uiRead	= 0;
+
+	hFile = CreateFileW	(
+				wzCSV, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+				FILE_FLAG_SEQUENTIAL_SCAN, NULL
+						);
+	if (INVALID_HANDLE_VALUE == hFile)
+		return ERROR_FILE_NOT_FOUND == GetLastError ();
+	if (!GetFileSizeEx (hFile, &liSize) || liSize.QuadPart > 0x7FFFFFFF)
+	{
+		CloseHandle (hFile);
+		SetLastError (ERROR_NOT_ENOUGH_MEMORY);
+		return false;
+	}
+	pm->lenFile	= (uint32_t) liSize.QuadPart;
+	pm->pFile	= HeapAlloc (GetProcessHeap (), 0, (size_t) pm->lenFile + 1);
+	while (pm->pFile && uiRead < pm->lenFile)
+	{
+		if (!ReadFile (hFile, pm->pFile + uiRead, pm->lenFile - uiRead, &dwRead, NULL) || 0 == dwRead)
+			break;
+		uiRead += dwRead;
+	}
+	CloseHandle (hFile);
+	if (NULL == pm->pFile || uiRead < pm->lenFile)
+	{
+		SetLastError (pm->pFile ? ERROR_READ_FAULT : ERROR_NOT_ENOUGH_MEMORY);
+		return false;
+	}
+	if (pm->lenFile >= 3 && 0 == memcmpU (pm->pFile, "\xEF\xBB\xBF", 3))
+		pm->ofsStart = 3;
+	return true;
+}
+
+/*
+	Splits the inventory file into lines and puts the MAC addresses and names of its records
+	into hash sets.
+*/
+static bool indexWOLharvInventory (SWOLHARVMERGE *pm)
+{
+	uint32_t	ofs		= pm->ofsStart;
+	bool		bFirst	= true;
+
+	while (ofs < pm->lenFile)
+	{
+		if (pm->nLines == pm->nLineAlloc)
+		{
+			uint32_t	nNew	= pm->nLineAlloc ? 2 * pm->nLineAlloc : U_WOLHARV_INITIAL_ENTRIES;
+			SWOLINVLINE	*p		= reallocWOLharv (pm->pLines, (size_t) nNew * sizeof (SWOLINVLINE));
+			if (NULL == p)
+				return false;
+			pm->pLines		= p;
+			pm->nLineAlloc	= nNew;
+		}
+		SWOLINVLINE	*pl	= pm->pLines + pm->nLines;
+		const char	*p	= pm->pFile + ofs;
+		memsetU (pl, 0, sizeof (SWOLINVLINE));
+		pl->ofs		= ofs;
+		pl->len		= (uint32_t) lineLengthU8 (p, pm->lenFile - ofs);
+		pl->lenEOL	= ofs + pl->len < pm->lenFile ? 1 : 0;
+		if (pl->len && '\r' == p [pl->len - 1])
+		{
+			-- pl->len;
+			++ pl->lenEOL;
+		}
+		ofs += pl->len + pl->lenEOL;
+		++ pm->nLines;
+
+		uint32_t i = 0;
+		while (i < pl->len && (' ' == p [i] || '\t' == p [i]))
+			++ i;
+		if (i == pl->len || '#' == p [i] || ';' == p [i])
+			continue;
+		splitWOLinvLine (p, pl);
+		const char	*szName	= fieldWOLinvLine (pm, pl, U_WOLHARV_FIELD_NAME);
+		uint32_t	lenName	= pl->lenField [U_WOLHARV_FIELD_NAME];
+		if (bFirst && isSameWOLname (szName, lenName, "name", 4))
+			continue;
+		bFirst			= false;
+		pl->bRecord		= true;
+		unsigned char ucMAC [6];
+		if	(
+				parseWOLmacU8	(
+					ucMAC, fieldWOLinvLine (pm, pl, U_WOLHARV_FIELD_MAC),
+					pl->lenField [U_WOLHARV_FIELD_MAC]
+								)
+			)
+		{
+			if (!growWOLhset (&pm->setMACs))
+				return false;
+			putWOLhset (&pm->setMACs, keyWOLmac (ucMAC), pm->nLines - 1);
+		}
+		if (lenName)
+		{
+			if (!growWOLhset (&pm->setNames))
+				return false;
+			putWOLhset (&pm->setNames, keyWOLname (szName, lenName), pm->nLines - 1);
+		}
+	}
+	return true;
+}
+
+/*
+	Returns the index of the inventory line, or nLines plus the index of the harvest entry
+	added before, with the name szName, or U_WOLHSET_EMPTY.
+*/
+static uint32_t findWOLharvName	(
+					const SWOLHARVMERGE *pm, const SWOLHARVEST *ph, const char *szName,
+					size_t lenName
+								)
+{
+	uint32_t	uiPos	= U_WOLHSET_EMPTY;
+	uint64_t	uiKey	= keyWOLname (szName, lenName);
+	uint32_t	i;
+
+	while (U_WOLHSET_EMPTY != (i = findWOLhset (&pm->setNames, uiKey, &uiPos)))
+	{
+		if (i < pm->nLines)
+		{
+			const SWOLINVLINE *pl = pm->pLines + i;
+			if	(
+					isSameWOLname	(
+						fieldWOLinvLine (pm, pl, U_WOLHARV_FIELD_NAME),
+						pl->lenField [U_WOLHARV_FIELD_NAME], szName, lenName
+									)
+				)
+				return i;
+		} else
+		{
+			const SWOLHARVENTRY *pe = ph->pEntries + (i - pm->nLines);
+			const char *sz = ph->pStrings + (pe->ofsName ? pe->ofsName : pe->ofsIP);
+			if (isSameWOLname (sz, strlenU (sz), szName, lenName))
+				return i;
+		}
+	}
+	return U_WOLHSET_EMPTY;
+}
+
+static bool outWOLharv (SWOLHARVMERGE *pm, const char *p, size_t len)
+{
+	if ((uint64_t) pm->lenOut + len > 0x7FFFFFFF)
+		return false;
+	if (pm->lenOut + len > pm->nOutAlloc)
+	{
+		uint32_t nNew = pm->nOutAlloc ? pm->nOutAlloc : U_WOLHARV_INITIAL_STRINGS;
+		while (nNew < pm->lenOut + len)
+			nNew *= 2;
+		char *pOut = reallocWOLharv (pm->pOut, nNew);
+		if (NULL == pOut)
+			return false;
+		pm->pOut		= pOut;
+		pm->nOutAlloc	= nNew;
+	}
+	memcpyU (pm->pOut + pm->lenOut, p, len);
+	pm->lenOut += (uint32_t) len;
+	return true;
+}
+
+static bool outWOLharvSz (SWOLHARVMERGE *pm, const char *sz)
+{
+	return outWOLharv (pm, sz, strlenU (sz));
+}
+
+/*
+	Writes the changed line pl with its new MAC address and IP, and with commas as
+	separators. Empty fields at the end are left out.
+*/
+static bool outWOLharvChangedLine (SWOLHARVMERGE *pm, const SWOLHARVEST *ph, const SWOLINVLINE *pl)
+{
+	char		szMAC [U_WAKEONLAN_MAC_SIZ];
+	uint32_t	nFields	= U_WOLHARV_FIELDS;
+	uint32_t	f;
+	bool		bRet	= true;
+
+	if (pl->ofsNewIP)
+		nFields = U_WOLHARV_FIELD_IP + 1;
+	else
+	while (nFields > U_WOLHARV_FIELD_BRIP + 1 && 0 == pl->lenField [nFields - 1])
+		-- nFields;
+	for (f = 0; bRet && f < nFields; ++ f)
+	{
+		if (f)
+			bRet = outWOLharv (pm, ",", 1);
+		if (U_WOLHARV_FIELD_MAC == f && pl->bNewMAC)
+		{
+			strMACfromOctets (szMAC, pl->ucNewMAC);
+			bRet = bRet && outWOLharvSz (pm, szMAC);
+		} else
+		if (U_WOLHARV_FIELD_IP == f && pl->ofsNewIP)
+			bRet = bRet && outWOLharvSz (pm, ph->pStrings + pl->ofsNewIP);
+		else
+			bRet = bRet && outWOLharv (pm, fieldWOLinvLine (pm, pl, f), pl->lenField [f]);
+	}
+	return bRet && outWOLharv (pm, "\r\n", 2);
+}
+
+static bool outWOLharvNewLine (SWOLHARVMERGE *pm, const SWOLHARVEST *ph, const SWOLHARVENTRY *pe, const char *szBrIP)
+{
+	char szMAC [U_WAKEONLAN_MAC_SIZ];
+
+	strMACfromOctets (szMAC, pe->ucMAC);
+	return		outWOLharvSz (pm, ph->pStrings + (pe->ofsName ? pe->ofsName : pe->ofsIP))
+			&&	outWOLharv (pm, ",", 1)
+			&&	outWOLharvSz (pm, szMAC)
+			&&	outWOLharv (pm, ",", 1)
+			&&	outWOLharvSz (pm, pe->ofsBrIP ? ph->pStrings + pe->ofsBrIP : szBrIP)
+			&&	outWOLharv (pm, ",,,", 3)
+			&&	outWOLharvSz (pm, ph->pStrings + pe->ofsIP)
+			&&	outWOLharv (pm, "\r\n", 2);
+}
+
+/*
+	Matches every harvest entry against the inventory and marks changed lines and new
+	entries.
+*/
+static bool matchWOLharvest (SWOLHARVMERGE *pm, SWOLHARVEST *ph)
+{
+	uint32_t e;
+
+	for (e = 0; e < ph->nEntries; ++ e)
+	{
+		SWOLHARVENTRY	*pe		= ph->pEntries + e;
+		uint32_t		uiPos	= U_WOLHSET_EMPTY;
+		uint32_t		i		= findWOLhset (&pm->setMACs, keyWOLmac (pe->ucMAC), &uiPos);
+		bool			bNewMAC	= false;
+		// Hosts without name are named after their IP address.
+		uint32_t		ofsName	= pe->ofsName ? pe->ofsName : pe->ofsIP;
+		const char		*szName	= ph->pStrings + ofsName;
+		size_t			lenName	= strlenU (szName);
+
+		if (U_WOLHSET_EMPTY == i && lenName)
+		{
+			i = findWOLharvName (pm, ph, szName, lenName);
+			if (i >= pm->nLines && U_WOLHSET_EMPTY != i)
+			{	// Another MAC address of this harvest already took the name.
+				++ ph->nDuplicates;
+				continue;
+			}
+			bNewMAC = U_WOLHSET_EMPTY != i;
+		}
+		if (U_WOLHSET_EMPTY != i)
+		{
+			SWOLINVLINE	*pl		= pm->pLines + i;
+			bool		bChange	= bNewMAC;
+			if (bNewMAC)
+			{
+				pl->bNewMAC = true;
+				memcpyU (pl->ucNewMAC, pe->ucMAC, 6);
+			}
+			if	(
+						pe->ofsIP
+					&&	!isSameWOLname	(
+							fieldWOLinvLine (pm, pl, U_WOLHARV_FIELD_IP),
+							pl->lenField [U_WOLHARV_FIELD_IP], ph->pStrings + pe->ofsIP,
+							strlenU (ph->pStrings + pe->ofsIP)
+										)
+				)
+			{
+				pl->ofsNewIP	= pe->ofsIP;
+				bChange			= true;
+			}
+			if (bChange && !pl->bChanged)
+				++ ph->nUpdated;
+			else
+			if (!bChange)
+				++ ph->nUnchanged;
+			pl->bChanged = pl->bChanged || bChange;
+			continue;
+		}
+		if (0 == lenName)
+		{	// Neither name nor IP address, hence no name for the inventory.
+			++ ph->nIgnored;
+			continue;
+		}
+		if (!growWOLhset (&pm->setNames))
+			return false;
+		putWOLhset (&pm->setNames, keyWOLname (szName, lenName), pm->nLines + e);
+		pe->bAdded = true;
+		++ ph->nAdded;
+	}
+	return true;
+}
+
+static bool writeWOLharvHandle (HANDLE hFile, const char *p, uint32_t len)
+{
+	DWORD dwWritten;
+
+	while (len)
+	{
+		if (!WriteFile (hFile, p, len, &dwWritten, NULL) || 0 == dwWritten)
+			return false;
+		p	+= dwWritten;
+		len	-= dwWritten;
+	}
+	return true;
+}
+
+/*
+	Writes the output buffer to a new file next to wzCSV, which then replaces wzCSV.
+*/
+static bool replaceWOLharvInventory (SWOLHARVMERGE *pm, const wchar_t *wzCSV)
+{
+	size_t	len		= strlenW (wzCSV);
+	wchar_t	*wzTmp	= HeapAlloc (GetProcessHeap (), 0, (len + 5) * sizeof (wchar_t));
+	HANDLE	hFile;
+	bool	bRet;
+
+	if (NULL == wzTmp)
+		return false;
+	memcpyU (wzTmp, wzCSV, len * sizeof (wchar_t));
+	memcpyU (wzTmp + len, L".tmp", 5 * sizeof (wchar_t));
+	hFile = CreateFileW	(
+				wzTmp, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+				FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL
+						);
+	bRet = INVALID_HANDLE_VALUE != hFile;
+	if (bRet)
+	{
+		bRet = writeWOLharvHandle (hFile, pm->pOut, pm->lenOut);
+		bRet = CloseHandle (hFile) && bRet;
+		bRet = bRet && MoveFileExW (wzTmp, wzCSV, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+		if (!bRet)
+		{
+			DWORD dwErr = GetLastError ();
+			DeleteFileW (wzTmp);
+			SetLastError (dwErr);
+		}
+	}
+	freeWOLharv (wzTmp);
+	return bRet;
+}
+
+static bool appendWOLharvInventory (SWOLHARVMERGE *pm, const wchar_t *wzCSV)
+{
+	HANDLE	hFile;
+	bool	bRet;
+
+	hFile = CreateFileW	(
+				wzCSV, FILE_APPEND_DATA, FILE_SHARE_READ, NULL, OPEN_ALWAYS,
+				FILE_ATTRIBUTE_NORMAL, NULL
+						);
+	if (INVALID_HANDLE_VALUE == hFile)
+		return false;
+	bRet = writeWOLharvHandle (hFile, pm->pOut, pm->lenOut);
+	return CloseHandle (hFile) && bRet;
+}
+
+bool mergeWOLharvestW (SWOLHARVEST *ph, const wchar_t *wzCSV, const char *szBrIP)
+{
+	SWOLHARVMERGE	m;
+	bool			bRet;
+	uint32_t		n;
+
+	memsetU (&m, 0, sizeof (m));
+	ph->nUnchanged	= 0;
+	ph->nUpdated	= 0;
+	ph->nAdded		= 0;
+	ph->bRewritten	= false;
+	ph->bAppended	= false;
+	if (NULL == szBrIP)
+		szBrIP = U_WOLHARV_DEF_BRIP;
+	bRet =		readWOLharvInventory (&m, wzCSV)
+			&&	indexWOLharvInventory (&m)
+			&&	matchWOLharvest (&m, ph);
+	if (bRet && ph->nUpdated)
+	{	// Unchanged lines are copied as they are.
+		if (m.ofsStart)
+			bRet = outWOLharv (&m, m.pFile, m.ofsStart);
+		for (n = 0; bRet && n < m.nLines; ++ n)
+		{
+			const SWOLINVLINE *pl = m.pLines + n;
+			if (pl->bChanged)
+				bRet = outWOLharvChangedLine (&m, ph, pl);
+			else
+			{
+				bRet = outWOLharv (&m, m.pFile + pl->ofs, pl->len + pl->lenEOL);
+				if (bRet && 0 == pl->lenEOL)
+					bRet = outWOLharv (&m, "\r\n", 2);
+			}
+		}
+	} else
+	if (bRet && ph->nAdded)
+	{
+		if (0 == m.lenFile)
+			bRet = outWOLharvSz (&m, "name,mac,brip,group,port,ip\r\n");
+		else
+		if ('\n' != m.pFile [m.lenFile - 1])
+			bRet = outWOLharv (&m, "\r\n", 2);
+	}
+	for (n = 0; bRet && n < ph->nEntries; ++ n)
+	{
+		if (ph->pEntries [n].bAdded)
+			bRet = outWOLharvNewLine (&m, ph, ph->pEntries + n, szBrIP);
+	}
+	if (bRet && ph->nUpdated)
+		bRet = ph->bRewritten = replaceWOLharvInventory (&m, wzCSV);
+	else
+	if (bRet && ph->nAdded)
+		bRet = ph->bAppended = appendWOLharvInventory (&m, wzCSV);
+	else
+	if (!bRet && ERROR_SUCCESS == GetLastError ())
+		SetLastError (ERROR_NOT_ENOUGH_MEMORY);
+	freeWOLharv (m.pFile);
+	freeWOLharv (m.pLines);
+	freeWOLharv (m.pOut);
+	doneWOLhset (&m.setMACs);
+	doneWOLhset (&m.setNames);
+	return bRet;
+}
+
+void doneWOLharvest (SWOLHARVEST *ph)
+{
+	freeWOLharv (ph->pEntries);
+	freeWOLharv (ph->pStrings);
+	doneWOLhset (&ph->setMACs);
+	memsetU (ph, 0, sizeof (SWOLHARVEST));
+}
@@ -0,0 +1,204 @@
+/****************************************************************************************
+
+File		WakeOnLANHarvest.h
+Why:		Harvests MAC addresses from ethers files and neighbour tables into the inventory.
+OS:			Windows
+Created:	2026-10-17
+
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2026-10-17	Thomas			Created.
+
+****************************************************************************************/
+
+/*
+	This file is maintained as part of OnOffMate. See https://github.com/ThomasPGH/OnOffMate .
+*/
+
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Copyright (c) 2024, 2025, 2026 Thomas
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#ifndef U_WAKEONLANHARVEST_H
+#define U_WAKEONLANHARVEST_H
+
+#include <stdbool.h>
+#include <inttypes.h>
+#include <Winsock2.h>
+#include <ws2tcpip.h>
+#include "./externC.h"
+
+/*
+	The default broadcast IP of hosts added to the inventory whose subnet is unknown.
+*/
+#define U_WOLHARV_DEF_BRIP				"auto"
+
+/*
+	SWOLHARVENTRY
+
+	A MAC address found by harvestWOLfileW () or harvestWOLneighbours (), with the name and
+	the IP address of its host if the source had them. The string offsets point into the
+	string pool of the harvest and are 0 if there's no such string.
+*/
+typedef struct swolharventry
+{
+	unsigned char		ucMAC [6];
+	bool				bAdded;								// Set by mergeWOLharvestW ().
+	uint32_t			ofsName;
+	uint32_t			ofsIP;
+	uint32_t			ofsBrIP;							// Broadcast IP if known.
+} SWOLHARVENTRY;
+
+/*
+	SWOLHSLOT, SWOLHSET
+
+	An open addressing hash set of 64 bit keys with linear probing. Each slot stores the
+	key and the index of its element. The set is grown when it's half full.
+*/
+typedef struct swolhslot
+{
+	uint64_t			uiKey;
+	uint32_t			uiIdx;								// U_WOLHSET_EMPTY if unused.
+} SWOLHSLOT;
+
+#define U_WOLHSET_EMPTY					((uint32_t) -1)
+
+typedef struct swolhset
+{
+	SWOLHSLOT			*pSlots;
+	uint32_t			uiMask;								// Slots - 1.
+	uint32_t			nUsed;
+} SWOLHSET;
+
+/*
+	SWOLHARVEST
+
+	The MAC addresses of a harvest, deduplicated with a hash set on the MAC address, and
+	its statistics. Initialise it with initWOLharvest () and release it with
+	doneWOLharvest ().
+*/
+typedef struct swolharvest
+{
+	SWOLHARVENTRY		*pEntries;
+	uint32_t			nEntries;
+	uint32_t			nAlloc;
+	char				*pStrings;
+	uint32_t			lenStrings;
+	uint32_t			nStrAlloc;
+	SWOLHSET			setMACs;
+	uint64_t			nLines;								// Lines of all sources.
+	uint64_t			nOctets;							// Octets of all sources.
+	uint64_t			nDuplicates;						// MAC addresses seen before.
+	uint64_t			nIgnored;							// Lines without MAC address.
+	uint64_t			uiTicks;							// Performance counter ticks reading.
+	uint64_t			uiTicksPerSec;
+	uint32_t			nUnchanged;							// Set by mergeWOLharvestW ().
+	uint32_t			nUpdated;
+	uint32_t			nAdded;
+	bool				bRewritten;							// Inventory rewritten.
+	bool				bAppended;							// Records appended only.
+} SWOLHARVEST;
+
+EXTERN_C_BEGIN
+
+/*
+	initWOLharvest
+
+	Initialises the harvest ph points to.
+*/
+void initWOLharvest (SWOLHARVEST *ph)
+;
+
+/*
+	harvestWOLfileW
+
+	Reads the MAC addresses from the file wzFile, or from standard input if wzFile is "-",
+	and adds them to the harvest. The format of every line is detected on its own, so
+	that dumps of several kinds can be concatenated. Recognised are:
+
+	00:11:22:33:44:55 build-07						/etc/ethers (name or IP address)
+	192.168.0.97 0x1 0x2 00:11:22:33:44:55 * eth0	/proc/net/arp
+	192.168.0.97 dev eth0 lladdr 00:11:22:33:44:55	ip neigh (netlink neighbour dump)
+	build-07 (192.168.0.97) at 00:11:22:33:44:55	arp -a on Linux and BSD
+	192.168.0.97 00-11-22-33-44-55 dynamic			arp -a on Windows
+
+	Every line is split in place, in a single pass over the line reader's buffer, without
+	any allocation per line. Lines without MAC address, like headers and incomplete
+	entries, and the MAC addresses 00-00-00-00-00-00 and multicast and broadcast addresses
+	are ignored. A MAC address that is already in the harvest only fills in a name or IP
+	address the earlier entry didn't have.
+
+	The function returns false if the file cannot be opened or an out of memory condition
+	occurs. Call GetLastError () for more information.
+*/
+bool harvestWOLfileW (SWOLHARVEST *ph, const wchar_t *wzFile)
+;
+
+/*
+	harvestWOLneighbours
+
+	Adds the MAC addresses of the local neighbour (ARP and NDP) table to the harvest, which
+	is the Windows equivalent of a netlink neighbour dump. IPv4 entries get the broadcast
+	address of the interface they were learned on. See getWOLifaces (). IPv6 entries get
+	the all-nodes multicast address with the interface as scope id. The function returns
+	false if the table cannot be read.
+*/
+bool harvestWOLneighbours (SWOLHARVEST *ph)
+;
+
+/*
+	mergeWOLharvestW
+
+	Merges the harvest into the inventory CSV file wzCSV. See compileWOLinventoryW () for
+	its format. A host whose MAC address is in the inventory gets the harvested IP address
+	as its ip field if it differs. A host whose name is in the inventory with a different
+	MAC address gets the harvested MAC address. All other hosts are added with their name,
+	or their IP address if they have no name, and their broadcast IP, or szBrIP if it's
+	unknown.
+
+	Only changed records are rewritten. If no record changed, the new records are appended
+	to the file. Otherwise a new file is written and replaces the old one, with all other
+	lines, including comments, copied unchanged. The file is created if it doesn't exist.
+
+	The function returns false if the file cannot be read or written, or an out of memory
+	condition occurs. Call GetLastError () for more information.
+*/
+bool mergeWOLharvestW (SWOLHARVEST *ph, const wchar_t *wzCSV, const char *szBrIP)
+;
+
+/*
+	doneWOLharvest
+
+	Releases the resources of the harvest.
+*/
+void doneWOLharvest (SWOLHARVEST *ph)
+;
+
+EXTERN_C_END
+
+#endif														// Of #ifndef U_WAKEONLANHARVEST_H.
@@ -0,0 +1,233 @@
+/****************************************************************************************
+
+File		WakeOnLANIfaces.c
+Why:		Cached table of local interfaces and their broadcast addresses.
+OS:			Windows
+Created:	2026-10-17
+
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2026-10-17	Thomas			Created.
+2026-10-17	Thomas			Table protected by an SRW lock. Function releaseWOLifaces () added.
+
+****************************************************************************************/
+
+/*
+	This file is maintained as part of OnOffMate. See https://github.com/ThomasPGH/OnOffMate .
+*/
+
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Copyright (c) 2024, 2025, 2026 Thomas
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "./WakeOnLANIfaces.h"
+#include <Windows.h>
+#include <iphlpapi.h>
+#include "./WinRuntimeReplacements.h"
+
+#pragma comment (lib, "Iphlpapi.lib")
+
+static SWOLIFACE		*pWOLifaces;
+static size_t			nWOLifaces;
+static size_t			nWOLifAlloc;
+static uint64_t			nWOLifRefreshes;
+static volatile LONG	lWOLifStale		= 1;
+static HANDLE			hWOLifNotify;
+
+/*
+	Readers hold the lock shared from getWOLifaces () until releaseWOLifaces (). The table
+	is only rebuilt with the lock held exclusively, which waits until all readers are done.
+*/
+static SRWLOCK			srwWOLifaces	= SRWLOCK_INIT;
+
+/*
+	Called by Windows on a thread of its own when a unicast address is added, changed,
+	or deleted.
+*/
+static VOID WINAPI onWOLifaceChange	(
+						PVOID pCallerContext, PMIB_UNICASTIPADDRESS_ROW pRow,
+						MIB_NOTIFICATION_TYPE NotificationType
+									)
+{
+	UNREFERENCED_PARAMETER (pCallerContext);
+	UNREFERENCED_PARAMETER (pRow);
+	UNREFERENCED_PARAMETER (NotificationType);
+	InterlockedExchange (&lWOLifStale, 1);
+}
+
+/*
+	Returns an entry appended to the table, or NULL if the table couldn't be extended.
+*/
+static SWOLIFACE *appendWOLiface (void)
+{
+	if (nWOLifaces == nWOLifAlloc)
+	{
+		size_t		nNew	= nWOLifAlloc ? 2 * nWOLifAlloc : 16;
+		SWOLIFACE	*pi;
+		if (pWOLifaces)
+			pi = HeapReAlloc (GetProcessHeap (), 0, pWOLifaces, nNew * sizeof (SWOLIFACE));
+		else
+			pi = HeapAlloc (GetProcessHeap (), 0, nNew * sizeof (SWOLIFACE));
+		if (NULL == pi)
+			return NULL;
+		pWOLifaces	= pi;
+		nWOLifAlloc	= nNew;
+	}
+	return pWOLifaces + nWOLifaces ++;
+}
+
+/*
+	Returns true if the table already contains the broadcast address of pi for the same
+	interface, which happens when an interface has several addresses in one subnet.
+*/
+static bool hasWOLiface (const SWOLIFACE *pi)
+{
+	size_t n;
+
+	for (n = 0; n < nWOLifaces; ++ n)
+	{
+		if	(
+					pWOLifaces [n].uiIfIndex == pi->uiIfIndex
+				&&	pWOLifaces [n].inBroadcast.s_addr == pi->inBroadcast.s_addr
+			)
+			return true;
+	}
+	return false;
+}
+
+/*
+	Enumerates the interfaces and rebuilds the table.
+*/
+static void enumWOLifaces (void)
+{
+	PIP_ADAPTER_ADDRESSES	paa		= NULL;
+	PIP_ADAPTER_ADDRESSES	pa;
+	ULONG					ulSize	= 16 * 1024;
+	ULONG					ulRet;
+
+	nWOLifaces = 0;
+	++ nWOLifRefreshes;
+	do
+	{
+		if (paa)
+			HeapFree (GetProcessHeap (), 0, paa);
+		paa = HeapAlloc (GetProcessHeap (), 0, ulSize);
+		if (NULL == paa)
+			return;
+		ulRet = GetAdaptersAddresses	(
+					AF_INET,
+						GAA_FLAG_SKIP_ANYCAST | GAA_FLAG_SKIP_MULTICAST
+					|	GAA_FLAG_SKIP_DNS_SERVER,
+					NULL, paa, &ulSize
+										);
+	} while (ERROR_BUFFER_OVERFLOW == ulRet);
+
+	for (pa = ERROR_SUCCESS == ulRet ? paa : NULL; pa; pa = pa->Next)
+	{
+		PIP_ADAPTER_UNICAST_ADDRESS pu;
+
+		if (IfOperStatusUp != pa->OperStatus || IF_TYPE_SOFTWARE_LOOPBACK == pa->IfType)
+			continue;
+		for (pu = pa->FirstUnicastAddress; pu; pu = pu->Next)
+		{
+			UCHAR uiPfx = pu->OnLinkPrefixLength;
+			if (AF_INET != pu->Address.lpSockaddr->sa_family || 0 == uiPfx || uiPfx > 30)
+				continue;
+
+			SWOLIFACE	wi;
+			ULONG		ulMask	= htonl (0xFFFFFFFFul << (32 - uiPfx));
+			wi.uiIfIndex			= pa->IfIndex;
+			wi.inLocal				= ((struct sockaddr_in *) pu->Address.lpSockaddr)->sin_addr;
+			wi.inBroadcast.s_addr	= wi.inLocal.s_addr | ~ulMask;
+			wi.uiPrefixLen			= uiPfx;
+			if (hasWOLiface (&wi))
+				continue;
+			SWOLIFACE *pi = appendWOLiface ();
+			if (NULL == pi)
+				break;
+			memcpyU (pi, &wi, sizeof (SWOLIFACE));
+		}
+	}
+	HeapFree (GetProcessHeap (), 0, paa);
+}
+
+/*
+	Returns true if the table needs to be enumerated (again).
+*/
+static bool isWOLifaceTableStale (void)
+{
+	// Without notifications we cannot know when the table is out of date.
+	return 0 != lWOLifStale || NULL == hWOLifNotify;
+}
+
+const SWOLIFACE *getWOLifaces (size_t *pnIfaces)
+{
+	AcquireSRWLockShared (&srwWOLifaces);
+	if (isWOLifaceTableStale ())
+	{
+		// SRW locks cannot be upgraded. Another thread may refresh in between.
+		ReleaseSRWLockShared (&srwWOLifaces);
+		AcquireSRWLockExclusive (&srwWOLifaces);
+		if	(
+					NULL == hWOLifNotify
+				&&	NO_ERROR != NotifyUnicastIpAddressChange	(
+									AF_INET, onWOLifaceChange, NULL, FALSE, &hWOLifNotify
+																)
+			)
+			hWOLifNotify = NULL;
+		if (InterlockedExchange (&lWOLifStale, 0) || NULL == hWOLifNotify)
+			enumWOLifaces ();
+		ReleaseSRWLockExclusive (&srwWOLifaces);
+		AcquireSRWLockShared (&srwWOLifaces);
+	}
+	*pnIfaces = nWOLifaces;
+	return nWOLifaces ? pWOLifaces : NULL;
+}
+
+void releaseWOLifaces (void)
+{
+	ReleaseSRWLockShared (&srwWOLifaces);
+}
+
+uint64_t refreshesWOLifaces (void)
+{
+	return nWOLifRefreshes;
+}
+
+void doneWOLifaces (void)
+{
+	AcquireSRWLockExclusive (&srwWOLifaces);
+	if (hWOLifNotify)
+		CancelMibChangeNotify2 (hWOLifNotify);
+	hWOLifNotify = NULL;
+	if (pWOLifaces)
+		HeapFree (GetProcessHeap (), 0, pWOLifaces);
+	pWOLifaces	= NULL;
+	nWOLifaces	= 0;
+	nWOLifAlloc	= 0;
+	InterlockedExchange (&lWOLifStale, 1);
+	ReleaseSRWLockExclusive (&srwWOLifaces);
+}
@@ -0,0 +1,118 @@
+/****************************************************************************************
+
+File		WakeOnLANIfaces.h
+Why:		Cached table of local interfaces and their broadcast addresses.
+OS:			Windows
+Created:	2026-10-17
+
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2026-10-17	Thomas			Created.
+2026-10-17	Thomas			Thread-safe. Function releaseWOLifaces () added.
+
+****************************************************************************************/
+
+/*
+	This file is maintained as part of OnOffMate. See https://github.com/ThomasPGH/OnOffMate .
+*/
+
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Copyright (c) 2024, 2025, 2026 Thomas
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef U_WAKEONLANIFACES_H
+#define U_WAKEONLANIFACES_H
+
+#include <stdbool.h>
+#include <inttypes.h>
+#include <Winsock2.h>
+#include <ws2tcpip.h>
+#include "./externC.h"
+
+EXTERN_C_BEGIN
+
+/*
+	SWOLIFACE
+
+	An IPv4 address of a local interface that is up, and the broadcast address of its
+	subnet.
+*/
+typedef struct swoliface
+{
+	ULONG						uiIfIndex;
+	struct in_addr				inLocal;
+	struct in_addr				inBroadcast;
+	UCHAR						uiPrefixLen;
+} SWOLIFACE;
+
+/*
+	getWOLifaces
+
+	Returns the table of local IPv4 interfaces that can send broadcasts, and stores the
+	amount of entries at pnIfaces. Loopback interfaces, interfaces that are not up, and
+	addresses with a prefix longer than 30 bits are left out.
+
+	The interfaces are only enumerated on the first call and after Windows reported an
+	address change. All other calls return the cached table. The function returns NULL
+	and stores 0 at pnIfaces if no interface is eligible or the enumeration failed.
+
+	The function is thread-safe. It holds a shared lock on the table, which keeps the
+	table valid and unchanged until the caller calls releaseWOLifaces (). Every call must
+	be paired with a call of releaseWOLifaces (), also if it returned NULL. Don't call
+	getWOLifaces () again before, since a refresh by another thread could then deadlock.
+*/
+const SWOLIFACE *getWOLifaces (size_t *pnIfaces)
+;
+
+/*
+	releaseWOLifaces
+
+	Releases the lock getWOLifaces () holds on the table. The table must not be accessed
+	afterwards.
+*/
+void releaseWOLifaces (void)
+;
+
+/*
+	refreshesWOLifaces
+
+	Returns how often the interfaces have been enumerated so far.
+*/
+uint64_t refreshesWOLifaces (void)
+;
+
+/*
+	doneWOLifaces
+
+	Stops listening for address changes and frees the table. It waits for all callers of
+	getWOLifaces () to call releaseWOLifaces () first.
+*/
+void doneWOLifaces (void)
+;
+
+EXTERN_C_END
+
+#endif														// Of #ifndef U_WAKEONLANIFACES_H.
@@ -0,0 +1,966 @@
+/****************************************************************************************
+
+File		WakeOnLANInventory.c
+Why:		Compiled host inventory database with a perfect hash index.
+OS:			Windows
+Created:	2026-10-17
+
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2026-10-17	Thomas			Created.
+2026-10-17	Thomas			IP prefix index.
+
+****************************************************************************************/
+
+/*
+	This file is maintained as part of OnOffMate. See https://github.com/ThomasPGH/OnOffMate .
+*/
+
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Copyright (c) 2024, 2025, 2026 Thomas
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#ifndef _WINSOCK_DEPRECATED_NO_WARNINGS
+#define _WINSOCK_DEPRECATED_NO_WARNINGS
+#endif
+
+#include "./WakeOnLANInventory.h"
+#include <Windows.h>
+#include "./WinRuntimeReplacements.h"
+#include "./WinLineReader.h"
+#include "./WakeOnLANMAC.h"
+
+/*
+	Gives up searching for a displacement of a bucket after this many attempts. With
+	buckets of a few keys each, a displacement is usually found within a few hundred.
+*/
+#ifndef U_WOLINV_MAX_DISPLACEMENT
+#define U_WOLINV_MAX_DISPLACEMENT		(0x01000000)
+#endif
+
+/*
+	The amount of records and string pool octets reserved initially when compiling.
+*/
+#ifndef U_WOLINV_INITIAL_RECORDS
+#define U_WOLINV_INITIAL_RECORDS		(1024)
+#endif
+#ifndef U_WOLINV_INITIAL_STRINGS
+#define U_WOLINV_INITIAL_STRINGS		(16384)
+#endif
+
+#define U_WOLINV_NONE					((uint32_t) -1)
+
+static inline unsigned char lowerWOLinvChar (unsigned char c)
+{
+	return c >= 'A' && c <= 'Z' ? c | 0x20 : c;
+}
+
+/*
+	FNV-1a of the ASCII lowercase name, with the displacement d as seed, followed by the
+	finaliser of MurmurHash3 to spread the seeds' results. A displacement of 0 gives the
+	hash that selects the bucket.
+*/
+static uint32_t hashWOLinvName (uint32_t d, const char *szName, size_t lenName)
+{
+	uint32_t	h	= 0x811C9DC5 ^ d;
+	size_t		n;
+
+	for (n = 0; n < lenName; ++ n)
+	{
+		h ^= lowerWOLinvChar ((unsigned char) szName [n]);
+		h *= 0x01000193;
+	}
+	h ^= h >> 16;
+	h *= 0x85EBCA6B;
+	h ^= h >> 13;
+	h *= 0xC2B2AE35;
+	h ^= h >> 16;
+	return h;
+}
+
+/*
+	Returns true if the NUL-terminated string sz is the lenName octets at szName, ignoring
+	the case of ASCII letters.
+*/
+static bool isWOLinvName (const char *sz, const char *szName, size_t lenName)
+{
+	size_t n;
+
+	for (n = 0; n < lenName; ++ n)
+	{
+		if	(
+					'\0' == sz [n]
+				||	lowerWOLinvChar ((unsigned char) sz [n])
+						!= lowerWOLinvChar ((unsigned char) szName [n])
+			)
+			return false;
+	}
+	return '\0' == sz [lenName];
+}
+
+/*
+	The state of compileWOLinventoryW ().
+*/
+typedef struct swolinvbuild
+{
+	SWOLINVRECORD		*pRecs;
+	uint32_t			nRecs;
+	uint32_t			nRecAlloc;
+	char				*pStrings;
+	uint32_t			lenStrings;
+	uint32_t			nStrAlloc;
+} SWOLINVBUILD;
+
+static void *reallocWOLinv (void *p, size_t size)
+{
+	if (p)
+		return HeapReAlloc (GetProcessHeap (), 0, p, size);
+	return HeapAlloc (GetProcessHeap (), 0, size);
+}
+
+static void freeWOLinv (void *p)
+{
+	if (p)
+		HeapFree (GetProcessHeap (), 0, p);
+}
+
+/*
+	Appends a new record to pb and returns it, or returns NULL if pb couldn't be extended.
+*/
+static SWOLINVRECORD *newWOLinvRecord (SWOLINVBUILD *pb)
+{
+	if (pb->nRecs == pb->nRecAlloc)
+	{
+		if (pb->nRecAlloc >= 0x40000000)
+			return NULL;
+		uint32_t		nNew	= pb->nRecAlloc ? 2 * pb->nRecAlloc : U_WOLINV_INITIAL_RECORDS;
+		SWOLINVRECORD	*pr		= reallocWOLinv (pb->pRecs, (size_t) nNew * sizeof (SWOLINVRECORD));
+		if (NULL == pr)
+			return NULL;
+		pb->pRecs		= pr;
+		pb->nRecAlloc	= nNew;
+	}
+	SWOLINVRECORD *pr = pb->pRecs + pb->nRecs;
+	memsetU (pr, 0, sizeof (SWOLINVRECORD));
+	return pr;
+}
+
+/*
+	Adds the string sz to the string pool of pb and stores its offset at pofs. The empty
+	string is not added but is at offset 0. The function returns false if the pool couldn't
+	be extended.
+*/
+static bool addWOLinvString (SWOLINVBUILD *pb, uint32_t *pofs, const char *sz)
+{
+	size_t len = strlenU (sz);
+
+	if (0 == len)
+	{
+		*pofs = 0;
+		return true;
+	}
+	if ((uint64_t) pb->lenStrings + len + 1 > 0x7FFFFFFF)
+		return false;
+	if (pb->lenStrings + len + 1 > pb->nStrAlloc)
+	{
+		uint32_t nNew = pb->nStrAlloc ? pb->nStrAlloc : U_WOLINV_INITIAL_STRINGS;
+		while (nNew < pb->lenStrings + len + 1)
+			nNew *= 2;
+		char *p = reallocWOLinv (pb->pStrings, nNew);
+		if (NULL == p)
+			return false;
+		pb->pStrings	= p;
+		pb->nStrAlloc	= nNew;
+	}
+	*pofs = pb->lenStrings;
+	memcpyU (pb->pStrings + pb->lenStrings, sz, len + 1);
+	pb->lenStrings += (uint32_t) (len + 1);
+	return true;
+}
+
+/*
+	Returns the next field of a CSV line, with surrounding spaces removed and NUL-
+	terminated in place, or NULL if the line has no more fields. Unlike
+	nextWOLlistTokenU8 (), two consecutive separators enclose an empty field.
+*/
+static char *nextWOLinvFieldU8 (char **sz)
+{
+	char *p = *sz;
+
+	if (NULL == p)
+		return NULL;
+	while (' ' == *p)
+		++ p;
+	char *f = p;
+	while (*p && ',' != *p && ';' != *p && '\t' != *p)
+		++ p;
+	char *e = p;
+	*sz = *p ? p + 1 : NULL;
+	while (e > f && ' ' == e [-1])
+		-- e;
+	*e = '\0';
+	return f;
+}
+
+static bool isWOLinvFieldEmpty (const char *sz)
+{
+	return NULL == sz || '\0' == sz [0];
+}
+
+/*
+	Parses the decimal port number sz. An empty field is port 0, which means the send
+	policy decides.
+*/
+static bool parseWOLinvPort (uint16_t *puiPort, const char *sz)
+{
+	uint32_t ui = 0;
+
+	*puiPort = 0;
+	if (isWOLinvFieldEmpty (sz))
+		return true;
+	while (*sz)
+	{
+		if (*sz < '0' || *sz > '9')
+			return false;
+		ui = ui * 10 + (uint32_t) (*sz - '0');
+		if (ui > 0xFFFF)
+			return false;
+		++ sz;
+	}
+	*puiPort = (uint16_t) ui;
+	return true;
+}
+
+/*
+	Parses the address of the host itself into the record.
+*/
+static bool parseWOLinvHost (SWOLINVRECORD *pr, const char *szIP)
+{
+	struct sockaddr_in	si;
+	struct sockaddr_in6	si6;
+
+	if (isWOLinvFieldEmpty (szIP))
+		return true;
+	memsetU (&si, 0, sizeof (si));
+	memsetU (&si6, 0, sizeof (si6));
+	if (1 == inet_pton (AF_INET, szIP, &si.sin_addr))
+	{
+		si.sin_family	= AF_INET;
+		pr->lenHost		= sizeof (si);
+		memcpyU (pr->ucHost, &si, sizeof (si));
+	} else
+	if (1 == inet_pton (AF_INET6, szIP, &si6.sin6_addr))
+	{
+		si6.sin6_family	= AF_INET6;
+		pr->lenHost		= sizeof (si6);
+		memcpyU (pr->ucHost, &si6, sizeof (si6));
+	}
+	return 0 != pr->lenHost;
+}
+
+static bool isWOLinvAutoU8 (const char *sz)
+{
+	return		4 == strlenU (sz)
+			&&	'a' == (sz [0] | 0x20) && 'u' == (sz [1] | 0x20)
+			&&	't' == (sz [2] | 0x20) && 'o' == (sz [3] | 0x20);
+}
+
+/*
+	Parses a line of the CSV file into a new record of pb. The function returns wolinvOk
+	and sets *pbRecord to false for lines without a record.
+*/
+static enum eWOLinvRet parseWOLinvLineU8	(
+							SWOLINVBUILD *pb, char *szLine, bool bFirst, bool *pbRecord
+											)
+{
+	char *p = szLine;
+
+	*pbRecord = false;
+	while (' ' == *p || '\t' == *p)
+		++ p;
+	if ('\0' == *p || '#' == *p || ';' == *p)
+		return wolinvOk;
+	char *szName	= nextWOLinvFieldU8 (&p);
+	char *szMAC		= nextWOLinvFieldU8 (&p);
+	char *szBrIP	= nextWOLinvFieldU8 (&p);
+	char *szGroup	= nextWOLinvFieldU8 (&p);
+	char *szPort	= nextWOLinvFieldU8 (&p);
+	char *szIP		= nextWOLinvFieldU8 (&p);
+	if (bFirst && isWOLinvName ("name", szName, strlenU (szName)))
+		return wolinvOk;
+	if (isWOLinvFieldEmpty (szName))
+		return wolinvMissingName;
+
+	SWOLINVRECORD *pr = newWOLinvRecord (pb);
+	if (NULL == pr)
+		return wolinvErrMemory;
+	if (isWOLinvFieldEmpty (szMAC) || !parseWOLmacU8 (pr->ucMAC, szMAC, strlenU (szMAC)))
+		return wolinvSyntaxMAC;
+	if (!parseWOLinvPort (&pr->uiPort, szPort))
+		return wolinvSyntaxPort;
+	if (isWOLinvFieldEmpty (szBrIP))
+		return wolinvSyntaxHst;
+	if (isWOLinvAutoU8 (szBrIP))
+		pr->uiFlags |= U_WOLINV_FLAG_AUTO;
+	else
+	{
+		struct sockaddr_storage	ss;
+		int						len;
+		if (!parseWOLpeerU8 (&ss, &len, szBrIP, false) || len > (int) sizeof (pr->ucPeer))
+			return wolinvSyntaxHst;
+		// sin_port and sin6_port are at the same offset.
+		if (pr->uiPort)
+			((struct sockaddr_in *) &ss)->sin_port = htons (pr->uiPort);
+		memcpyU (pr->ucPeer, &ss, (size_t) len);
+		pr->lenPeer = (uint8_t) len;
+	}
+	if (!parseWOLinvHost (pr, szIP))
+		return wolinvSyntaxIP;
+	if	(
+				!addWOLinvString (pb, &pr->ofsName, szName)
+			||	!addWOLinvString (pb, &pr->ofsBroadcast, szBrIP)
+			||	!addWOLinvString (pb, &pr->ofsGroup, szGroup ? szGroup : "")
+		)
+		return wolinvErrMemory;
+	++ pb->nRecs;
+	*pbRecord = true;
+	return wolinvOk;
+}
+
+/*
+	Searches the minimal perfect hash for the records of pb (hash and displace). Every
+	record is put into the bucket of its hash with displacement 0. Starting with the
+	largest bucket, each bucket with more than one record gets the smallest displacement
+	that moves all its records to free slots. Buckets with a single record get the next
+	free slot directly, stored as -(slot + 1). Empty buckets keep 0. The slot of every
+	record is stored at puiSlots, its displacement at piDisp. Both have space for nRecs
+	elements.
+*/
+static enum eWOLinvRet searchWOLinvHash	(
+							const SWOLINVBUILD *pb, int32_t *piDisp, uint32_t *puiSlots,
+							uint32_t *puiMaxDisp
+										)
+{
+	uint32_t		n			= pb->nRecs;
+	uint32_t		*puiHead	= HeapAlloc (GetProcessHeap (), 0, (size_t) n * sizeof (uint32_t));
+	uint32_t		*puiNext	= HeapAlloc (GetProcessHeap (), 0, (size_t) n * sizeof (uint32_t));
+	uint32_t		*puiSize	= HeapAlloc (GetProcessHeap (), HEAP_ZERO_MEMORY, (size_t) n * sizeof (uint32_t));
+	uint32_t		*puiMark	= HeapAlloc (GetProcessHeap (), HEAP_ZERO_MEMORY, (size_t) n * sizeof (uint32_t));
+	bool			*pbUsed		= HeapAlloc (GetProcessHeap (), HEAP_ZERO_MEMORY, (size_t) n * sizeof (bool));
+	enum eWOLinvRet	ret			= wolinvOk;
+	uint32_t		uiMaxSize	= 0;
+	uint32_t		uiTry		= 0;
+	uint32_t		uiFree		= 0;
+	uint32_t		b, r, s;
+
+	*puiMaxDisp = 0;
+	if (NULL == puiHead || NULL == puiNext || NULL == puiSize || NULL == puiMark || NULL == pbUsed)
+	{
+		ret = wolinvErrMemory;
+		goto done;
+	}
+	for (b = 0; b < n; ++ b)
+	{
+		puiHead [b]	= U_WOLINV_NONE;
+		piDisp [b]	= 0;
+	}
+	for (r = 0; r < n; ++ r)
+	{
+		const char *sz = pb->pStrings + pb->pRecs [r].ofsName;
+		b = hashWOLinvName (0, sz, strlenU (sz)) % n;
+		puiNext [r] = puiHead [b];
+		puiHead [b] = r;
+		if (++ puiSize [b] > uiMaxSize)
+			uiMaxSize = puiSize [b];
+	}
+	// Buckets with several records, largest first.
+	for (s = uiMaxSize; s > 1; -- s)
+	{
+		for (b = 0; b < n; ++ b)
+		{
+			if (s != puiSize [b])
+				continue;
+			// The same name always ends up in the same bucket.
+			for (r = puiHead [b]; U_WOLINV_NONE != r; r = puiNext [r])
+			{
+				const char	*sz	= pb->pStrings + pb->pRecs [r].ofsName;
+				uint32_t	o;
+				for (o = puiNext [r]; U_WOLINV_NONE != o; o = puiNext [o])
+				{
+					if (isWOLinvName (pb->pStrings + pb->pRecs [o].ofsName, sz, strlenU (sz)))
+					{
+						ret = wolinvDuplicate;
+						puiSlots [0] = o > r ? o : r;
+						goto done;
+					}
+				}
+			}
+			uint32_t d;
+			for (d = 1; d < U_WOLINV_MAX_DISPLACEMENT; ++ d)
+			{
+				bool bFits = true;
+				++ uiTry;
+				for (r = puiHead [b]; bFits && U_WOLINV_NONE != r; r = puiNext [r])
+				{
+					const char *sz = pb->pStrings + pb->pRecs [r].ofsName;
+					puiSlots [r] = hashWOLinvName (d, sz, strlenU (sz)) % n;
+					if (pbUsed [puiSlots [r]] || uiTry == puiMark [puiSlots [r]])
+						bFits = false;
+					else
+						puiMark [puiSlots [r]] = uiTry;
+				}
+				if (bFits)
+					break;
+			}
+			if (U_WOLINV_MAX_DISPLACEMENT == d)
+			{
+				ret = wolinvTooBig;
+				goto done;
+			}
+			for (r = puiHead [b]; U_WOLINV_NONE != r; r = puiNext [r])
+				pbUsed [puiSlots [r]] = true;
+			piDisp [b] = (int32_t) d;
+			if (d > *puiMaxDisp)
+				*puiMaxDisp = d;
+		}
+	}
+	// Buckets with a single record take the remaining slots in order.
+	for (b = 0; b < n; ++ b)
+	{
+		if (1 != puiSize [b])
+			continue;
+		while (pbUsed [uiFree])
+			++ uiFree;
+		pbUsed [uiFree]				= true;
+		puiSlots [puiHead [b]]		= uiFree;
+		piDisp [b]					= - (int32_t) uiFree - 1;
+	}
+done:
+	freeWOLinv (puiHead);
+	freeWOLinv (puiNext);
+	freeWOLinv (puiSize);
+	freeWOLinv (puiMark);
+	freeWOLinv (pbUsed);
+	return ret;
+}
+
+bool keyWOLinventoryIP (unsigned char ucKey [16], const void *pAddr)
+{
+	const struct sockaddr *psa = pAddr;
+
+	if (AF_INET == psa->sa_family)
+	{
+		memsetU (ucKey, 0, 10);
+		ucKey [10] = 0xFF;
+		ucKey [11] = 0xFF;
+		memcpyU (ucKey + 12, &((const struct sockaddr_in *) pAddr)->sin_addr, 4);
+		return true;
+	}
+	if (AF_INET6 == psa->sa_family)
+	{
+		memcpyU (ucKey, &((const struct sockaddr_in6 *) pAddr)->sin6_addr, 16);
+		return true;
+	}
+	return false;
+}
+
+static void siftDownWOLinvIPKeys (SWOLINVIPKEY *pk, size_t root, size_t n)
+{
+	size_t child;
+
+	while ((child = 2 * root + 1) < n)
+	{
+		if (child + 1 < n && memcmpU (pk [child].ucKey, pk [child + 1].ucKey, 16) < 0)
+			++ child;
+		if (memcmpU (pk [root].ucKey, pk [child].ucKey, 16) >= 0)
+			return;
+		SWOLINVIPKEY k	= pk [root];
+		pk [root]		= pk [child];
+		pk [child]		= k;
+		root			= child;
+	}
+}
+
+/*
+	Heapsort, like sortWOLtargetsByPeer (). Comparing the keys octet by octet as unsigned
+	numbers is the same as comparing them bit by bit.
+*/
+static void sortWOLinvIPKeys (SWOLINVIPKEY *pk, size_t n)
+{
+	size_t i;
+
+	if (n < 2)
+		return;
+	i = n / 2;
+	while (i --)
+		siftDownWOLinvIPKeys (pk, i, n);
+	while (-- n)
+	{
+		SWOLINVIPKEY k	= pk [0];
+		pk [0]			= pk [n];
+		pk [n]			= k;
+		siftDownWOLinvIPKeys (pk, 0, n);
+	}
+}
+
+/*
+	Builds the IP prefix index of the n records at pRecs at pk, which has space for n
+	entries, and returns the amount of entries.
+*/
+static uint32_t buildWOLinvIPIndex (SWOLINVIPKEY *pk, const SWOLINVRECORD *pRecs, uint32_t n)
+{
+	uint32_t nKeys = 0;
+	uint32_t r;
+
+	for (r = 0; r < n; ++ r)
+	{
+		const SWOLINVRECORD *pr = pRecs + r;
+		const void *pAddr = pr->lenHost ? pr->ucHost : pr->lenPeer ? pr->ucPeer : NULL;
+		if (pAddr && keyWOLinventoryIP (pk [nKeys].ucKey, pAddr))
+			pk [nKeys ++].uiSlot = r;
+	}
+	sortWOLinvIPKeys (pk, nKeys);
+	return nKeys;
+}
+
+/*
+	Copies the string at *pofs of the pool pSrc to *puiDst of the pool pDst, and updates
+	both offsets.
+*/
+static void moveWOLinvString (char *pDst, uint32_t *puiDst, uint32_t *pofs, const char *pSrc)
+{
+	if (0 == *pofs)
+		return;
+	size_t len = strlenU (pSrc + *pofs) + 1;
+	memcpyU (pDst + *puiDst, pSrc + *pofs, len);
+	*pofs		= *puiDst;
+	*puiDst		+= (uint32_t) len;
+}
+
+/*
+	Writes the string pool pSrc to pDst in the order of the n records at pRecs, i.e. in
+	slot order, and updates the records' offsets. A pass over all records, like a
+	selection by name pattern, then reads the pool sequentially instead of jumping around
+	in it. Both pools have the same size.
+*/
+static void layoutWOLinvStrings (char *pDst, SWOLINVRECORD *pRecs, uint32_t n, const char *pSrc)
+{
+	uint32_t	uiDst	= 1;
+	uint32_t	r;
+
+	pDst [0] = '\0';
+	for (r = 0; r < n; ++ r)
+	{
+		moveWOLinvString (pDst, &uiDst, &pRecs [r].ofsName, pSrc);
+		moveWOLinvString (pDst, &uiDst, &pRecs [r].ofsGroup, pSrc);
+		moveWOLinvString (pDst, &uiDst, &pRecs [r].ofsBroadcast, pSrc);
+	}
+}
+
+/*
+	Writes the lenData octets at pData to the new file wzDB.
+*/
+static bool writeWOLinvFile (const wchar_t *wzDB, const unsigned char *pData, uint64_t lenData)
+{
+	HANDLE	hFile;
+	DWORD	dwWritten;
+	bool	bRet	= true;
+
+	hFile = CreateFileW	(
+				wzDB, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+				FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL
+						);
+	if (INVALID_HANDLE_VALUE == hFile)
+		return false;
+	while (bRet && lenData)
+	{
+		DWORD dwChunk = lenData > 0x40000000 ? 0x40000000 : (DWORD) lenData;
+		bRet = WriteFile (hFile, pData, dwChunk, &dwWritten, NULL) && dwWritten == dwChunk;
+		pData	+= dwChunk;
+		lenData	-= dwChunk;
+	}
+	if (!bRet)
+	{
+		DWORD dwErr = GetLastError ();
+		CloseHandle (hFile);
+		DeleteFileW (wzDB);
+		SetLastError (dwErr);
+		return false;
+	}
+	return CloseHandle (hFile);
+}
+
+/*
+	Builds the database file from the records and the string pool of pb and writes it to
+	wzDB.
+*/
+static enum eWOLinvRet writeWOLinventory	(
+							const SWOLINVBUILD *pb, const wchar_t *wzDB, SWOLINVSTATS *ps
+											)
+{
+	uint32_t		n			= pb->nRecs;
+	uint64_t		ofsRecs		= sizeof (SWOLINVHEADER) + (uint64_t) n * sizeof (int32_t);
+	ofsRecs						= (ofsRecs + 7) & ~ (uint64_t) 7;
+	uint64_t		ofsIPIndex	= ofsRecs + (uint64_t) n * sizeof (SWOLINVRECORD);
+	uint64_t		ofsStrings	= ofsIPIndex + (uint64_t) n * sizeof (SWOLINVIPKEY);
+	uint64_t		uiSize		= ofsStrings + pb->lenStrings;
+	uint32_t		*puiSlots;
+	unsigned char	*pFile;
+	enum eWOLinvRet	ret;
+	uint32_t		r;
+
+	if (uiSize > 0xFFFFFFFF)
+		return wolinvTooBig;
+	pFile		= HeapAlloc (GetProcessHeap (), HEAP_ZERO_MEMORY, (size_t) uiSize);
+	puiSlots	= HeapAlloc (GetProcessHeap (), 0, ((size_t) n + 1) * sizeof (uint32_t));
+	if (NULL == pFile || NULL == puiSlots)
+	{
+		freeWOLinv (pFile);
+		freeWOLinv (puiSlots);
+		return wolinvErrMemory;
+	}
+
+	SWOLINVHEADER	*ph			= (SWOLINVHEADER *) pFile;
+	int32_t			*piDisp		= (int32_t *) (pFile + sizeof (SWOLINVHEADER));
+	SWOLINVRECORD	*pRecs		= (SWOLINVRECORD *) (pFile + ofsRecs);
+	ret = n ? searchWOLinvHash (pb, piDisp, puiSlots, &ps->uiMaxDisplacement) : wolinvOk;
+	if (wolinvDuplicate == ret)
+		ps->nLine = puiSlots [0];						// Record index, see caller.
+	if (wolinvOk == ret)
+	{
+		memcpyU (ph->cMagic, U_WOLINV_MAGIC, U_WOLINV_MAGIC_LEN);
+		ph->uiVersion			= U_WOLINV_VERSION;
+		ph->nRecords			= n;
+		ph->ofsDisplacements	= sizeof (SWOLINVHEADER);
+		ph->ofsRecords			= (uint32_t) ofsRecs;
+		ph->ofsStrings			= (uint32_t) ofsStrings;
+		ph->lenStrings			= pb->lenStrings;
+		ph->uiRecordSize		= sizeof (SWOLINVRECORD);
+		for (r = 0; r < n; ++ r)
+			memcpyU (pRecs + puiSlots [r], pb->pRecs + r, sizeof (SWOLINVRECORD));
+		ph->ofsIPIndex			= (uint32_t) ofsIPIndex;
+		ph->nIPIndex			= buildWOLinvIPIndex	(
+									(SWOLINVIPKEY *) (pFile + ofsIPIndex), pRecs, n
+														);
+		// Hosts without an address leave a gap of zeroes before the string pool.
+		layoutWOLinvStrings ((char *) pFile + ofsStrings, pRecs, n, pb->pStrings);
+		ph->uiFileSize			= uiSize;
+		if (!writeWOLinvFile (wzDB, pFile, uiSize))
+			ret = wolinvErrWrite;
+		ps->uiFileSize = uiSize;
+	}
+	freeWOLinv (pFile);
+	freeWOLinv (puiSlots);
+	return ret;
+}
+
+enum eWOLinvRet compileWOLinventoryW (const wchar_t *wzCSV, const wchar_t *wzDB, SWOLINVSTATS *ps)
+{
+	SWOLINVSTATS	st;
+	SWOLINVBUILD	b;
+	SLINEREADER		lr;
+	LARGE_INTEGER	liFreq, liStart, liEnd;
+	enum eWOLinvRet	ret			= wolinvOk;
+	uint64_t		*puiLines	= NULL;
+	uint64_t		nLineAlloc	= 0;
+	bool			bFirst		= true;
+	bool			bRecord;
+	char			*szLine;
+
+	if (NULL == ps)
+		ps = &st;
+	memsetU (ps, 0, sizeof (SWOLINVSTATS));
+	memsetU (&b, 0, sizeof (b));
+	QueryPerformanceFrequency (&liFreq);
+	QueryPerformanceCounter (&liStart);
+	// The string at offset 0 is the empty string.
+	if (NULL == (b.pStrings = HeapAlloc (GetProcessHeap (), 0, U_WOLINV_INITIAL_STRINGS)))
+		return wolinvErrMemory;
+	b.nStrAlloc		= U_WOLINV_INITIAL_STRINGS;
+	b.pStrings [0]	= '\0';
+	b.lenStrings	= 1;
+
+	if (!openLineReaderW (&lr, wzCSV))
+	{
+		freeWOLinv (b.pStrings);
+		return wolinvErrRead;
+	}
+	while (wolinvOk == ret && (szLine = nextLineU8 (&lr, NULL)))
+	{
+		ret = parseWOLinvLineU8 (&b, szLine, bFirst, &bRecord);
+		if (wolinvOk != ret)
+			ps->nLine = lr.nLine;
+		if (bRecord)
+			bFirst = false;
+		if (bRecord && wolinvOk == ret)
+		{	// The line of every record, to report duplicates.
+			if (b.nRecs > nLineAlloc)
+			{
+				uint64_t *p	= reallocWOLinv (puiLines, (size_t) b.nRecAlloc * sizeof (uint64_t));
+				if (NULL == p)
+				{
+					ret = wolinvErrMemory;
+					break;
+				}
+				puiLines	= p;
+				nLineAlloc	= b.nRecAlloc;
+			}
+			puiLines [b.nRecs - 1] = lr.nLine;
+		}
+	}
+	closeLineReader (&lr);
+	if (wolinvOk == ret)
+	{
+		ret = writeWOLinventory (&b, wzDB, ps);
+		if (wolinvDuplicate == ret)
+			ps->nLine = puiLines [ps->nLine];
+	}
+	ps->nRecords = b.nRecs;
+	QueryPerformanceCounter (&liEnd);
+	ps->uiTicks			= (uint64_t) (liEnd.QuadPart - liStart.QuadPart);
+	ps->uiTicksPerSec	= (uint64_t) liFreq.QuadPart;
+	freeWOLinv (puiLines);
+	freeWOLinv (b.pRecs);
+	freeWOLinv (b.pStrings);
+	return ret;
+}
+
+/*
+	Returns true if the header ph of a file of uiSize octets is the header of a database
+	this version can read, all sections are within the file, and the string pool ends with
+	a NUL, which findWOLinventoryU8 () and strWOLinventory () rely on. ph points to the
+	beginning of the mapped file.
+*/
+static bool isGoodWOLinvHeader (const SWOLINVHEADER *ph, uint64_t uiSize)
+{
+	uint64_t n = ph->nRecords;
+
+	return		0 == memcmpU (ph->cMagic, U_WOLINV_MAGIC, U_WOLINV_MAGIC_LEN)
+			&&	U_WOLINV_VERSION == ph->uiVersion
+			&&	sizeof (SWOLINVRECORD) == ph->uiRecordSize
+			&&	uiSize == ph->uiFileSize
+			&&	0 == (ph->ofsDisplacements & 3)
+			&&	0 == (ph->ofsRecords & 7)
+			&&	ph->ofsDisplacements >= sizeof (SWOLINVHEADER)
+			&&	ph->ofsDisplacements + n * sizeof (int32_t) <= uiSize
+			&&	ph->ofsRecords + n * sizeof (SWOLINVRECORD) <= uiSize
+			&&	0 == (ph->ofsIPIndex & 3)
+			&&	ph->nIPIndex <= n
+			&&	ph->ofsIPIndex + (uint64_t) ph->nIPIndex * sizeof (SWOLINVIPKEY) <= uiSize
+			&&	ph->lenStrings
+			&&	(uint64_t) ph->ofsStrings + ph->lenStrings <= uiSize
+			&&	'\0' == ((const char *) ph) [(uint64_t) ph->ofsStrings + ph->lenStrings - 1];
+}
+
+bool openWOLinventoryW (SWOLINVENTORY *pi, const wchar_t *wzDB)
+{
+	LARGE_INTEGER liSize;
+
+	memsetU (pi, 0, sizeof (SWOLINVENTORY));
+	pi->hFile = CreateFileW	(
+					wzDB, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+					FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL
+							);
+	if (INVALID_HANDLE_VALUE == pi->hFile)
+	{
+		pi->hFile = NULL;
+		return false;
+	}
+	if (!GetFileSizeEx (pi->hFile, &liSize))
+		goto fail;
+	if (liSize.QuadPart < (LONGLONG) sizeof (SWOLINVHEADER))
+	{
+		SetLastError (ERROR_BAD_FORMAT);
+		goto fail;
+	}
+	pi->hMap = CreateFileMappingW (pi->hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (NULL == pi->hMap)
+		goto fail;
+	pi->pView = MapViewOfFile (pi->hMap, FILE_MAP_READ, 0, 0, 0);
+	if (NULL == pi->pView)
+		goto fail;
+	pi->ph = (const SWOLINVHEADER *) pi->pView;
+	if (!isGoodWOLinvHeader (pi->ph, (uint64_t) liSize.QuadPart))
+	{
+		SetLastError (ERROR_BAD_FORMAT);
+		goto fail;
+	}
+	pi->piDisp		= (const int32_t *) (pi->pView + pi->ph->ofsDisplacements);
+	pi->pRecs		= (const SWOLINVRECORD *) (pi->pView + pi->ph->ofsRecords);
+	pi->pIPIndex	= (const SWOLINVIPKEY *) (pi->pView + pi->ph->ofsIPIndex);
+	pi->pStrings	= (const char *) pi->pView + pi->ph->ofsStrings;
+	return true;
+fail:
+	{
+		DWORD dwErr = GetLastError ();
+		closeWOLinventory (pi);
+		SetLastError (dwErr);
+	}
+	return false;
+}
+
+bool defaultWOLinventoryW (wchar_t *wzPath, DWORD nPath)
+{
+	DWORD	len		= GetEnvironmentVariableW (U_WOLINV_ENVIRONMENT, wzPath, nPath);
+	size_t	lenExt	= sizeof (U_WOLINV_EXTENSION) / sizeof (wchar_t);	// Including NUL.
+
+	if (len && len < nPath)
+		return true;
+	len = GetModuleFileNameW (NULL, wzPath, nPath);
+	if (0 == len || len >= nPath)
+		return false;
+	WCHAR *pwcDot		= strrchrW (wzPath, L'.');
+	WCHAR *pwcSlash		= strrchrW (wzPath, L'\\');
+	if (pwcDot && (NULL == pwcSlash || pwcDot > pwcSlash))
+		len = (DWORD) (pwcDot - wzPath);
+	if (len + lenExt > nPath)
+		return false;
+	memcpyU (wzPath + len, U_WOLINV_EXTENSION, lenExt * sizeof (wchar_t));
+	return true;
+}
+
+bool openWOLinventoryDefault (SWOLINVENTORY *pi)
+{
+	wchar_t wzPath [MAX_PATH];
+
+	memsetU (pi, 0, sizeof (SWOLINVENTORY));
+	return defaultWOLinventoryW (wzPath, MAX_PATH) && openWOLinventoryW (pi, wzPath);
+}
+
+const SWOLINVRECORD *findWOLinventoryU8 (const SWOLINVENTORY *pi, const char *szName, size_t lenName)
+{
+	uint32_t n = pi->ph ? pi->ph->nRecords : 0;
+
+	if (0 == n)
+		return NULL;
+	uint32_t	b		= hashWOLinvName (0, szName, lenName) % n;
+	int32_t		d		= pi->piDisp [b];
+	uint32_t	uiSlot;
+	if (d < 0)
+		uiSlot = (uint32_t) (- (d + 1));
+	else
+		uiSlot = hashWOLinvName ((uint32_t) d, szName, lenName) % n;
+	if (uiSlot >= n)
+		return NULL;
+	const SWOLINVRECORD *pr = pi->pRecs + uiSlot;
+	if (pr->ofsName >= pi->ph->lenStrings)
+		return NULL;
+	// The pool ends with a NUL, which ends the comparison at the latest.
+	return isWOLinvName (pi->pStrings + pr->ofsName, szName, lenName) ? pr : NULL;
+}
+
+const char *strWOLinventory (const SWOLINVENTORY *pi, uint32_t ofs)
+{
+	return ofs < pi->ph->lenStrings ? pi->pStrings + ofs : "";
+}
+
+/*
+	Returns the index of the first entry of the IP prefix index whose key is greater than
+	ucKey, or, if bEqual is true, greater than or equal to ucKey.
+*/
+static size_t boundWOLinvIPIndex (const SWOLINVENTORY *pi, const unsigned char ucKey [16], bool bEqual)
+{
+	size_t lo = 0;
+	size_t hi = pi->ph->nIPIndex;
+
+	while (lo < hi)
+	{
+		size_t	mid = lo + (hi - lo) / 2;
+		int		c	= memcmpU (pi->pIPIndex [mid].ucKey, ucKey, 16);
+		if (c < 0 || (0 == c && !bEqual))
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+const SWOLINVIPKEY *rangeWOLinventoryIP	(
+						const SWOLINVENTORY *pi, const unsigned char ucLo [16],
+						const unsigned char ucHi [16], size_t *pn
+										)
+{
+	size_t uiFirst, uiEnd;
+
+	*pn = 0;
+	if (NULL == pi->ph || 0 == pi->ph->nIPIndex)
+		return NULL;
+	uiFirst	= boundWOLinvIPIndex (pi, ucLo, true);
+	uiEnd	= boundWOLinvIPIndex (pi, ucHi, false);
+	if (uiEnd <= uiFirst)
+		return NULL;
+	*pn = uiEnd - uiFirst;
+	return pi->pIPIndex + uiFirst;
+}
+
+enum eWOLret addWOLinventoryTarget	(
+				SWOLLIST *pl, const SWOLINVENTORY *pi, const SWOLINVRECORD *pr,
+				uint64_t nLine, const char *szGroup
+									)
+{
+	size_t			nFirst	= pl->nTargets;
+	const struct sockaddr *pPeer;
+	enum eWOLret	ret;
+	int				lenPeer;
+
+	/*
+		The records come from a file. A length that exceeds the record's address makes
+		addWOLlistTargetPeer () reject the target instead of reading past the record.
+	*/
+	pPeer	= pr->uiFlags & U_WOLINV_FLAG_AUTO ? NULL : (const struct sockaddr *) pr->ucPeer;
+	lenPeer	= pr->lenPeer <= sizeof (pr->ucPeer) ? pr->lenPeer : 0;
+	ret = addWOLlistTargetPeer	(
+				pl, pPeer, lenPeer, pr->ucMAC, strWOLinventory (pi, pr->ofsBroadcast),
+				nLine, szGroup ? szGroup : strWOLinventory (pi, pr->ofsGroup)
+								);
+	if (wolretErrMemory == ret)
+		return ret;
+	// Several targets for "auto".
+	for (; nFirst < pl->nTargets; ++ nFirst)
+	{
+		SWOLTARGET *pt = pl->pTargets + nFirst;
+		pt->uiPort = pr->uiPort;
+		if (pr->lenHost && pr->lenHost <= sizeof (pr->ucHost))
+		{
+			memcpyU (&pt->ssHost, pr->ucHost, pr->lenHost);
+			pt->lenHost = pr->lenHost;
+		}
+	}
+	return ret;
+}
+
+void closeWOLinventory (SWOLINVENTORY *pi)
+{
+	if (pi->pView)
+		UnmapViewOfFile (pi->pView);
+	if (pi->hMap)
+		CloseHandle (pi->hMap);
+	if (pi->hFile)
+		CloseHandle (pi->hFile);
+	memsetU (pi, 0, sizeof (SWOLINVENTORY));
+}
@@ -0,0 +1,333 @@
+/****************************************************************************************
+
+File		WakeOnLANInventory.h
+Why:		Compiled host inventory database with a perfect hash index.
+OS:			Windows
+Created:	2026-10-17
+
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2026-10-17	Thomas			Created.
+2026-10-17	Thomas			Version 2 with the IP prefix index SWOLINVIPKEY.
+
+****************************************************************************************/
+
+/*
+	This file is maintained as part of OnOffMate. See https://github.com/ThomasPGH/OnOffMate .
+*/
+
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Copyright (c) 2024, 2025, 2026 Thomas
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#ifndef U_WAKEONLANINVENTORY_H
+#define U_WAKEONLANINVENTORY_H
+
+#include <stdbool.h>
+#include <inttypes.h>
+#include <Winsock2.h>
+#include <ws2tcpip.h>
+#include "./WakeOnLAN.h"
+#include "./externC.h"
+
+/*
+	The first 8 octets and the version of an inventory database file.
+*/
+#define U_WOLINV_MAGIC					"OOMDB\r\n\x1A"
+#define U_WOLINV_MAGIC_LEN				(8)
+#define U_WOLINV_VERSION				(2)
+
+/*
+	The filename extension of inventory databases. The default database is the executable
+	with this extension instead of ".exe". See openWOLinventoryDefault ().
+*/
+#define U_WOLINV_EXTENSION				L".oomdb"
+
+/*
+	The environment variable that overrides the default database.
+*/
+#define U_WOLINV_ENVIRONMENT			L"ONOFFMATE_INVENTORY"
+
+/*
+	Flags of an SWOLINVRECORD.
+*/
+#define U_WOLINV_FLAG_AUTO				(0x01)			// Broadcast IP is "auto".
+
+/*
+	SWOLINVHEADER
+
+	The header at the beginning of an inventory database file. All offsets are from the
+	beginning of the file. The file consists of:
+
+	SWOLINVHEADER
+	int32_t [nRecords]			Displacements of the perfect hash.
+	SWOLINVRECORD [nRecords]	Records, in hash slot order, 8 octet aligned.
+	SWOLINVIPKEY [nIPIndex]		The IP prefix index. See SWOLINVIPKEY.
+	char [lenStrings]			String pool of NUL-terminated strings. The first string is
+								the empty string at offset 0.
+
+	Numbers are stored in the byte order of the machine that compiled the database, which
+	is little-endian on Windows.
+*/
+typedef struct swolinvheader
+{
+	char				cMagic [U_WOLINV_MAGIC_LEN];
+	uint32_t			uiVersion;
+	uint32_t			nRecords;
+	uint32_t			ofsDisplacements;
+	uint32_t			ofsRecords;
+	uint32_t			ofsStrings;
+	uint32_t			lenStrings;
+	uint32_t			uiRecordSize;						// sizeof (SWOLINVRECORD).
+	uint32_t			ofsIPIndex;
+	uint32_t			nIPIndex;
+	uint32_t			uiReserved;
+	uint64_t			uiFileSize;
+} SWOLINVHEADER;
+
+/*
+	SWOLINVRECORD
+
+	A host of an inventory database. Everything a target of a WOL list needs is parsed
+	when the database is compiled. ucPeer is the broadcast address, with the port already
+	set, and ucHost the address of the host itself for verification. Both are a struct
+	sockaddr_in or sockaddr_in6 of lenPeer and lenHost octets. lenHost is 0 if the host
+	has no address. The string offsets point into the string pool.
+*/
+typedef struct swolinvrecord
+{
+	uint32_t			ofsName;
+	uint32_t			ofsGroup;							// 0 for the default group.
+	uint32_t			ofsBroadcast;						// For output only.
+	uint16_t			uiPort;
+	unsigned char		ucMAC [6];
+	uint8_t				uiFlags;
+	uint8_t				lenPeer;
+	uint8_t				lenHost;
+	uint8_t				uiReserved;
+	unsigned char		ucPeer [sizeof (struct sockaddr_in6)];
+	unsigned char		ucHost [sizeof (struct sockaddr_in6)];
+} SWOLINVRECORD;
+
+/*
+	SWOLINVIPKEY
+
+	An entry of the IP prefix index. ucKey is the address of the host, or its broadcast
+	address if it has none, as an IPv6 address. IPv4 addresses are mapped to
+	::ffff:a.b.c.d. Hosts with neither, i.e. with "auto" as broadcast address and no
+	address of their own, are not in the index. uiSlot is the slot of the host's record.
+
+	The entries are sorted by ucKey, bit by bit from the most significant one, which is
+	the order of the leaves of a binary radix tree. All addresses with the same prefix
+	are therefore consecutive entries, and a CIDR range takes two binary searches to
+	find. See rangeWOLinventoryIP ().
+*/
+typedef struct swolinvipkey
+{
+	unsigned char		ucKey [16];
+	uint32_t			uiSlot;
+} SWOLINVIPKEY;
+
+/*
+	SWOLINVENTORY
+
+	An inventory database mapped into memory. See openWOLinventoryW ().
+*/
+typedef struct swolinventory
+{
+	HANDLE				hFile;
+	HANDLE				hMap;
+	const unsigned char	*pView;
+	const SWOLINVHEADER	*ph;
+	const int32_t		*piDisp;
+	const SWOLINVRECORD	*pRecs;
+	const SWOLINVIPKEY	*pIPIndex;
+	const char			*pStrings;
+} SWOLINVENTORY;
+
+enum eWOLinvRet
+{
+	wolinvOk,
+	wolinvErrRead,											// GetLastError () tells more.
+	wolinvErrWrite,											// GetLastError () tells more.
+	wolinvErrMemory,
+	wolinvSyntaxMAC,
+	wolinvSyntaxHst,
+	wolinvSyntaxPort,
+	wolinvSyntaxIP,
+	wolinvMissingName,
+	wolinvDuplicate,
+	wolinvTooBig
+};
+
+/*
+	SWOLINVSTATS
+
+	Filled in by compileWOLinventoryW ().
+*/
+typedef struct swolinvstats
+{
+	uint64_t			nLine;								// Line of the error, or 0.
+	uint32_t			nRecords;
+	uint64_t			uiFileSize;
+	uint32_t			uiMaxDisplacement;					// Largest displacement tried.
+	uint64_t			uiTicks;							// Performance counter ticks.
+	uint64_t			uiTicksPerSec;
+} SWOLINVSTATS;
+
+EXTERN_C_BEGIN
+
+/*
+	compileWOLinventoryW
+
+	Reads the host inventory from the CSV file wzCSV, or from standard input if wzCSV is
+	"-", and writes the inventory database wzDB. Each line consists of the fields
+
+	name,mac,brip[,group[,port[,ip]]]
+
+	separated by commas, semicolons, or tabs. Fields can be empty, white space around
+	them is ignored. name is the name of the host, which is case-insensitive and must be
+	unique. mac is the MAC address in any notation parseWOLmacU8 () accepts, and brip the
+	broadcast IP address or "auto", like in a WOL list. See readWOLlistW (). group is the
+	group of the host, port the UDP port of its magic packets (default
+	U_WAKEONLAN_MAGIC_PACKET_PORT), and ip the address of the host for verification.
+	Empty lines and lines that start with '#' or ';' are ignored, as is a first line
+	whose first field is "name".
+
+	Example:
+	name,mac,brip,group,port,ip
+	build-07,00-11-22-33-44-55,192.168.0.255,rack1,9,192.168.0.97
+	build-08,0011.2233.4466,ff02::1%Ethernet,rack1,,
+
+	Host names are indexed with a minimal perfect hash (hash and displace), which the
+	function searches for when compiling, so that looking up a name needs two hashes and
+	a single string comparison. IPv6 scope ids given as interface names are resolved
+	when the database is compiled.
+
+	The function returns wolinvOk on success. On a syntax error or a duplicate name the
+	member nLine of ps is the line of the error. ps can be NULL.
+*/
+enum eWOLinvRet compileWOLinventoryW (const wchar_t *wzCSV, const wchar_t *wzDB, SWOLINVSTATS *ps)
+;
+
+/*
+	openWOLinventoryW
+
+	Maps the inventory database wzDB into memory and checks its header. Nothing is read
+	or parsed apart from the header. The function returns false if the file cannot be
+	opened or is not an inventory database. Call GetLastError () for more information.
+	Release the mapping with closeWOLinventory ().
+*/
+bool openWOLinventoryW (SWOLINVENTORY *pi, const wchar_t *wzDB)
+;
+
+/*
+	defaultWOLinventoryW
+
+	Writes the path of the default inventory database to wzPath, which has space for
+	nPath characters. This is the value of the environment variable U_WOLINV_ENVIRONMENT
+	if it exists, otherwise the path of the executable with the extension
+	U_WOLINV_EXTENSION. The function returns false if the path doesn't fit.
+*/
+bool defaultWOLinventoryW (wchar_t *wzPath, DWORD nPath)
+;
+
+/*
+	openWOLinventoryDefault
+
+	Opens the default inventory database. See defaultWOLinventoryW () and
+	openWOLinventoryW ().
+*/
+bool openWOLinventoryDefault (SWOLINVENTORY *pi)
+;
+
+/*
+	findWOLinventoryU8
+
+	Returns the record of the host with the name in the lenName octets at szName, which
+	doesn't need to be NUL-terminated, or NULL if the inventory has no such host. The
+	comparison ignores the case of ASCII letters.
+*/
+const SWOLINVRECORD *findWOLinventoryU8 (const SWOLINVENTORY *pi, const char *szName, size_t lenName)
+;
+
+/*
+	strWOLinventory
+
+	Returns the string at the offset ofs of the string pool.
+*/
+const char *strWOLinventory (const SWOLINVENTORY *pi, uint32_t ofs)
+;
+
+/*
+	keyWOLinventoryIP
+
+	Stores the address of the struct sockaddr_in or sockaddr_in6 at pAddr as a key of
+	the IP prefix index at ucKey. See SWOLINVIPKEY. The function returns false if pAddr
+	is neither.
+*/
+bool keyWOLinventoryIP (unsigned char ucKey [16], const void *pAddr)
+;
+
+/*
+	rangeWOLinventoryIP
+
+	Finds the entries of the IP prefix index whose keys are within ucLo and ucHi,
+	inclusive, and returns them. The amount of entries is stored at pn. For the CIDR
+	prefix p/n, ucLo is p with all bits after the first n cleared, and ucHi p with all of
+	them set.
+*/
+const SWOLINVIPKEY *rangeWOLinventoryIP	(
+						const SWOLINVENTORY *pi, const unsigned char ucLo [16],
+						const unsigned char ucHi [16], size_t *pn
+										)
+;
+
+/*
+	addWOLinventoryTarget
+
+	Adds the host pr of the inventory pi to the list pl. Its group is szGroup, or the
+	group of the record if szGroup is NULL. See addWOLlistTargetPeer ().
+*/
+enum eWOLret addWOLinventoryTarget	(
+				SWOLLIST *pl, const SWOLINVENTORY *pi, const SWOLINVRECORD *pr,
+				uint64_t nLine, const char *szGroup
+									)
+;
+
+/*
+	closeWOLinventory
+
+	Unmaps the inventory database and closes its file.
+*/
+void closeWOLinventory (SWOLINVENTORY *pi)
+;
+
+EXTERN_C_END
+
+#endif														// Of #ifndef U_WAKEONLANINVENTORY_H.
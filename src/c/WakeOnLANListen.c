@@ -0,0 +1,222 @@
+/****************************************************************************************
+
+File		WakeOnLANListen.c
+Why:		Receives and verifies magic packets.
+OS:			Windows
+Created:	2026-10-17
+
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2026-10-17	Thomas			Created.
+
+****************************************************************************************/
+
+/*
+	This file is maintained as part of OnOffMate. See https://github.com/ThomasPGH/OnOffMate .
+*/
+
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Copyright (c) 2024, 2025, 2026 Thomas
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "./WakeOnLANListen.h"
+
+#include <Windows.h>
+#include "./WinRuntimeReplacements.h"
+
+/*
+	Opens a non-blocking UDP socket for iFamily bound to the wildcard address and port
+	uiPort.
+*/
+static SOCKET openWOLlistenSocket (int iFamily, uint16_t uiPort)
+{
+	struct sockaddr_storage	ss;
+	int						len;
+	u_long					ulNonBlocking	= 1;
+	DWORD					dwV6only		= 1;
+	SOCKET					s;
+
+	s = socket (iFamily, SOCK_DGRAM, IPPROTO_UDP);
+	if (INVALID_SOCKET == s)
+		return s;
+
+	memsetU (&ss, 0, sizeof (ss));
+	if (AF_INET == iFamily)
+	{
+		struct sockaddr_in *psi		= (struct sockaddr_in *) &ss;
+		psi->sin_family				= AF_INET;
+		psi->sin_addr.s_addr		= htonl (INADDR_ANY);
+		psi->sin_port				= htons (uiPort);
+		len							= sizeof (struct sockaddr_in);
+	} else
+	{
+		struct sockaddr_in6 *psi6	= (struct sockaddr_in6 *) &ss;
+		psi6->sin6_family			= AF_INET6;
+		psi6->sin6_addr				= in6addr_any;
+		psi6->sin6_port				= htons (uiPort);
+		len							= sizeof (struct sockaddr_in6);
+		// IPv4 is received by the IPv4 socket of the same port.
+		setsockopt (s, IPPROTO_IPV6, IPV6_V6ONLY, (char *) &dwV6only, sizeof (DWORD));
+	}
+	if	(
+				0 != ioctlsocket (s, FIONBIO, &ulNonBlocking)
+			||	0 != bind (s, (struct sockaddr *) &ss, len)
+		)
+	{
+		closesocket (s);
+		return INVALID_SOCKET;
+	}
+	return s;
+}
+
+bool openWOLlistener (SWOLLISTENER *pl, const uint16_t *puiPorts, size_t nPorts)
+{
+	size_t	n;
+
+	memsetU (pl, 0, sizeof (SWOLLISTENER));
+	if (nPorts > U_WAKEONLAN_LISTEN_MAX_PORTS)
+		nPorts = U_WAKEONLAN_LISTEN_MAX_PORTS;
+	for (n = 0; n < nPorts; ++ n)
+	{
+		SOCKET s4 = openWOLlistenSocket (AF_INET, puiPorts [n]);
+		if (INVALID_SOCKET != s4)
+		{
+			pl->ports [pl->nSockets]	= puiPorts [n];
+			pl->sockets [pl->nSockets]	= s4;
+			++ pl->nSockets;
+		}
+		SOCKET s6 = openWOLlistenSocket (AF_INET6, puiPorts [n]);
+		if (INVALID_SOCKET != s6)
+		{
+			pl->ports [pl->nSockets]	= puiPorts [n];
+			pl->sockets [pl->nSockets]	= s6;
+			++ pl->nSockets;
+		}
+	}
+	if (pl->nSockets)
+		pl->buf = HeapAlloc (GetProcessHeap (), 0, U_WAKEONLAN_LISTEN_BUFSIZE);
+	if (pl->buf)
+		return true;
+	closeWOLlistener (pl);
+	return false;
+}
+
+/*
+	Reads up to U_WAKEONLAN_LISTEN_BATCH datagrams from socket n.
+*/
+static void drainWOLlistenSocket (SWOLLISTENER *pl, size_t n, pfnWOLrecv fnc, void *pCustom)
+{
+	SWOLRECV		wr;
+	LARGE_INTEGER	liStart, liEnd;
+	unsigned int	uiBatch;
+
+	for (uiBatch = 0; uiBatch < U_WAKEONLAN_LISTEN_BATCH; ++ uiBatch)
+	{
+		wr.lenSource = sizeof (wr.ssSource);
+		int iRecv = recvfrom	(
+						pl->sockets [n], pl->buf, U_WAKEONLAN_LISTEN_BUFSIZE, 0,
+						(struct sockaddr *) &wr.ssSource, &wr.lenSource
+								);
+		++ pl->nRecvCalls;
+		if (SOCKET_ERROR == iRecv)
+		{
+			// An ICMP port unreachable from an earlier send shows up as WSAECONNRESET.
+			if (WSAECONNRESET == WSAGetLastError ())
+				continue;
+			return;
+		}
+		++ pl->nDatagrams;
+		pl->nOctets += (uint64_t) iRecv;
+
+		QueryPerformanceCounter (&liStart);
+		const unsigned char *pm = findWOLmagicPacket	(
+										(const unsigned char *) pl->buf, (size_t) iRecv,
+										wr.ucMAC
+														);
+		QueryPerformanceCounter (&liEnd);
+		pl->uiScanTicks += (uint64_t) (liEnd.QuadPart - liStart.QuadPart);
+		if (pm)
+		{
+			++ pl->nMagic;
+			if (fnc)
+			{
+				GetLocalTime (&wr.stReceived);
+				wr.uiTickReceived	= (uint64_t) liStart.QuadPart;
+				wr.uiPort			= pl->ports [n];
+				wr.pData			= pl->buf;
+				wr.lenData			= (size_t) iRecv;
+				wr.offMagic			= (size_t) (pm - (const unsigned char *) pl->buf);
+				fnc (&wr, pCustom);
+			}
+		}
+	}
+}
+
+void runWOLlistener (SWOLLISTENER *pl, pfnWOLrecv fnc, void *pCustom)
+{
+	WSAPOLLFD		pfd [U_WAKEONLAN_LISTEN_MAX_SOCKETS];
+	LARGE_INTEGER	liFreq, liStart, liEnd;
+	size_t			n;
+
+	for (n = 0; n < pl->nSockets; ++ n)
+	{
+		pfd [n].fd		= pl->sockets [n];
+		pfd [n].events	= POLLRDNORM;
+		pfd [n].revents	= 0;
+	}
+	QueryPerformanceFrequency (&liFreq);
+	QueryPerformanceCounter (&liStart);
+	pl->uiTicksPerSec = (uint64_t) liFreq.QuadPart;
+	while (!pl->lStop)
+	{
+		int iPoll = WSAPoll (pfd, (ULONG) pl->nSockets, U_WAKEONLAN_LISTEN_POLL_MS);
+		if (SOCKET_ERROR == iPoll)
+			break;
+		for (n = 0; iPoll > 0 && n < pl->nSockets; ++ n)
+		{
+			if (pfd [n].revents & POLLRDNORM)
+				drainWOLlistenSocket (pl, n, fnc, pCustom);
+		}
+	}
+	QueryPerformanceCounter (&liEnd);
+	pl->uiRunTicks += (uint64_t) (liEnd.QuadPart - liStart.QuadPart);
+}
+
+void stopWOLlistener (SWOLLISTENER *pl)
+{
+	InterlockedExchange (&pl->lStop, 1);
+}
+
+void closeWOLlistener (SWOLLISTENER *pl)
+{
+	size_t n;
+
+	for (n = 0; n < pl->nSockets; ++ n)
+		closesocket (pl->sockets [n]);
+	pl->nSockets = 0;
+	if (pl->buf)
+		HeapFree (GetProcessHeap (), 0, pl->buf);
+	pl->buf = NULL;
+}
@@ -0,0 +1,168 @@
+/****************************************************************************************
+
+File		WakeOnLANListen.h
+Why:		Receives and verifies magic packets.
+OS:			Windows
+Created:	2026-10-17
+
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2026-10-17	Thomas			Created.
+
+****************************************************************************************/
+
+/*
+	This file is maintained as part of OnOffMate. See https://github.com/ThomasPGH/OnOffMate .
+*/
+
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Copyright (c) 2024, 2025, 2026 Thomas
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef U_WAKEONLANLISTEN_H
+#define U_WAKEONLANLISTEN_H
+
+#include <stdbool.h>
+#include <inttypes.h>
+#include "./WakeOnLAN.h"
+#include "./externC.h"
+
+/*
+	The maximum amount of UDP ports a listener can listen on. Each port gets an IPv4 and
+	an IPv6 socket.
+*/
+#ifndef U_WAKEONLAN_LISTEN_MAX_PORTS
+#define U_WAKEONLAN_LISTEN_MAX_PORTS		(16)
+#endif
+#define U_WAKEONLAN_LISTEN_MAX_SOCKETS		(2 * U_WAKEONLAN_LISTEN_MAX_PORTS)
+
+/*
+	Size of the receive buffer. This is the maximum size of a UDP datagram.
+*/
+#ifndef U_WAKEONLAN_LISTEN_BUFSIZE
+#define U_WAKEONLAN_LISTEN_BUFSIZE			(64 * 1024)
+#endif
+
+/*
+	The maximum amount of datagrams read from a single socket before the other sockets
+	get their turn.
+*/
+#ifndef U_WAKEONLAN_LISTEN_BATCH
+#define U_WAKEONLAN_LISTEN_BATCH			(64)
+#endif
+
+/*
+	How often, in milliseconds, the listener checks whether it has been asked to stop.
+*/
+#ifndef U_WAKEONLAN_LISTEN_POLL_MS
+#define U_WAKEONLAN_LISTEN_POLL_MS			(250)
+#endif
+
+EXTERN_C_BEGIN
+
+/*
+	SWOLRECV
+
+	A received magic packet.
+*/
+typedef struct swolrecv
+{
+	unsigned char				ucMAC [6];
+	struct sockaddr_storage		ssSource;					// Sender.
+	int							lenSource;
+	uint16_t					uiPort;						// Local port.
+	SYSTEMTIME					stReceived;					// Local time.
+	uint64_t					uiTickReceived;				// Performance counter.
+	const char					*pData;						// The entire datagram.
+	size_t						lenData;
+	size_t						offMagic;					// Offset of magic packet.
+} SWOLRECV;
+
+/*
+	Callback function for received magic packets. The data SWOLRECV points to is only
+	valid until the function returns.
+*/
+typedef void (*pfnWOLrecv) (SWOLRECV *pr, void *pCustom);
+
+/*
+	SWOLLISTENER
+
+	The listener's sockets, receive buffer, and counters.
+*/
+typedef struct swollistener
+{
+	SOCKET						sockets [U_WAKEONLAN_LISTEN_MAX_SOCKETS];
+	uint16_t					ports [U_WAKEONLAN_LISTEN_MAX_SOCKETS];
+	size_t						nSockets;
+	char						*buf;						// Receive buffer.
+	volatile LONG				lStop;
+	uint64_t					nDatagrams;					// Datagrams received.
+	uint64_t					nOctets;					// Octets received.
+	uint64_t					nMagic;						// Magic packets found.
+	uint64_t					nRecvCalls;					// Calls to recvfrom ().
+	uint64_t					uiScanTicks;				// Ticks scanning datagrams.
+	uint64_t					uiRunTicks;					// Ticks running.
+	uint64_t					uiTicksPerSec;
+} SWOLLISTENER;
+
+/*
+	openWOLlistener
+
+	Opens an IPv4 and an IPv6 UDP socket for each of the nPorts ports in puiPorts. The
+	function fails if not a single socket could be opened.
+*/
+bool openWOLlistener (SWOLLISTENER *pl, const uint16_t *puiPorts, size_t nPorts)
+;
+
+/*
+	runWOLlistener
+
+	Receives datagrams on all sockets of the listener until stopWOLlistener () is called,
+	and calls fnc for each magic packet found. Sockets are non-blocking and drained in
+	batches of up to U_WAKEONLAN_LISTEN_BATCH datagrams.
+*/
+void runWOLlistener (SWOLLISTENER *pl, pfnWOLrecv fnc, void *pCustom)
+;
+
+/*
+	stopWOLlistener
+
+	Asks runWOLlistener () to return. The function can be called from another thread, for
+	instance from a console control handler.
+*/
+void stopWOLlistener (SWOLLISTENER *pl)
+;
+
+/*
+	closeWOLlistener
+
+	Closes the sockets and frees the receive buffer.
+*/
+void closeWOLlistener (SWOLLISTENER *pl)
+;
+
+EXTERN_C_END
+
+#endif														// Of #ifndef U_WAKEONLANLISTEN_H.
@@ -0,0 +1,218 @@
+/****************************************************************************************
+
+File		WakeOnLANMAC.c
+Why:		MAC address parser for all common notations.
+OS:			Windows
+Created:	2026-10-17
+
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2026-10-17	Thomas			Created.
+
+****************************************************************************************/
+
+/*
+	This file is maintained as part of OnOffMate. See https://github.com/ThomasPGH/OnOffMate .
+*/
+
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Copyright (c) 2024, 2025, 2026 Thomas
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+#include "./WakeOnLANMAC.h"
+#include <Windows.h>
+#include "./WinRuntimeReplacements.h"
+
+/*
+	The values of hexadecimal digits. All other characters are 0xFF.
+*/
+static const unsigned char ucWOLhexValues [256] =
+{
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
+static inline unsigned int chWOLmacAt (const void *p, size_t i, bool bWide)
+{
+	return bWide ? ((const wchar_t *) p) [i] : ((const unsigned char *) p) [i];
+}
+
+static inline bool isWOLhexDigit (unsigned int c)
+{
+	return c < 256 && 0xFF != ucWOLhexValues [c];
+}
+
+/*
+	Decodes the 12 hexadecimal digits at ucDigits, which are followed by 4 octets of
+	padding, into the 6 octets at ucMAC. Returns false if one of the digits is invalid.
+*/
+static bool decodeWOLmacDigits (unsigned char ucMAC [6], const unsigned char ucDigits [16])
+{
+	#ifdef U_WINRUNTIME_SSE2
+		__m128i	v		= _mm_loadu_si128 ((const __m128i *) ucDigits);
+		// Setting bit 5 turns 'A'...'F' into 'a'...'f' and leaves '0'...'9' unchanged.
+		__m128i	lower	= _mm_or_si128 (v, _mm_set1_epi8 (0x20));
+		// Octets from 0x80 upwards are negative and fail both signed comparisons.
+		__m128i	isDig	= _mm_and_si128	(
+							_mm_cmpgt_epi8 (v, _mm_set1_epi8 ('0' - 1)),
+							_mm_cmplt_epi8 (v, _mm_set1_epi8 ('9' + 1))
+										);
+		__m128i	isAlp	= _mm_and_si128	(
+							_mm_cmpgt_epi8 (lower, _mm_set1_epi8 ('a' - 1)),
+							_mm_cmplt_epi8 (lower, _mm_set1_epi8 ('f' + 1))
+										);
+		unsigned char uc [8];
+
+		if (0x0FFF != (_mm_movemask_epi8 (_mm_or_si128 (isDig, isAlp)) & 0x0FFF))
+			return false;
+		__m128i val = _mm_or_si128	(
+						_mm_and_si128 (isDig, _mm_sub_epi8 (v, _mm_set1_epi8 ('0'))),
+						_mm_and_si128 (isAlp, _mm_sub_epi8 (lower, _mm_set1_epi8 ('a' - 10)))
+									);
+		/*
+			Every 16 bit lane holds the high nibble of an octet in its low octet and the low
+			nibble in its high octet.
+		*/
+		__m128i oct = _mm_or_si128	(
+						_mm_and_si128 (_mm_slli_epi16 (val, 4), _mm_set1_epi16 (0x00F0)),
+						_mm_srli_epi16 (val, 8)
+									);
+		_mm_storel_epi64 ((__m128i *) uc, _mm_packus_epi16 (oct, oct));
+		memcpyU (ucMAC, uc, 6);
+		return true;
+	#else
+		int n;
+
+		for (n = 0; n < 6; ++ n)
+		{
+			unsigned char hi = ucWOLhexValues [ucDigits [2 * n]];
+			unsigned char lo = ucWOLhexValues [ucDigits [2 * n + 1]];
+			if (0xFF == hi || 0xFF == lo)
+				return false;
+			ucMAC [n] = (unsigned char) (hi << 4 | lo);
+		}
+		return true;
+	#endif
+}
+
+/*
+	Copies the character c into the digit buffer. Characters outside of ASCII become an
+	invalid digit, which decodeWOLmacDigits () rejects.
+*/
+static inline unsigned char digWOLmac (unsigned int c)
+{
+	return c < 0x80 ? (unsigned char) c : 'x';
+}
+
+static bool parseWOLmac (unsigned char ucMAC [6], const void *p, size_t len, bool bWide)
+{
+	unsigned char	ucDigits [16];
+	size_t			i;
+	size_t			n			= 0;
+
+	if (len < U_WAKEONLAN_MAC_MIN_LEN || len > U_WAKEONLAN_MAC_MAX_LEN)
+		return false;
+	memsetU (ucDigits, '0', sizeof (ucDigits));
+	if (12 == len)
+	{	// 001122334455
+		for (i = 0; i < 12; ++ i)
+			ucDigits [i] = digWOLmac (chWOLmacAt (p, i, bWide));
+		if (decodeWOLmacDigits (ucMAC, ucDigits))
+			return true;
+	} else
+	if (14 == len && '.' == chWOLmacAt (p, 4, bWide) && '.' == chWOLmacAt (p, 9, bWide))
+	{	// 0011.2233.4455
+		for (i = 0; i < 14; ++ i)
+		{
+			if (4 != i && 9 != i)
+				ucDigits [n ++] = digWOLmac (chWOLmacAt (p, i, bWide));
+		}
+		if (decodeWOLmacDigits (ucMAC, ucDigits))
+			return true;
+	}
+
+	/*
+		Six fields of one or two digits, like a:b:c:d:e:ff, which can have 12 or 14
+		characters too. A field with one digit gets a leading zero.
+	*/
+	unsigned int	uiSep		= 0;
+	size_t			nFields		= 0;
+	size_t			lenField	= 0;
+	for (i = 0; i <= len; ++ i)
+	{
+		unsigned int c = i < len ? chWOLmacAt (p, i, bWide) : 0;
+		if (i < len && isWOLhexDigit (c))
+		{
+			if (2 == lenField)
+				return false;
+			ucDigits [2 * nFields + lenField ++] = (unsigned char) c;
+			continue;
+		}
+		if (0 == lenField || 6 == nFields)
+			return false;
+		if (i < len)
+		{
+			if (0 == uiSep)
+				uiSep = c;
+			else
+			if (c != uiSep)
+				return false;
+		}
+		if (1 == lenField)
+		{
+			ucDigits [2 * nFields + 1]	= ucDigits [2 * nFields];
+			ucDigits [2 * nFields]		= '0';
+		}
+		++ nFields;
+		lenField = 0;
+	}
+	return 6 == nFields && decodeWOLmacDigits (ucMAC, ucDigits);
+}
+
+bool parseWOLmacU8 (unsigned char ucMAC [6], const char *szMAC, size_t lenMAC)
+{
+	return parseWOLmac (ucMAC, szMAC, lenMAC, false);
+}
+
+bool parseWOLmacW (unsigned char ucMAC [6], const wchar_t *wzMAC, size_t lenMAC)
+{
+	return parseWOLmac (ucMAC, wzMAC, lenMAC, true);
+}
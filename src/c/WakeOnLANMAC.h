@@ -0,0 +1,92 @@
+/****************************************************************************************
+
+File		WakeOnLANMAC.h
+Why:		MAC address parser for all common notations.
+OS:			Windows
+Created:	2026-10-17
+
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2026-10-17	Thomas			Created.
+
+****************************************************************************************/
+
+/*
+	This file is maintained as part of OnOffMate. See https://github.com/ThomasPGH/OnOffMate .
+*/
+
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Copyright (c) 2024, 2025, 2026 Thomas
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+#ifndef U_WAKEONLANMAC_H
+#define U_WAKEONLANMAC_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "./externC.h"
+
+/*
+	Length of the shortest and the longest MAC address parseWOLmacU8 () and parseWOLmacW ()
+	accept. "a:b:c:d:e:f" is the shortest, "00-11-22-33-44-55" the longest.
+*/
+#define U_WAKEONLAN_MAC_MIN_LEN			(6 + 5)
+#define U_WAKEONLAN_MAC_MAX_LEN			(17)
+
+EXTERN_C_BEGIN
+
+/*
+	parseWOLmacU8
+
+	Parses the MAC address in the lenMAC characters at szMAC, which doesn't need to be NUL-
+	terminated, and stores its 6 octets at ucMAC. Accepted notations are:
+
+	00-11-22-33-44-55	Six fields, separated by the same character. Each field has one or
+	0:11:2:33:4:55		two hexadecimal digits.
+	0011.2233.4455		Three fields of four hexadecimal digits, separated by dots (Cisco).
+	001122334455		Twelve hexadecimal digits.
+
+	Hexadecimal digits can be uppercase or lowercase. The digits are looked up in a table,
+	and on x64 all 12 of them are validated and decoded with SSE2 at once.
+
+	The function returns false if szMAC is not a MAC address in one of these notations.
+*/
+bool parseWOLmacU8 (unsigned char ucMAC [6], const char *szMAC, size_t lenMAC)
+;
+
+/*
+	parseWOLmacW
+
+	The UTF-16 version of parseWOLmacU8 (). The characters are read directly. There's no
+	conversion to UTF-8.
+*/
+bool parseWOLmacW (unsigned char ucMAC [6], const wchar_t *wzMAC, size_t lenMAC)
+;
+
+EXTERN_C_END
+
+#endif														// Of #ifndef U_WAKEONLANMAC_H.
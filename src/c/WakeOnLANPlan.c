@@ -0,0 +1,711 @@
+/****************************************************************************************
+
+File		WakeOnLANPlan.c
+Why:		Wake plans: stages of hosts woken in dependency order.
+OS:			Windows
+Created:	2026-10-17
+
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2026-10-17	Thomas			Created.
+
+****************************************************************************************/
+
+/*
+	This file is maintained as part of OnOffMate. See https://github.com/ThomasPGH/OnOffMate .
+*/
+
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Copyright (c) 2024, 2025, 2026 Thomas
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+
+#ifndef _WINSOCK_DEPRECATED_NO_WARNINGS
+#define _WINSOCK_DEPRECATED_NO_WARNINGS
+#endif
+
+#include "./WakeOnLANPlan.h"
+#include <Windows.h>
+#include "./WinRuntimeReplacements.h"
+#include "./WinLineReader.h"
+#include "./WakeOnLANSelect.h"
+
+/*
+	The stages a stage depends on are only names until all lines have been read, as they
+	can be declared further down. They're kept in this many octets per stage.
+*/
+#define U_WOLPLAN_AFTER_SIZ				(U_WOLPLAN_NAME_SIZ * U_WOLPLAN_MAX_AFTER)
+
+#define U_WOLPLAN_NEVER					((uint64_t) -1)
+
+static inline unsigned char lowerWOLplanChar (unsigned char c)
+{
+	return c >= 'A' && c <= 'Z' ? c | 0x20 : c;
+}
+
+/*
+	Returns true if the NUL-terminated strings sz1 and sz2 are equal, ignoring the case of
+	ASCII letters.
+*/
+static bool isWOLplanName (const char *sz1, const char *sz2)
+{
+	while (*sz1 && lowerWOLplanChar ((unsigned char) *sz1) == lowerWOLplanChar ((unsigned char) *sz2))
+	{
+		++ sz1;
+		++ sz2;
+	}
+	return *sz1 == *sz2;
+}
+
+/*
+	Returns the value of the token sz if it is the lowercase key szKey followed by '=', or
+	NULL if it isn't.
+*/
+static char *valueWOLplanKey (char *sz, const char *szKey)
+{
+	while (*szKey)
+	{
+		if (lowerWOLplanChar ((unsigned char) *sz) != (unsigned char) *szKey)
+			return NULL;
+		++ sz;
+		++ szKey;
+	}
+	return '=' == *sz ? sz + 1 : NULL;
+}
+
+/*
+	Returns the next token of a line of a plan and NUL-terminates it in place. Unlike
+	nextWOLlistTokenU8 () only white space separates tokens, since selectors and after=
+	contain commas.
+*/
+static char *nextWOLplanTokenU8 (char **sz)
+{
+	char *p = *sz;
+
+	while (' ' == *p || '\t' == *p)
+		++ p;
+	if ('\0' == *p)
+		return NULL;
+	char *t = p;
+	while (*p && ' ' != *p && '\t' != *p)
+		++ p;
+	if (*p)
+		*p ++ = '\0';
+	*sz = p;
+	return t;
+}
+
+/*
+	Parses the decimal number of seconds sz into milliseconds.
+*/
+static bool parseWOLplanSeconds (uint64_t *puiMs, const char *sz)
+{
+	uint64_t ui = 0;
+
+	if ('\0' == *sz)
+		return false;
+	while (*sz)
+	{
+		if (*sz < '0' || *sz > '9' || ui > 1000000000)
+			return false;
+		ui = ui * 10 + (uint64_t) (*sz - '0');
+		++ sz;
+	}
+	*puiMs = ui * 1000;
+	return true;
+}
+
+/*
+	Sets the probe of pv from the ASCII specification sz. See parseWOLprobeW ().
+*/
+static bool parseWOLplanProbe (SWOLVERIFY *pv, const char *sz)
+{
+	wchar_t	wc [16];
+	size_t	n;
+
+	if (isWOLplanName (sz, "none"))
+	{
+		pv->probe = wolprobeNone;
+		return true;
+	}
+	for (n = 0; sz [n] && n < 15; ++ n)
+		wc [n] = (unsigned char) sz [n];
+	wc [n] = L'\0';
+	return '\0' == sz [n] && parseWOLprobeW (pv, wc);
+}
+
+void initWOLplan (SWOLPLAN *pp)
+{
+	memsetU (pp, 0, sizeof (SWOLPLAN));
+	pp->uiLast = U_WOLPLAN_NONE;
+}
+
+/*
+	Appends a new stage to pp, and space for the names of its dependencies to *ppAfter,
+	and returns the stage, or NULL if the plan couldn't be extended.
+*/
+static SWOLSTAGE *newWOLstage (SWOLPLAN *pp, char **ppAfter)
+{
+	if (pp->nStages == pp->nAlloc)
+	{
+		uint32_t	nNew	= pp->nAlloc ? 2 * pp->nAlloc : 16;
+		SWOLSTAGE	*ps;
+		char		*pa;
+		if (pp->pStages)
+			ps = HeapReAlloc (GetProcessHeap (), 0, pp->pStages, (size_t) nNew * sizeof (SWOLSTAGE));
+		else
+			ps = HeapAlloc (GetProcessHeap (), 0, (size_t) nNew * sizeof (SWOLSTAGE));
+		if (NULL == ps)
+			return NULL;
+		pp->pStages = ps;
+		if (*ppAfter)
+			pa = HeapReAlloc (GetProcessHeap (), 0, *ppAfter, (size_t) nNew * U_WOLPLAN_AFTER_SIZ);
+		else
+			pa = HeapAlloc (GetProcessHeap (), 0, (size_t) nNew * U_WOLPLAN_AFTER_SIZ);
+		if (NULL == pa)
+			return NULL;
+		*ppAfter	= pa;
+		pp->nAlloc	= nNew;
+	}
+	SWOLSTAGE *ps = pp->pStages + pp->nStages;
+	memsetU (ps, 0, sizeof (SWOLSTAGE));
+	(*ppAfter) [(size_t) pp->nStages * U_WOLPLAN_AFTER_SIZ] = '\0';
+	return ps;
+}
+
+/*
+	Selects the hosts of the stage ps with the selector szSel from the inventory pi and adds
+	them to the stage's list. psel is the memory for the selector.
+*/
+static enum eWOLplanRet selectWOLstage	(
+							SWOLSTAGE *ps, SWOLSELECTOR *psel, const char *szSel,
+							const SWOLINVENTORY *pi
+										)
+{
+	SWOLSELECTION	sel;
+	uint32_t		n;
+
+	initWOLselector (psel);
+	if (wolselOk != addWOLselectorU8 (psel, szSel))
+		return wolplanSelector;
+	if (!selectWOLinventory (&sel, psel, pi))
+		return wolplanErrMemory;
+	for (n = 0; n < sel.nSelected; ++ n)
+	{
+		const SWOLINVRECORD *pr = pi->pRecs + sel.puiSlots [n];
+		if (wolretErrMemory == addWOLinventoryTarget (&ps->wl, pi, pr, ps->nLine, NULL))
+		{
+			doneWOLselection (&sel);
+			return wolplanErrMemory;
+		}
+	}
+	doneWOLselection (&sel);
+	return wolplanOk;
+}
+
+/*
+	Parses a line of the plan file into a new stage of pp. Blank lines and comments don't
+	add a stage.
+*/
+static enum eWOLplanRet parseWOLplanLineU8	(
+							SWOLPLAN *pp, char **ppAfter, char *szLine, uint64_t nLine,
+							SWOLSELECTOR *psel, const SWOLINVENTORY *pi,
+							const SWOLLIST *plTemplate, const SWOLVERIFY *pvTemplate
+											)
+{
+	char		*szName;
+	char		*szSel;
+	char		*szTok;
+	char		*szVal;
+	uint32_t	s;
+
+	while (' ' == *szLine || '\t' == *szLine)
+		++ szLine;
+	if ('\0' == *szLine || '#' == *szLine || ';' == *szLine)
+		return wolplanOk;
+	szName	= nextWOLplanTokenU8 (&szLine);
+	szSel	= nextWOLplanTokenU8 (&szLine);
+	if (NULL == szSel || strlenU (szName) >= U_WOLPLAN_NAME_SIZ)
+		return wolplanSyntax;
+	for (s = 0; s < pp->nStages; ++ s)
+	{
+		if (isWOLplanName (pp->pStages [s].szName, szName))
+			return wolplanDuplicate;
+	}
+
+	SWOLSTAGE *ps = newWOLstage (pp, ppAfter);
+	if (NULL == ps)
+		return wolplanErrMemory;
+	char *szAfter = *ppAfter + (size_t) pp->nStages * U_WOLPLAN_AFTER_SIZ;
+	// From here on the stage belongs to the plan, so that doneWOLplan () releases its list.
+	++ pp->nStages;
+	memcpyU (ps->szName, szName, strlenU (szName) + 1);
+	ps->nLine = nLine;
+	initWOLlist (&ps->wl);
+	memcpyU (&ps->wl.policy, &plTemplate->policy, sizeof (SWOLPOLICY));
+	ps->wl.bUseUSO		= plTemplate->bUseUSO;
+	ps->wl.uiRate		= plTemplate->uiRate;
+	ps->wl.uiGroupRate	= plTemplate->uiGroupRate;
+	memcpyU (&ps->wv, pvTemplate, sizeof (SWOLVERIFY));
+	while ((szTok = nextWOLplanTokenU8 (&szLine)))
+	{
+		if ((szVal = valueWOLplanKey (szTok, "after")))
+		{
+			size_t len = strlenU (szVal);
+			if (len >= U_WOLPLAN_AFTER_SIZ)
+				return wolplanTooManyAfter;
+			memcpyU (szAfter, szVal, len + 1);
+		} else
+		if ((szVal = valueWOLplanKey (szTok, "verify")))
+		{
+			if (!parseWOLplanProbe (&ps->wv, szVal))
+				return wolplanSyntax;
+		} else
+		if ((szVal = valueWOLplanKey (szTok, "timeout")))
+		{
+			if (!parseWOLplanSeconds (&ps->wv.uiTimeoutMs, szVal))
+				return wolplanSyntax;
+		} else
+		if ((szVal = valueWOLplanKey (szTok, "wait")))
+		{
+			if (!parseWOLplanSeconds (&ps->uiWaitMs, szVal))
+				return wolplanSyntax;
+		} else
+		if (isWOLplanName (szTok, "required"))
+			ps->bRequired = true;
+		else
+			return wolplanSyntax;
+	}
+	ps->bVerify = wolprobeNone != ps->wv.probe;
+	return selectWOLstage (ps, psel, szSel, pi);
+}
+
+/*
+	Returns the index of the stage szName, or U_WOLPLAN_NONE.
+*/
+static uint32_t findWOLstage (const SWOLPLAN *pp, const char *szName)
+{
+	uint32_t s;
+
+	for (s = 0; s < pp->nStages; ++ s)
+	{
+		if (isWOLplanName (pp->pStages [s].szName, szName))
+			return s;
+	}
+	return U_WOLPLAN_NONE;
+}
+
+/*
+	Resolves the names of the dependencies of all stages to their indices.
+*/
+static enum eWOLplanRet resolveWOLplan (SWOLPLAN *pp, char *pAfter)
+{
+	uint32_t s, a;
+
+	for (s = 0; s < pp->nStages; ++ s)
+	{
+		SWOLSTAGE	*ps		= pp->pStages + s;
+		char		*sz		= pAfter + (size_t) s * U_WOLPLAN_AFTER_SIZ;
+
+		pp->nLine = ps->nLine;
+		while (*sz)
+		{
+			char *szName = sz;
+			while (*sz && ',' != *sz)
+				++ sz;
+			if (*sz)
+				*sz ++ = '\0';
+			if ('\0' == *szName)
+				continue;
+			uint32_t uiDep = findWOLstage (pp, szName);
+			if (U_WOLPLAN_NONE == uiDep)
+				return wolplanUnknownStage;
+			for (a = 0; a < ps->nAfter && ps->uiAfter [a] != uiDep; ++ a)
+				;
+			if (a < ps->nAfter)
+				continue;
+			if (U_WOLPLAN_MAX_AFTER == ps->nAfter)
+				return wolplanTooManyAfter;
+			ps->uiAfter [ps->nAfter ++] = uiDep;
+		}
+	}
+	pp->nLine = 0;
+	return wolplanOk;
+}
+
+static bool isWOLstageAfter (const SWOLSTAGE *ps, uint32_t uiDep)
+{
+	uint32_t a;
+
+	for (a = 0; a < ps->nAfter; ++ a)
+	{
+		if (uiDep == ps->uiAfter [a])
+			return true;
+	}
+	return false;
+}
+
+/*
+	Checks that the stages form a DAG by removing stages without pending dependencies
+	until none are left (Kahn's algorithm). Stages that remain are on a cycle, or depend
+	on one.
+*/
+static enum eWOLplanRet checkWOLplanCycles (SWOLPLAN *pp)
+{
+	uint32_t	*puiQueue;
+	uint32_t	nHead	= 0;
+	uint32_t	nTail	= 0;
+	uint32_t	s, d;
+
+	puiQueue = HeapAlloc (GetProcessHeap (), 0, ((size_t) pp->nStages + 1) * sizeof (uint32_t));
+	if (NULL == puiQueue)
+		return wolplanErrMemory;
+	for (s = 0; s < pp->nStages; ++ s)
+	{
+		pp->pStages [s].nPending = pp->pStages [s].nAfter;
+		if (0 == pp->pStages [s].nAfter)
+			puiQueue [nTail ++] = s;
+	}
+	while (nHead < nTail)
+	{
+		s = puiQueue [nHead ++];
+		for (d = 0; d < pp->nStages; ++ d)
+		{
+			if (isWOLstageAfter (pp->pStages + d, s) && 0 == -- pp->pStages [d].nPending)
+				puiQueue [nTail ++] = d;
+		}
+	}
+	HeapFree (GetProcessHeap (), 0, puiQueue);
+	if (nTail == pp->nStages)
+		return wolplanOk;
+	// Follow pending dependencies until a stage repeats, which is on the cycle.
+	for (s = 0; 0 == pp->pStages [s].nPending; ++ s)
+		;
+	for (d = 0; d < pp->nStages; ++ d)
+	{
+		uint32_t a;
+		for (a = 0; 0 == pp->pStages [pp->pStages [s].uiAfter [a]].nPending; ++ a)
+			;
+		s = pp->pStages [s].uiAfter [a];
+	}
+	pp->nLine = pp->pStages [s].nLine;
+	return wolplanCycle;
+}
+
+enum eWOLplanRet readWOLplanW	(
+					SWOLPLAN *pp, const wchar_t *wzFile, const SWOLINVENTORY *pi,
+					const SWOLLIST *plTemplate, const SWOLVERIFY *pvTemplate
+								)
+{
+	SLINEREADER			lr;
+	SWOLSELECTOR		*psel;
+	char				*pAfter		= NULL;
+	char				*szLine;
+	enum eWOLplanRet	ret			= wolplanOk;
+
+	pp->nLine = 0;
+	// Too big for the stack.
+	psel = HeapAlloc (GetProcessHeap (), 0, sizeof (SWOLSELECTOR));
+	if (NULL == psel)
+		return wolplanErrMemory;
+	if (!openLineReaderW (&lr, wzFile))
+	{
+		HeapFree (GetProcessHeap (), 0, psel);
+		return wolplanErrRead;
+	}
+	while (wolplanOk == ret && (szLine = nextLineU8 (&lr, NULL)))
+	{
+		ret = parseWOLplanLineU8 (pp, &pAfter, szLine, lr.nLine, psel, pi, plTemplate, pvTemplate);
+		if (wolplanOk != ret)
+			pp->nLine = lr.nLine;
+	}
+	closeLineReader (&lr);
+	HeapFree (GetProcessHeap (), 0, psel);
+	if (wolplanOk == ret && pp->nStages)
+		ret = resolveWOLplan (pp, pAfter);
+	if (wolplanOk == ret && pp->nStages)
+		ret = checkWOLplanCycles (pp);
+	if (pAfter)
+		HeapFree (GetProcessHeap (), 0, pAfter);
+	return ret;
+}
+
+/*
+	Returns the performance counter ticks since the start of the plan.
+*/
+static uint64_t nowWOLplan (const SWOLPLAN *pp)
+{
+	LARGE_INTEGER li;
+
+	QueryPerformanceCounter (&li);
+	return (uint64_t) li.QuadPart - pp->uiStart;
+}
+
+static uint64_t ticksWOLplan (const SWOLPLAN *pp, uint64_t uiMs)
+{
+	return uiMs * pp->uiTicksPerSec / 1000;
+}
+
+/*
+	Schedules the next retry round of a stage without verification, if any. Stages with
+	verification send their retry rounds in stepWOLverify ().
+*/
+static void scheduleWOLstageRound (const SWOLPLAN *pp, SWOLSTAGE *ps, uint64_t uiNow)
+{
+	SWOLPOLICY *pol = &ps->wl.policy;
+
+	ps->uiNextRound = U_WOLPLAN_NEVER;
+	if (ps->wl.nRounds && ps->wl.nRounds <= pol->uiRetries)
+		ps->uiNextRound = uiNow + ticksWOLplan (pp, backoffWOLpolicyMs (pol, ps->wl.nRounds));
+}
+
+/*
+	Counts down the pending dependencies of the dependents of the stage s, which has
+	ended. If s failed and is required, or was skipped, its dependents are skipped too.
+*/
+static void releaseWOLdependents (SWOLPLAN *pp, uint32_t s)
+{
+	const SWOLSTAGE	*ps		= pp->pStages + s;
+	bool			bFail	=		wolstgSkipped == ps->state
+								||	(wolstgDone != ps->state && ps->bRequired);
+	uint32_t		d;
+
+	for (d = 0; d < pp->nStages; ++ d)
+	{
+		SWOLSTAGE *pd = pp->pStages + d;
+		if (!isWOLstageAfter (pd, s))
+			continue;
+		-- pd->nPending;
+		// Stages end in chronological order, hence the last one to end is the gate.
+		pd->uiGate = s;
+		if (bFail)
+			pd->bSkip = true;
+	}
+}
+
+static void endWOLstage (SWOLPLAN *pp, uint32_t s, enum eWOLstage state)
+{
+	SWOLSTAGE *ps = pp->pStages + s;
+
+	if (wolstgRunning == ps->state)
+		-- pp->nRunning;
+	ps->state	= state;
+	ps->uiEnd	= nowWOLplan (pp);
+	if (ps->uiEnd >= pp->uiEnd)
+	{
+		pp->uiEnd	= ps->uiEnd;
+		pp->uiLast	= s;
+	}
+	if (pp->pfnEvent)
+		pp->pfnEvent (pp, ps);
+	releaseWOLdependents (pp, s);
+}
+
+/*
+	Sends the magic packets of the stage s and starts verifying its hosts.
+*/
+static void startWOLstage (SWOLPLAN *pp, uint32_t s)
+{
+	SWOLSTAGE *ps = pp->pStages + s;
+
+	ps->state	= wolstgRunning;
+	ps->uiStart	= nowWOLplan (pp);
+	++ pp->nRunning;
+	if (pp->pfnEvent)
+		pp->pfnEvent (pp, ps);
+	if (ps->wl.nTargets)
+		sendWOLlist (&ps->wl);
+	if (ps->bVerify && !startWOLverify (&ps->wv, &ps->wl, pp->hIOCP))
+	{
+		doneWOLverify (&ps->wv);
+		ps->bVerify = false;
+	}
+	if (!ps->bVerify)
+		scheduleWOLstageRound (pp, ps, nowWOLplan (pp));
+}
+
+/*
+	Starts all stages whose dependencies have ended, and skips the ones that depend on a
+	failed required stage, until there are no more.
+*/
+static void startReadyWOLstages (SWOLPLAN *pp)
+{
+	bool		bAgain	= true;
+	uint32_t	s;
+
+	while (bAgain)
+	{
+		bAgain = false;
+		for (s = 0; s < pp->nStages; ++ s)
+		{
+			SWOLSTAGE *ps = pp->pStages + s;
+			if (wolstgWaiting != ps->state || ps->nPending)
+				continue;
+			if (ps->bSkip)
+			{
+				ps->uiStart = nowWOLplan (pp);
+				endWOLstage (pp, s, wolstgSkipped);
+				bAgain = true;
+			} else
+				startWOLstage (pp, s);
+		}
+	}
+}
+
+/*
+	Does what's due for the running stage ps. Returns the time at which the stage needs
+	attention again, or 0 if it has ended.
+*/
+static uint64_t stepWOLstage (SWOLPLAN *pp, SWOLSTAGE *ps, uint64_t uiNow)
+{
+	if (ps->bVerify)
+	{
+		uint64_t uiWake = stepWOLverify (&ps->wv);
+		if (0 == uiWake)
+			return 0;
+		return uiWake > pp->uiStart ? uiWake - pp->uiStart : 1;
+	}
+	if (ps->uiNextRound <= uiNow)
+	{
+		sendWOLlist (&ps->wl);
+		uiNow = nowWOLplan (pp);
+		scheduleWOLstageRound (pp, ps, uiNow);
+	}
+	uint64_t uiDone = ps->uiStart + ticksWOLplan (pp, ps->uiWaitMs);
+	if (U_WOLPLAN_NEVER == ps->uiNextRound && uiNow >= uiDone)
+		return 0;
+	return ps->uiNextRound < uiDone ? ps->uiNextRound : uiDone;
+}
+
+enum eWOLplanRet runWOLplan (SWOLPLAN *pp)
+{
+	LARGE_INTEGER	li;
+	uint32_t		s;
+
+	pp->hIOCP = CreateIoCompletionPort (INVALID_HANDLE_VALUE, NULL, 0, 1);
+	if (NULL == pp->hIOCP)
+		return wolplanErrIOCP;
+	QueryPerformanceFrequency (&li);
+	pp->uiTicksPerSec	= (uint64_t) li.QuadPart;
+	QueryPerformanceCounter (&li);
+	pp->uiStart			= (uint64_t) li.QuadPart;
+	pp->uiEnd			= 0;
+	pp->uiLast			= U_WOLPLAN_NONE;
+	pp->nRunning		= 0;
+	for (s = 0; s < pp->nStages; ++ s)
+	{
+		SWOLSTAGE *ps = pp->pStages + s;
+		ps->nPending	= ps->nAfter;
+		ps->uiGate		= U_WOLPLAN_NONE;
+		ps->bSkip		= false;
+		ps->state		= wolstgWaiting;
+	}
+
+	startReadyWOLstages (pp);
+	while (pp->nRunning)
+	{
+		uint64_t	uiNow	= nowWOLplan (pp);
+		uint64_t	uiWake	= U_WOLPLAN_NEVER;
+		bool		bEnded	= false;
+
+		for (s = 0; s < pp->nStages; ++ s)
+		{
+			SWOLSTAGE *ps = pp->pStages + s;
+			if (wolstgRunning != ps->state)
+				continue;
+			uint64_t uiStep = stepWOLstage (pp, ps, uiNow);
+			if (0 == uiStep)
+			{
+				enum eWOLstage state = wolstgDone;
+				if (ps->bVerify)
+				{
+					endWOLverify (&ps->wv);
+					if (ps->wv.nUp < ps->wv.nProbes)
+						state = wolstgTimedOut;
+				}
+				endWOLstage (pp, s, state);
+				bEnded = true;
+			} else
+			if (uiStep < uiWake)
+				uiWake = uiStep;
+		}
+		if (bEnded)
+		{
+			// Dependents start without waiting.
+			startReadyWOLstages (pp);
+			continue;
+		}
+		uiNow = nowWOLplan (pp);
+		uint64_t uiMs = uiWake > uiNow
+						? ((uiWake - uiNow) * 1000 + pp->uiTicksPerSec - 1) / pp->uiTicksPerSec
+						: 0;
+		if (uiMs > 0x7FFFFFFF)
+			uiMs = 0x7FFFFFFF;
+		// Completions and APCs of the probes of all stages.
+		waitWOLverifyIOCP (pp->hIOCP, (DWORD) uiMs);
+	}
+	CloseHandle (pp->hIOCP);
+	pp->hIOCP = NULL;
+	return wolplanOk;
+}
+
+uint32_t criticalWOLplan (const SWOLPLAN *pp, uint32_t *puiPath)
+{
+	uint32_t	n	= 0;
+	uint32_t	s	= pp->uiLast;
+	uint32_t	i;
+
+	while (U_WOLPLAN_NONE != s && n < pp->nStages)
+	{
+		puiPath [n ++]	= s;
+		s				= pp->pStages [s].uiGate;
+	}
+	for (i = 0; i < n / 2; ++ i)
+	{
+		s					= puiPath [i];
+		puiPath [i]			= puiPath [n - 1 - i];
+		puiPath [n - 1 - i]	= s;
+	}
+	return n;
+}
+
+void doneWOLplan (SWOLPLAN *pp)
+{
+	uint32_t s;
+
+	for (s = 0; s < pp->nStages; ++ s)
+	{
+		doneWOLverify (&pp->pStages [s].wv);
+		doneWOLlist (&pp->pStages [s].wl);
+	}
+	if (pp->pStages)
+		HeapFree (GetProcessHeap (), 0, pp->pStages);
+	if (pp->hIOCP)
+		CloseHandle (pp->hIOCP);
+	initWOLplan (pp);
+}
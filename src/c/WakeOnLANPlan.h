@@ -0,0 +1,227 @@
+/****************************************************************************************
+
+File		WakeOnLANPlan.h
+Why:		Wake plans: stages of hosts woken in dependency order.
+OS:			Windows
+Created:	2026-10-17
+
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2026-10-17	Thomas			Created.
+
+****************************************************************************************/
+
+/*
+	This file is maintained as part of OnOffMate. See https://github.com/ThomasPGH/OnOffMate .
+*/
+
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Copyright (c) 2024, 2025, 2026 Thomas
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+
+#ifndef U_WAKEONLANPLAN_H
+#define U_WAKEONLANPLAN_H
+
+#include <stdbool.h>
+#include <inttypes.h>
+#include "./WakeOnLAN.h"
+#include "./WakeOnLANInventory.h"
+#include "./WakeOnLANVerify.h"
+#include "./externC.h"
+
+/*
+	The maximum length of a stage name, including the NUL, and the maximum amount of
+	stages a stage can depend on.
+*/
+#ifndef U_WOLPLAN_NAME_SIZ
+#define U_WOLPLAN_NAME_SIZ				(64)
+#endif
+#ifndef U_WOLPLAN_MAX_AFTER
+#define U_WOLPLAN_MAX_AFTER				(16)
+#endif
+
+#define U_WOLPLAN_NONE					((uint32_t) -1)
+
+enum eWOLstage
+{
+	wolstgWaiting,											// For its dependencies.
+	wolstgRunning,
+	wolstgDone,												// All hosts up, or no probes.
+	wolstgTimedOut,											// Not all hosts up in time.
+	wolstgSkipped											// A required stage failed.
+};
+
+/*
+	SWOLSTAGE
+
+	A stage of a wake plan: the hosts selected on one line of the plan file, and the
+	stages that must be finished before they're woken. Times are performance counter
+	ticks since the start of the plan.
+*/
+typedef struct swolstage
+{
+	char				szName [U_WOLPLAN_NAME_SIZ];
+	uint64_t			nLine;
+	uint32_t			uiAfter [U_WOLPLAN_MAX_AFTER];		// Indices of the dependencies.
+	uint32_t			nAfter;
+	uint32_t			nPending;							// Dependencies not finished.
+	uint32_t			uiGate;								// The one that finished last.
+	bool				bRequired;							// Dependents need it up.
+	bool				bSkip;								// A dependency failed.
+	bool				bVerify;
+	uint64_t			uiWaitMs;							// Without verification.
+	enum eWOLstage		state;
+	uint64_t			uiStart;
+	uint64_t			uiEnd;
+	uint64_t			uiNextRound;						// Without verification.
+	SWOLLIST			wl;
+	SWOLVERIFY			wv;
+} SWOLSTAGE;
+
+struct swolplan;
+
+/*
+	Called when a stage starts or ends. The state member of ps tells which.
+*/
+typedef void (*pfnWOLplanEvent) (const struct swolplan *pp, const SWOLSTAGE *ps);
+
+/*
+	SWOLPLAN
+
+	A wake plan. The stages form a directed acyclic graph. See readWOLplanW ().
+*/
+typedef struct swolplan
+{
+	SWOLSTAGE			*pStages;
+	uint32_t			nStages;
+	uint32_t			nAlloc;
+	uint32_t			nRunning;
+	uint32_t			uiLast;								// Stage that ended last.
+	uint64_t			nLine;								// Line of an error.
+	uint64_t			uiTicksPerSec;
+	uint64_t			uiStart;							// Performance counter.
+	uint64_t			uiEnd;								// Ticks since uiStart.
+	HANDLE				hIOCP;								// Shared by all stages.
+	pfnWOLplanEvent		pfnEvent;							// Set by caller, or NULL.
+} SWOLPLAN;
+
+enum eWOLplanRet
+{
+	wolplanOk,
+	wolplanErrRead,											// GetLastError () tells more.
+	wolplanErrMemory,
+	wolplanSyntax,
+	wolplanSelector,
+	wolplanDuplicate,										// Stage defined twice.
+	wolplanUnknownStage,
+	wolplanTooManyAfter,
+	wolplanCycle,
+	wolplanErrIOCP											// GetLastError () tells more.
+};
+
+EXTERN_C_BEGIN
+
+/*
+	initWOLplan
+
+	Initialises the plan pp without any stages.
+*/
+void initWOLplan (SWOLPLAN *pp)
+;
+
+/*
+	readWOLplanW
+
+	Reads the wake plan wzFile, or standard input if wzFile is "-". Each line declares a
+	stage:
+
+	<stage> <selector> [after=<stage>[,<stage>...]] [verify=tcp:<port>|icmp|none]
+		[timeout=<s>] [wait=<s>] [required]
+
+	<selector> selects the hosts of the stage from the inventory pi, and cannot contain
+	spaces. See addWOLselectorU8 (). The stage is started when all stages in after= have
+	ended, which can be declared on any line. Its hosts are woken like a WOL list, with
+	the send policy and pacing of plTemplate, and verified with the probe of verify=, or
+	of pvTemplate if the line has none. The stage ends when all its hosts are up or after
+	timeout=<s> seconds, or, without verification, after wait=<s> seconds (default 0)
+	and the last retry round. A stage marked "required" that times out causes its
+	dependents, and theirs, to be skipped. Empty lines and lines starting with '#' or ';'
+	are ignored.
+
+	Example:
+	nas			group:storage		verify=tcp:445		timeout=300		required
+	license		lic-01				verify=tcp:27000
+	compute		group:compute		after=nas,license	verify=icmp
+	login		login-*				after=compute		wait=30
+
+	The function returns wolplanOk on success. On all errors the nLine member of pp is
+	the line of the error. A cycle is reported for the line of a stage on the cycle.
+*/
+enum eWOLplanRet readWOLplanW	(
+					SWOLPLAN *pp, const wchar_t *wzFile, const SWOLINVENTORY *pi,
+					const SWOLLIST *plTemplate, const SWOLVERIFY *pvTemplate
+								)
+;
+
+/*
+	runWOLplan
+
+	Runs the plan pp. All stages whose dependencies have ended are started right away,
+	and run in parallel. All stages are driven by a single loop in the calling thread:
+	the probes of all stages wait on the same completion port, and the loop wakes up
+	when a probe completes, a retry round is due, or a stage times out. When the function
+	returns, the uiStart and uiEnd members of each stage tell when it ran, and its uiGate
+	member which dependency ended last, which makes it the one the stage waited for. See
+	criticalWOLplan ().
+*/
+enum eWOLplanRet runWOLplan (SWOLPLAN *pp)
+;
+
+/*
+	criticalWOLplan
+
+	Stores the critical path of the plan at puiPath, which has space for nStages entries,
+	starting with the first stage on the path, and returns its length. The critical path
+	ends with the stage that ended last, and each stage on it is preceded by the
+	dependency it waited for.
+*/
+uint32_t criticalWOLplan (const SWOLPLAN *pp, uint32_t *puiPath)
+;
+
+/*
+	doneWOLplan
+
+	Releases all resources of the plan pp.
+*/
+void doneWOLplan (SWOLPLAN *pp)
+;
+
+EXTERN_C_END
+
+#endif														// Of #ifndef U_WAKEONLANPLAN_H.
@@ -0,0 +1,204 @@
+/****************************************************************************************
+
+File		WakeOnLANRelay.c
+Why:		Relays magic packets to other subnets.
+OS:			Windows
+Created:	2026-10-17
+
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2026-10-17	Thomas			Created.
+2026-10-17	Thomas			Egress addresses with IPv6 scope ids, e.g. ff02::1%12.
+
+****************************************************************************************/
+
+/*
+	This file is maintained as part of OnOffMate. See https://github.com/ThomasPGH/OnOffMate .
+*/
+
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Copyright (c) 2024, 2025, 2026 Thomas
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "./WakeOnLANRelay.h"
+#include <Windows.h>
+#include "./WinRuntimeReplacements.h"
+
+/*
+	Opens a non-blocking broadcast UDP socket for iFamily bound to an ephemeral port and
+	stores the port in puiPort.
+*/
+static SOCKET openWOLrelaySocket (int iFamily, uint16_t *puiPort)
+{
+	struct sockaddr_storage	ss;
+	int						len;
+	u_long					ulNonBlocking	= 1;
+	BOOL					bBrc			= true;
+	DWORD					dwV6only		= 1;
+	SOCKET					s;
+
+	s = socket (iFamily, SOCK_DGRAM, IPPROTO_UDP);
+	if (INVALID_SOCKET == s)
+		return s;
+
+	memsetU (&ss, 0, sizeof (ss));
+	ss.ss_family = (ADDRESS_FAMILY) iFamily;
+	len = AF_INET == iFamily ? sizeof (struct sockaddr_in) : sizeof (struct sockaddr_in6);
+	if (AF_INET6 == iFamily)
+		setsockopt (s, IPPROTO_IPV6, IPV6_V6ONLY, (char *) &dwV6only, sizeof (DWORD));
+	if	(
+				0 != setsockopt (s, SOL_SOCKET, SO_BROADCAST, (char *) &bBrc, sizeof (BOOL))
+			||	0 != ioctlsocket (s, FIONBIO, &ulNonBlocking)
+			||	0 != bind (s, (struct sockaddr *) &ss, len)
+			||	0 != getsockname (s, (struct sockaddr *) &ss, &len)
+		)
+	{
+		closesocket (s);
+		return INVALID_SOCKET;
+	}
+	// sin_port and sin6_port are at the same offset.
+	*puiPort = ntohs (((struct sockaddr_in *) &ss)->sin_port);
+	return s;
+}
+
+bool openWOLrelay (SWOLRELAY *pr, const uint16_t *puiPorts, size_t nPorts)
+{
+	memsetU (pr, 0, sizeof (SWOLRELAY));
+	pr->s4 = INVALID_SOCKET;
+	pr->s6 = INVALID_SOCKET;
+	if (!openWOLlistener (&pr->listener, puiPorts, nPorts))
+		return false;
+	pr->s4 = openWOLrelaySocket (AF_INET, &pr->uiPort4);
+	pr->s6 = openWOLrelaySocket (AF_INET6, &pr->uiPort6);
+	if (INVALID_SOCKET != pr->s4 || INVALID_SOCKET != pr->s6)
+		return true;
+	closeWOLrelay (pr);
+	return false;
+}
+
+bool addWOLrelayEgressU8 (SWOLRELAY *pr, const char *szIP)
+{
+	SWOLEGRESS	*pe;
+
+	if (pr->nEgress >= U_WAKEONLAN_RELAY_MAX_EGRESS)
+		return false;
+	pe = &pr->egress [pr->nEgress];
+	memsetU (pe, 0, sizeof (SWOLEGRESS));
+
+	if (!parseWOLpeerU8 (&pe->ssPeer, &pe->lenPeer, szIP, false))
+		return false;
+	if (INVALID_SOCKET == (AF_INET == pe->ssPeer.ss_family ? pr->s4 : pr->s6))
+		return false;
+	++ pr->nEgress;
+	return true;
+}
+
+/*
+	Returns true if the packet in pwr has been sent by one of the relay's own sockets,
+	for instance when the relay listens on the port it relays to.
+*/
+static bool isWOLrelayLoop (SWOLRELAY *pr, SWOLRECV *pwr)
+{
+	uint16_t uiPort = ntohs (((struct sockaddr_in *) &pwr->ssSource)->sin_port);
+
+	if (AF_INET == pwr->ssSource.ss_family)
+		return INVALID_SOCKET != pr->s4 && uiPort == pr->uiPort4;
+	return INVALID_SOCKET != pr->s6 && uiPort == pr->uiPort6;
+}
+
+/*
+	Callback for the listener. Sends the magic packet to all egress addresses.
+*/
+static void relayWOLrecv (SWOLRECV *pwr, void *pCustom)
+{
+	SWOLRELAY		*pr		= pCustom;
+	LARGE_INTEGER	liSent;
+	size_t			n;
+	bool			bSent	= false;
+
+	if (isWOLrelayLoop (pr, pwr))
+	{
+		++ pr->nLooped;
+		return;
+	}
+	initWOLmagicPacket (pr->cMagicPacket, pwr->ucMAC);
+	for (n = 0; n < pr->nEgress; ++ n)
+	{
+		SWOLEGRESS	*pe	= &pr->egress [n];
+		SOCKET		s	= AF_INET == pe->ssPeer.ss_family ? pr->s4 : pr->s6;
+
+		++ pr->nSendCalls;
+		if	(
+					!setWOLmulticastIf (s, &pe->ssPeer, &pr->ulMcastIf6)
+				||	SOCKET_ERROR == sendto	(
+										s, pr->cMagicPacket, sizeof (pr->cMagicPacket), 0,
+										(struct sockaddr *) &pe->ssPeer, pe->lenPeer
+											)
+			)
+		{
+			++ pe->nFailed;
+		} else
+		{
+			++ pe->nSent;
+			bSent = true;
+		}
+	}
+	if (!bSent)
+		return;
+	QueryPerformanceCounter (&liSent);
+	uint64_t uiLatency = (uint64_t) liSent.QuadPart - pwr->uiTickReceived;
+	if (0 == pr->nRelayed || uiLatency < pr->uiLatencyMin)
+		pr->uiLatencyMin = uiLatency;
+	if (uiLatency > pr->uiLatencyMax)
+		pr->uiLatencyMax = uiLatency;
+	pr->uiLatencyTicks += uiLatency;
+	++ pr->nRelayed;
+	if (pr->fnc)
+		pr->fnc (pwr, pr->pCustom);
+}
+
+void runWOLrelay (SWOLRELAY *pr, pfnWOLrecv fnc, void *pCustom)
+{
+	pr->fnc		= fnc;
+	pr->pCustom	= pCustom;
+	runWOLlistener (&pr->listener, relayWOLrecv, pr);
+}
+
+void stopWOLrelay (SWOLRELAY *pr)
+{
+	stopWOLlistener (&pr->listener);
+}
+
+void closeWOLrelay (SWOLRELAY *pr)
+{
+	closeWOLlistener (&pr->listener);
+	if (INVALID_SOCKET != pr->s4)
+		closesocket (pr->s4);
+	if (INVALID_SOCKET != pr->s6)
+		closesocket (pr->s6);
+	pr->s4 = INVALID_SOCKET;
+	pr->s6 = INVALID_SOCKET;
+}
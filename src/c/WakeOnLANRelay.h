@@ -0,0 +1,153 @@
+/****************************************************************************************
+
+File		WakeOnLANRelay.h
+Why:		Relays magic packets to other subnets.
+OS:			Windows
+Created:	2026-10-17
+
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2026-10-17	Thomas			Created.
+2026-10-17	Thomas			Egress addresses with IPv6 scope ids, e.g. ff02::1%12.
+
+****************************************************************************************/
+
+/*
+	This file is maintained as part of OnOffMate. See https://github.com/ThomasPGH/OnOffMate .
+*/
+
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Copyright (c) 2024, 2025, 2026 Thomas
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef U_WAKEONLANRELAY_H
+#define U_WAKEONLANRELAY_H
+
+#include <stdbool.h>
+#include <inttypes.h>
+#include "./WakeOnLANListen.h"
+#include "./externC.h"
+
+/*
+	The maximum amount of broadcast addresses a relay forwards magic packets to.
+*/
+#ifndef U_WAKEONLAN_RELAY_MAX_EGRESS
+#define U_WAKEONLAN_RELAY_MAX_EGRESS		(32)
+#endif
+
+EXTERN_C_BEGIN
+
+/*
+	SWOLEGRESS
+
+	A broadcast address magic packets are relayed to.
+*/
+typedef struct swolegress
+{
+	struct sockaddr_storage		ssPeer;
+	int							lenPeer;
+	uint64_t					nSent;
+	uint64_t					nFailed;
+} SWOLEGRESS;
+
+/*
+	SWOLRELAY
+
+	The relay's listener, egress addresses, send sockets, and counters.
+*/
+typedef struct swolrelay
+{
+	SWOLLISTENER				listener;
+	SWOLEGRESS					egress [U_WAKEONLAN_RELAY_MAX_EGRESS];
+	size_t						nEgress;
+	SOCKET						s4;							// IPv4 send socket.
+	SOCKET						s6;							// IPv6 send socket.
+	uint16_t					uiPort4;					// Local port of s4.
+	uint16_t					uiPort6;					// Local port of s6.
+	ULONG						ulMcastIf6;					// IPV6_MULTICAST_IF of s6.
+	char						cMagicPacket [U_WAKEONLAN_MAGIC_PACKET_LEN];	// Reused send buffer.
+	uint64_t					nRelayed;					// Magic packets relayed.
+	uint64_t					nLooped;					// Own packets ignored.
+	uint64_t					nSendCalls;
+	uint64_t					uiLatencyTicks;				// Sum of relay latencies.
+	uint64_t					uiLatencyMin;
+	uint64_t					uiLatencyMax;
+	pfnWOLrecv					fnc;						// Called after relaying.
+	void						*pCustom;
+} SWOLRELAY;
+
+/*
+	openWOLrelay
+
+	Opens the relay's listener on the nPorts ports in puiPorts, and its IPv4 and IPv6 send
+	sockets. The function fails if the listener cannot be opened or if none of the send
+	sockets can be opened.
+*/
+bool openWOLrelay (SWOLRELAY *pr, const uint16_t *puiPorts, size_t nPorts)
+;
+
+/*
+	addWOLrelayEgressU8
+
+	Adds the broadcast address szIP (IPv4 or IPv6) magic packets are relayed to. Magic
+	packets are sent to port U_WAKEONLAN_MAGIC_PACKET_PORT of this address. An IPv6
+	multicast address can have a scope id, like "ff02::1%Ethernet". See parseWOLpeerU8 (). The function
+	returns false if szIP is not a valid address, if no send socket for its address
+	family is open, or if U_WAKEONLAN_RELAY_MAX_EGRESS addresses have been added already.
+*/
+bool addWOLrelayEgressU8 (SWOLRELAY *pr, const char *szIP)
+;
+
+/*
+	runWOLrelay
+
+	Relays magic packets until stopWOLrelay () is called. Each valid magic packet received
+	is rebuilt with initWOLmagicPacket () and sent to every egress address. Packets sent
+	by the relay itself are ignored. If fnc is not NULL it is called after a packet has
+	been relayed.
+*/
+void runWOLrelay (SWOLRELAY *pr, pfnWOLrecv fnc, void *pCustom)
+;
+
+/*
+	stopWOLrelay
+
+	Asks runWOLrelay () to return. The function can be called from another thread.
+*/
+void stopWOLrelay (SWOLRELAY *pr)
+;
+
+/*
+	closeWOLrelay
+
+	Closes the relay's sockets and frees its buffers.
+*/
+void closeWOLrelay (SWOLRELAY *pr)
+;
+
+EXTERN_C_END
+
+#endif														// Of #ifndef U_WAKEONLANRELAY_H.
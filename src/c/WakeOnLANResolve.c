@@ -0,0 +1,518 @@
+/****************************************************************************************
+
+File		WakeOnLANResolve.c
+Why:		Resolves host names of wake targets in parallel, with a TTL cache.
+OS:			Windows
+Created:	2026-10-17
+
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2026-10-17	Thomas			Created.
+
+****************************************************************************************/
+
+/*
+	This file is maintained as part of OnOffMate. See https://github.com/ThomasPGH/OnOffMate .
+*/
+
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Copyright (c) 2024, 2025, 2026 Thomas
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "./WakeOnLANResolve.h"
+#include <Windows.h>
+#include "./WinRuntimeReplacements.h"
+
+#pragma comment (lib, "Ws2_32.lib")
+
+/*
+	An entry of the cache. The names are stored in lower case. Entries are never removed,
+	only overwritten when their name is looked up again, hence the table can use linear
+	probing without tombstones. Expired entries are dropped when the table grows.
+*/
+typedef struct swolresentry
+{
+	uint32_t				uiHash;							// 0 for an empty slot.
+	SWOLRESOLVED			res;
+	char					szName [U_WAKEONLAN_HOST_SIZ];
+} SWOLRESENTRY;
+
+static SWOLRESENTRY		*pWOLres;
+static size_t			nWOLres;							// Slots in use.
+static size_t			nWOLresSlots;						// Always a power of 2.
+static volatile LONG	lWOLresTTLms	= U_WOLRESOLVE_TTL_MS;
+static volatile LONG	lWOLresNegTTLms	= U_WOLRESOLVE_NEG_TTL_MS;
+
+/*
+	Lookups hold the lock shared, new entries are added with the lock held exclusively.
+	The lock is never held during a call of GetAddrInfoW ().
+*/
+static SRWLOCK			srwWOLres		= SRWLOCK_INIT;
+
+bool isWOLhostNameU8 (const char *szName)
+{
+	const unsigned char	*p		= (const unsigned char *) szName;
+	size_t				len		= 0;
+	size_t				lenLbl	= 0;
+	bool				bAlpha	= false;
+
+	for (; *p; ++ p)
+	{
+		if (++ len > U_WAKEONLAN_HOST_LEN)
+			return false;
+		if ('.' == *p)
+		{
+			if (0 == lenLbl)
+				return false;
+			lenLbl = 0;
+			continue;
+		}
+		if (++ lenLbl > 63)
+			return false;
+		if (((*p | 0x20) >= 'a' && (*p | 0x20) <= 'z') || *p > 127)
+			bAlpha = true;
+		else
+		if (!(*p >= '0' && *p <= '9') && '-' != *p && '_' != *p)
+			return false;
+	}
+	// Without a letter it's an IPv4 address, or a mistyped one.
+	return bAlpha;
+}
+
+void setWOLresolveTTL (uint32_t uiTTLms, uint32_t uiNegTTLms)
+{
+	InterlockedExchange (&lWOLresTTLms, (LONG) (uiTTLms & 0x7FFFFFFF));
+	InterlockedExchange (&lWOLresNegTTLms, (LONG) (uiNegTTLms & 0x7FFFFFFF));
+}
+
+/*
+	Returns the FNV-1a hash of szName in lower case, which is never 0.
+*/
+static uint32_t hashWOLnameU8 (const char *szName)
+{
+	uint32_t	uiHash	= 2166136261u;
+	char		c;
+
+	while ((c = *szName ++))
+	{
+		uiHash ^= (uint32_t) (unsigned char) (c >= 'A' && c <= 'Z' ? c | 0x20 : c);
+		uiHash *= 16777619u;
+	}
+	return uiHash ? uiHash : 1;
+}
+
+/*
+	Returns true if the names sz1 and sz2 only differ in case.
+*/
+static bool isSameWOLnameU8 (const char *sz1, const char *sz2)
+{
+	for (;;)
+	{
+		char c1 = *sz1 ++;
+		char c2 = *sz2 ++;
+		if (c1 >= 'A' && c1 <= 'Z')
+			c1 |= 0x20;
+		if (c2 >= 'A' && c2 <= 'Z')
+			c2 |= 0x20;
+		if (c1 != c2)
+			return false;
+		if ('\0' == c1)
+			return true;
+	}
+}
+
+/*
+	Returns the slot of the name szName with the hash uiHash, or the empty slot it would be
+	stored in. The caller must hold the lock, and the table must exist.
+*/
+static SWOLRESENTRY *slotWOLresolved (const char *szName, uint32_t uiHash)
+{
+	size_t s = uiHash & (nWOLresSlots - 1);
+
+	while	(
+					pWOLres [s].uiHash
+				&&	(pWOLres [s].uiHash != uiHash || !isSameWOLnameU8 (pWOLres [s].szName, szName))
+			)
+		s = (s + 1) & (nWOLresSlots - 1);
+	return pWOLres + s;
+}
+
+/*
+	Copies the cache entry of szName to pr and returns true if it exists and has not
+	expired yet.
+*/
+static bool findWOLresolved (SWOLRESOLVED *pr, const char *szName, uint32_t uiHash)
+{
+	bool bFound = false;
+
+	AcquireSRWLockShared (&srwWOLres);
+	if (pWOLres)
+	{
+		SWOLRESENTRY *pe = slotWOLresolved (szName, uiHash);
+		if (pe->uiHash && GetTickCount64 () < pe->res.uiExpires)
+		{
+			memcpyU (pr, &pe->res, sizeof (SWOLRESOLVED));
+			bFound = true;
+		}
+	}
+	ReleaseSRWLockShared (&srwWOLres);
+	return bFound;
+}
+
+/*
+	Doubles the table, or creates it, and drops expired entries. The caller must hold the
+	lock exclusively.
+*/
+static bool growWOLresolved (void)
+{
+	size_t			nOld	= nWOLresSlots;
+	SWOLRESENTRY	*pOld	= pWOLres;
+	size_t			nNew	= nOld ? 2 * nOld : U_WOLRESOLVE_CACHE_INITIAL;
+	uint64_t		uiNow	= GetTickCount64 ();
+	size_t			n;
+
+	pWOLres = HeapAlloc (GetProcessHeap (), HEAP_ZERO_MEMORY, nNew * sizeof (SWOLRESENTRY));
+	if (NULL == pWOLres)
+	{
+		pWOLres = pOld;
+		return false;
+	}
+	nWOLresSlots	= nNew;
+	nWOLres			= 0;
+	for (n = 0; n < nOld; ++ n)
+	{
+		if (pOld [n].uiHash && uiNow < pOld [n].res.uiExpires)
+		{
+			memcpyU (slotWOLresolved (pOld [n].szName, pOld [n].uiHash), pOld + n, sizeof (SWOLRESENTRY));
+			++ nWOLres;
+		}
+	}
+	if (pOld)
+		HeapFree (GetProcessHeap (), 0, pOld);
+	return true;
+}
+
+/*
+	Adds the result pr of the name szName to the cache, or replaces the entry of the name.
+	Running out of memory only means the name is not cached.
+*/
+static void storeWOLresolved (const SWOLRESOLVED *pr, const char *szName, uint32_t uiHash)
+{
+	AcquireSRWLockExclusive (&srwWOLres);
+	// The load factor stays below 1/2.
+	if (2 * (nWOLres + 1) <= nWOLresSlots || growWOLresolved ())
+	{
+		SWOLRESENTRY	*pe		= slotWOLresolved (szName, uiHash);
+		size_t			len		= strlenU (szName);
+		size_t			n;
+
+		if (0 == pe->uiHash)
+			++ nWOLres;
+		pe->uiHash = uiHash;
+		memcpyU (&pe->res, pr, sizeof (SWOLRESOLVED));
+		for (n = 0; n <= len; ++ n)
+			pe->szName [n] = szName [n] >= 'A' && szName [n] <= 'Z' ? szName [n] | 0x20 : szName [n];
+	}
+	ReleaseSRWLockExclusive (&srwWOLres);
+}
+
+/*
+	Looks up szName with GetAddrInfoW () and writes the first IPv4 and the first IPv6
+	address to pr. The function returns true if the result may be cached, which is the
+	case if the name resolved or doesn't exist. Other errors, like WSATRY_AGAIN, may go
+	away on the next attempt.
+*/
+static bool lookupWOLname (SWOLRESOLVED *pr, const char *szName)
+{
+	WCHAR		wcName [U_WAKEONLAN_HOST_SIZ];
+	ADDRINFOW	hints;
+	ADDRINFOW	*pai	= NULL;
+	ADDRINFOW	*p;
+
+	memsetU (pr, 0, sizeof (SWOLRESOLVED));
+	if (U16_from_UTF8 (wcName, U_WAKEONLAN_HOST_SIZ, szName, USE_STRLEN, NULL) > U_WAKEONLAN_HOST_SIZ)
+	{
+		pr->iErr = WSAHOST_NOT_FOUND;
+		return false;
+	}
+	memsetU (&hints, 0, sizeof (hints));
+	hints.ai_family		= AF_UNSPEC;
+	hints.ai_socktype	= SOCK_DGRAM;
+	hints.ai_protocol	= IPPROTO_UDP;
+	pr->iErr = GetAddrInfoW (wcName, NULL, &hints, &pai);
+	for (p = pai; p && (!pr->b4 || !pr->b6); p = p->ai_next)
+	{
+		if (AF_INET == p->ai_family && !pr->b4 && p->ai_addrlen >= sizeof (struct sockaddr_in))
+		{
+			memcpyU (&pr->si4, p->ai_addr, sizeof (struct sockaddr_in));
+			pr->si4.sin_port	= htons (U_WAKEONLAN_MAGIC_PACKET_PORT);
+			pr->b4				= true;
+		} else
+		if (AF_INET6 == p->ai_family && !pr->b6 && p->ai_addrlen >= sizeof (struct sockaddr_in6))
+		{
+			memcpyU (&pr->si6, p->ai_addr, sizeof (struct sockaddr_in6));
+			pr->si6.sin6_port	= htons (U_WAKEONLAN_MAGIC_PACKET_PORT);
+			pr->b6				= true;
+		}
+	}
+	if (pai)
+		FreeAddrInfoW (pai);
+	if (0 == pr->iErr && !pr->b4 && !pr->b6)
+		pr->iErr = WSANO_DATA;
+	pr->uiExpires = GetTickCount64 () + (uint64_t) (pr->iErr ? lWOLresNegTTLms : lWOLresTTLms);
+	return 0 == pr->iErr || WSAHOST_NOT_FOUND == pr->iErr || WSANO_DATA == pr->iErr;
+}
+
+bool resolveWOLnameU8 (SWOLRESOLVED *pr, const char *szName, bool *pbCached)
+{
+	uint32_t	uiHash	= hashWOLnameU8 (szName);
+	bool		bCached	= findWOLresolved (pr, szName, uiHash);
+
+	if (!bCached)
+	{
+		callWSAStartup ();
+		if (lookupWOLname (pr, szName) && pr->uiExpires > GetTickCount64 ())
+			storeWOLresolved (pr, szName, uiHash);
+	}
+	if (pbCached)
+		*pbCached = bCached;
+	return pr->b4 || pr->b6;
+}
+
+bool peerWOLresolved	(
+		struct sockaddr_storage *pss, int *plen, const SWOLRESOLVED *pr, bool bForceIPv6
+						)
+{
+	struct sockaddr_in6 *psi6 = (struct sockaddr_in6 *) pss;
+
+	memsetU (pss, 0, sizeof (struct sockaddr_storage));
+	if (pr->b4 && !bForceIPv6)
+	{
+		memcpyU (pss, &pr->si4, sizeof (struct sockaddr_in));
+		*plen = sizeof (struct sockaddr_in);
+		return true;
+	}
+	if (pr->b4)
+	{
+		// The IPv4-mapped IPv6 address ::FFFF:a.b.c.d.
+		psi6->sin6_family				= AF_INET6;
+		psi6->sin6_port					= pr->si4.sin_port;
+		psi6->sin6_addr.s6_addr [10]	= 0xFF;
+		psi6->sin6_addr.s6_addr [11]	= 0xFF;
+		memcpyU (&psi6->sin6_addr.s6_addr [12], &pr->si4.sin_addr, 4);
+		*plen = sizeof (struct sockaddr_in6);
+		return true;
+	}
+	if (pr->b6)
+	{
+		memcpyU (pss, &pr->si6, sizeof (struct sockaddr_in6));
+		*plen = sizeof (struct sockaddr_in6);
+		return true;
+	}
+	return false;
+}
+
+/*
+	The distinct names of a list and their results. The threads take the names that are
+	not in the cache from puiMiss in turns.
+*/
+typedef struct swolresjob
+{
+	SWOLLIST				*pl;
+	SWOLRESOLVED			*pRes;							// Result of every name.
+	size_t					*puiTarget;						// First target of every name.
+	size_t					*puiMiss;						// Names not in the cache.
+	size_t					nMisses;
+	volatile LONG			lNext;							// Next index into puiMiss.
+} SWOLRESJOB;
+
+static DWORD WINAPI runWOLresolveJob (LPVOID pParam)
+{
+	SWOLRESJOB	*pj	= pParam;
+	size_t		i;
+
+	while ((i = (size_t) InterlockedIncrement (&pj->lNext) - 1) < pj->nMisses)
+	{
+		size_t k = pj->puiMiss [i];
+		resolveWOLnameU8 (pj->pRes + k, pj->pl->pTargets [pj->puiTarget [k]].szHost, NULL);
+	}
+	return 0;
+}
+
+/*
+	Returns the slot of the temporary hash table puiSlots with nSlots slots that belongs
+	to the name szName, or the empty slot it would go to. A slot holds the index of the
+	name plus 1.
+*/
+static size_t *slotWOLresolveJob	(
+					SWOLRESJOB *pj, size_t *puiSlots, size_t nSlots, const char *szName
+									)
+{
+	size_t s = hashWOLnameU8 (szName) & (nSlots - 1);
+
+	while	(
+					puiSlots [s]
+				&&	!isSameWOLnameU8 (pj->pl->pTargets [pj->puiTarget [puiSlots [s] - 1]].szHost, szName)
+			)
+		s = (s + 1) & (nSlots - 1);
+	return puiSlots + s;
+}
+
+/*
+	Resolves the targets of the list one after the other. Used if there's not enough
+	memory for the job. The cache still makes sure that every name is looked up once.
+*/
+static size_t resolveWOLlistSerially (SWOLLIST *pl)
+{
+	SWOLRESOLVED	res;
+	bool			bCached;
+	size_t			nResolved	= 0;
+	size_t			n;
+
+	for (n = 0; n < pl->nTargets; ++ n)
+	{
+		SWOLTARGET *pt = pl->pTargets + n;
+		if (wolretUnresolved != pt->ret)
+			continue;
+		if (resolveWOLnameU8 (&res, pt->szHost, &bCached))
+		{
+			peerWOLresolved (&pt->ssPeer, &pt->lenPeer, &res, pt->bForceIPv6);
+			pt->ret = wolretOk;
+			++ nResolved;
+		} else
+		{
+			pt->iWSAerr = res.iErr;
+			++ pl->nFailed;
+		}
+		pl->nLookups += bCached ? 0 : 1;
+	}
+	return nResolved;
+}
+
+size_t resolveWOLlist (SWOLLIST *pl)
+{
+	SWOLRESJOB		job;
+	HANDLE			hThreads [U_WOLRESOLVE_THREADS];
+	DWORD			nThreads	= 0;
+	LARGE_INTEGER	liFreq, liStart, liEnd;
+	size_t			nNames		= 0;
+	size_t			nResolved	= 0;
+	size_t			nSlots		= 16;
+	size_t			*puiSlots;
+	size_t			n;
+
+	if (0 == pl->nUnresolved)
+		return 0;
+	QueryPerformanceFrequency (&liFreq);
+	QueryPerformanceCounter (&liStart);
+	while (nSlots < 2 * pl->nUnresolved)
+		nSlots *= 2;
+	memsetU (&job, 0, sizeof (job));
+	job.pl = pl;
+	// One block for all arrays. The results come first because of their alignment.
+	job.pRes	= HeapAlloc	(
+					GetProcessHeap (), HEAP_ZERO_MEMORY,
+						pl->nUnresolved * (sizeof (SWOLRESOLVED) + 2 * sizeof (size_t))
+					+	nSlots * sizeof (size_t)
+							);
+	if (NULL == job.pRes)
+	{
+		nResolved = resolveWOLlistSerially (pl);
+		goto done;
+	}
+	job.puiTarget	= (size_t *) (job.pRes + pl->nUnresolved);
+	job.puiMiss		= job.puiTarget + pl->nUnresolved;
+	puiSlots		= job.puiMiss + pl->nUnresolved;
+
+	// Distinct names. Names in the cache need no thread.
+	for (n = 0; n < pl->nTargets; ++ n)
+	{
+		SWOLTARGET *pt = pl->pTargets + n;
+		if (wolretUnresolved != pt->ret)
+			continue;
+		size_t *ps = slotWOLresolveJob (&job, puiSlots, nSlots, pt->szHost);
+		if (*ps)
+			continue;
+		job.puiTarget [nNames] = n;
+		*ps = ++ nNames;
+		if (!findWOLresolved (job.pRes + nNames - 1, pt->szHost, hashWOLnameU8 (pt->szHost)))
+			job.puiMiss [job.nMisses ++] = nNames - 1;
+	}
+
+	// The calling thread resolves names too.
+	while (nThreads + 1 < job.nMisses && nThreads + 1 < U_WOLRESOLVE_THREADS)
+	{
+		hThreads [nThreads] = CreateThread (NULL, 0, runWOLresolveJob, &job, 0, NULL);
+		if (NULL == hThreads [nThreads])
+			break;
+		++ nThreads;
+	}
+	runWOLresolveJob (&job);
+	if (nThreads)
+	{
+		WaitForMultipleObjects (nThreads, hThreads, TRUE, INFINITE);
+		while (nThreads)
+			CloseHandle (hThreads [-- nThreads]);
+	}
+
+	for (n = 0; n < pl->nTargets; ++ n)
+	{
+		SWOLTARGET *pt = pl->pTargets + n;
+		if (wolretUnresolved != pt->ret)
+			continue;
+		SWOLRESOLVED *pr = job.pRes + *slotWOLresolveJob (&job, puiSlots, nSlots, pt->szHost) - 1;
+		if (peerWOLresolved (&pt->ssPeer, &pt->lenPeer, pr, pt->bForceIPv6))
+		{
+			pt->ret = wolretOk;
+			++ nResolved;
+		} else
+		{
+			pt->iWSAerr = pr->iErr;
+			++ pl->nFailed;
+		}
+	}
+	pl->nNames		+= nNames;
+	pl->nLookups	+= job.nMisses;
+	HeapFree (GetProcessHeap (), 0, job.pRes);
+
+done:
+	QueryPerformanceCounter (&liEnd);
+	pl->nUnresolved		= 0;
+	pl->uiResolveTicks	+= (uint64_t) (liEnd.QuadPart - liStart.QuadPart);
+	pl->uiTicksPerSec	= (uint64_t) liFreq.QuadPart;
+	return nResolved;
+}
+
+void doneWOLresolve (void)
+{
+	AcquireSRWLockExclusive (&srwWOLres);
+	if (pWOLres)
+		HeapFree (GetProcessHeap (), 0, pWOLres);
+	pWOLres			= NULL;
+	nWOLres			= 0;
+	nWOLresSlots	= 0;
+	ReleaseSRWLockExclusive (&srwWOLres);
+}
@@ -0,0 +1,175 @@
+/****************************************************************************************
+
+File		WakeOnLANResolve.h
+Why:		Resolves host names of wake targets in parallel, with a TTL cache.
+OS:			Windows
+Created:	2026-10-17
+
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2026-10-17	Thomas			Created.
+
+****************************************************************************************/
+
+/*
+	This file is maintained as part of OnOffMate. See https://github.com/ThomasPGH/OnOffMate .
+*/
+
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Copyright (c) 2024, 2025, 2026 Thomas
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef U_WAKEONLANRESOLVE_H
+#define U_WAKEONLANRESOLVE_H
+
+#include <stdbool.h>
+#include <inttypes.h>
+#include <Winsock2.h>
+#include <ws2tcpip.h>
+#include "./WakeOnLAN.h"
+#include "./externC.h"
+
+/*
+	How long a resolved name, and a name that doesn't exist, stay in the cache, in
+	milliseconds. getaddrinfo () doesn't return the TTL of the DNS records, hence these
+	are fixed. See setWOLresolveTTL ().
+*/
+#ifndef U_WOLRESOLVE_TTL_MS
+#define U_WOLRESOLVE_TTL_MS				(300000)
+#endif
+#ifndef U_WOLRESOLVE_NEG_TTL_MS
+#define U_WOLRESOLVE_NEG_TTL_MS			(30000)
+#endif
+
+/*
+	The maximum amount of threads that resolve names at the same time.
+*/
+#ifndef U_WOLRESOLVE_THREADS
+#define U_WOLRESOLVE_THREADS			(16)
+#endif
+
+/*
+	The amount of entries the cache reserves space for initially. It grows as required.
+*/
+#ifndef U_WOLRESOLVE_CACHE_INITIAL
+#define U_WOLRESOLVE_CACHE_INITIAL		(256)
+#endif
+
+/*
+	SWOLRESOLVED
+
+	The addresses a host name resolved to. Only the first IPv4 and the first IPv6 address
+	are kept. If the name doesn't exist, iErr is the error of GetAddrInfoW (), for instance
+	WSAHOST_NOT_FOUND, and neither address is valid.
+*/
+typedef struct swolresolved
+{
+	struct sockaddr_in		si4;
+	struct sockaddr_in6		si6;
+	bool					b4;								// si4 is valid.
+	bool					b6;								// si6 is valid.
+	int						iErr;							// 0, or the lookup error.
+	uint64_t				uiExpires;						// GetTickCount64 () value.
+} SWOLRESOLVED;
+
+EXTERN_C_BEGIN
+
+/*
+	isWOLhostNameU8
+
+	Returns true if szName can be a DNS host name, which means it consists of labels of
+	up to 63 letters, digits, hyphens, or underscores, separated by dots, is not longer
+	than 253 characters, and is not an IPv4 address. Octets above 127 are accepted for
+	internationalised names.
+*/
+bool isWOLhostNameU8 (const char *szName)
+;
+
+/*
+	setWOLresolveTTL
+
+	Sets how long resolved names (uiTTLms) and names that don't exist (uiNegTTLms) are
+	cached, in milliseconds. The defaults are U_WOLRESOLVE_TTL_MS and
+	U_WOLRESOLVE_NEG_TTL_MS. A value of 0 switches off caching. Entries already in the
+	cache keep their expiry time.
+*/
+void setWOLresolveTTL (uint32_t uiTTLms, uint32_t uiNegTTLms)
+;
+
+/*
+	resolveWOLnameU8
+
+	Resolves the host name szName and writes the result to pr. The cache is consulted
+	first. A name that is not in the cache, or whose entry expired, is looked up with
+	GetAddrInfoW (), which also uses the hosts file, and the result is added to the cache.
+	The function returns true if the name has an IPv4 or IPv6 address, and sets *pbCached
+	to whether the result came from the cache. pbCached can be NULL.
+
+	The function is thread-safe. It calls callWSAStartup ().
+*/
+bool resolveWOLnameU8 (SWOLRESOLVED *pr, const char *szName, bool *pbCached)
+;
+
+/*
+	peerWOLresolved
+
+	Writes the address of pr to the socket address pss points to, with the magic packet
+	port, and stores its length at plen. The IPv4 address is preferred, since it usually is
+	a broadcast address. If bForceIPv6 is true, an IPv4 address is mapped to IPv6, like
+	parseWOLpeerU8 () does. The function returns false if pr has no address.
+*/
+bool peerWOLresolved	(
+		struct sockaddr_storage *pss, int *plen, const SWOLRESOLVED *pr, bool bForceIPv6
+						)
+;
+
+/*
+	resolveWOLlist
+
+	Resolves the host names of all targets of the list pl that have a ret member of
+	wolretUnresolved. See addWOLlistTargetU8 (). Every name is looked up only once, no
+	matter how many targets it has, and only if it's not in the cache. The lookups run
+	on up to U_WOLRESOLVE_THREADS threads at the same time.
+
+	Resolved targets get their peer address and a ret member of wolretOk. The others
+	keep wolretUnresolved and are counted as failed. The function updates the members
+	nUnresolved, nNames, nLookups, and uiResolveTicks of the list, and returns the amount
+	of targets it resolved. sendWOLlist () calls it if required.
+*/
+size_t resolveWOLlist (SWOLLIST *pl)
+;
+
+/*
+	doneWOLresolve
+
+	Frees the cache. Call it when no other thread resolves names anymore.
+*/
+void doneWOLresolve (void)
+;
+
+EXTERN_C_END
+
+#endif														// Of #ifndef U_WAKEONLANRESOLVE_H.
@@ -0,0 +1,591 @@
+/****************************************************************************************
+
+File		WakeOnLANSelect.c
+Why:		Selects hosts of the inventory database by CIDR, group, and name pattern.
+OS:			Windows
+Created:	2026-10-17
+
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2026-10-17	Thomas			Created.
+
+****************************************************************************************/
+
+/*
+	This file is maintained as part of OnOffMate. See https://github.com/ThomasPGH/OnOffMate .
+*/
+
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Copyright (c) 2024, 2025, 2026 Thomas
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+
+#ifndef _WINSOCK_DEPRECATED_NO_WARNINGS
+#define _WINSOCK_DEPRECATED_NO_WARNINGS
+#endif
+
+#include "./WakeOnLANSelect.h"
+#include <Windows.h>
+#include <intrin.h>
+#include "./WinRuntimeReplacements.h"
+
+// Selectors given as UTF-16 that fit into this many octets are converted on the stack.
+#define U_WOLSEL_STACK_SIZ		(512)
+
+static inline unsigned char lowerWOLselChar (unsigned char c)
+{
+	return c >= 'A' && c <= 'Z' ? c | 0x20 : c;
+}
+
+static inline void setWOLglobClassBit (uint32_t *puiClass, unsigned char c)
+{
+	c = lowerWOLselChar (c);
+	puiClass [c >> 5] |= (uint32_t) 1 << (c & 31);
+}
+
+/*
+	Compiles the character class that starts after the '[' at *pi into the next class of
+	pg, and returns its atom. *pi is the index of the closing ']' afterwards. The function
+	returns 0 if the class is not closed or pg has no more classes.
+*/
+static uint16_t compileWOLglobClass (SWOLGLOB *pg, const char *sz, size_t len, size_t *pi)
+{
+	size_t		i		= *pi + 1;
+	bool		bNeg	= false;
+	uint32_t	*puiClass;
+	size_t		n;
+
+	if (pg->nClasses == U_WOLSEL_MAX_CLASSES)
+		return 0;
+	puiClass = pg->uiClasses [pg->nClasses];
+	if (i < len && ('!' == sz [i] || '^' == sz [i]))
+	{
+		bNeg = true;
+		++ i;
+	}
+	// A ']' right after the '[' or the negation is part of the class.
+	n = i;
+	while (i < len && (']' != sz [i] || i == n))
+	{
+		unsigned char c = (unsigned char) sz [i];
+		if (i + 2 < len && '-' == sz [i + 1] && ']' != sz [i + 2])
+		{
+			unsigned int u;
+			for (u = c; u <= (unsigned char) sz [i + 2]; ++ u)
+				setWOLglobClassBit (puiClass, (unsigned char) u);
+			i += 3;
+		} else
+		{
+			setWOLglobClassBit (puiClass, c);
+			++ i;
+		}
+	}
+	if (i == len)
+		return 0;
+	if (bNeg)
+	{
+		for (n = 0; n < 8; ++ n)
+			puiClass [n] = ~ puiClass [n];
+	}
+	*pi = i;
+	return (uint16_t) (U_WOLGLOB_CLASS + pg->nClasses ++);
+}
+
+bool compileWOLglobU8 (SWOLGLOB *pg, const char *sz, size_t len)
+{
+	size_t		i;
+	uint8_t		nAtoms		= 0;
+	uint8_t		uiSegStart	= 0;
+
+	memsetU (pg, 0, sizeof (SWOLGLOB));
+	pg->bAnchorStart	= !(len && '*' == sz [0]);
+	pg->bAnchorEnd		= !(len && '*' == sz [len - 1]);
+	pg->bLiteral		= true;
+	for (i = 0; i < len; ++ i)
+	{
+		uint16_t uiAtom;
+
+		if ('*' == sz [i])
+		{
+			pg->bStar		= true;
+			pg->bLiteral	= false;
+			if (nAtoms > uiSegStart)
+			{
+				pg->ofsSeg [pg->nSegs]		= uiSegStart;
+				pg->lenSeg [pg->nSegs ++]	= nAtoms - uiSegStart;
+				uiSegStart					= nAtoms;
+			}
+			continue;
+		}
+		if (nAtoms == U_WOLSEL_MAX_PATTERN - 1)
+			return false;
+		if ('?' == sz [i])
+			uiAtom = U_WOLGLOB_ANY;
+		else
+		if ('[' == sz [i])
+		{
+			if (0 == (uiAtom = compileWOLglobClass (pg, sz, len, &i)))
+				return false;
+		} else
+			uiAtom = lowerWOLselChar ((unsigned char) sz [i]);
+		if (uiAtom > 0xFF)
+			pg->bLiteral = false;
+		pg->uiAtoms [nAtoms ++] = uiAtom;
+	}
+	if (nAtoms > uiSegStart)
+	{
+		pg->ofsSeg [pg->nSegs]		= uiSegStart;
+		pg->lenSeg [pg->nSegs ++]	= nAtoms - uiSegStart;
+	}
+	return true;
+}
+
+/*
+	Returns true if segment s of pg matches the octets at sz, which are at least as many as
+	the segment has atoms.
+*/
+static bool isWOLglobSegmentAt (const SWOLGLOB *pg, unsigned int s, const char *sz)
+{
+	const uint16_t	*puiAtom	= pg->uiAtoms + pg->ofsSeg [s];
+	unsigned int	n;
+
+	for (n = 0; n < pg->lenSeg [s]; ++ n)
+	{
+		unsigned char	c	= lowerWOLselChar ((unsigned char) sz [n]);
+		uint16_t		a	= puiAtom [n];
+
+		if (a < U_WOLGLOB_ANY)
+		{
+			if (a != c)
+				return false;
+		} else
+		if (a >= U_WOLGLOB_CLASS)
+		{
+			if (!(pg->uiClasses [a - U_WOLGLOB_CLASS][c >> 5] & ((uint32_t) 1 << (c & 31))))
+				return false;
+		}
+	}
+	return true;
+}
+
+bool isWOLglobMatchU8 (const SWOLGLOB *pg, const char *sz, size_t len)
+{
+	size_t			pos		= 0;
+	size_t			end		= len;
+	unsigned int	first	= 0;
+	unsigned int	last	= pg->nSegs;
+	unsigned int	s;
+
+	if (!pg->bStar)
+		return		(0 == pg->nSegs ? 0 : pg->lenSeg [0]) == len
+				&&	(0 == pg->nSegs || isWOLglobSegmentAt (pg, 0, sz));
+	if (pg->bAnchorStart && pg->nSegs)
+	{
+		if (pg->lenSeg [0] > len || !isWOLglobSegmentAt (pg, 0, sz))
+			return false;
+		pos		= pg->lenSeg [0];
+		first	= 1;
+	}
+	if (pg->bAnchorEnd && last > first)
+	{
+		size_t l = pg->lenSeg [last - 1];
+		if (l > end - pos || !isWOLglobSegmentAt (pg, last - 1, sz + len - l))
+			return false;
+		end = len - l;
+		-- last;
+	}
+	// The segments in between match as far left as possible.
+	for (s = first; s < last; ++ s)
+	{
+		size_t l = pg->lenSeg [s];
+		while (pos + l <= end && !isWOLglobSegmentAt (pg, s, sz + pos))
+			++ pos;
+		if (pos + l > end)
+			return false;
+		pos += l;
+	}
+	return true;
+}
+
+void initWOLselector (SWOLSELECTOR *ps)
+{
+	ps->nTerms		= 0;
+	ps->nIncludes	= 0;
+}
+
+/*
+	Returns true if the len octets at sz start with the lowercase prefix szPrefix, ignoring
+	case.
+*/
+static bool hasWOLselPrefix (const char *sz, size_t len, const char *szPrefix)
+{
+	size_t n;
+
+	for (n = 0; szPrefix [n]; ++ n)
+	{
+		if (n == len || lowerWOLselChar ((unsigned char) sz [n]) != (unsigned char) szPrefix [n])
+			return false;
+	}
+	return true;
+}
+
+/*
+	Parses the CIDR prefix in the len octets at sz into the range of keys of pt.
+*/
+static bool parseWOLselCIDR (SWOLSELTERM *pt, const char *sz, size_t len)
+{
+	struct sockaddr_in6	si6;
+	struct sockaddr_in	si;
+	char				szAddr [U_WAKEONLAN_IPV6_SIZ];
+	size_t				lenAddr	= 0;
+	unsigned int		uiBits	= 0;
+	unsigned int		uiMax;
+	unsigned int		n;
+
+	while (lenAddr < len && '/' != sz [lenAddr])
+		++ lenAddr;
+	if (0 == lenAddr || lenAddr >= sizeof (szAddr))
+		return false;
+	memcpyU (szAddr, sz, lenAddr);
+	szAddr [lenAddr] = '\0';
+	memsetU (&si, 0, sizeof (si));
+	memsetU (&si6, 0, sizeof (si6));
+	if (1 == inet_pton (AF_INET, szAddr, &si.sin_addr))
+	{
+		si.sin_family = AF_INET;
+		keyWOLinventoryIP (pt->ucLo, &si);
+		uiMax = 32;
+	} else
+	if (1 == inet_pton (AF_INET6, szAddr, &si6.sin6_addr))
+	{
+		si6.sin6_family = AF_INET6;
+		keyWOLinventoryIP (pt->ucLo, &si6);
+		uiMax = 128;
+	} else
+		return false;
+	if (lenAddr < len)
+	{
+		if (lenAddr + 1 == len || len - lenAddr > 4)
+			return false;
+		for (n = (unsigned int) lenAddr + 1; n < len; ++ n)
+		{
+			if (sz [n] < '0' || sz [n] > '9')
+				return false;
+			uiBits = uiBits * 10 + (unsigned int) (sz [n] - '0');
+		}
+		if (uiBits > uiMax)
+			return false;
+	} else
+		uiBits = uiMax;
+	// IPv4 prefixes are within ::ffff:0:0/96.
+	uiBits += 128 - uiMax;
+	for (n = 0; n < 16; ++ n)
+	{
+		unsigned int	uiOctetBits	= uiBits >= 8 * (n + 1) ? 8 : uiBits > 8 * n ? uiBits - 8 * n : 0;
+		unsigned char	ucMask		= (unsigned char) (0xFF00 >> uiOctetBits);
+		pt->ucLo [n]	&= ucMask;
+		pt->ucHi [n]	= pt->ucLo [n] | (unsigned char) ~ ucMask;
+	}
+	return true;
+}
+
+/*
+	Parses the single term in the len octets at sz into the next term of ps.
+*/
+static enum eWOLselRet addWOLselectorTermU8 (SWOLSELECTOR *ps, const char *sz, size_t len)
+{
+	SWOLSELTERM *pt;
+
+	if (ps->nTerms == U_WOLSEL_MAX_TERMS)
+		return wolselTooMany;
+	pt = ps->terms + ps->nTerms;
+	memsetU (pt, 0, sizeof (SWOLSELTERM));
+	if (len && U_WOLSEL_EXCLUDE == sz [0])
+	{
+		pt->bExclude = true;
+		++ sz;
+		-- len;
+	}
+	if (hasWOLselPrefix (sz, len, U_WOLSEL_PREFIX_CIDR))
+	{
+		pt->kind = wolselCIDR;
+		if	(
+				!parseWOLselCIDR	(
+					pt, sz + sizeof (U_WOLSEL_PREFIX_CIDR) - 1,
+					len - (sizeof (U_WOLSEL_PREFIX_CIDR) - 1)
+									)
+			)
+			return wolselSyntaxCIDR;
+	} else
+	{
+		pt->kind = wolselName;
+		if (hasWOLselPrefix (sz, len, U_WOLSEL_PREFIX_GROUP))
+		{
+			pt->kind	= wolselGroup;
+			sz			+= sizeof (U_WOLSEL_PREFIX_GROUP) - 1;
+			len			-= sizeof (U_WOLSEL_PREFIX_GROUP) - 1;
+		}
+		if (len >= U_WOLSEL_MAX_PATTERN)
+			return wolselTooLong;
+		if (!compileWOLglobU8 (&pt->glob, sz, len))
+			return wolselSyntaxPattern;
+		memcpyU (pt->szLiteral, sz, len);
+		pt->szLiteral [len]	= '\0';
+		pt->lenLiteral		= len;
+	}
+	if (!pt->bExclude)
+		++ ps->nIncludes;
+	++ ps->nTerms;
+	return wolselOk;
+}
+
+enum eWOLselRet addWOLselectorU8 (SWOLSELECTOR *ps, const char *sz)
+{
+	enum eWOLselRet	ret	= wolselOk;
+
+	while (wolselOk == ret && *sz)
+	{
+		const char *e;
+
+		while (' ' == *sz || ',' == *sz)
+			++ sz;
+		e = sz;
+		while (*e && ',' != *e)
+			++ e;
+		size_t len = (size_t) (e - sz);
+		while (len && ' ' == sz [len - 1])
+			-- len;
+		if (len)
+			ret = addWOLselectorTermU8 (ps, sz, len);
+		sz = e;
+	}
+	return ret;
+}
+
+enum eWOLselRet addWOLselectorW (SWOLSELECTOR *ps, const wchar_t *wz)
+{
+	enum eWOLselRet	ret;
+	char			szBuf [U_WOLSEL_STACK_SIZ];
+	char			*sz		= szBuf;
+	size_t			size	= UTF8_from_U16 (szBuf, sizeof (szBuf), wz, USE_STRLEN, NULL);
+
+	// Only selectors that don't fit on the stack are converted twice.
+	if (size > sizeof (szBuf))
+	{
+		sz = HeapAlloc (GetProcessHeap (), 0, size);
+		if (NULL == sz)
+			return wolselErrMemory;
+		UTF8_from_U16 (sz, size, wz, USE_STRLEN, NULL);
+	}
+	ret = addWOLselectorU8 (ps, sz);
+	if (sz != szBuf)
+		HeapFree (GetProcessHeap (), 0, sz);
+	return ret;
+}
+
+static inline void setWOLselBit (uint32_t *puiBits, uint32_t ui)
+{
+	puiBits [ui >> 5] |= (uint32_t) 1 << (ui & 31);
+}
+
+static inline void clearWOLselBit (uint32_t *puiBits, uint32_t ui)
+{
+	puiBits [ui >> 5] &= ~ ((uint32_t) 1 << (ui & 31));
+}
+
+static inline bool isWOLselBit (const uint32_t *puiBits, uint32_t ui)
+{
+	return 0 != (puiBits [ui >> 5] & ((uint32_t) 1 << (ui & 31)));
+}
+
+static inline bool isWOLselScanTerm (const SWOLSELTERM *pt)
+{
+	return wolselGroup == pt->kind || (wolselName == pt->kind && !pt->glob.bLiteral);
+}
+
+/*
+	Applies the terms of ps with bExclude that don't need a pass over the records, i.e.
+	CIDR terms and literal names, and returns true if there are other ones.
+*/
+static bool applyWOLselIndexed	(
+					uint32_t *puiBits, const SWOLSELECTOR *ps, const SWOLINVENTORY *pi,
+					bool bExclude
+								)
+{
+	bool			bScan	= false;
+	unsigned int	t;
+
+	for (t = 0; t < ps->nTerms; ++ t)
+	{
+		const SWOLSELTERM *pt = ps->terms + t;
+
+		if (bExclude != pt->bExclude)
+			continue;
+		if (isWOLselScanTerm (pt))
+		{
+			bScan = true;
+			continue;
+		}
+		if (wolselCIDR == pt->kind)
+		{
+			size_t				n;
+			const SWOLINVIPKEY	*pk	= rangeWOLinventoryIP (pi, pt->ucLo, pt->ucHi, &n);
+			for (; n; -- n, ++ pk)
+			{
+				if (bExclude)
+					clearWOLselBit (puiBits, pk->uiSlot);
+				else
+					setWOLselBit (puiBits, pk->uiSlot);
+			}
+		} else
+		{
+			const SWOLINVRECORD *pr = findWOLinventoryU8 (pi, pt->szLiteral, pt->lenLiteral);
+			if (pr)
+			{
+				if (bExclude)
+					clearWOLselBit (puiBits, (uint32_t) (pr - pi->pRecs));
+				else
+					setWOLselBit (puiBits, (uint32_t) (pr - pi->pRecs));
+			}
+		}
+	}
+	return bScan;
+}
+
+/*
+	Returns true if the record pr matches a pattern term of ps with bExclude.
+*/
+static bool isWOLselScanMatch	(
+					const SWOLSELECTOR *ps, const SWOLINVENTORY *pi, const SWOLINVRECORD *pr,
+					bool bExclude
+								)
+{
+	const char		*szName		= NULL;
+	const char		*szGroup	= NULL;
+	size_t			lenName		= 0;
+	size_t			lenGroup	= 0;
+	unsigned int	t;
+
+	for (t = 0; t < ps->nTerms; ++ t)
+	{
+		const SWOLSELTERM *pt = ps->terms + t;
+
+		if (bExclude != pt->bExclude || !isWOLselScanTerm (pt))
+			continue;
+		if (wolselName == pt->kind)
+		{
+			if (NULL == szName)
+			{
+				szName	= strWOLinventory (pi, pr->ofsName);
+				lenName	= strlenU (szName);
+			}
+			if (isWOLglobMatchU8 (&pt->glob, szName, lenName))
+				return true;
+		} else
+		{
+			if (NULL == szGroup)
+			{
+				szGroup		= strWOLinventory (pi, pr->ofsGroup);
+				lenGroup	= strlenU (szGroup);
+			}
+			if (isWOLglobMatchU8 (&pt->glob, szGroup, lenGroup))
+				return true;
+		}
+	}
+	return false;
+}
+
+bool selectWOLinventory (SWOLSELECTION *psel, const SWOLSELECTOR *ps, const SWOLINVENTORY *pi)
+{
+	LARGE_INTEGER	liFreq, liStart, liEnd;
+	uint32_t		n		= pi->ph ? pi->ph->nRecords : 0;
+	uint32_t		nWords	= (n + 31) / 32;
+	uint32_t		r, w;
+
+	memsetU (psel, 0, sizeof (SWOLSELECTION));
+	QueryPerformanceFrequency (&liFreq);
+	QueryPerformanceCounter (&liStart);
+	psel->nRecords	= n;
+	psel->puiBits	= HeapAlloc (GetProcessHeap (), HEAP_ZERO_MEMORY, ((size_t) nWords + 1) * sizeof (uint32_t));
+	psel->puiSlots	= HeapAlloc (GetProcessHeap (), 0, ((size_t) n + 1) * sizeof (uint32_t));
+	if (NULL == psel->puiBits || NULL == psel->puiSlots)
+	{
+		doneWOLselection (psel);
+		return false;
+	}
+
+	if (0 == ps->nIncludes)
+	{
+		memsetU (psel->puiBits, 0xFF, (size_t) nWords * sizeof (uint32_t));
+		if (n & 31)
+			psel->puiBits [nWords - 1] = ((uint32_t) 1 << (n & 31)) - 1;
+	} else
+	if (applyWOLselIndexed (psel->puiBits, ps, pi, false))
+	{
+		for (r = 0; r < n; ++ r)
+		{
+			if (!isWOLselBit (psel->puiBits, r) && isWOLselScanMatch (ps, pi, pi->pRecs + r, false))
+				setWOLselBit (psel->puiBits, r);
+		}
+	}
+	if (applyWOLselIndexed (psel->puiBits, ps, pi, true))
+	{
+		for (r = 0; r < n; ++ r)
+		{
+			if (isWOLselBit (psel->puiBits, r) && isWOLselScanMatch (ps, pi, pi->pRecs + r, true))
+				clearWOLselBit (psel->puiBits, r);
+		}
+	}
+
+	for (w = 0; w < nWords; ++ w)
+	{
+		uint32_t m = psel->puiBits [w];
+		while (m)
+		{
+			unsigned long b;
+			_BitScanForward (&b, m);
+			psel->puiSlots [psel->nSelected ++] = w * 32 + (uint32_t) b;
+			m &= m - 1;
+		}
+	}
+	QueryPerformanceCounter (&liEnd);
+	psel->uiTicks		= (uint64_t) (liEnd.QuadPart - liStart.QuadPart);
+	psel->uiTicksPerSec	= (uint64_t) liFreq.QuadPart;
+	return true;
+}
+
+void doneWOLselection (SWOLSELECTION *psel)
+{
+	if (psel->puiBits)
+		HeapFree (GetProcessHeap (), 0, psel->puiBits);
+	if (psel->puiSlots)
+		HeapFree (GetProcessHeap (), 0, psel->puiSlots);
+	psel->puiBits	= NULL;
+	psel->puiSlots	= NULL;
+	psel->nSelected	= 0;
+}
@@ -0,0 +1,248 @@
+/****************************************************************************************
+
+File		WakeOnLANSelect.h
+Why:		Selects hosts of the inventory database by CIDR, group, and name pattern.
+OS:			Windows
+Created:	2026-10-17
+
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2026-10-17	Thomas			Created.
+
+****************************************************************************************/
+
+/*
+	This file is maintained as part of OnOffMate. See https://github.com/ThomasPGH/OnOffMate .
+*/
+
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Copyright (c) 2024, 2025, 2026 Thomas
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+
+#ifndef U_WAKEONLANSELECT_H
+#define U_WAKEONLANSELECT_H
+
+#include <stdbool.h>
+#include <inttypes.h>
+#include "./WakeOnLANInventory.h"
+#include "./externC.h"
+
+/*
+	The maximum amount of terms of a selector, the maximum length of a pattern, and the
+	maximum amount of character classes ("[...]") of a pattern.
+*/
+#ifndef U_WOLSEL_MAX_TERMS
+#define U_WOLSEL_MAX_TERMS				(32)
+#endif
+#ifndef U_WOLSEL_MAX_PATTERN
+#define U_WOLSEL_MAX_PATTERN			(128)
+#endif
+#ifndef U_WOLSEL_MAX_CLASSES
+#define U_WOLSEL_MAX_CLASSES			(8)
+#endif
+
+/*
+	The prefixes of selector terms.
+*/
+#define U_WOLSEL_PREFIX_CIDR			"cidr:"
+#define U_WOLSEL_PREFIX_GROUP			"group:"
+#define U_WOLSEL_EXCLUDE				'!'
+
+/*
+	SWOLGLOB
+
+	A compiled pattern with the wildcards '*' (any amount of characters), '?' (a single
+	character), and "[...]" (a character of the class, like "[0-9a-f]", or of its
+	complement with "[!...]"). The pattern is split at its asterisks into segments of
+	atoms. An atom is either a lowercase character, U_WOLGLOB_ANY, or
+	U_WOLGLOB_CLASS + n for the class n. The first segment is anchored at the beginning of
+	the string unless the pattern starts with an asterisk, the last one at its end unless
+	the pattern ends with one, and the segments in between are found left to right.
+	Patterns ignore the case of ASCII letters.
+*/
+#define U_WOLGLOB_ANY					(0x100)
+#define U_WOLGLOB_CLASS					(0x200)
+
+typedef struct swolglob
+{
+	uint16_t			uiAtoms [U_WOLSEL_MAX_PATTERN];
+	uint8_t				ofsSeg [U_WOLSEL_MAX_PATTERN];		// First atom of a segment.
+	uint8_t				lenSeg [U_WOLSEL_MAX_PATTERN];		// Atoms of a segment.
+	uint32_t			uiClasses [U_WOLSEL_MAX_CLASSES][8];	// 256 bits each.
+	uint8_t				nSegs;
+	uint8_t				nClasses;
+	bool				bStar;								// Has at least one '*'.
+	bool				bAnchorStart;
+	bool				bAnchorEnd;
+	bool				bLiteral;							// No wildcards at all.
+} SWOLGLOB;
+
+enum eWOLselKind
+{
+	wolselName,
+	wolselGroup,
+	wolselCIDR
+};
+
+/*
+	SWOLSELTERM
+
+	A term of a selector. CIDR terms cover the keys ucLo to ucHi of the IP prefix index.
+	See SWOLINVIPKEY. Name and group terms have a pattern.
+*/
+typedef struct swolselterm
+{
+	enum eWOLselKind	kind;
+	bool				bExclude;
+	unsigned char		ucLo [16];
+	unsigned char		ucHi [16];
+	SWOLGLOB			glob;
+	char				szLiteral [U_WOLSEL_MAX_PATTERN];	// The name if glob.bLiteral.
+	size_t				lenLiteral;
+} SWOLSELTERM;
+
+/*
+	SWOLSELECTOR
+
+	Terms are added with addWOLselectorU8 () or addWOLselectorW ().
+*/
+typedef struct swolselector
+{
+	SWOLSELTERM			terms [U_WOLSEL_MAX_TERMS];
+	unsigned int		nTerms;
+	unsigned int		nIncludes;
+} SWOLSELECTOR;
+
+/*
+	SWOLSELECTION
+
+	The result of selectWOLinventory (). puiSlots are the slots of the nSelected records
+	selected, in slot order.
+*/
+typedef struct swolselection
+{
+	uint32_t			*puiBits;							// One bit per record.
+	uint32_t			*puiSlots;
+	uint32_t			nRecords;
+	uint32_t			nSelected;
+	uint64_t			uiTicks;							// Performance counter ticks.
+	uint64_t			uiTicksPerSec;
+} SWOLSELECTION;
+
+enum eWOLselRet
+{
+	wolselOk,
+	wolselSyntaxCIDR,
+	wolselSyntaxPattern,
+	wolselTooLong,
+	wolselTooMany,
+	wolselErrMemory
+};
+
+EXTERN_C_BEGIN
+
+/*
+	compileWOLglobU8
+
+	Compiles the pattern in the len octets at sz into pg. The function returns false if
+	the pattern is too long, has too many character classes, or a class is not closed.
+*/
+bool compileWOLglobU8 (SWOLGLOB *pg, const char *sz, size_t len)
+;
+
+/*
+	isWOLglobMatchU8
+
+	Returns true if the len octets at sz match the compiled pattern pg.
+*/
+bool isWOLglobMatchU8 (const SWOLGLOB *pg, const char *sz, size_t len)
+;
+
+/*
+	initWOLselector
+
+	Initialises the selector ps without any terms. A selector without terms selects all
+	hosts.
+*/
+void initWOLselector (SWOLSELECTOR *ps)
+;
+
+/*
+	addWOLselectorU8
+
+	Adds the terms in the NUL-terminated string sz to the selector ps. Terms are separated
+	by commas. A term is one of
+
+	cidr:<prefix>[/<bits>]	The hosts whose address is within the IPv4 or IPv6 prefix.
+							Hosts without an address are selected by their broadcast
+							address. See SWOLINVIPKEY.
+	group:<pattern>			The hosts whose group matches the pattern.
+	<pattern>				The hosts whose name matches the pattern.
+
+	A term that starts with '!' excludes the hosts it matches instead. The selector
+	selects the hosts matched by at least one including term, or all hosts if it has
+	none, minus the hosts matched by any excluding term.
+
+	Example:
+	cidr:10.20.0.0/16,!group:storage,!build-1[0-4]
+*/
+enum eWOLselRet addWOLselectorU8 (SWOLSELECTOR *ps, const char *sz)
+;
+
+/*
+	addWOLselectorW
+
+	Like addWOLselectorU8 () but the terms are given in UTF-16.
+*/
+enum eWOLselRet addWOLselectorW (SWOLSELECTOR *ps, const wchar_t *wz)
+;
+
+/*
+	selectWOLinventory
+
+	Selects the hosts of the inventory pi the selector ps matches. CIDR terms are looked up
+	in the IP prefix index, names without wildcards with the perfect hash of the
+	inventory, and only patterns require a pass over the records, which stops at the first
+	term a record matches. The function returns false if it runs out of memory. Release
+	the selection with doneWOLselection ().
+*/
+bool selectWOLinventory (SWOLSELECTION *psel, const SWOLSELECTOR *ps, const SWOLINVENTORY *pi)
+;
+
+/*
+	doneWOLselection
+
+	Releases the memory of the selection psel.
+*/
+void doneWOLselection (SWOLSELECTION *psel)
+;
+
+EXTERN_C_END
+
+#endif														// Of #ifndef U_WAKEONLANSELECT_H.
@@ -0,0 +1,399 @@
+/****************************************************************************************
+
+File		WakeOnLANStress.c
+Why:		Stress test of the WOL functions from concurrent threads.
+OS:			Windows
+Created:	2026-10-17
+
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2026-10-17	Thomas			Created.
+2026-10-17	Thomas			Option to submit asynchronously via WakeOnLANAsync.
+
+****************************************************************************************/
+
+/*
+	This file is maintained as part of OnOffMate. See https://github.com/ThomasPGH/OnOffMate .
+*/
+
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Copyright (c) 2024, 2025, 2026 Thomas
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+#include "./WakeOnLANStress.h"
+#include <Windows.h>
+#include "./WinRuntimeReplacements.h"
+#include "./WakeOnLANIfaces.h"
+
+/*
+	The first four octets of the MAC addresses the test sends. 02 is a locally
+	administered unicast address, and "OOM" is OnOffMate.
+*/
+static const unsigned char ucWOLstressMAC [4]	= { 0x02, 'O', 'O', 'M' };
+
+/*
+	Called by the receiver thread for every magic packet.
+*/
+static void onWOLstressRecv (SWOLRECV *pr, void *pCustom)
+{
+	SWOLSTRESS *ps = pCustom;
+
+	if	(
+				0 == memcmpU (pr->ucMAC, ucWOLstressMAC, 4)
+			&&	(((uint32_t) pr->ucMAC [4] << 8) | pr->ucMAC [5]) < ps->nThreads
+		)
+	{
+		++ ps->threads [((uint32_t) pr->ucMAC [4] << 8) | pr->ucMAC [5]].nReceived;
+		InterlockedIncrement64 (&ps->nReceived);
+		InterlockedDecrement64 (&ps->nInFlight);
+	} else
+		++ ps->nForeign;
+}
+
+static DWORD WINAPI runWOLstressReceiver (LPVOID pParam)
+{
+	SWOLSTRESS *ps = pParam;
+
+	runWOLlistener (&ps->listener, onWOLstressRecv, ps);
+	return 0;
+}
+
+/*
+	Waits while the threads are more than U_WOLSTRESS_WINDOW magic packets ahead of the
+	receiver.
+*/
+static void waitWOLstressWindow (SWOLSTRESS *ps)
+{
+	while (ps->nInFlight > U_WOLSTRESS_WINDOW)
+		Sleep (1);
+}
+
+/*
+	Sets the loopback peer of the thread pt.
+*/
+static int loopbackWOLstressPeer (struct sockaddr_storage *pss, const SWOLSTRESSTHREAD *pt)
+{
+	memsetU (pss, 0, sizeof (struct sockaddr_storage));
+	if (AF_INET == pt->iFamily)
+	{
+		struct sockaddr_in *psi		= (struct sockaddr_in *) pss;
+		psi->sin_family				= AF_INET;
+		psi->sin_addr.s_addr		= htonl (INADDR_LOOPBACK);
+		psi->sin_port				= htons (pt->ps->uiPort);
+		return sizeof (struct sockaddr_in);
+	}
+	struct sockaddr_in6 *psi6		= (struct sockaddr_in6 *) pss;
+	psi6->sin6_family				= AF_INET6;
+	psi6->sin6_addr					= in6addr_loopback;
+	psi6->sin6_port					= htons (pt->ps->uiPort);
+	return sizeof (struct sockaddr_in6);
+}
+
+/*
+	A request of an asynchronously submitting thread. It's busy from submission until its
+	completion.
+*/
+typedef struct swolstressreq
+{
+	SWOLASYNCREQ			req;
+	volatile LONG			lBusy;
+} SWOLSTRESSREQ;
+
+/*
+	Called on the I/O thread of the asynchronous sender. The I/O thread is the only
+	writer of the counters of the submitting threads while they submit.
+*/
+static void onWOLstressDone (SWOLASYNCREQ *pr, void *pCustom)
+{
+	SWOLSTRESSTHREAD	*pt	= pr->pCustom;
+	SWOLSTRESS			*ps	= pCustom;
+
+	if (wolretOk == pr->target.ret)
+		++ pt->nSent;
+	else
+	{
+		++ pt->nFailed;
+		InterlockedDecrement64 (&ps->nInFlight);
+	}
+	InterlockedExchange (&CONTAINING_RECORD (pr, SWOLSTRESSREQ, req)->lBusy, 0);
+}
+
+/*
+	Submits the packets of the thread pt to the asynchronous sender, reusing its
+	U_WOLSTRESS_ASYNC_REQS requests in turn.
+*/
+static DWORD submitWOLstressAsync	(
+					SWOLSTRESSTHREAD *pt, const unsigned char ucMAC [6],
+					const struct sockaddr *pPeer, int lenPeer
+									)
+{
+	SWOLSTRESS		*ps		= pt->ps;
+	SWOLSTRESSREQ	*prs;
+	uint64_t		k;
+	size_t			i;
+
+	// Too big for the stack.
+	prs = HeapAlloc (GetProcessHeap (), 0, U_WOLSTRESS_ASYNC_REQS * sizeof (SWOLSTRESSREQ));
+	if (NULL == prs)
+	{
+		pt->nFailed = ps->nPackets;
+		return 1;
+	}
+	for (i = 0; i < U_WOLSTRESS_ASYNC_REQS; ++ i)
+	{
+		initWOLtarget (&prs [i].req.target, ucMAC, pPeer, lenPeer);
+		prs [i].req.pCustom	= pt;
+		prs [i].lBusy		= 0;
+	}
+	for (k = 0; k < ps->nPackets; ++ k)
+	{
+		SWOLSTRESSREQ *pr = prs + k % U_WOLSTRESS_ASYNC_REQS;
+		while (pr->lBusy)
+			Sleep (0);
+		waitWOLstressWindow (ps);
+		pr->lBusy = 1;
+		InterlockedIncrement64 (&ps->nInFlight);
+		submitWOLasync (ps->pAsync, &pr->req);
+	}
+	for (i = 0; i < U_WOLSTRESS_ASYNC_REQS; ++ i)
+	{
+		while (prs [i].lBusy)
+			Sleep (0);
+	}
+	HeapFree (GetProcessHeap (), 0, prs);
+	return 0;
+}
+
+static DWORD WINAPI runWOLstressSender (LPVOID pParam)
+{
+	SWOLSTRESSTHREAD		*pt		= pParam;
+	SWOLSTRESS				*ps		= pt->ps;
+	size_t					nBatch	= pt->bSender ? U_WOLSTRESS_BATCH : 1;
+	uint64_t				nLeft	= ps->nPackets;
+	struct sockaddr_storage	ss;
+	int						len;
+	unsigned char			ucMAC [6];
+	SWOLSENDER				sd;
+	SWOLTARGET				*pwt;
+	size_t					nIfaces;
+	size_t					n;
+
+	if (!callWSAStartup ())
+	{
+		pt->nFailed = nLeft;
+		return 1;
+	}
+	len = loopbackWOLstressPeer (&ss, pt);
+	memcpyU (ucMAC, ucWOLstressMAC, 4);
+	ucMAC [4] = (unsigned char) (pt->uiIndex >> 8);
+	ucMAC [5] = (unsigned char) (pt->uiIndex & 0xFF);
+	if (ps->pAsync)
+		return submitWOLstressAsync (pt, ucMAC, (struct sockaddr *) &ss, len);
+
+	// Too big for the stack.
+	pwt = HeapAlloc (GetProcessHeap (), 0, nBatch * sizeof (SWOLTARGET));
+	if (NULL == pwt)
+	{
+		pt->nFailed = nLeft;
+		return 1;
+	}
+	for (n = 0; n < nBatch; ++ n)
+		initWOLtarget (pwt + n, ucMAC, (struct sockaddr *) &ss, len);
+
+	initWOLsender (&sd);
+	while (nLeft)
+	{
+		size_t	nSend	= nLeft < nBatch ? (size_t) nLeft : nBatch;
+		size_t	nSent;
+
+		// Readers of the interface table share its lock with the "auto" targets of lists.
+		getWOLifaces (&nIfaces);
+		releaseWOLifaces ();
+		waitWOLstressWindow (ps);
+		InterlockedAdd64 (&ps->nInFlight, (LONG64) nSend);
+		if (pt->bSender)
+			nSent = sendWOLbatch (&sd, pwt, nSend);
+		else
+			nSent = sendWOLtarget (pwt) ? 1 : 0;
+		if (nSent < nSend)
+			InterlockedAdd64 (&ps->nInFlight, - (LONG64) (nSend - nSent));
+		pt->nSent	+= nSent;
+		pt->nFailed	+= nSend - nSent;
+		nLeft		-= nSend;
+	}
+	doneWOLsender (&sd);
+	HeapFree (GetProcessHeap (), 0, pwt);
+	return 0;
+}
+
+/*
+	Sends a single magic packet, which makes Winsock and the interface table create
+	their handles before the handles of the process are counted.
+*/
+static void warmUpWOLstress (SWOLSTRESS *ps)
+{
+	static const unsigned char	ucMAC [6]	= { 0 };
+	SWOLSTRESSTHREAD			wt;
+	struct sockaddr_storage		ss;
+	SWOLTARGET					t;
+	size_t						nIfaces;
+
+	getWOLifaces (&nIfaces);
+	releaseWOLifaces ();
+	wt.ps		= ps;
+	wt.iFamily	= AF_INET;
+	initWOLtarget (&t, ucMAC, (struct sockaddr *) &ss, loopbackWOLstressPeer (&ss, &wt));
+	sendWOLtarget (&t);
+}
+
+/*
+	Raises the receive buffers of the listener's sockets. The default of 64 KiB holds only
+	about 600 magic packets.
+*/
+static void growWOLstressRcvBuf (SWOLLISTENER *pl)
+{
+	int		iSize	= 8 * 1024 * 1024;
+	size_t	n;
+
+	for (n = 0; n < pl->nSockets; ++ n)
+		setsockopt (pl->sockets [n], SOL_SOCKET, SO_RCVBUF, (char *) &iSize, sizeof (int));
+}
+
+/*
+	Waits until all magic packets sent have been received, or until the receiver hasn't
+	received anything for U_WOLSTRESS_DRAIN_MS milliseconds.
+*/
+static void drainWOLstress (SWOLSTRESS *ps, uint64_t nSent)
+{
+	LONG64	nLast	= -1;
+	DWORD	dwIdle	= 0;
+
+	while ((uint64_t) ps->nReceived < nSent && dwIdle < U_WOLSTRESS_DRAIN_MS)
+	{
+		if (nLast == ps->nReceived)
+			dwIdle += 10;
+		else
+			dwIdle = 0;
+		nLast = ps->nReceived;
+		Sleep (10);
+	}
+}
+
+enum eWOLstressRet runWOLstress (SWOLSTRESS *ps)
+{
+	HANDLE			hThreads [U_WOLSTRESS_MAX_THREADS];
+	HANDLE			hReceiver;
+	LARGE_INTEGER	liFreq, liStart, liEnd;
+	uint32_t		nStarted	= 0;
+	uint32_t		n;
+
+	if (0 == ps->nThreads)
+		ps->nThreads = 1;
+	if (ps->nThreads > U_WOLSTRESS_MAX_THREADS)
+		ps->nThreads = U_WOLSTRESS_MAX_THREADS;
+	memsetU (ps->threads, 0, sizeof (ps->threads));
+	ps->nReceived	= 0;
+	ps->nInFlight	= 0;
+	ps->nForeign	= 0;
+	ps->nSent		= 0;
+	ps->nFailed		= 0;
+	ps->nLost		= 0;
+	ps->nDuplicates	= 0;
+	if (!callWSAStartup ())
+		return wolstressErrWSA;
+
+	warmUpWOLstress (ps);
+	GetProcessHandleCount (GetCurrentProcess (), &ps->dwHandlesBefore);
+	if (!openWOLlistener (&ps->listener, &ps->uiPort, 1))
+		return wolstressErrListen;
+	growWOLstressRcvBuf (&ps->listener);
+	hReceiver = CreateThread (NULL, 0, runWOLstressReceiver, ps, 0, NULL);
+	if (NULL == hReceiver)
+	{
+		closeWOLlistener (&ps->listener);
+		return wolstressErrThread;
+	}
+	if (ps->pAsync && !openWOLasync (ps->pAsync, onWOLstressDone, ps, NULL))
+	{
+		stopWOLlistener (&ps->listener);
+		WaitForSingleObject (hReceiver, INFINITE);
+		CloseHandle (hReceiver);
+		closeWOLlistener (&ps->listener);
+		return wolstressErrThread;
+	}
+
+	QueryPerformanceFrequency (&liFreq);
+	QueryPerformanceCounter (&liStart);
+	for (n = 0; n < ps->nThreads; ++ n)
+	{
+		SWOLSTRESSTHREAD *pt = ps->threads + n;
+		pt->ps		= ps;
+		pt->uiIndex	= n;
+		pt->bSender	= 0 == (n & 1);
+		pt->iFamily	= 0 == (n & 2) ? AF_INET : AF_INET6;
+		pt->hThread	= CreateThread (NULL, 0, runWOLstressSender, pt, 0, NULL);
+		if (NULL == pt->hThread)
+			break;
+		hThreads [nStarted ++] = pt->hThread;
+	}
+	if (nStarted)
+		WaitForMultipleObjects (nStarted, hThreads, TRUE, INFINITE);
+	// Closing the asynchronous sender waits until all submitted packets are sent.
+	if (ps->pAsync)
+		closeWOLasync (ps->pAsync);
+	QueryPerformanceCounter (&liEnd);
+	for (n = 0; n < nStarted; ++ n)
+	{
+		CloseHandle (hThreads [n]);
+		ps->threads [n].hThread = NULL;
+		ps->nSent	+= ps->threads [n].nSent;
+		ps->nFailed	+= ps->threads [n].nFailed;
+	}
+	ps->uiTicks			= (uint64_t) (liEnd.QuadPart - liStart.QuadPart);
+	ps->uiTicksPerSec	= (uint64_t) liFreq.QuadPart;
+
+	drainWOLstress (ps, ps->nSent);
+	stopWOLlistener (&ps->listener);
+	WaitForSingleObject (hReceiver, INFINITE);
+	CloseHandle (hReceiver);
+	closeWOLlistener (&ps->listener);
+	GetProcessHandleCount (GetCurrentProcess (), &ps->dwHandlesAfter);
+
+	for (n = 0; n < nStarted; ++ n)
+	{
+		const SWOLSTRESSTHREAD *pt = ps->threads + n;
+		if (pt->nReceived < pt->nSent)
+			ps->nLost		+= pt->nSent - pt->nReceived;
+		else
+			ps->nDuplicates	+= pt->nReceived - pt->nSent;
+	}
+	if (nStarted < ps->nThreads)
+		return wolstressErrThread;
+	if (ps->dwHandlesAfter > ps->dwHandlesBefore)
+		return wolstressLeak;
+	return ps->nLost || ps->nFailed ? wolstressLost : wolstressOk;
+}
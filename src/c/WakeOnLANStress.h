@@ -0,0 +1,185 @@
+/****************************************************************************************
+
+File		WakeOnLANStress.h
+Why:		Stress test of the WOL functions from concurrent threads.
+OS:			Windows
+Created:	2026-10-17
+
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2026-10-17	Thomas			Created.
+2026-10-17	Thomas			Option to submit asynchronously via WakeOnLANAsync.
+
+****************************************************************************************/
+
+/*
+	This file is maintained as part of OnOffMate. See https://github.com/ThomasPGH/OnOffMate .
+*/
+
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Copyright (c) 2024, 2025, 2026 Thomas
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+#ifndef U_WAKEONLANSTRESS_H
+#define U_WAKEONLANSTRESS_H
+
+#include <stdbool.h>
+#include <inttypes.h>
+#include "./WakeOnLANListen.h"
+#include "./WakeOnLANAsync.h"
+#include "./externC.h"
+
+/*
+	The maximum amount of sending threads. WaitForMultipleObjects () waits for up to
+	MAXIMUM_WAIT_OBJECTS (64) handles.
+*/
+#define U_WOLSTRESS_MAX_THREADS				(64)
+
+/*
+	The loopback UDP port magic packets are sent to by default.
+*/
+#ifndef U_WOLSTRESS_DEF_PORT
+#define U_WOLSTRESS_DEF_PORT				(40009)
+#endif
+
+/*
+	The amount of targets a thread with a sender passes to sendWOLbatch () at once.
+*/
+#ifndef U_WOLSTRESS_BATCH
+#define U_WOLSTRESS_BATCH					(16)
+#endif
+
+/*
+	How long, in milliseconds, the receiver may stay idle after the last sender ended before
+	missing magic packets are considered lost.
+*/
+/*
+	The amount of requests each thread cycles through when it submits asynchronously.
+*/
+#ifndef U_WOLSTRESS_ASYNC_REQS
+#define U_WOLSTRESS_ASYNC_REQS				(256)
+#endif
+
+/*
+	The maximum amount of magic packets all threads together send ahead of the receiver.
+	Without this limit a loopback stress test mainly measures how quickly the receive buffer
+	overflows.
+*/
+#ifndef U_WOLSTRESS_WINDOW
+#define U_WOLSTRESS_WINDOW					(2048)
+#endif
+
+#ifndef U_WOLSTRESS_DRAIN_MS
+#define U_WOLSTRESS_DRAIN_MS				(500)
+#endif
+
+EXTERN_C_BEGIN
+
+/*
+	SWOLSTRESSTHREAD
+
+	The counters of a sending thread. The thread sends magic packets for the MAC address
+	02-4F-4F-4D-00-<index>, hence the receiver can tell which thread sent a packet.
+*/
+typedef struct swolstressthread
+{
+	struct swolstress			*ps;
+	uint32_t					uiIndex;
+	HANDLE						hThread;
+	bool						bSender;					// SWOLSENDER or sendWOLtarget ().
+	int							iFamily;					// AF_INET or AF_INET6.
+	uint64_t					nSent;
+	uint64_t					nFailed;
+	uint64_t					nReceived;					// Counted by the receiver.
+} SWOLSTRESSTHREAD;
+
+/*
+	SWOLSTRESS
+
+	A stress test. The caller sets nThreads, nPackets, uiPort, and pAsync, and
+	runWOLstress () sets all other members.
+*/
+typedef struct swolstress
+{
+	uint32_t					nThreads;					// Set by caller.
+	uint64_t					nPackets;					// Set by caller. Per thread.
+	uint16_t					uiPort;						// Set by caller.
+	SWOLASYNC					*pAsync;					// Set by caller, or NULL.
+	SWOLLISTENER				listener;
+	SWOLSTRESSTHREAD			threads [U_WOLSTRESS_MAX_THREADS];
+	volatile LONG64				nReceived;					// All magic packets received.
+	volatile LONG64				nInFlight;					// Sent but not received yet.
+	uint64_t					nForeign;					// Not sent by this test.
+	uint64_t					nSent;
+	uint64_t					nFailed;
+	uint64_t					nLost;
+	uint64_t					nDuplicates;
+	DWORD						dwHandlesBefore;
+	DWORD						dwHandlesAfter;
+	uint64_t					uiTicks;					// Start until all packets were sent.
+	uint64_t					uiTicksPerSec;
+} SWOLSTRESS;
+
+enum eWOLstressRet
+{
+	wolstressOk,											// No loss, no leak.
+	wolstressLost,											// Magic packets lost or not sent.
+	wolstressLeak,											// Handles were leaked.
+	wolstressErrWSA,
+	wolstressErrListen,
+	wolstressErrThread
+};
+
+/*
+	runWOLstress
+
+	Receives magic packets on the loopback port ps->uiPort, and sends ps->nPackets magic
+	packets to it from each of ps->nThreads threads at the same time. Every thread calls
+	callWSAStartup () and getWOLifaces () on its own, to exercise their once-only
+	initialisation and locking. Half of the threads send over a sender of their own (see
+	SWOLSENDER), and the other half calls sendWOLtarget (), which creates and closes a
+	socket per packet. The threads alternate between IPv4 (127.0.0.1) and IPv6 (::1).
+
+	If ps->pAsync is not NULL, all threads submit their magic packets to this asynchronous
+	sender instead, each cycling through U_WOLSTRESS_ASYNC_REQS requests of its own, and
+	its counters hold the submit-to-wire latencies afterwards. See openWOLasync ().
+
+	The function compares the amount of handles of the process, which includes sockets,
+	before and after the test, and counts the magic packets of each thread that didn't
+	arrive. Loopback UDP may drop datagrams when the receiver falls behind, which shows
+	up as loss, not as a failed send.
+
+	The function returns wolstressOk if every magic packet was sent and received, and no
+	handle leaked.
+	An SWOLSTRESS structure is larger than a page. Allocate it on the heap.
+*/
+enum eWOLstressRet runWOLstress (SWOLSTRESS *ps)
+;
+
+EXTERN_C_END
+
+#endif														// Of #ifndef U_WAKEONLANSTRESS_H.
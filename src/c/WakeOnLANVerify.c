@@ -0,0 +1,589 @@
+/****************************************************************************************
+
+File		WakeOnLANVerify.c
+Why:		Verifies that woken up hosts are reachable.
+OS:			Windows
+Created:	2026-10-17
+
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2026-10-17	Thomas			Created.
+2026-10-17	Thomas			Retry rounds of the send policy for hosts not up yet.
+2026-10-17	Thomas			Stepwise verification with a shared completion port for wake plans.
+2026-10-17	Thomas			ConnectEx () pointer published atomically.
+
+****************************************************************************************/
+
+/*
+	This file is maintained as part of OnOffMate. See https://github.com/ThomasPGH/OnOffMate .
+*/
+
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Copyright (c) 2024, 2025, 2026 Thomas
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "./WakeOnLANVerify.h"
+#include <Windows.h>
+#include <mswsock.h>
+#include <winternl.h>
+#include <iphlpapi.h>
+#include <icmpapi.h>
+#include "./WinRuntimeReplacements.h"
+#include "./WinUTF8Console.h"
+
+#pragma comment (lib, "Iphlpapi.lib")
+
+/*
+	The echo data of ICMP probes. It's only read.
+*/
+static char	cWOLicmpData [8]	= { 'O', 'n', 'O', 'f', 'f', 'W', 'O', 'L' };
+
+/*
+	Retrieved once by the first TCP probe of any thread. See getConnectEx ().
+*/
+static LPFN_CONNECTEX	pfnConnectEx;
+
+void initWOLverify (SWOLVERIFY *pv)
+{
+	memsetU (pv, 0, sizeof (SWOLVERIFY));
+	pv->uiTimeoutMs		= U_WAKEONLAN_VERIFY_TIMEOUT_MS;
+	pv->uiAttemptMs		= U_WAKEONLAN_VERIFY_ATTEMPT_MS;
+	pv->uiBackoffMs		= U_WAKEONLAN_VERIFY_BACKOFF_MS;
+	pv->uiBackoffMaxMs	= U_WAKEONLAN_VERIFY_BACKOFF_MAX_MS;
+}
+
+bool parseWOLprobeW (SWOLVERIFY *pv, const wchar_t *wzSpec)
+{
+	size_t		len	= strlenW (wzSpec);
+	uint64_t	uiPort;
+
+	if (4 == len && 0 == stricmpW (wzSpec, L"icmp", 4))
+	{
+		pv->probe = wolprobeICMP;
+		return true;
+	}
+	if	(
+				len > 4 && 0 == stricmpW (wzSpec, L"tcp:", 4)
+			&&	numberArgumentW (&uiPort, (WCHAR *) wzSpec + 4) && uiPort && uiPort <= 0xFFFF
+		)
+	{
+		pv->probe	= wolprobeTCP;
+		pv->uiPort	= (uint16_t) uiPort;
+		return true;
+	}
+	return false;
+}
+
+static uint64_t nowWOLverify (SWOLVERIFY *pv)
+{
+	LARGE_INTEGER li;
+
+	QueryPerformanceCounter (&li);
+	pv->uiNow = (uint64_t) li.QuadPart;
+	return pv->uiNow;
+}
+
+static uint64_t ticksFromMs (SWOLVERIFY *pv, uint64_t uiMs)
+{
+	return uiMs * pv->uiTicksPerSec / 1000;
+}
+
+/*
+	Marks the targets of pp as awake, which excludes them from further retry rounds. These
+	are its own target and the consecutive targets with the same host. See needsWOLprobe ().
+*/
+static void setWOLprobeAwake (SWOLPROBE *pp)
+{
+	SWOLLIST	*pl		= pp->pv->pl;
+	SWOLTARGET	*pt		= pp->pt;
+	SWOLTARGET	*pEnd	= pl->pTargets + pl->nTargets;
+
+	pt->nCopiesToWake = pt->nCopies;
+	do
+		pt->bAwake = true;
+	while	(
+					++ pt < pEnd && pt->lenHost == pp->pt->lenHost
+				&&	0 == memcmpU (&pt->ssHost, &pp->pt->ssHost, pt->lenHost)
+			);
+}
+
+/*
+	Ends an attempt of pp. If bUp is false the next attempt is scheduled with exponential
+	backoff.
+*/
+static void endWOLprobeAttempt (SWOLPROBE *pp, bool bUp)
+{
+	SWOLVERIFY *pv = pp->pv;
+
+	-- pv->nInFlight;
+	if (INVALID_SOCKET != pp->s)
+	{
+		closesocket (pp->s);
+		pp->s = INVALID_SOCKET;
+	}
+	nowWOLverify (pv);
+	if (bUp)
+	{
+		pp->state		= wolprbUp;
+		pp->uiWakeMs	= (pv->uiNow - pv->uiStart) * 1000 / pv->uiTicksPerSec;
+		++ pv->nUp;
+		setWOLprobeAwake (pp);
+		return;
+	}
+	pp->state		= wolprbIdle;
+	pp->uiDue		= pv->uiNow + pp->uiBackoff;
+	pp->uiBackoff	*= 2;
+	if (pp->uiBackoff > ticksFromMs (pv, pv->uiBackoffMaxMs))
+		pp->uiBackoff = ticksFromMs (pv, pv->uiBackoffMaxMs);
+}
+
+/*
+	Returns the ConnectEx () extension function, which is retrieved via the socket s on
+	the first call.
+*/
+static LPFN_CONNECTEX getConnectEx (SOCKET s)
+{
+	static GUID		guid	= WSAID_CONNECTEX;
+	LPFN_CONNECTEX	pfn		= (LPFN_CONNECTEX) InterlockedCompareExchangePointer	(
+										(PVOID volatile *) &pfnConnectEx, NULL, NULL
+																						);
+	DWORD			dw;
+
+	// Threads that get here at the same time all retrieve the same pointer.
+	if (NULL == pfn)
+	{
+		if	(
+				0 != WSAIoctl	(
+						s, SIO_GET_EXTENSION_FUNCTION_POINTER, &guid, sizeof (guid),
+						&pfn, sizeof (pfn), &dw, NULL, NULL
+								)
+			)
+			return NULL;
+		InterlockedExchangePointer ((PVOID volatile *) &pfnConnectEx, (PVOID) pfn);
+	}
+	return pfn;
+}
+
+/*
+	Starts a TCP connect of pp. Returns false if the attempt failed right away.
+*/
+static bool startWOLprobeTCP (SWOLPROBE *pp)
+{
+	SWOLVERIFY				*pv		= pp->pv;
+	SWOLTARGET				*pt		= pp->pt;
+	int						iFamily	= pt->ssHost.ss_family;
+	struct sockaddr_storage	ss;
+	LPFN_CONNECTEX			pfn;
+
+	pp->s = WSASocketW (iFamily, SOCK_STREAM, IPPROTO_TCP, NULL, 0, WSA_FLAG_OVERLAPPED);
+	if (INVALID_SOCKET == pp->s)
+		return false;
+	// ConnectEx () requires a bound socket.
+	memsetU (&ss, 0, sizeof (ss));
+	ss.ss_family = (ADDRESS_FAMILY) iFamily;
+	// sin_port and sin6_port are at the same offset.
+	((struct sockaddr_in *) &pt->ssHost)->sin_port = htons (pv->uiPort);
+	if	(
+				0 != bind (pp->s, (struct sockaddr *) &ss, pt->lenHost)
+			||	NULL == CreateIoCompletionPort ((HANDLE) pp->s, pv->hIOCP, 0, 0)
+			||	NULL == (pfn = getConnectEx (pp->s))
+		)
+		return false;
+	memsetU (&pp->ov, 0, sizeof (OVERLAPPED));
+	if	(
+				!pfn (pp->s, (struct sockaddr *) &pt->ssHost, pt->lenHost, NULL, 0, NULL, &pp->ov)
+			&&	ERROR_IO_PENDING != WSAGetLastError ()
+		)
+		return false;
+	return true;
+}
+
+/*
+	Called by the completion port loop when a ConnectEx () completed.
+*/
+static void doneWOLprobeTCP (SWOLPROBE *pp)
+{
+	DWORD	dwBytes;
+	DWORD	dwFlags;
+	bool	bUp;
+
+	bUp = WSAGetOverlappedResult (pp->s, &pp->ov, &dwBytes, FALSE, &dwFlags);
+	if (!bUp && !pp->bCancelled)
+		bUp = WSAECONNREFUSED == WSAGetLastError ();
+	endWOLprobeAttempt (pp, bUp);
+}
+
+/*
+	APC called when an ICMP echo request completed or timed out.
+*/
+static VOID NTAPI onWOLprobeICMP (PVOID pApcContext, PIO_STATUS_BLOCK pIoStatusBlock, ULONG ulReserved)
+{
+	SWOLPROBE	*pp		= pApcContext;
+	bool		bUp		= false;
+
+	UNREFERENCED_PARAMETER (pIoStatusBlock);
+	UNREFERENCED_PARAMETER (ulReserved);
+	if (AF_INET == pp->pt->ssHost.ss_family)
+	{
+		if (IcmpParseReplies (pp->cReply, sizeof (pp->cReply)))
+			bUp = IP_SUCCESS == ((PICMP_ECHO_REPLY) pp->cReply)->Status;
+	} else
+	{
+		if (Icmp6ParseReplies (pp->cReply, sizeof (pp->cReply)))
+			bUp = IP_SUCCESS == ((PICMPV6_ECHO_REPLY) pp->cReply)->Status;
+	}
+	endWOLprobeAttempt (pp, bUp);
+}
+
+/*
+	Sends an ICMP echo request to the host of pp. Returns false if the attempt failed
+	right away.
+*/
+static bool startWOLprobeICMP (SWOLPROBE *pp)
+{
+	SWOLVERIFY	*pv		= pp->pv;
+	SWOLTARGET	*pt		= pp->pt;
+	DWORD		dwRet;
+
+	if (AF_INET == pt->ssHost.ss_family)
+	{
+		if (INVALID_HANDLE_VALUE == pv->hIcmp4)
+			return false;
+		dwRet = IcmpSendEcho2	(
+					pv->hIcmp4, NULL, (PIO_APC_ROUTINE) onWOLprobeICMP, pp,
+					((struct sockaddr_in *) &pt->ssHost)->sin_addr.s_addr,
+					cWOLicmpData, sizeof (cWOLicmpData), NULL,
+					pp->cReply, sizeof (pp->cReply), (DWORD) pv->uiAttemptMs
+								);
+	} else
+	{
+		struct sockaddr_in6 sa6Src;
+		if (INVALID_HANDLE_VALUE == pv->hIcmp6)
+			return false;
+		memsetU (&sa6Src, 0, sizeof (sa6Src));
+		sa6Src.sin6_family = AF_INET6;
+		dwRet = Icmp6SendEcho2	(
+					pv->hIcmp6, NULL, (PIO_APC_ROUTINE) onWOLprobeICMP, pp,
+					&sa6Src, (struct sockaddr_in6 *) &pt->ssHost,
+					cWOLicmpData, sizeof (cWOLicmpData), NULL,
+					pp->cReply, sizeof (pp->cReply), (DWORD) pv->uiAttemptMs
+								);
+	}
+	// Asynchronous calls return 0 and ERROR_IO_PENDING.
+	return 0 == dwRet && ERROR_IO_PENDING == GetLastError ();
+}
+
+/*
+	Starts the next attempt of pp.
+*/
+static void startWOLprobe (SWOLPROBE *pp)
+{
+	SWOLVERIFY	*pv	= pp->pv;
+	bool		bStarted;
+
+	++ pp->nAttempts;
+	++ pv->nAttempts;
+	++ pv->nInFlight;
+	pp->state		= wolprbInFlight;
+	pp->bCancelled	= false;
+	pp->uiDue		= pv->uiNow + ticksFromMs (pv, pv->uiAttemptMs);
+	if (wolprobeTCP == pv->probe)
+		bStarted = startWOLprobeTCP (pp);
+	else
+		bStarted = startWOLprobeICMP (pp);
+	if (!bStarted)
+		endWOLprobeAttempt (pp, false);
+}
+
+void waitWOLverifyIOCP (HANDLE hIOCP, DWORD dwMs)
+{
+	OVERLAPPED_ENTRY	oe [64];
+	ULONG				nRemoved	= 0;
+	ULONG				n;
+
+	if (NULL == hIOCP)
+	{
+		SleepEx (dwMs, TRUE);
+		return;
+	}
+	if (!GetQueuedCompletionStatusEx (hIOCP, oe, 64, &nRemoved, dwMs, TRUE))
+		return;
+	// The probe, and through it its verification, is found via the OVERLAPPED structure.
+	for (n = 0; n < nRemoved; ++ n)
+		doneWOLprobeTCP (CONTAINING_RECORD (oe [n].lpOverlapped, SWOLPROBE, ov));
+}
+
+/*
+	Waits up to dwMs milliseconds for completions. APCs of ICMP probes run during the
+	alertable wait.
+*/
+static void waitWOLverify (SWOLVERIFY *pv, DWORD dwMs)
+{
+	waitWOLverifyIOCP (wolprobeTCP == pv->probe ? pv->hIOCP : NULL, dwMs);
+}
+
+/*
+	Sorts the times to wake (heapsort, as there's no qsort () without the CRT).
+*/
+static void siftDownUint64 (uint64_t *pui, size_t root, size_t n)
+{
+	while (2 * root + 1 < n)
+	{
+		size_t child = 2 * root + 1;
+		if (child + 1 < n && pui [child] < pui [child + 1])
+			++ child;
+		if (pui [root] >= pui [child])
+			return;
+		uint64_t ui		= pui [root];
+		pui [root]		= pui [child];
+		pui [child]		= ui;
+		root			= child;
+	}
+}
+
+static void sortUint64 (uint64_t *pui, size_t n)
+{
+	size_t i;
+
+	for (i = n / 2; i > 0; -- i)
+		siftDownUint64 (pui, i - 1, n);
+	for (i = n; i > 1; -- i)
+	{
+		uint64_t ui		= pui [0];
+		pui [0]			= pui [i - 1];
+		pui [i - 1]		= ui;
+		siftDownUint64 (pui, 0, i - 1);
+	}
+}
+
+/*
+	Returns true if the target n of the list needs a probe. Consecutive targets with the
+	same host, which a broadcast IP of "auto" creates, share a single probe.
+*/
+static bool needsWOLprobe (SWOLLIST *pl, size_t n)
+{
+	SWOLTARGET *pt = pl->pTargets + n;
+
+	if (wolretOk != pt->ret || 0 == pt->lenHost)
+		return false;
+	while (n --)
+	{
+		SWOLTARGET *pp = pl->pTargets + n;
+		if (wolretOk == pp->ret && pp->lenHost)
+			return pp->lenHost != pt->lenHost || memcmpU (&pp->ssHost, &pt->ssHost, pt->lenHost);
+	}
+	return true;
+}
+
+static bool openWOLverify (SWOLVERIFY *pv, SWOLLIST *pl, HANDLE hIOCP)
+{
+	LARGE_INTEGER	liFreq;
+	size_t			n;
+
+	pv->hIcmp4	= INVALID_HANDLE_VALUE;
+	pv->hIcmp6	= INVALID_HANDLE_VALUE;
+	pv->nProbes	= 0;
+	pv->pl		= pl;
+	for (n = 0; n < pl->nTargets; ++ n)
+	{
+		if (needsWOLprobe (pl, n))
+			++ pv->nProbes;
+	}
+	pv->pProbes = HeapAlloc (GetProcessHeap (), HEAP_ZERO_MEMORY, (pv->nProbes + 1) * sizeof (SWOLPROBE));
+	pv->puiWakeMs = HeapAlloc (GetProcessHeap (), 0, (pv->nProbes + 1) * sizeof (uint64_t));
+	if (NULL == pv->pProbes || NULL == pv->puiWakeMs)
+		return false;
+
+	QueryPerformanceFrequency (&liFreq);
+	pv->uiTicksPerSec	= (uint64_t) liFreq.QuadPart;
+	pv->uiTimeoutTicks	= ticksFromMs (pv, pv->uiTimeoutMs);
+	SWOLPROBE *pp		= pv->pProbes;
+	for (n = 0; n < pl->nTargets; ++ n)
+	{
+		if (!needsWOLprobe (pl, n))
+			continue;
+		pp->pt			= pl->pTargets + n;
+		pp->pv			= pv;
+		pp->s			= INVALID_SOCKET;
+		pp->state		= wolprbIdle;
+		pp->uiBackoff	= ticksFromMs (pv, pv->uiBackoffMs);
+		++ pp;
+	}
+
+	if (wolprobeTCP == pv->probe)
+	{
+		pv->bOwnIOCP	= NULL == hIOCP;
+		pv->hIOCP		= hIOCP ? hIOCP : CreateIoCompletionPort (INVALID_HANDLE_VALUE, NULL, 0, 1);
+		return NULL != pv->hIOCP;
+	}
+	pv->hIcmp4 = IcmpCreateFile ();
+	pv->hIcmp6 = Icmp6CreateFile ();
+	return INVALID_HANDLE_VALUE != pv->hIcmp4 || INVALID_HANDLE_VALUE != pv->hIcmp6;
+}
+
+/*
+	Schedules the next retry round of the list's send policy, if any.
+*/
+static void scheduleWOLverifyRound (SWOLVERIFY *pv)
+{
+	SWOLPOLICY *pp = &pv->pl->policy;
+
+	pv->uiNextRound = 0;
+	if (pv->pl->nRounds && pv->pl->nRounds <= pp->uiRetries)
+		pv->uiNextRound = pv->uiNow + ticksFromMs (pv, backoffWOLpolicyMs (pp, pv->pl->nRounds));
+}
+
+bool startWOLverify (SWOLVERIFY *pv, SWOLLIST *pl, HANDLE hIOCP)
+{
+	size_t n;
+
+	if (wolprobeNone == pv->probe || !openWOLverify (pv, pl, hIOCP))
+		return false;
+
+	pv->uiStart = nowWOLverify (pv);
+	for (n = 0; n < pv->nProbes; ++ n)
+		pv->pProbes [n].uiDue = pv->uiStart;
+	scheduleWOLverifyRound (pv);
+	return true;
+}
+
+uint64_t stepWOLverify (SWOLVERIFY *pv)
+{
+	size_t n;
+
+	nowWOLverify (pv);
+	if (pv->nUp == pv->nProbes || pv->uiNow - pv->uiStart >= pv->uiTimeoutTicks)
+		return 0;
+
+	uint64_t uiWake = pv->uiStart + pv->uiTimeoutTicks;
+	if (pv->uiNextRound && pv->uiNextRound <= pv->uiNow)
+	{
+		sendWOLlist (pv->pl);
+		nowWOLverify (pv);
+		scheduleWOLverifyRound (pv);
+	}
+	if (pv->uiNextRound && pv->uiNextRound < uiWake)
+		uiWake = pv->uiNextRound;
+
+	for (n = 0; n < pv->nProbes; ++ n)
+	{
+		SWOLPROBE *pp = pv->pProbes + n;
+		if	(
+					wolprbIdle == pp->state && pp->uiDue <= pv->uiNow
+				&&	pv->nInFlight < U_WAKEONLAN_VERIFY_MAX_INFLIGHT
+			)
+			startWOLprobe (pp);
+		// ICMP requests time out on their own.
+		if	(
+					wolprbInFlight == pp->state && wolprobeTCP == pv->probe
+				&&	!pp->bCancelled && pp->uiDue <= pv->uiNow
+			)
+		{
+			CancelIoEx ((HANDLE) pp->s, &pp->ov);
+			pp->bCancelled = true;
+		}
+		if	(
+					(wolprbIdle == pp->state || wolprbInFlight == pp->state)
+				&&	pp->uiDue > pv->uiNow && pp->uiDue < uiWake
+			)
+			uiWake = pp->uiDue;
+	}
+	// A probe that ended right away may have been the last one.
+	return pv->nUp == pv->nProbes ? 0 : uiWake;
+}
+
+void endWOLverify (SWOLVERIFY *pv)
+{
+	size_t n;
+
+	// Attempts still in flight must complete before their buffers can be released.
+	for (n = 0; n < pv->nProbes; ++ n)
+	{
+		SWOLPROBE *pp = pv->pProbes + n;
+		if (wolprbInFlight == pp->state && wolprobeTCP == pv->probe && !pp->bCancelled)
+		{
+			CancelIoEx ((HANDLE) pp->s, &pp->ov);
+			pp->bCancelled = true;
+		}
+	}
+	while (pv->nInFlight)
+		waitWOLverify (pv, (DWORD) pv->uiAttemptMs);
+
+	size_t nUp = 0;
+	for (n = 0; n < pv->nProbes; ++ n)
+	{
+		SWOLPROBE *pp = pv->pProbes + n;
+		if (wolprbUp == pp->state)
+			pv->puiWakeMs [nUp ++] = pp->uiWakeMs;
+		else
+			pp->state = wolprbDown;
+	}
+	sortUint64 (pv->puiWakeMs, nUp);
+}
+
+bool verifyWOLlist (SWOLVERIFY *pv, SWOLLIST *pl)
+{
+	uint64_t uiWake;
+
+	if (!startWOLverify (pv, pl, NULL))
+		return false;
+	while ((uiWake = stepWOLverify (pv)))
+	{
+		uint64_t uiMs = uiWake > pv->uiNow
+						? ((uiWake - pv->uiNow) * 1000 + pv->uiTicksPerSec - 1) / pv->uiTicksPerSec
+						: 0;
+		waitWOLverify (pv, (DWORD) uiMs);
+	}
+	endWOLverify (pv);
+	return true;
+}
+
+uint64_t percentileWOLverify (SWOLVERIFY *pv, unsigned int uiPercent)
+{
+	if (0 == pv->nUp)
+		return 0;
+	size_t nRank = (pv->nUp * uiPercent + 99) / 100;
+	return pv->puiWakeMs [nRank ? nRank - 1 : 0];
+}
+
+void doneWOLverify (SWOLVERIFY *pv)
+{
+	if (pv->hIOCP && pv->bOwnIOCP)
+		CloseHandle (pv->hIOCP);
+	if (pv->hIcmp4 && INVALID_HANDLE_VALUE != pv->hIcmp4)
+		IcmpCloseHandle (pv->hIcmp4);
+	if (pv->hIcmp6 && INVALID_HANDLE_VALUE != pv->hIcmp6)
+		IcmpCloseHandle (pv->hIcmp6);
+	if (pv->pProbes)
+		HeapFree (GetProcessHeap (), 0, pv->pProbes);
+	if (pv->puiWakeMs)
+		HeapFree (GetProcessHeap (), 0, pv->puiWakeMs);
+	pv->hIOCP		= NULL;
+	pv->hIcmp4		= NULL;
+	pv->hIcmp6		= NULL;
+	pv->pProbes		= NULL;
+	pv->puiWakeMs	= NULL;
+}
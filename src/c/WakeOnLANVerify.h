@@ -0,0 +1,262 @@
+/****************************************************************************************
+
+File		WakeOnLANVerify.h
+Why:		Verifies that woken up hosts are reachable.
+OS:			Windows
+Created:	2026-10-17
+
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2026-10-17	Thomas			Created.
+2026-10-17	Thomas			Retry rounds of the send policy for hosts not up yet.
+2026-10-17	Thomas			Stepwise verification with a shared completion port for wake plans.
+
+****************************************************************************************/
+
+/*
+	This file is maintained as part of OnOffMate. See https://github.com/ThomasPGH/OnOffMate .
+*/
+
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Copyright (c) 2024, 2025, 2026 Thomas
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef U_WAKEONLANVERIFY_H
+#define U_WAKEONLANVERIFY_H
+
+#include <stdbool.h>
+#include <inttypes.h>
+#include "./WakeOnLAN.h"
+#include "./externC.h"
+
+/*
+	Defaults for SWOLVERIFY. See initWOLverify ().
+*/
+#ifndef U_WAKEONLAN_VERIFY_TIMEOUT_MS
+#define U_WAKEONLAN_VERIFY_TIMEOUT_MS		(120 * 1000)
+#endif
+#ifndef U_WAKEONLAN_VERIFY_ATTEMPT_MS
+#define U_WAKEONLAN_VERIFY_ATTEMPT_MS		(1000)
+#endif
+#ifndef U_WAKEONLAN_VERIFY_BACKOFF_MS
+#define U_WAKEONLAN_VERIFY_BACKOFF_MS		(250)
+#endif
+#ifndef U_WAKEONLAN_VERIFY_BACKOFF_MAX_MS
+#define U_WAKEONLAN_VERIFY_BACKOFF_MAX_MS	(8000)
+#endif
+
+/*
+	The maximum amount of probes in flight at the same time. This limits the amount of
+	sockets and ephemeral ports used for TCP probes.
+*/
+#ifndef U_WAKEONLAN_VERIFY_MAX_INFLIGHT
+#define U_WAKEONLAN_VERIFY_MAX_INFLIGHT		(1024)
+#endif
+
+/*
+	Size of the reply buffer of an ICMP probe. It must hold an ICMP_ECHO_REPLY or
+	ICMPV6_ECHO_REPLY structure, the echo data, 8 octets for an ICMP error message, and
+	an IO_STATUS_BLOCK structure.
+*/
+#ifndef U_WAKEONLAN_VERIFY_REPLY_SIZ
+#define U_WAKEONLAN_VERIFY_REPLY_SIZ		(128)
+#endif
+
+EXTERN_C_BEGIN
+
+enum eWOLprobe
+{
+	wolprobeNone,
+	wolprobeTCP,											// TCP connect to a port.
+	wolprobeICMP											// ICMP echo (ping).
+};
+
+enum eWOLprobeState
+{
+	wolprbIdle,												// Waiting for next attempt.
+	wolprbInFlight,
+	wolprbUp,
+	wolprbDown												// Not up when time ran out.
+};
+
+/*
+	SWOLPROBE
+
+	The probe of a single target.
+*/
+typedef struct swolprobe
+{
+	OVERLAPPED					ov;							// TCP: ConnectEx ().
+	SWOLTARGET					*pt;
+	struct swolverify			*pv;
+	SOCKET						s;
+	enum eWOLprobeState			state;
+	bool						bCancelled;					// TCP attempt timed out.
+	uint64_t					uiDue;						// Next attempt or deadline.
+	uint64_t					uiBackoff;					// Ticks until the next attempt.
+	uint64_t					uiWakeMs;					// Time to wake if up.
+	uint32_t					nAttempts;
+	char						cReply [U_WAKEONLAN_VERIFY_REPLY_SIZ];
+} SWOLPROBE;
+
+/*
+	SWOLVERIFY
+
+	Settings and results of a verification. The caller sets probe and uiPort, or calls
+	parseWOLprobeW (). All other settings have defaults set by initWOLverify ().
+*/
+typedef struct swolverify
+{
+	enum eWOLprobe				probe;
+	uint16_t					uiPort;						// TCP port.
+	uint64_t					uiTimeoutMs;				// Waiting for all hosts.
+	uint64_t					uiAttemptMs;				// Waiting for a single probe.
+	uint64_t					uiBackoffMs;				// Delay before first retry.
+	uint64_t					uiBackoffMaxMs;				// Maximum delay.
+	SWOLPROBE					*pProbes;
+	size_t						nProbes;					// Targets with a host address.
+	size_t						nUp;
+	size_t						nInFlight;
+	uint64_t					nAttempts;
+	uint64_t					*puiWakeMs;					// Sorted times to wake.
+	uint64_t					uiTicksPerSec;
+	uint64_t					uiTimeoutTicks;
+	uint64_t					uiStart;					// Start of verification.
+	uint64_t					uiNow;
+	HANDLE						hIOCP;						// TCP probes.
+	bool						bOwnIOCP;					// Not shared.
+	HANDLE						hIcmp4;						// ICMP probes.
+	HANDLE						hIcmp6;
+	SWOLLIST					*pl;						// The list verified.
+	uint64_t					uiNextRound;				// Retry round due, or 0.
+} SWOLVERIFY;
+
+/*
+	initWOLverify
+
+	Initialises the SWOLVERIFY structure pv points to with default settings.
+*/
+void initWOLverify (SWOLVERIFY *pv)
+;
+
+/*
+	parseWOLprobeW
+
+	Sets the probe of pv from the specification wzSpec, which is either "tcp:<port>" or
+	"icmp". A TCP connection that is refused counts as reachable since the host's stack
+	answered. The function returns false if wzSpec is invalid.
+*/
+bool parseWOLprobeW (SWOLVERIFY *pv, const wchar_t *wzSpec)
+;
+
+/*
+	verifyWOLlist
+
+	Probes every target of the list that was sent successfully and has a host address
+	(see setWOLtargetHostU8 ()) until all of them are reachable or the timeout is reached.
+	Call it right after sendWOLlist (). Times to wake are measured from the start of
+	this function. Consecutive targets with the same host address, which a broadcast IP
+	of "auto" creates, share a single probe.
+
+	All probes run concurrently in a single thread. TCP probes use ConnectEx () and an
+	I/O completion port, ICMP probes IcmpSendEcho2 () with APCs that run while the
+	thread waits alertably. A failed attempt is retried after a delay that starts at
+	uiBackoffMs and doubles up to uiBackoffMaxMs.
+
+	The function also sends the retry rounds of the list's send policy (see SWOLPOLICY),
+	but only to targets whose host is not up yet. When a probe succeeds, the bAwake
+	member of its targets is set, and nCopiesToWake tells how many magic packets had been
+	sent to the host by then.
+
+	The function returns false if the probes could not be set up.
+*/
+bool verifyWOLlist (SWOLVERIFY *pv, SWOLLIST *pl)
+;
+
+/*
+	startWOLverify
+
+	Starts the verification of the list pl like verifyWOLlist () but returns right away
+	instead of waiting for the hosts. The caller then calls stepWOLverify () and
+	waitWOLverifyIOCP () until stepWOLverify () returns 0, and finally endWOLverify ().
+	If hIOCP is not NULL, TCP probes use this completion port instead of their own. This
+	lets a single thread run several verifications at the same time, all waiting on the
+	same port. The function returns false if the probes could not be set up.
+*/
+bool startWOLverify (SWOLVERIFY *pv, SWOLLIST *pl, HANDLE hIOCP)
+;
+
+/*
+	stepWOLverify
+
+	Sends the retry round of the list if it is due, starts the probe attempts that are
+	due, and cancels the ones that took too long. The function returns the performance
+	counter value at which it needs to be called again, or 0 when all hosts are up or the
+	timeout has been reached.
+*/
+uint64_t stepWOLverify (SWOLVERIFY *pv)
+;
+
+/*
+	waitWOLverifyIOCP
+
+	Waits up to dwMs milliseconds for completed TCP probes on the completion port hIOCP,
+	which is the port passed to startWOLverify (), or the hIOCP member of a verification.
+	ICMP probes complete with APCs during the wait, which is alertable. If hIOCP is NULL
+	the function only waits for APCs.
+*/
+void waitWOLverifyIOCP (HANDLE hIOCP, DWORD dwMs)
+;
+
+/*
+	endWOLverify
+
+	Cancels the attempts still in flight, waits for them, and sorts the times to wake.
+	Hosts that are not up are marked as down.
+*/
+void endWOLverify (SWOLVERIFY *pv)
+;
+
+/*
+	percentileWOLverify
+
+	Returns the time to wake in milliseconds that uiPercent percent of the hosts that are
+	up did not exceed (nearest rank), or 0 if no host is up.
+*/
+uint64_t percentileWOLverify (SWOLVERIFY *pv, unsigned int uiPercent)
+;
+
+/*
+	doneWOLverify
+
+	Deallocates the resources of the SWOLVERIFY structure pv points to.
+*/
+void doneWOLverify (SWOLVERIFY *pv)
+;
+
+EXTERN_C_END
+
+#endif														// Of #ifndef U_WAKEONLANVERIFY_H.
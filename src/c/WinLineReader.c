@@ -0,0 +1,189 @@
+/****************************************************************************************
+
+File		WinLineReader.c
+Why:		Reads text files or stdin line by line.
+OS:			Windows
+Created:	2026-10-17
+
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2026-10-17	Thomas			Created.
+2026-10-17	Thomas			Line ends searched with SSE2. Function lineLengthU8 () added.
+
+****************************************************************************************/
+
+/*
+	This file is maintained as part of OnOffMate. See https://github.com/ThomasPGH/OnOffMate .
+*/
+
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Copyright (c) 2024, 2025, 2026 Thomas
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Windows.h>
+#include <stdint.h>
+#include "./WinLineReader.h"
+#include "./WinRuntimeReplacements.h"
+
+size_t lineLengthU8 (const char *p, size_t len)
+{
+	size_t i = 0;
+
+	#ifdef U_WINRUNTIME_SSE2
+		const __m128i nl = _mm_set1_epi8 ('\n');
+		while (i + 16 <= len)
+		{
+			int m = _mm_movemask_epi8 (_mm_cmpeq_epi8 (_mm_loadu_si128 ((const __m128i *) (p + i)), nl));
+			if (m)
+			{
+				unsigned long b;
+				_BitScanForward (&b, (unsigned long) m);
+				return i + b;
+			}
+			i += 16;
+		}
+	#endif
+	while (i < len && '\n' != p [i])
+		++ i;
+	return i;
+}
+
+bool openLineReaderW (SLINEREADER *plr, const WCHAR *wcFile)
+{
+	memsetU (plr, 0, sizeof (SLINEREADER));
+
+	if (L'-' == wcFile [0] && L'\0' == wcFile [1])
+	{
+		plr->hFile		= GetStdHandle (STD_INPUT_HANDLE);
+		plr->bOwnHandle	= false;
+	} else
+	{
+		plr->hFile		= CreateFileW	(
+								wcFile, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+								NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL
+										);
+		plr->bOwnHandle	= true;
+	}
+	if (NULL == plr->hFile || INVALID_HANDLE_VALUE == plr->hFile)
+		return false;
+
+	plr->buf = HeapAlloc (GetProcessHeap (), 0, WINLINEREADER_BUFSIZE);
+	if (plr->buf)
+	{
+		plr->size = WINLINEREADER_BUFSIZE;
+		return true;
+	}
+	if (plr->bOwnHandle)
+		CloseHandle (plr->hFile);
+	plr->hFile = NULL;
+	return false;
+}
+
+/*
+	Reads more data into the buffer. Returns false if there's nothing more to read.
+*/
+static bool fillLineReader (SLINEREADER *plr)
+{
+	if (plr->bEOF)
+		return false;
+
+	// Move the remainder of the current line to the start of the buffer.
+	if (plr->pos)
+	{
+		memcpyU (plr->buf, plr->buf + plr->pos, plr->fill - plr->pos);
+		plr->fill	-= plr->pos;
+		plr->pos	= 0;
+	}
+	// We always keep one octet for the NUL terminator.
+	if (plr->fill + 1 >= plr->size)
+	{
+		char *nb = HeapReAlloc (GetProcessHeap (), 0, plr->buf, plr->size * 2);
+		if (NULL == nb)
+			return false;
+		plr->buf	= nb;
+		plr->size	*= 2;
+	}
+
+	DWORD	dwRead	= 0;
+	BOOL	b		= ReadFile	(
+							plr->hFile, plr->buf + plr->fill,
+							(DWORD) (plr->size - plr->fill - 1), &dwRead, NULL
+								);
+	// Reading from a pipe fails with ERROR_BROKEN_PIPE when the writer is done.
+	if (!b || 0 == dwRead)
+	{
+		plr->bEOF = true;
+		return false;
+	}
+	plr->fill += dwRead;
+	return true;
+}
+
+char *nextLineU8 (SLINEREADER *plr, size_t *plen)
+{
+	size_t	scan	= plr->pos;
+
+	while (true)
+	{
+		scan += lineLengthU8 (plr->buf + scan, plr->fill - scan);
+		if (scan < plr->fill)
+			break;
+		size_t consumed = scan - plr->pos;
+		if (!fillLineReader (plr))
+		{	// Last line without line ending.
+			if (plr->pos == plr->fill)
+				return NULL;
+			scan = plr->fill;
+			break;
+		}
+		scan = plr->pos + consumed;
+	}
+
+	char	*sz		= plr->buf + plr->pos;
+	size_t	len		= scan - plr->pos;
+
+	plr->pos = scan < plr->fill ? scan + 1 : scan;
+	if (len && '\r' == sz [len - 1])
+		-- len;
+	sz [len] = '\0';
+	if (0 == plr->nLine && len >= 3 && !memcmpU (sz, "\xEF\xBB\xBF", 3))
+	{
+		sz	+= 3;
+		len	-= 3;
+	}
+	++ plr->nLine;
+	if (plen)
+		*plen = len;
+	return sz;
+}
+
+void closeLineReader (SLINEREADER *plr)
+{
+	if (plr->buf)
+		HeapFree (GetProcessHeap (), 0, plr->buf);
+	if (plr->bOwnHandle && plr->hFile && INVALID_HANDLE_VALUE != plr->hFile)
+		CloseHandle (plr->hFile);
+	memsetU (plr, 0, sizeof (SLINEREADER));
+}
@@ -0,0 +1,125 @@
+/****************************************************************************************
+
+File		WinLineReader.h
+Why:		Reads text files or stdin line by line.
+OS:			Windows
+Created:	2026-10-17
+
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2026-10-17	Thomas			Created.
+2026-10-17	Thomas			Function lineLengthU8 () added.
+
+****************************************************************************************/
+
+/*
+	This file is maintained as part of OnOffMate. See https://github.com/ThomasPGH/OnOffMate .
+*/
+
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Copyright (c) 2024, 2025, 2026 Thomas
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef WINLINEREADER_H
+#define WINLINEREADER_H
+
+#include <Windows.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "./externC.h"
+
+/*
+	Initial size of the read buffer. The buffer grows if a single line doesn't fit
+	into it.
+*/
+#ifndef WINLINEREADER_BUFSIZE
+#define WINLINEREADER_BUFSIZE				(64 * 1024)
+#endif
+
+EXTERN_C_BEGIN
+
+/*
+	SLINEREADER
+
+	The structure used by the line reader functions. Its members are private.
+*/
+typedef struct slinereader
+{
+	HANDLE			hFile;
+	bool			bOwnHandle;								// True if we close hFile.
+	bool			bEOF;
+	char			*buf;
+	size_t			size;									// Allocated size of buf.
+	size_t			pos;									// Start of next line.
+	size_t			fill;									// Octets in buf.
+	uint64_t		nLine;									// Current line number.
+} SLINEREADER;
+
+/*
+	openLineReaderW
+
+	Opens the file wcFile for reading. If wcFile is "-" the line reader reads from
+	standard input instead.
+
+	The function returns true on success, false otherwise. Call GetLastError () for
+	more information.
+*/
+bool openLineReaderW (SLINEREADER *plr, const WCHAR *wcFile)
+;
+
+/*
+	nextLineU8
+
+	Returns the next line as a NUL-terminated string without its line ending, or NULL
+	if there are no more lines. The length of the line is stored at plen if plen is not
+	NULL. A UTF-8 BOM at the beginning of the first line is swallowed.
+
+	The returned pointer points into the buffer of the line reader and is only valid until
+	the next call to nextLineU8 () or closeLineReader (). The caller may modify the
+	characters of the line, for instance to tokenise it in place.
+*/
+char *nextLineU8 (SLINEREADER *plr, size_t *plen)
+;
+
+/*
+	lineLengthU8
+
+	Returns the offset of the first line feed within the len octets at p, or len if there
+	is none. On x64 16 octets are searched at once with SSE2.
+*/
+size_t lineLengthU8 (const char *p, size_t len)
+;
+
+/*
+	closeLineReader
+
+	Closes the file and deallocates the buffer of the line reader.
+*/
+void closeLineReader (SLINEREADER *plr)
+;
+
+EXTERN_C_END
+
+#endif														// Of #ifndef WINLINEREADER_H.
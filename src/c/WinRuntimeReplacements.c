@@ -11,6 +11,11 @@ History
 When		Who				What
 -----------------------------------------------------------------------------------------
 2024-04-08	Thomas			Created.
+2026-10-17	Thomas			SSE2 and word-at-a-time memcpyU (), memsetU (), and memcmpU ().
+2026-10-17	Thomas			SSE2 and SWAR string functions. isEqualW () and isEqualIgnoreCaseW ().
+2026-10-17	Thomas			Own UTF-16 to UTF-8 transcoder and back, with an SSE2 ASCII path.
+2026-10-17	Thomas			Numbers formatted and parsed 2 and 8 digits at a time. Hex with SWAR.
+2026-10-17	Thomas			Unaligned loads and stores through U_LOADU () and U_STOREU ().
 
 ****************************************************************************************/
 
@@ -51,6 +56,7 @@ When		Who				What
 */
 
 #include <Windows.h>
+#include <intrin.h>
 #include <stdint.h>
 #include "./WinRuntimeReplacements.h"
 
@@ -69,29 +75,303 @@ bool isNotDigitW (WCHAR wc)
 	return wc < L'0' || wc > L'9';
 }
 
+#define U_WORD_SIZ	(sizeof (size_t))
+#define U_WORD_MSK	(sizeof (size_t) - 1)
+
+/*
+	Unaligned loads and stores. UNALIGNED is empty for MSVC on x64, where the CPU handles
+	them. gcc and clang only allow them through __builtin_memcpy (), which they compile to
+	a single move.
+*/
+#ifdef __GNUC__
+	#define U_LOADU(t, p)		\
+		__extension__ ({ t u_; __builtin_memcpy (&u_, (p), sizeof (t)); u_; })
+	#define U_STOREU(t, p, v)	\
+		do { t u_ = (v); __builtin_memcpy ((p), &u_, sizeof (t)); } while (0)
+#else
+	#define U_LOADU(t, p)		(*(const UNALIGNED t *) (p))
+	#define U_STOREU(t, p, v)	(*(UNALIGNED t *) (p) = (v))
+#endif
+
+/*
+	The compiler turns loops that copy or set bytes into calls of memcpy () and memset (),
+	which we don't have. The SSE2 versions only loop over intrinsics, which are left alone,
+	and handle heads and tails without loops. The other versions copy words at a time if
+	both pointers have the same alignment, and are compiled without optimisation.
+
+	memcpyU () copies forwards, and every step loads before it stores. Buffers may therefore
+	overlap if dest is below src, which the line reader relies on.
+*/
+#ifdef U_WINRUNTIME_SSE2
+
 void *memcpyU (void *dest, const void *src, size_t len)
 {
-	char *d = dest;
-	const char *s = src;
+	unsigned char		*d	= dest;
+	const unsigned char	*s	= src;
+
+	if (len >= 16)
+	{
+		// Align the destination to 16 octets.
+		size_t h = (size_t) (0 - (uintptr_t) d) & 15;
+		len -= h;
+		if (h & 1)
+		{
+			*d = *s;
+			d += 1;
+			s += 1;
+		}
+		if (h & 2)
+		{
+			U_STOREU (uint16_t, d, U_LOADU (uint16_t, s));
+			d += 2;
+			s += 2;
+		}
+		if (h & 4)
+		{
+			U_STOREU (uint32_t, d, U_LOADU (uint32_t, s));
+			d += 4;
+			s += 4;
+		}
+		if (h & 8)
+		{
+			_mm_storel_epi64 ((__m128i *) d, _mm_loadl_epi64 ((const __m128i *) s));
+			d += 8;
+			s += 8;
+		}
+		while (len >= 64)
+		{
+			__m128i x0 = _mm_loadu_si128 ((const __m128i *) s);
+			__m128i x1 = _mm_loadu_si128 ((const __m128i *) (s + 16));
+			__m128i x2 = _mm_loadu_si128 ((const __m128i *) (s + 32));
+			__m128i x3 = _mm_loadu_si128 ((const __m128i *) (s + 48));
+			_mm_store_si128 ((__m128i *) d, x0);
+			_mm_store_si128 ((__m128i *) (d + 16), x1);
+			_mm_store_si128 ((__m128i *) (d + 32), x2);
+			_mm_store_si128 ((__m128i *) (d + 48), x3);
+			d	+= 64;
+			s	+= 64;
+			len	-= 64;
+		}
+		while (len >= 16)
+		{
+			_mm_store_si128 ((__m128i *) d, _mm_loadu_si128 ((const __m128i *) s));
+			d	+= 16;
+			s	+= 16;
+			len	-= 16;
+		}
+	}
+	if (len & 8)
+	{
+		_mm_storel_epi64 ((__m128i *) d, _mm_loadl_epi64 ((const __m128i *) s));
+		d += 8;
+		s += 8;
+	}
+	if (len & 4)
+	{
+		U_STOREU (uint32_t, d, U_LOADU (uint32_t, s));
+		d += 4;
+		s += 4;
+	}
+	if (len & 2)
+	{
+		U_STOREU (uint16_t, d, U_LOADU (uint16_t, s));
+		d += 2;
+		s += 2;
+	}
+	if (len & 1)
+		*d = *s;
+	return dest;
+}
+
+void *memsetU (void *dest, uint8_t ch, size_t len)
+{
+	unsigned char	*d	= dest;
+	__m128i			v	= _mm_set1_epi8 ((char) ch);
 
-	while (len--)
+	if (len >= 16)
+	{
+		// The unaligned stores at both ends overlap the aligned ones in between.
+		unsigned char *e = d + len - 16;
+		_mm_storeu_si128 ((__m128i *) d, v);
+		_mm_storeu_si128 ((__m128i *) e, v);
+		d = (unsigned char *) (((uintptr_t) d + 16) & ~(uintptr_t) 15);
+		while (d + 64 <= e)
+		{
+			_mm_store_si128 ((__m128i *) d, v);
+			_mm_store_si128 ((__m128i *) (d + 16), v);
+			_mm_store_si128 ((__m128i *) (d + 32), v);
+			_mm_store_si128 ((__m128i *) (d + 48), v);
+			d += 64;
+		}
+		while (d < e)
+		{
+			_mm_store_si128 ((__m128i *) d, v);
+			d += 16;
+		}
+	} else
+	if (len >= 8)
+	{
+		_mm_storel_epi64 ((__m128i *) d, v);
+		_mm_storel_epi64 ((__m128i *) (d + len - 8), v);
+	} else
+	if (len >= 4)
 	{
-		*d++ = *s++;
+		uint32_t ui = (uint32_t) _mm_cvtsi128_si32 (v);
+		U_STOREU (uint32_t, d, ui);
+		U_STOREU (uint32_t, d + len - 4, ui);
+	} else
+	if (len)
+	{
+		d [0]		= ch;
+		d [len / 2]	= ch;
+		d [len - 1]	= ch;
 	}
 	return dest;
 }
 
+/*
+	Returns the difference of the first octets that differ within the 16 octets at s1 and
+	s2, or 0 if they're equal.
+*/
+static int cmp16U (const unsigned char *s1, const unsigned char *s2)
+{
+	__m128i			a	= _mm_loadu_si128 ((const __m128i *) s1);
+	__m128i			b	= _mm_loadu_si128 ((const __m128i *) s2);
+	unsigned int	m	= (unsigned int) _mm_movemask_epi8 (_mm_cmpeq_epi8 (a, b)) ^ 0xFFFF;
+	unsigned long	i	= 0;
+
+	if (0 == m)
+		return 0;
+	_BitScanForward (&i, m);
+	return s1 [i] < s2 [i] ? -1 : 1;
+}
+
+int memcmpU (const void *str1, const void *str2, size_t count)
+{
+	const unsigned char	*s1	= str1;
+	const unsigned char	*s2	= str2;
+	int					r;
+
+	if (count >= 16)
+	{
+		// One test per 64 octets. The 16 octets that differ are found below.
+		while (count >= 64)
+		{
+			__m128i e0 = _mm_cmpeq_epi8	(
+							_mm_loadu_si128 ((const __m128i *) s1),
+							_mm_loadu_si128 ((const __m128i *) s2)
+										);
+			__m128i e1 = _mm_cmpeq_epi8	(
+							_mm_loadu_si128 ((const __m128i *) (s1 + 16)),
+							_mm_loadu_si128 ((const __m128i *) (s2 + 16))
+										);
+			__m128i e2 = _mm_cmpeq_epi8	(
+							_mm_loadu_si128 ((const __m128i *) (s1 + 32)),
+							_mm_loadu_si128 ((const __m128i *) (s2 + 32))
+										);
+			__m128i e3 = _mm_cmpeq_epi8	(
+							_mm_loadu_si128 ((const __m128i *) (s1 + 48)),
+							_mm_loadu_si128 ((const __m128i *) (s2 + 48))
+										);
+			e0 = _mm_and_si128 (_mm_and_si128 (e0, e1), _mm_and_si128 (e2, e3));
+			if (0xFFFF != _mm_movemask_epi8 (e0))
+				break;
+			s1		+= 64;
+			s2		+= 64;
+			count	-= 64;
+		}
+		while (count >= 16)
+		{
+			if ((r = cmp16U (s1, s2)))
+				return r;
+			s1		+= 16;
+			s2		+= 16;
+			count	-= 16;
+		}
+		// The last 16 octets overlap octets already found equal.
+		return count ? cmp16U (s1 + count - 16, s2 + count - 16) : 0;
+	}
+	if (count >= 8)
+	{
+		uint64_t a = U_LOADU (uint64_t, s1);
+		uint64_t b = U_LOADU (uint64_t, s2);
+		if (a != b)
+			count = 8;
+		else
+		{
+			s1		+= 8;
+			s2		+= 8;
+			count	-= 8;
+		}
+	}
+	while (count --)
+	{
+		if (*s1 ++ != *s2 ++)
+			return s1 [-1] < s2 [-1] ? -1 : 1;
+	}
+	return 0;
+}
+
+#else
+
+/*
+	Returns true if the word-aligned parts of d and s start at the same offset.
+*/
+static bool isCoAlignedU (const void *d, const void *s)
+{
+	return 0 == (((uintptr_t) d ^ (uintptr_t) s) & U_WORD_MSK);
+}
+
 #ifdef THIS_IS_ONOFFMATE
 	#pragma optimize ("", off)
 #endif
 
+void *memcpyU (void *dest, const void *src, size_t len)
+{
+	unsigned char		*d	= dest;
+	const unsigned char	*s	= src;
+
+	if (len >= 2 * U_WORD_SIZ && isCoAlignedU (d, s))
+	{
+		while ((uintptr_t) d & U_WORD_MSK)
+		{
+			*d ++ = *s ++;
+			-- len;
+		}
+		while (len >= U_WORD_SIZ)
+		{
+			*(size_t *) d = *(const size_t *) s;
+			d	+= U_WORD_SIZ;
+			s	+= U_WORD_SIZ;
+			len	-= U_WORD_SIZ;
+		}
+	}
+	while (len --)
+		*d ++ = *s ++;
+	return dest;
+}
+
 void *memsetU (void *dest, uint8_t ch, size_t len)
 {
-	char *d = dest;
-	while (len--)
+	unsigned char	*d	= dest;
+	size_t			w	= ((size_t) -1 / 0xFF) * ch;		// ch in every octet.
+
+	if (len >= 2 * U_WORD_SIZ)
 	{
-		*d++ = ch;
+		while ((uintptr_t) d & U_WORD_MSK)
+		{
+			*d ++ = ch;
+			-- len;
+		}
+		while (len >= U_WORD_SIZ)
+		{
+			*(size_t *) d = w;
+			d	+= U_WORD_SIZ;
+			len	-= U_WORD_SIZ;
+		}
 	}
+	while (len --)
+		*d ++ = ch;
 	return dest;
 }
 
@@ -101,52 +381,287 @@ void *memsetU (void *dest, uint8_t ch, size_t len)
 
 int memcmpU (const void *str1, const void *str2, size_t count)
 {
-	register const unsigned char *s1 = (const unsigned char*) str1;
-	register const unsigned char *s2 = (const unsigned char*) str2;
+	const unsigned char	*s1	= str1;
+	const unsigned char	*s2	= str2;
 
-	while (count-- > 0)
+	if (count >= 2 * U_WORD_SIZ && isCoAlignedU (s1, s2))
+	{
+		while ((uintptr_t) s1 & U_WORD_MSK)
+		{
+			if (*s1 ++ != *s2 ++)
+				return s1 [-1] < s2 [-1] ? -1 : 1;
+			-- count;
+		}
+		// The first word that differs is compared octet by octet below.
+		while (count >= U_WORD_SIZ && *(const size_t *) s1 == *(const size_t *) s2)
+		{
+			s1		+= U_WORD_SIZ;
+			s2		+= U_WORD_SIZ;
+			count	-= U_WORD_SIZ;
+		}
+	}
+	while (count --)
 	{
-		if (*s1++ != *s2++)
-			return s1[-1] < s2[-1] ? -1 : 1;
+		if (*s1 ++ != *s2 ++)
+			return s1 [-1] < s2 [-1] ? -1 : 1;
 	}
 	return 0;
 }
 
+#endif
+
+/*
+	Case folding only maps the ASCII letters a to z, like toupperW (). All other code units,
+	including the ones of surrogate pairs, compare as they are. The vectorised versions
+	therefore need no fallback for text that isn't ASCII.
+*/
+#ifdef U_WINRUNTIME_SSE2
+
+/*
+	Returns the 8 UTF-16 code units of x with a to z turned into A to Z. Code units from
+	0x8000 upwards are negative for the signed comparisons, hence they're left alone.
+*/
+static __m128i toupper8W (__m128i x)
+{
+	__m128i lower	= _mm_and_si128	(
+						_mm_cmpgt_epi16 (x, _mm_set1_epi16 (L'a' - 1)),
+						_mm_cmplt_epi16 (x, _mm_set1_epi16 (L'z' + 1))
+									);
+	return _mm_sub_epi16 (x, _mm_and_si128 (lower, _mm_set1_epi16 (0x20)));
+}
+
 int stricmpW (const unsigned short *wc1, const unsigned short *wc2, size_t count)
 {
-	register const unsigned short *s1 = wc1;
-	register const unsigned short *s2 = wc2;
+	while (count >= 8)
+	{
+		__m128i			a	= toupper8W (_mm_loadu_si128 ((const __m128i *) wc1));
+		__m128i			b	= toupper8W (_mm_loadu_si128 ((const __m128i *) wc2));
+		unsigned int	m	= (unsigned int) _mm_movemask_epi8 (_mm_cmpeq_epi16 (a, b)) ^ 0xFFFF;
+		if (m)
+		{
+			unsigned long i = 0;
+			_BitScanForward (&i, m);
+			i /= 2;
+			return toupperW (wc1 [i]) < toupperW (wc2 [i]) ? -1 : 1;
+		}
+		wc1		+= 8;
+		wc2		+= 8;
+		count	-= 8;
+	}
+	while (count --)
+	{
+		WCHAR c1 = toupperW (*wc1 ++);
+		WCHAR c2 = toupperW (*wc2 ++);
+		if (c1 != c2)
+			return c1 < c2 ? -1 : 1;
+	}
+	return 0;
+}
+
+/*
+	The loads are aligned to 16 octets. An aligned load never crosses a page boundary,
+	hence it can't fault, even if it reads beyond the terminating NUL. The octets before
+	the start of the string are masked out.
+*/
+size_t strlenW (const WCHAR *ch)
+{
+	const WCHAR		*p	= ch;
+	const __m128i	*pa;
+	__m128i			z	= _mm_setzero_si128 ();
+	unsigned int	m;
+	unsigned long	i;
+
+	// WCHARs are always aligned to 2 octets on Windows, but better safe than sorry.
+	if ((uintptr_t) p & 1)
+	{
+		while (*p)
+			++ p;
+		return (size_t) (p - ch);
+	}
+	pa	= (const __m128i *) ((uintptr_t) p & ~(uintptr_t) 15);
+	m	= (unsigned int) _mm_movemask_epi8 (_mm_cmpeq_epi16 (_mm_load_si128 (pa), z));
+	m	&= 0xFFFFu << ((uintptr_t) p & 15);
+	while (0 == m)
+		m = (unsigned int) _mm_movemask_epi8 (_mm_cmpeq_epi16 (_mm_load_si128 (++ pa), z));
+	_BitScanForward (&i, m);
+	return (size_t) ((const WCHAR *) ((const char *) pa + i) - ch);
+}
+
+size_t strlenU (const char *sz)
+{
+	const __m128i	*pa	= (const __m128i *) ((uintptr_t) sz & ~(uintptr_t) 15);
+	__m128i			z	= _mm_setzero_si128 ();
+	unsigned int	m;
+	unsigned long	i;
+
+	m	= (unsigned int) _mm_movemask_epi8 (_mm_cmpeq_epi8 (_mm_load_si128 (pa), z));
+	m	&= 0xFFFFu << ((uintptr_t) sz & 15);
+	while (0 == m)
+		m = (unsigned int) _mm_movemask_epi8 (_mm_cmpeq_epi8 (_mm_load_si128 (++ pa), z));
+	_BitScanForward (&i, m);
+	return (size_t) ((const char *) pa + i - sz);
+}
+
+/*
+	A single pass that looks for wc and the terminating NUL at the same time, 8 code units
+	per step. Matches after the NUL are dropped.
+*/
+WCHAR *strrchrW (WCHAR *pwc, WCHAR wc)
+{
+	const __m128i	*pa;
+	__m128i			z		= _mm_setzero_si128 ();
+	__m128i			c		= _mm_set1_epi16 ((short) wc);
+	WCHAR			*pLast	= NULL;
+	unsigned int	skip;
 
-	while (count-- > 0)
+	if (L'\0' == wc)
+		return NULL;
+	if ((uintptr_t) pwc & 1)
+	{
+		for (; *pwc; ++ pwc)
+		{
+			if (wc == *pwc)
+				pLast = pwc;
+		}
+		return pLast;
+	}
+	pa		= (const __m128i *) ((uintptr_t) pwc & ~(uintptr_t) 15);
+	skip	= 0xFFFFu << ((uintptr_t) pwc & 15);
+	for (;; ++ pa)
 	{
-		if (toupperW (*s1++) != toupperW (*s2++))
-			return toupperW (s1[-1]) < toupperW (s2[-1]) ? -1 : 1;
+		__m128i			x	= _mm_load_si128 (pa);
+		unsigned int	mz	= (unsigned int) _mm_movemask_epi8 (_mm_cmpeq_epi16 (x, z)) & skip;
+		unsigned int	mc	= (unsigned int) _mm_movemask_epi8 (_mm_cmpeq_epi16 (x, c)) & skip;
+		unsigned long	i;
+
+		skip = 0xFFFF;
+		if (mz)
+		{
+			// Only the bits below the first NUL.
+			mc &= (mz & (0 - mz)) - 1;
+		}
+		if (mc && _BitScanReverse (&i, mc))
+			pLast = (WCHAR *) ((char *) pa + (i & ~1ul));
+		if (mz)
+			return pLast;
+	}
+}
+
+/*
+	Returns how many loads of 16 octets, starting at p, stay within the page of p.
+*/
+static size_t nLoads16inPage (const void *p)
+{
+	return (4096 - ((uintptr_t) p & 4095)) / 16;
+}
+
+/*
+	Compares the NUL-terminated strings wc1 and wc2 in a single pass, 8 code units per
+	step. The unaligned loads might run over the terminating NUL, which is why they must
+	not touch the next page. The last few code units of a page are compared one at a time.
+*/
+static bool isEqualWcore (const WCHAR *wc1, const WCHAR *wc2, bool bIgnoreCase)
+{
+	__m128i z = _mm_setzero_si128 ();
+
+	for (;;)
+	{
+		size_t n1	= nLoads16inPage (wc1);
+		size_t n2	= nLoads16inPage (wc2);
+		size_t n	= n1 < n2 ? n1 : n2;
+
+		while (n --)
+		{
+			__m128i			a	= _mm_loadu_si128 ((const __m128i *) wc1);
+			__m128i			b	= _mm_loadu_si128 ((const __m128i *) wc2);
+			unsigned int	mz	= (unsigned int) _mm_movemask_epi8 (_mm_cmpeq_epi16 (a, z));
+			unsigned int	mn;
+
+			if (bIgnoreCase)
+			{
+				a = toupper8W (a);
+				b = toupper8W (b);
+			}
+			mn = (unsigned int) _mm_movemask_epi8 (_mm_cmpeq_epi16 (a, b)) ^ 0xFFFF;
+			if (mz | mn)
+			{
+				// The first code unit that differs or ends wc1 decides.
+				unsigned long i;
+				_BitScanForward (&i, mz | mn);
+				return 0 == (mn & (1u << i));
+			}
+			wc1 += 8;
+			wc2 += 8;
+		}
+		WCHAR c1 = bIgnoreCase ? toupperW (*wc1) : *wc1;
+		WCHAR c2 = bIgnoreCase ? toupperW (*wc2) : *wc2;
+		if (c1 != c2)
+			return false;
+		if (L'\0' == c1)
+			return true;
+		++ wc1;
+		++ wc2;
+	}
+}
+
+#else
+
+int stricmpW (const unsigned short *wc1, const unsigned short *wc2, size_t count)
+{
+	while (count --)
+	{
+		WCHAR c1 = toupperW (*wc1 ++);
+		WCHAR c2 = toupperW (*wc2 ++);
+		if (c1 != c2)
+			return c1 < c2 ? -1 : 1;
 	}
 	return 0;
 }
 
+/*
+	SWAR: a code unit or octet of the aligned word w is 0 if (w - lo) & ~w & hi is not 0.
+	The aligned words never cross a page boundary.
+*/
+#define U_SWAR_LO8	((size_t) -1 / 0xFF)
+#define U_SWAR_HI8	(U_SWAR_LO8 << 7)
+#define U_SWAR_LO16	((size_t) -1 / 0xFFFF)
+#define U_SWAR_HI16	(U_SWAR_LO16 << 15)
+
 size_t strlenW (const WCHAR *ch)
 {
-	size_t	dwLen = 0;
+	const WCHAR *p = ch;
 
-	while (*ch)
+	if (0 == ((uintptr_t) p & 1))
 	{
-		++ ch;
-		++ dwLen;
+		while ((uintptr_t) p & U_WORD_MSK)
+		{
+			if (L'\0' == *p)
+				return (size_t) (p - ch);
+			++ p;
+		}
+		while (0 == ((*(const size_t *) p - U_SWAR_LO16) & ~*(const size_t *) p & U_SWAR_HI16))
+			p += U_WORD_SIZ / sizeof (WCHAR);
 	}
-	return dwLen;
+	while (*p)
+		++ p;
+	return (size_t) (p - ch);
 }
 
 size_t strlenU (const char *sz)
 {
-	size_t	dwLen = 0;
+	const char *p = sz;
 
-	while (*sz)
+	while ((uintptr_t) p & U_WORD_MSK)
 	{
-		++ sz;
-		++ dwLen;
+		if ('\0' == *p)
+			return (size_t) (p - sz);
+		++ p;
 	}
-	return dwLen;
+	while (0 == ((*(const size_t *) p - U_SWAR_LO8) & ~*(const size_t *) p & U_SWAR_HI8))
+		p += U_WORD_SIZ;
+	while (*p)
+		++ p;
+	return (size_t) (p - sz);
 }
 
 WCHAR *strrchrW (WCHAR *pwc, WCHAR wc)
@@ -164,6 +679,33 @@ WCHAR *strrchrW (WCHAR *pwc, WCHAR wc)
 	}
 	return NULL;
 }
+
+static bool isEqualWcore (const WCHAR *wc1, const WCHAR *wc2, bool bIgnoreCase)
+{
+	for (;;)
+	{
+		WCHAR c1 = bIgnoreCase ? toupperW (*wc1) : *wc1;
+		WCHAR c2 = bIgnoreCase ? toupperW (*wc2) : *wc2;
+		if (c1 != c2)
+			return false;
+		if (L'\0' == c1)
+			return true;
+		++ wc1;
+		++ wc2;
+	}
+}
+
+#endif
+
+bool isEqualW (const WCHAR *wc1, const WCHAR *wc2)
+{
+	return isEqualWcore (wc1, wc2, false);
+}
+
+bool isEqualIgnoreCaseW (const WCHAR *wc1, const WCHAR *wc2)
+{
+	return isEqualWcore (wc1, wc2, true);
+}
 /*
 	See
 	https://docs.microsoft.com/en-us/cpp/c-runtime-library/reference/strrchr-wcsrchr-mbsrchr-mbsrchr-l?view=msvc-170 .
@@ -201,92 +743,355 @@ size_t nTrailingWhiteSpaceW (WCHAR *pwc)
 	return r;
 }
 
+/*
+	SWAR helpers for 4 UTF-16 code units in a 64 bit word. Bit 8 of every lane is set
+	before a subtraction so that a borrow never reaches the next lane.
+*/
+#define U_LANES16(x)	((uint64_t) (x) * 0x0001000100010001)
+
+static inline uint64_t loadW4 (const WCHAR *pw)
+{
+	return U_LOADU (uint64_t, pw);
+}
+
+#ifdef U_WINRUNTIME_SSE2
+
+/*
+	Returns the value of the digits at the start of the 8 code units at pw, and their
+	amount at *pk. Only the first *pk digits are kept, which gives their value multiplied
+	by 10^(8 - *pk). Pairs and then quadruples of digits are combined with madd.
+*/
+static inline uint32_t leadingDigitsW8 (const WCHAR *pw, size_t *pk)
+{
+	__m128i			d	= _mm_sub_epi16	(
+								_mm_loadu_si128 ((const __m128i *) pw),
+								_mm_set1_epi16 ('0')
+										);
+	__m128i			z	= _mm_setzero_si128 ();
+	unsigned		m;
+	unsigned long	i	= 16;
+	size_t			k;
+
+	// Digits are the only code units that don't exceed 9 after the subtraction.
+	m = ~_mm_movemask_epi8 (_mm_cmpeq_epi16 (_mm_subs_epu16 (d, _mm_set1_epi16 (9)), z));
+	_BitScanForward (&i, m | 0x10000);
+	k = i / 2;
+	d = _mm_and_si128 (d, _mm_cmpgt_epi16 (_mm_set1_epi16 ((short) k), _mm_setr_epi16 (0, 1, 2, 3, 4, 5, 6, 7)));
+	d = _mm_madd_epi16 (d, _mm_setr_epi16 (10, 1, 10, 1, 10, 1, 10, 1));
+	d = _mm_packs_epi32 (d, d);
+	d = _mm_madd_epi16 (d, _mm_setr_epi16 (100, 1, 100, 1, 100, 1, 100, 1));
+	*pk = k;
+	return		(uint32_t) _mm_cvtsi128_si32 (d) * 10000
+			+	(uint32_t) _mm_cvtsi128_si32 (_mm_srli_si128 (d, 4));
+}
+
+#else
+
+/*
+	Returns bit 7 set in every lane of w that is not one of the digits '0' to '9'. Lanes
+	with bits above bit 6 are caught separately, so that no addition overflows a lane.
+*/
+static inline uint64_t nonDigitsW4 (uint64_t w)
+{
+	uint64_t	b	= w & U_LANES16 (0x007F);
+	uint64_t	h	= (((w & U_LANES16 (0xFF80)) >> 1) + U_LANES16 (0x7FC0)) >> 8;
+
+	return		~(		(b + U_LANES16 (0x80 - '0'))
+					&	~(b + U_LANES16 (0x80 - '9' - 1))
+					&	~h
+				)
+			&	U_LANES16 (0x0080);
+}
+
+/*
+	Returns the index of the lowest lane flagged in nd, which must not be 0. The isolated
+	flag selects the lane of the constant that holds the index.
+*/
+static inline size_t lowestLaneW4 (uint64_t nd)
+{
+	return (size_t) ((((nd & (0 - nd)) >> 7) * 0x0000000100020003) >> 48);
+}
+
+/*
+	Like the SSE2 version. The 8 code units are packed into the 8 octets of a word, which
+	are combined to pairs, quadruples, and finally to all 8 digits.
+*/
+static inline uint32_t leadingDigitsW8 (const WCHAR *pw, size_t *pk)
+{
+	uint64_t	w0		= loadW4 (pw);
+	uint64_t	w1		= loadW4 (pw + 4);
+	uint64_t	nd0		= nonDigitsW4 (w0);
+	uint64_t	nd1		= nonDigitsW4 (w1);
+	uint64_t	m;
+	uint64_t	v;
+	size_t		k;
+
+	if (nd0)
+	{
+		k	= lowestLaneW4 (nd0);
+		m	= ((uint64_t) 1 << (16 * k)) - 1;
+		w0	= (w0 & m) | (U_LANES16 ('0') & ~m);
+		w1	= U_LANES16 ('0');
+	} else
+	if (nd1)
+	{
+		k	= 4 + lowestLaneW4 (nd1);
+		m	= ((uint64_t) 1 << (16 * (k - 4))) - 1;
+		w1	= (w1 & m) | (U_LANES16 ('0') & ~m);
+	} else
+		k	= 8;
+	*pk = k;
+	w0 -= U_LANES16 ('0');
+	w1 -= U_LANES16 ('0');
+	w0 = (w0 | w0 >> 8) & 0x0000FFFF0000FFFF;
+	w1 = (w1 | w1 >> 8) & 0x0000FFFF0000FFFF;
+	v = ((w0 | w0 >> 16) & 0xFFFFFFFF) | ((w1 | w1 >> 16) << 32);
+	v = (v * 10 + (v >> 8)) & 0x00FF00FF00FF00FF;
+	v = (v * 100 + (v >> 16)) & 0x0000FFFF0000FFFF;
+	return (uint32_t) (v * 10000 + (v >> 32));
+}
+
+#endif
+
+/*
+	Powers of 10, and UINT64_MAX divided by them and the remainders. A value u can be
+	multiplied by 10^k and get d added if u is below uiMaxDiv10 [k], or equal to it and
+	d is not greater than uiMaxMod10 [k].
+*/
+static const uint64_t	uiPow10 [20]	=
+{
+	1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000,
+	10000000000, 100000000000, 1000000000000, 10000000000000, 100000000000000,
+	1000000000000000, 10000000000000000, 100000000000000000, 1000000000000000000,
+	10000000000000000000u
+};
+static const uint64_t	uiMaxDiv10 [9]	=
+{
+	UINT64_MAX, 1844674407370955161, 184467440737095516, 18446744073709551,
+	1844674407370955, 184467440737095, 18446744073709, 1844674407370, 184467440737
+};
+static const uint32_t	uiMaxMod10 [9]	=
+{
+	0, 5, 15, 615, 1615, 51615, 551615, 9551615, 9551615
+};
+
+/*
+	The multiplicative inverses of 5^j modulo 2^32. A multiple of 10^j is divided by it
+	exactly with a shift by j and a multiplication by the inverse of 5^j.
+*/
+static const uint32_t	uiInv5 [9]		=
+{
+	0x00000001, 0xCCCCCCCD, 0xC28F5C29, 0x26E978D5, 0x3AFB7E91,
+	0x0BCBE61D, 0x68C26139, 0xAE8D46A5, 0x22E90E21
+};
+
+/*
+	The first 4 digits, which can't overflow, are read one at a time. Then every step reads
+	8 code units. If only the first k of them are digits, the others are replaced by '0',
+	which gives the value of the k digits multiplied by 10^(8 - k). Digits close to the
+	end of a page are read one at a time.
+*/
 bool ubf_uint64_from_strW (uint64_t * ui, const WCHAR *wcStr)
 {
 	uint64_t		u		= 0;
 	const WCHAR		*ch;
-	WCHAR			c;
+	uint32_t		d;
+	size_t			k;
 
 	ch = (const WCHAR *) wcStr;
 	if (ch)
 	{
-		c = *ch;
-		if (L'+' == c)
-		{
+		if (L'+' == *ch)
 			ch ++;
-			c = *ch;
+		for (k = 0; k < 4; ++ k, ++ ch)
+		{
+			if (!isDigitW (*ch))
+				goto done;
+			u = u * 10 + (uint64_t) (*ch - L'0');
 		}
-		while (c)
+		while (isDigitW (*ch) && ((uintptr_t) ch & 4095) <= 4096 - 16)
 		{
-			if (isNotDigitW (c))
-				break;
-			c -= L'0';
-			if (u > UINT64_MAX / 10)
+			d = leadingDigitsW8 (ch, &k);
+			d = (d >> (8 - k)) * uiInv5 [8 - k];
+			if (u > uiMaxDiv10 [k] || (uiMaxDiv10 [k] == u && d > uiMaxMod10 [k]))
 				return FALSE;
-			u *= 10;
-			if (u > UINT64_MAX - c)
+			u = u * uiPow10 [k] + d;
+			if (k < 8)
+				goto done;
+			ch += 8;
+		}
+		while (isDigitW (*ch))
+		{
+			d = (uint32_t) (*ch - L'0');
+			if (u > uiMaxDiv10 [1] || (uiMaxDiv10 [1] == u && d > uiMaxMod10 [1]))
 				return FALSE;
-			u += c;
+			u = u * 10 + d;
 			ch ++;
-			c = *ch;
 		}
 	}
+done:
 	if (ui)
 		*ui = u;
 	return TRUE;
 }
 
 /*
-	See http://www.strudel.org.uk/itoa/ .
-	2018-04-09, Thomas.
+	The decimal digits of all values from 0 to 99, two characters each.
 */
-/**
- * C++ version 0.4 char* style "itoa":
- * Written by Lukas Chmela
- * Released under GPLv3.
+static const char	ccDigitPairs [201]	=
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
 
- */
+/*
+	The amount of bits gives an estimate of the amount of digits that is at most 1 too
+	low. 1233 / 4096 is slightly above log10 (2).
+*/
+static inline size_t nDigitsUint64 (uint64_t ui)
+{
+	unsigned long	b;
+	size_t			n;
 
-WCHAR	wc_ito_alphabet []	=
-		L"zyxwvutsrqponmlkjihgfedcba9876543210123456789abcdefghijklmnopqrstuvwxyz";
+	if (ui >> 32)
+	{
+		_BitScanReverse (&b, (unsigned long) (ui >> 32));
+		b += 32;
+	} else
+		_BitScanReverse (&b, (unsigned long) ui | 1);
+	n = ((b + 1) * 1233) >> 12;
+	return n + ((ui | 1) >= uiPow10 [n]);
+}
 
+/*
+	Stores the two digits of i, which is below 100, at pw.
+*/
+static inline void digitPairW (WCHAR *pw, uint32_t i)
+{
+	U_STOREU	(
+					uint32_t, pw,
+						(uint32_t) ccDigitPairs [2 * i]
+					|	(uint32_t) ccDigitPairs [2 * i + 1] << 16
+				);
+}
+
+/*
+	The digits are written from the end of the string backwards, two per step. Values
+	above 32 bits are split into parts of 8 digits first, so that only the divisions by
+	10^8 need 64 bit arithmetic.
+*/
 size_t wstr_from_uint64 (WCHAR* result, uint64_t ui64)
 {
-	WCHAR*		ptr			= result, *ptr1 = result, tmp_char;
-	uint64_t	tmp_value;
-	WCHAR		*r;
+	size_t		len		= nDigitsUint64 (ui64);
+	WCHAR		*pw		= result + len;
+	uint32_t	ui;
 
-	do {
-		tmp_value = ui64;
-		ui64 /= 10;
-		*ptr++ = wc_ito_alphabet [35 + (tmp_value - ui64 * 10)];
-	} while (ui64);
-	r = ptr;
-	*ptr-- = L'\0';
-	while(ptr1 < ptr) {
-		tmp_char = *ptr;
-		*ptr--= *ptr1;
-		*ptr1++ = tmp_char;
+	*pw = L'\0';
+	while (ui64 > UINT32_MAX)
+	{
+		ui		= (uint32_t) (ui64 % 100000000);
+		ui64	/= 100000000;
+		digitPairW (pw - 2, ui % 100);
+		ui /= 100;
+		digitPairW (pw - 4, ui % 100);
+		ui /= 100;
+		digitPairW (pw - 6, ui % 100);
+		digitPairW (pw - 8, ui / 100);
+		pw -= 8;
+	}
+	ui = (uint32_t) ui64;
+	while (ui >= 100)
+	{
+		pw -= 2;
+		digitPairW (pw, ui % 100);
+		ui /= 100;
 	}
-	return ((size_t) (r - result));
+	if (ui >= 10)
+		digitPairW (pw - 2, ui);
+	else
+		pw [-1] = (WCHAR) (L'0' + ui);
+	return len;
 }
 
-// Used by the hex conversion functions. No NUL-terminator is stored.
-//DISABLE_WARNING_ARRAY_TOO_SMALL_FOR_NUL_TERMINATOR ()
-static char				hexASCIIu [16]		= "0123456789ABCDEF";
-static char				hexASCIIl [16]		= "0123456789abcdef";
-//DEFAULT_WARNING_ARRAY_TOO_SMALL_FOR_NUL_TERMINATOR ()
+/*
+	Returns the 8 uppercase hexadecimal digits of ui in the 8 octets of a word. The
+	lowest nibble ends up in the lowest octet.
+*/
+static inline uint64_t hexDigits8 (uint32_t ui)
+{
+	uint64_t	x	= ui;
+	uint64_t	m;
+
+	x = (x | x << 16) & 0x0000FFFF0000FFFF;
+	x = (x | x << 8) & 0x00FF00FF00FF00FF;
+	x = (x | x << 4) & 0x0F0F0F0F0F0F0F0F;
+	// 1 in every octet with a value from 10 upwards, which skips 7 characters to 'A'.
+	m = ((x + 0x0606060606060606) >> 4) & 0x0101010101010101;
+	return x + 0x3030303030303030 + m * ('A' - '9' - 1);
+}
 
 void asc_hex_from_dword_W (WCHAR *pc, uint32_t ui)
 {
-	*pc ++	= hexASCIIu [((ui & 0xF0000000) >> 28) & 0x0F];
-	*pc ++	= hexASCIIu [((ui & 0x0F000000) >> 24) & 0x0F];
-	*pc ++	= hexASCIIu [((ui & 0x00F00000) >> 20) & 0x0F];
-	*pc ++	= hexASCIIu [((ui & 0x000F0000) >> 16) & 0x0F];
-	*pc ++	= hexASCIIu [((ui & 0x0000F000) >> 12) & 0x0F];
-	*pc ++	= hexASCIIu [((ui & 0x00000F00) >>  8) & 0x0F];
-	*pc ++	= hexASCIIu [((ui & 0x000000F0) >>  4) & 0x0F];
-	*pc		= hexASCIIu [((ui & 0x0000000F))];
+	uint64_t	x	= hexDigits8 (ui);
+
+	#ifdef U_WINRUNTIME_SSE2
+		// Widen to UTF-16 and reverse the order of the 8 code units.
+		__m128i v = _mm_unpacklo_epi8 (_mm_loadl_epi64 ((const __m128i *) &x), _mm_setzero_si128 ());
+		v = _mm_shufflelo_epi16 (v, _MM_SHUFFLE (0, 1, 2, 3));
+		v = _mm_shufflehi_epi16 (v, _MM_SHUFFLE (0, 1, 2, 3));
+		v = _mm_shuffle_epi32 (v, _MM_SHUFFLE (1, 0, 3, 2));
+		_mm_storeu_si128 ((__m128i *) pc, v);
+	#else
+		int n;
+
+		for (n = 7; n >= 0; -- n)
+		{
+			pc [n] = (WCHAR) (x & 0xFF);
+			x >>= 8;
+		}
+	#endif
+}
+
+/*
+	Returns the values of the 4 hexadecimal digits in w, one per lane, or UINT64_MAX if
+	one of them isn't a hexadecimal digit. Bit 7 of a lane flags a successful range check.
+	The letters have bit 6 set, and their low nibble is 9 below their value.
+*/
+static inline uint64_t valueHexW4 (uint64_t w)
+{
+	uint64_t	l	= w | U_LANES16 (0x20);
+	uint64_t	dig;
+	uint64_t	alp;
+
+	if (w & U_LANES16 (0xFF80))
+		return UINT64_MAX;
+	dig =		(((w | U_LANES16 (0x0100)) - U_LANES16 ('0')) >> 1)
+			&	~(w + U_LANES16 (0x80 - '9' - 1));
+	alp =		(((l | U_LANES16 (0x0100)) - U_LANES16 ('a')) >> 1)
+			&	~(l + U_LANES16 (0x80 - 'f' - 1));
+	if (U_LANES16 (0x0080) != ((dig | alp) & U_LANES16 (0x0080)))
+		return UINT64_MAX;
+	return (w & U_LANES16 (0x000F)) + ((w >> 6) & U_LANES16 (0x0001)) * 9;
+}
+
+bool dword_from_asc_hex_W (uint32_t *pui, const WCHAR *pc)
+{
+	uint64_t	v0	= valueHexW4 (loadW4 (pc));
+	uint64_t	v1	= valueHexW4 (loadW4 (pc + 4));
+
+	if (UINT64_MAX == v0 || UINT64_MAX == v1)
+		return false;
+	// The first digit is in the lowest lane and the most significant one.
+	v0 = (v0 & 0xF) << 12 | (v0 >> 16 & 0xF) << 8 | (v0 >> 32 & 0xF) << 4 | v0 >> 48;
+	v1 = (v1 & 0xF) << 12 | (v1 >> 16 & 0xF) << 8 | (v1 >> 32 & 0xF) << 4 | v1 >> 48;
+	*pui = (uint32_t) (v0 << 16 | v1);
+	return true;
 }
 
 /*
@@ -317,17 +1122,258 @@ size_t ubf_octet_from_hex (unsigned char *o, const char *chHx)
 	return 2;
 }
 
+/*
+	UTF-16 to UTF-8 and back. Both converters size and convert in the same pass: they store
+	complete characters while there's space left, and only count from the first character
+	that doesn't fit. With SSE2, runs of ASCII are converted 16 characters per step. After
+	a block that contains other characters, the converters continue one character at a time
+	until the end of that block.
+*/
+#define U_UNI_REPLACEMENT	(0xFFFD)
+
+size_t UTF8_from_U16 (char *chU8, size_t sizU8, const WCHAR *wcU16, size_t lenU16, bool *pbValid)
+{
+	unsigned char	*po		= (unsigned char *) chU8;
+	unsigned char	*pz		= po ? po + sizU8 : po;
+	const WCHAR		*pw		= wcU16;
+	const WCHAR		*pe;
+	const WCHAR		*pb;
+	size_t			nOver	= 0;							// Octets that didn't fit.
+	bool			bValid	= true;
+	uint32_t		cp;
+	size_t			n;
+
+	if (USE_STRLEN == lenU16)
+		lenU16 = strlenW (wcU16) + 1;
+	pe = pw + lenU16;
+	while (pw < pe)
+	{
+		#ifdef U_WINRUNTIME_SSE2
+			__m128i z	= _mm_setzero_si128 ();
+			__m128i m	= _mm_set1_epi16 ((short) 0xFF80);
+
+			while (pe - pw >= 16)
+			{
+				__m128i x0 = _mm_loadu_si128 ((const __m128i *) pw);
+				__m128i x1 = _mm_loadu_si128 ((const __m128i *) (pw + 8));
+				__m128i a  = _mm_and_si128 (_mm_or_si128 (x0, x1), m);
+				if (0xFFFF != _mm_movemask_epi8 (_mm_cmpeq_epi16 (a, z)))
+					break;
+				if (pz - po >= 16)
+				{
+					_mm_storeu_si128 ((__m128i *) po, _mm_packus_epi16 (x0, x1));
+					po += 16;
+				} else
+				if (pz == po)
+					nOver += 16;
+				else
+					break;
+				pw += 16;
+			}
+			pb = pe - pw > 16 ? pw + 16 : pe;
+		#else
+			pb = pe;
+		#endif
+		while (pw < pb)
+		{
+			cp = *pw ++;
+			if (cp < 0x80)
+				n = 1;
+			else
+			if (cp < 0x800)
+				n = 2;
+			else
+			if (cp < 0xD800 || cp > 0xDFFF)
+				n = 3;
+			else
+			if (cp <= 0xDBFF && pw < pe && *pw >= 0xDC00 && *pw <= 0xDFFF)
+			{
+				cp = 0x10000 + ((cp - 0xD800) << 10) + (*pw ++ - 0xDC00);
+				n = 4;
+			} else
+			{	// Unpaired surrogate.
+				cp		= U_UNI_REPLACEMENT;
+				n		= 3;
+				bValid	= false;
+			}
+			if ((size_t) (pz - po) < n)
+			{
+				pz		= po;
+				nOver	+= n;
+				continue;
+			}
+			switch (n)
+			{
+				case 1:
+					po [0] = (unsigned char) cp;
+					break;
+				case 2:
+					po [0] = (unsigned char) (0xC0 | (cp >> 6));
+					po [1] = (unsigned char) (0x80 | (cp & 0x3F));
+					break;
+				case 3:
+					po [0] = (unsigned char) (0xE0 | (cp >> 12));
+					po [1] = (unsigned char) (0x80 | ((cp >> 6) & 0x3F));
+					po [2] = (unsigned char) (0x80 | (cp & 0x3F));
+					break;
+				default:
+					po [0] = (unsigned char) (0xF0 | (cp >> 18));
+					po [1] = (unsigned char) (0x80 | ((cp >> 12) & 0x3F));
+					po [2] = (unsigned char) (0x80 | ((cp >> 6) & 0x3F));
+					po [3] = (unsigned char) (0x80 | (cp & 0x3F));
+					break;
+			}
+			po += n;
+		}
+	}
+	if (pbValid)
+		*pbValid = bValid;
+	return (size_t) (po - (unsigned char *) chU8) + nOver;
+}
+
+/*
+	Decodes the UTF-8 sequence that starts with the lead octet c. The continuation octets
+	start at *ppc. Overlong forms, surrogates, and code points above U+10FFFF are invalid.
+	An invalid sequence is replaced by a single U+FFFD, and *ppc is moved behind its valid
+	part, which is at least the lead octet.
+*/
+static uint32_t cpFromUTF8 (const unsigned char **ppc, const unsigned char *pe, unsigned char c, bool *pbValid)
+{
+	const unsigned char	*pc	= *ppc;
+	unsigned char		lo	= 0x80;
+	unsigned char		hi	= 0xBF;
+	uint32_t			cp;
+	int					nc;								// Continuation octets.
+
+	if (c >= 0xC2 && c <= 0xDF)
+	{
+		nc = 1;
+		cp = c & 0x1F;
+	} else
+	if (c >= 0xE0 && c <= 0xEF)
+	{
+		nc = 2;
+		cp = c & 0x0F;
+		if (0xE0 == c)
+			lo = 0xA0;
+		if (0xED == c)
+			hi = 0x9F;
+	} else
+	if (c >= 0xF0 && c <= 0xF4)
+	{
+		nc = 3;
+		cp = c & 0x07;
+		if (0xF0 == c)
+			lo = 0x90;
+		if (0xF4 == c)
+			hi = 0x8F;
+	} else
+		goto invalid;
+	// Only the first continuation octet has a narrower range.
+	for (; nc; -- nc)
+	{
+		if (pc == pe || *pc < lo || *pc > hi)
+			goto invalid;
+		cp = (cp << 6) | (*pc ++ & 0x3F);
+		lo = 0x80;
+		hi = 0xBF;
+	}
+	*ppc = pc;
+	return cp;
+invalid:
+	*ppc		= pc;
+	*pbValid	= false;
+	return U_UNI_REPLACEMENT;
+}
+
+size_t U16_from_UTF8 (WCHAR *wcU16, size_t sizU16, const char *chU8, size_t lenU8, bool *pbValid)
+{
+	WCHAR				*po		= wcU16;
+	WCHAR				*pz		= po ? po + sizU16 : po;
+	const unsigned char	*pc		= (const unsigned char *) chU8;
+	const unsigned char	*pe;
+	const unsigned char	*pb;
+	size_t				nOver	= 0;						// Code units that didn't fit.
+	bool				bValid	= true;
+	uint32_t			cp;
+	size_t				n;
+
+	if (USE_STRLEN == lenU8)
+		lenU8 = strlenU (chU8) + 1;
+	pe = pc + lenU8;
+	while (pc < pe)
+	{
+		#ifdef U_WINRUNTIME_SSE2
+			__m128i z	= _mm_setzero_si128 ();
+
+			while (pe - pc >= 16)
+			{
+				__m128i x = _mm_loadu_si128 ((const __m128i *) pc);
+				if (_mm_movemask_epi8 (x))
+					break;
+				if (pz - po >= 16)
+				{
+					_mm_storeu_si128 ((__m128i *) po, _mm_unpacklo_epi8 (x, z));
+					_mm_storeu_si128 ((__m128i *) (po + 8), _mm_unpackhi_epi8 (x, z));
+					po += 16;
+				} else
+				if (pz == po)
+					nOver += 16;
+				else
+					break;
+				pc += 16;
+			}
+			pb = pe - pc > 16 ? pc + 16 : pe;
+		#else
+			pb = pe;
+		#endif
+		while (pc < pb)
+		{
+			cp = *pc ++;
+			if (cp >= 0x80)
+				cp = cpFromUTF8 (&pc, pe, (unsigned char) cp, &bValid);
+			n = cp < 0x10000 ? 1 : 2;
+			if ((size_t) (pz - po) < n)
+			{
+				pz		= po;
+				nOver	+= n;
+				continue;
+			}
+			if (1 == n)
+			{
+				po [0] = (WCHAR) cp;
+			} else
+			{
+				cp -= 0x10000;
+				po [0] = (WCHAR) (0xD800 + (cp >> 10));
+				po [1] = (WCHAR) (0xDC00 + (cp & 0x3FF));
+			}
+			po += n;
+		}
+	}
+	if (pbValid)
+		*pbValid = bValid;
+	return (size_t) (po - wcU16) + nOver;
+}
+
 int reqUTF8size (const WCHAR *wcU16)
 {
-	return WideCharToMultiByte (CP_UTF8, 0, wcU16, -1, NULL, 0, NULL, NULL);
+	return (int) UTF8_from_U16 (NULL, 0, wcU16, USE_STRLEN, NULL);
 }
 
 int UTF8_from_WinU16 (char *chU8, int sizeU8, const WCHAR *wcU16)
 {
-	return WideCharToMultiByte (CP_UTF8, 0, wcU16, -1, chU8, sizeU8, NULL, NULL);
+	return UTF8_from_WinU16l (chU8, sizeU8, wcU16, -1);
 }
 
 int UTF8_from_WinU16l (char *chU8, int sizeU8, const WCHAR *wcU16, int lenU16)
 {
-	return WideCharToMultiByte (CP_UTF8, 0, wcU16, lenU16, chU8, sizeU8, NULL, NULL);
+	size_t	len		= lenU16 < 0 ? USE_STRLEN : (size_t) lenU16;
+	size_t	n		= UTF8_from_U16 (sizeU8 > 0 ? chU8 : NULL, sizeU8 > 0 ? (size_t) sizeU8 : 0, wcU16, len, NULL);
+
+	if (sizeU8 <= 0 || n <= (size_t) sizeU8)
+		return (int) n;
+	if (lenU16 < 0)
+		chU8 [0] = '\0';
+	return 0;
 }
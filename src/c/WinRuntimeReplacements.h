@@ -11,6 +11,11 @@ History
 When		Who				What
 -----------------------------------------------------------------------------------------
 2024-04-08	Thomas			Created.
+2026-10-17	Thomas			memcpyU (), memsetU (), and memcmpU () use SSE2 on x64.
+2026-10-17	Thomas			String functions use SSE2 on x64. isEqualIgnoreCaseW () added.
+2026-10-17	Thomas			UTF8_from_U16 () and U16_from_UTF8 () replace the Windows API.
+2026-10-17	Thomas			Function dword_from_asc_hex_W () added.
+2026-10-17	Thomas			U_WINRUNTIME_SSE2 moved here from WinRuntimeReplacements.c.
 
 ****************************************************************************************/
 
@@ -48,6 +53,21 @@ When		Who				What
 #include <stdbool.h>
 #include "./externC.h"
 
+/*
+	U_WINRUNTIME_SSE2
+
+	Defined if the SSE2 intrinsics are available, which they always are on x64. Code that
+	uses them only needs to test this macro. <emmintrin.h> and <intrin.h> are included
+	here.
+*/
+#if defined (_M_X64) || defined (_M_AMD64) || defined (__SSE2__)
+	#include <emmintrin.h>
+	#include <intrin.h>
+	#ifndef U_WINRUNTIME_SSE2
+	#define U_WINRUNTIME_SSE2
+	#endif
+#endif
+
 #ifndef ASSERT
 #define ASSERT(x)	_ASSERT(x)
 #endif
@@ -106,6 +126,10 @@ bool isNotDigitW (WCHAR wc)
 
 	Because we are not using the run-time library to obtain a small executable size we
 	got to provide our own standard functions.
+
+	On x64 they use SSE2, otherwise they process a word at a time where possible.
+	memcpyU () copies forwards, hence dest and src may overlap if dest is below src.
+	memcmpU () returns -1, 0, or 1.
 */
 void *memcpyU (void *dest, const void *src, size_t len);
 void *memsetU (void *dest, uint8_t ch, size_t len);
@@ -114,7 +138,8 @@ int memcmpU (const void *str1, const void *str2, size_t count);
 /*
 	stricmpW
 
-	Case insensitive string comparison.
+	Case insensitive comparison of count UTF-16 code units. Only the ASCII letters are
+	folded. See toupperW (). On x64 8 code units are compared at a time.
 */
 int stricmpW (const unsigned short *wc1, const unsigned short *wc2, size_t count)
 ;
@@ -139,10 +164,24 @@ size_t strlenU (const char *sz)
 	strrchrW
 
 	Our strrchr () for WCHARs. Scans a string for the last occurrence of a character.
+	On x64 the string is only read once.
 */
 WCHAR *strrchrW (WCHAR *pwc, WCHAR wc)
 ;
 
+/*
+	isEqualW
+	isEqualIgnoreCaseW
+
+	Return true if the NUL-terminated strings wc1 and wc2 are identical. The second
+	function folds the ASCII letters like stricmpW () does. Both compare in a single pass
+	and stop at the first difference, hence neither needs the lengths of the strings.
+*/
+bool isEqualW (const WCHAR *wc1, const WCHAR *wc2)
+;
+bool isEqualIgnoreCaseW (const WCHAR *wc1, const WCHAR *wc2)
+;
+
 /*
 	Returns wc as an upper case character.
 */
@@ -168,6 +207,12 @@ size_t nTrailingWhiteSpaceW (WCHAR *pwc)
 /*
 	ubf_uint64_from_strW
 
+	Reads the decimal number at wcStr, which can start with a '+', until the first
+	character that isn't a digit, and stores its value at ui if ui is not NULL. A string
+	without digits has the value 0. The function returns FALSE if the value doesn't fit
+	into 64 bits, and ui is not changed in this case.
+
+	Runs of 8 digits are converted at a time.
 */
 bool ubf_uint64_from_strW (uint64_t * ui, const WCHAR *wcStr)
 ;
@@ -195,6 +240,16 @@ size_t wstr_from_uint64 (WCHAR* result, uint64_t ui64)
 void asc_hex_from_dword_W (WCHAR *pc, uint32_t ui)
 ;
 
+/*
+	dword_from_asc_hex_W
+
+	The counterpart of asc_hex_from_dword_W (). Reads exactly 8 hexadecimal characters,
+	uppercase or lowercase, from pc and stores their value at pui. The function returns
+	false if one of the characters is not hexadecimal, and leaves pui unchanged then.
+*/
+bool dword_from_asc_hex_W (uint32_t *pui, const WCHAR *pc)
+;
+
 /*
 	ubf_value_of_ASCII_hex
 	
@@ -245,16 +300,72 @@ void asc_hex_from_dword_W (WCHAR *pc, uint32_t ui)
 size_t ubf_octet_from_hex (unsigned char *o, const char *chHx);
 
 /*
+	UTF8_from_U16
+
+	Converts lenU16 UTF-16 code units from wcU16 to UTF-8 in a single pass. If lenU16 is
+	USE_STRLEN, wcU16 is NUL-terminated, and the NUL is converted too, like with
+	WideCharToMultiByte ().
+
+	The function writes at most sizU8 octets to chU8. It returns the amount of octets the
+	complete UTF-8 string requires, which includes the NUL if lenU16 is USE_STRLEN. The
+	string has been converted completely if the return value is not greater than sizU8.
+	Otherwise chU8 only contains the characters that fitted. To only obtain the required
+	size, chU8 can be NULL.
+
+	Unpaired surrogates are replaced by U+FFFD. If pbValid is not NULL, the function sets
+	it to false if this happened, and to true if not.
+*/
+size_t UTF8_from_U16 (char *chU8, size_t sizU8, const WCHAR *wcU16, size_t lenU16, bool *pbValid)
+;
+
+/*
+	U16_from_UTF8
+
+	Converts lenU8 octets of UTF-8 from chU8 to UTF-16 in a single pass. If lenU8 is
+	USE_STRLEN, chU8 is NUL-terminated, and the NUL is converted too.
+
+	The function writes at most sizU16 code units to wcU16 and returns the amount of code
+	units the complete UTF-16 string requires. The string has been converted completely if
+	the return value is not greater than sizU16. To only obtain the required size, wcU16
+	can be NULL.
+
+	Invalid or incomplete sequences, overlong forms, encoded surrogates, and code points
+	above U+10FFFF are replaced by U+FFFD. If pbValid is not NULL, the function sets it to
+	false if this happened, and to true if not.
+*/
+size_t U16_from_UTF8 (WCHAR *wcU16, size_t sizU16, const char *chU8, size_t lenU8, bool *pbValid)
+;
+
+/*
+	reqUTF8size
+
+	Returns the amount of octets required to store the NUL-terminated UTF-16 string wcU16
+	as UTF-8, including the NUL terminator.
 */
 int reqUTF8size (const WCHAR *wcU16)
 ;
 
 /*
+	UTF8_from_WinU16
+
+	Converts the NUL-terminated UTF-16 string wcU16 to UTF-8. See UTF8_from_WinU16l ().
 */
 int UTF8_from_WinU16 (char *chU8, int sizeU8, const WCHAR *wcU16)
 ;
 
 /*
+	UTF8_from_WinU16l
+
+	Converts lenU16 code units from wcU16 to UTF-8, with the return values of
+	WideCharToMultiByte (). If lenU16 is -1, wcU16 is NUL-terminated and the NUL is
+	converted too.
+
+	If sizeU8 is 0, the function returns the required size in octets. Otherwise it returns
+	the amount of octets written to chU8, or 0 if they don't fit into sizeU8 octets. In
+	this case chU8 receives an empty string if lenU16 is -1.
+
+	The functions UTF8_from_U16 () and U16_from_UTF8 () don't need a second call to
+	obtain the size first.
 */
 int UTF8_from_WinU16l (char *chU8, int sizeU8, const WCHAR *wcU16, int lenU16)
 ;
@@ -11,6 +11,9 @@ History
 When		Who				What
 -----------------------------------------------------------------------------------------
 2024-04-08	Thomas			Created.
+2026-10-17	Thomas			Function consoleOutUint64 () added.
+2026-10-17	Thomas			isArgumentW () and isArgumentIgnoreCaseW () compare in a single pass.
+2026-10-17	Thomas			consoleOutW () writes UTF-8 if the output is redirected.
 
 ****************************************************************************************/
 
@@ -84,17 +87,47 @@ bool SetConsoleEnableANSI (void)
 	return false;
 }
 
+/*
+	WriteConsoleW () fails if the output is redirected to a file or a pipe. The text is
+	written as UTF-8 then, in chunks that never end between the two halves of a surrogate
+	pair. A code unit never takes more than 3 octets.
+*/
+#define U_CONSOLE_CHUNK_LEN		(256)
+
+static void fileOutW (HANDLE hFile, const WCHAR *wcText, size_t len)
+{
+	char	szU8 [3 * U_CONSOLE_CHUNK_LEN];
+	size_t	n;
+	size_t	lenU8;
+	DWORD	dwWritten;
+
+	while (len)
+	{
+		n = len > U_CONSOLE_CHUNK_LEN ? U_CONSOLE_CHUNK_LEN : len;
+		if (n < len && wcText [n - 1] >= 0xD800 && wcText [n - 1] <= 0xDBFF)
+			-- n;
+		lenU8 = UTF8_from_U16 (szU8, sizeof (szU8), wcText, n, NULL);
+		WriteFile (hFile, szU8, (DWORD) lenU8, &dwWritten, NULL);
+		wcText	+= n;
+		len		-= n;
+	}
+}
+
 void consoleOutW (const WCHAR *wcText)
 {
 	size_t	len		= strlenW (wcText);
 	HANDLE	hstdout	= GetStdHandle (STD_OUTPUT_HANDLE);
+	DWORD	dwMode;
 
+	if (!GetConsoleMode (hstdout, &dwMode))
+	{
+		fileOutW (hstdout, wcText, len);
+		return;
+	}
 	#ifdef _DEBUG
 		BOOL b = WriteConsoleW (hstdout, wcText, (DWORD) len, NULL, NULL);
 	#else
 		WriteConsoleW (hstdout, wcText, (DWORD) len, NULL, NULL);
-		// Only supports UTF-8:
-		//WriteFile (hstdout, wcText, sizeof (WCHAR) * len, NULL, NULL);
 	#endif
 }
 
@@ -111,6 +144,14 @@ void consoleOutU8 (const char *szTextU8)
 	#endif
 }
 
+void consoleOutUint64 (uint64_t ui)
+{
+	WCHAR wcNum [UBF_UINT64_SIZ];
+
+	wstr_from_uint64 (wcNum, ui);
+	consoleOutW (wcNum);
+}
+
 WCHAR **cmdLineArgsW (int *nArgs)
 {
 	return CommandLineToArgvW (GetCommandLineW (), nArgs);
@@ -185,26 +226,12 @@ BOOL swallowExeArgW (int *pargc, WCHAR **pargv [])
 
 bool isArgumentW (const WCHAR *wcFixed, WCHAR *wcArgument)
 {
-	size_t	lFixed = strlenW (wcFixed);
-	size_t	lArgum = strlenW (wcArgument);
-
-	if (lFixed == lArgum)
-	{
-		return !memcmpU (wcFixed, wcArgument, sizeof (WCHAR) * lFixed);
-	}
-	return false;
+	return isEqualW (wcFixed, wcArgument);
 }
 
 bool isArgumentIgnoreCaseW (const WCHAR *wcFixed, WCHAR *wcArgument)
 {
-	size_t	lFixed = strlenW (wcFixed);
-	size_t	lArgum = strlenW (wcArgument);
-
-	if (lFixed == lArgum)
-	{
-		return !stricmpW (wcFixed, wcArgument, lFixed);
-	}
-	return false;
+	return isEqualIgnoreCaseW (wcFixed, wcArgument);
 }
 
 bool numberArgumentW (uint64_t *pui, WCHAR *wcArgument)
@@ -11,6 +11,8 @@ History
 When		Who				What
 -----------------------------------------------------------------------------------------
 2024-04-08	Thomas			Created.
+2026-10-17	Thomas			Function consoleOutUint64 () added.
+2026-10-17	Thomas			consoleOutW () writes UTF-8 if the output is redirected.
 
 ****************************************************************************************/
 
@@ -99,7 +101,8 @@ bool SetConsoleEnableANSI (void)
 /*
 	consoleOutW
 
-	Outputs to the console.
+	Outputs to the console. If the output is redirected to a file or a pipe, the text is
+	written as UTF-8.
 */
 void consoleOutW (const WCHAR *wcText)
 ;
@@ -112,6 +115,14 @@ void consoleOutW (const WCHAR *wcText)
 void consoleOutU8 (const char *szTextU8)
 ;
 
+/*
+	consoleOutUint64
+
+	Outputs the decimal value of ui to the console.
+*/
+void consoleOutUint64 (uint64_t ui)
+;
+
 /*
 	cmdLineArgs
 
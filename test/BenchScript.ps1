@@ -0,0 +1,49 @@
+<#
+	BenchScript.ps1
+
+	Compares running a command N times, each time in a new OnOffMate process, with
+	running the same N commands as lines of one script through the command Script.
+	The command is Version, which only outputs text. Both run N times the same
+	dispatch code; the difference is the process start, the privilege, and the
+	Winsock start-up, which a script only pays once. The output of OnOffMate is
+	discarded. The best of -Runs runs is reported.
+
+	.\BenchScript.ps1 -Exe ..\msproj\msvc2019\OnOffMate\x64\Release\OnOffMate.exe -N 200
+#>
+
+param
+(
+	[Parameter(Mandatory = $true)] [string] $Exe,
+	[int] $N	= 200,
+	[int] $Runs	= 5
+)
+
+$ErrorActionPreference	= 'Stop'
+$Exe					= (Resolve-Path $Exe).Path
+$Script					= Join-Path ([IO.Path]::GetTempPath()) "BenchScript-$PID.txt"
+
+# UTF-8 without BOM, one command per line.
+[IO.File]::WriteAllLines($Script, [string[]] (1..$N | ForEach-Object { 'Version' }),
+	(New-Object Text.UTF8Encoding -ArgumentList $false))
+
+$Launches	= [double]::MaxValue
+$InScript	= [double]::MaxValue
+try
+{
+	for ($r = 0; $r -lt $Runs; $r++)
+	{
+		$t = Measure-Command { for ($i = 0; $i -lt $N; $i++) { & $Exe Version | Out-Null } }
+		$Launches = [Math]::Min($Launches, $t.TotalMilliseconds)
+		$t = Measure-Command { & $Exe Script $Script | Out-Null }
+		$InScript = [Math]::Min($InScript, $t.TotalMilliseconds)
+	}
+}
+finally
+{
+	Remove-Item $Script
+}
+
+'{0} commands, best of {1} runs:' -f $N, $Runs
+'  {0} launches: {1:F1} ms ({2:F1} ms per command)' -f $N, $Launches, ($Launches / $N)
+'  One script:  {0:F1} ms ({1:F3} ms per command, including one launch)' -f $InScript, ($InScript / $N)
+'  Ratio:       {0:F1}x' -f ($Launches / $InScript)
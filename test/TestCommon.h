@@ -0,0 +1,109 @@
+/****************************************************************************************
+
+File		TestCommon.h
+Why:		Random numbers, guard pages, and timing for the test drivers.
+OS:			Windows, or any platform with gcc or clang. See readme.md.
+Created:	2026-10-17
+
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2026-10-17	Thomas			Created.
+
+****************************************************************************************/
+
+/*
+	This file is maintained as part of OnOffMate. See https://github.com/ThomasPGH/OnOffMate .
+*/
+
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Copyright (c) 2026 Thomas
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef TEST_COMMON_H
+#define TEST_COMMON_H
+
+#include <stdint.h>
+#include <time.h>
+
+#ifdef _WIN32
+	#include <Windows.h>
+#else
+	#include <sys/mman.h>
+#endif
+
+#define TEST_PAGE_SIZ		(4096)
+
+static uint64_t		uiRnd		= 0x9E3779B97F4A7C15ull;
+
+/*
+	rnd64
+
+	xorshift64*. The C runtime's rand () only has 15 bits on Windows.
+*/
+static uint64_t rnd64 (void)
+{
+	uiRnd ^= uiRnd >> 12;
+	uiRnd ^= uiRnd << 25;
+	uiRnd ^= uiRnd >> 27;
+	return uiRnd * 0x2545F4914F6CDD1Dull;
+}
+
+static unsigned rnd (unsigned n)
+{
+	return (unsigned) (rnd64 () >> 33) % n;
+}
+
+/*
+	guardedPage
+
+	Returns a readable and writable page that is directly followed by an inaccessible one.
+*/
+static unsigned char *guardedPage (void)
+{
+	unsigned char	*p;
+
+	#ifdef _WIN32
+		DWORD		dwOld;
+
+		p = VirtualAlloc (NULL, 2 * TEST_PAGE_SIZ, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+		if (p && !VirtualProtect (p + TEST_PAGE_SIZ, TEST_PAGE_SIZ, PAGE_NOACCESS, &dwOld))
+			p = NULL;
+	#else
+		p = mmap	(
+						NULL, 2 * TEST_PAGE_SIZ, PROT_READ | PROT_WRITE,
+						MAP_PRIVATE | MAP_ANONYMOUS, -1, 0
+					);
+		if (MAP_FAILED == p || mprotect (p + TEST_PAGE_SIZ, TEST_PAGE_SIZ, PROT_NONE))
+			p = NULL;
+	#endif
+	return p;
+}
+
+static double nsPerCall (clock_t cStart, unsigned n)
+{
+	return (double) (clock () - cStart) / CLOCKS_PER_SEC * 1e9 / n;
+}
+
+#endif														// Of #ifndef TEST_COMMON_H.
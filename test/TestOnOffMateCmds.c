@@ -0,0 +1,234 @@
+/****************************************************************************************
+
+File		TestOnOffMateCmds.c
+Why:		Test and benchmark for the command lookup of OnOffMateMain.c.
+OS:			Windows. See readme.md.
+Created:	2026-10-17
+
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2026-10-17	Thomas			Created.
+
+****************************************************************************************/
+
+/*
+	This file is maintained as part of OnOffMate. See https://github.com/ThomasPGH/OnOffMate .
+*/
+
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Copyright (c) 2026 Thomas
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	The driver includes OnOffMateMain.c to get at its static command table ourCmds and
+	compares findOOMcmdW () against the chain of comparisons ourmain () used before the
+	table was hashed: every command name in ourCmds, one after the other, through
+	isArgumentIgnoreCaseW (). The tokens are the command names in random case and, for
+	one in ten, a name with a character changed, removed, or added. It also checks that
+	no two commands share a slot of the hash table.
+
+	With the argument "bench" it looks up a million tokens with both and outputs the
+	best of seven runs.
+*/
+
+#include "./../src/c/OnOffMateMain.c"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "./TestCommon.h"
+
+#define TEST_NUM_TOKENS		(1000000)
+#define TEST_TOKEN_LEN		(64)
+#define TEST_BENCH_RUNS		(7)
+
+/*
+	chainOOMcmdW
+
+	The reference. Compares the token against every command name in turn.
+*/
+static const SOOMCMD *chainOOMcmdW (WCHAR *wcCmd)
+{
+	size_t	n;
+
+	for (n = 0; n < N_OOMCMDS; ++ n)
+	{
+		if (isArgumentIgnoreCaseW (ourCmds [n].wcName, wcCmd))
+			return &ourCmds [n];
+	}
+	return NULL;
+}
+
+/*
+	makeToken
+
+	Writes a command name in random case to wc. One in ten is changed so that it's
+	most likely not a command anymore.
+*/
+static void makeToken (WCHAR wc [TEST_TOKEN_LEN])
+{
+	const WCHAR	*wcName	= ourCmds [rnd ((unsigned) N_OOMCMDS)].wcName;
+	size_t		len		= strlenW (wcName);
+	size_t		i;
+
+	for (i = 0; i < len; ++ i)
+	{
+		WCHAR c = wcName [i];
+		if (rnd (2) && ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')))
+			c ^= 0x20;
+		wc [i] = c;
+	}
+	if (0 == rnd (10))
+	{
+		switch (rnd (3))
+		{
+			case 0:
+				wc [rnd ((unsigned) len)] = (WCHAR) ('a' + rnd (26));
+				break;
+			case 1:
+				i = rnd ((unsigned) len);
+				memmove (wc + i, wc + i + 1, (len - i - 1) * sizeof (WCHAR));
+				-- len;
+				break;
+			case 2:
+				i = rnd ((unsigned) len + 1);
+				memmove (wc + i + 1, wc + i, (len - i) * sizeof (WCHAR));
+				wc [i] = (WCHAR) ('A' + rnd (26));
+				++ len;
+				break;
+		}
+	}
+	wc [len] = 0;
+}
+
+/*
+	testSlots
+
+	Returns the amount of commands that don't have a slot of their own.
+*/
+static unsigned long testSlots (void)
+{
+	uint8_t			uiSlots [U_OOMCMD_SLOTS]	= { 0 };
+	unsigned long	nShared						= 0;
+	size_t			n;
+
+	for (n = 0; n < N_OOMCMDS; ++ n)
+	{
+		unsigned int h = hashOOMcmdW (ourCmds [n].wcName, strlenW (ourCmds [n].wcName));
+		if (uiSlots [h])
+			++ nShared;
+		uiSlots [h] = 1;
+	}
+	printf	(
+				"Commands: %u, slots: %u, commands sharing a slot: %lu.\n",
+				(unsigned) N_OOMCMDS, U_OOMCMD_SLOTS, nShared
+			);
+	return nShared;
+}
+
+/*
+	testCmds
+
+	Returns the amount of tokens findOOMcmdW () and chainOOMcmdW () disagree on.
+*/
+static unsigned long testCmds (WCHAR (*pwcTokens) [TEST_TOKEN_LEN])
+{
+	unsigned long	nBad	= 0;
+	unsigned long	nFound	= 0;
+	size_t			n;
+
+	for (n = 0; n < N_OOMCMDS; ++ n)
+	{
+		if (findOOMcmdW (ourCmds [n].wcName) != &ourCmds [n])
+			++ nBad;
+	}
+	if (findOOMcmdW (L""))
+		++ nBad;
+	for (n = 0; n < TEST_NUM_TOKENS; ++ n)
+	{
+		const SOOMCMD *pc = chainOOMcmdW (pwcTokens [n]);
+		if (findOOMcmdW (pwcTokens [n]) != pc)
+			++ nBad;
+		nFound += NULL != pc;
+	}
+	printf	(
+				"Tokens: %u, commands: %lu, mismatches: %lu.\n",
+				TEST_NUM_TOKENS, nFound, nBad
+			);
+	return nBad;
+}
+
+static void benchCmds (WCHAR (*pwcTokens) [TEST_TOKEN_LEN])
+{
+	volatile size_t	nFound	= 0;
+	double			d [2]	= { 0, 0 };
+	unsigned		r, i;
+	clock_t			c;
+
+	for (r = 0; r < TEST_BENCH_RUNS; ++ r)
+	{
+		double	dr;
+
+		c = clock ();
+		for (i = 0; i < TEST_NUM_TOKENS; ++ i)
+			nFound += NULL != chainOOMcmdW (pwcTokens [i]);
+		dr = nsPerCall (c, TEST_NUM_TOKENS);
+		if (0 == r || dr < d [0])
+			d [0] = dr;
+		c = clock ();
+		for (i = 0; i < TEST_NUM_TOKENS; ++ i)
+			nFound += NULL != findOOMcmdW (pwcTokens [i]);
+		dr = nsPerCall (c, TEST_NUM_TOKENS);
+		if (0 == r || dr < d [1])
+			d [1] = dr;
+	}
+	printf	(
+				"%u tokens, best of %u, ns per token: chain %.1f, table %.1f (%.1fx)\n",
+				TEST_NUM_TOKENS, TEST_BENCH_RUNS, d [0], d [1], d [0] / d [1]
+			);
+}
+
+int main (int argc, char *argv [])
+{
+	WCHAR			(*pwcTokens) [TEST_TOKEN_LEN];
+	unsigned long	nBad;
+	size_t			n;
+
+	pwcTokens = malloc ((size_t) TEST_NUM_TOKENS * sizeof (*pwcTokens));
+	if (NULL == pwcTokens)
+	{
+		puts ("Out of memory.");
+		return EXIT_FAILURE;
+	}
+	for (n = 0; n < TEST_NUM_TOKENS; ++ n)
+		makeToken (pwcTokens [n]);
+	nBad = testSlots () + testCmds (pwcTokens);
+	if (argc > 1 && 0 == strcmp (argv [1], "bench"))
+		benchCmds (pwcTokens);
+	free (pwcTokens);
+	puts (nBad ? "FAILED." : "Passed.");
+	return nBad ? EXIT_FAILURE : EXIT_SUCCESS;
+}
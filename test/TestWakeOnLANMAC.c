@@ -0,0 +1,310 @@
+/****************************************************************************************
+
+File		TestWakeOnLANMAC.c
+Why:		Differential test and benchmark for the MAC address parser in WakeOnLANMAC.c.
+OS:			Windows, or any platform with gcc or clang. See readme.md.
+Created:	2026-10-17
+
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2026-10-17	Thomas			Created.
+
+****************************************************************************************/
+
+/*
+	This file is maintained as part of OnOffMate. See https://github.com/ThomasPGH/OnOffMate .
+*/
+
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Copyright (c) 2026 Thomas
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	parseWOLmacU8 () and parseWOLmacW () are compared against a reference that follows the
+	documented notations character by character, on valid addresses in all notations and
+	on addresses with a character changed, removed, or added. Every address ends at an
+	inaccessible page.
+
+	With the argument "bench" the driver parses an inventory of a million addresses in
+	mixed notations and outputs the parse rate of both functions and the reference.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+
+#include "./TestCommon.h"
+#include "./../src/c/WakeOnLANMAC.h"
+
+#define TEST_NUM_CASES		(4000000)
+#define TEST_BENCH_MACS		(1000000)
+
+static int refHexValue (unsigned c)
+{
+	if (c >= '0' && c <= '9')
+		return (int) (c - '0');
+	if (c >= 'a' && c <= 'f')
+		return (int) (c - 'a' + 10);
+	if (c >= 'A' && c <= 'F')
+		return (int) (c - 'A' + 10);
+	return -1;
+}
+
+/*
+	refParseMAC
+
+	The reference. 12 hexadecimal digits, Cisco's 0011.2233.4455, or six fields of one
+	or two hexadecimal digits separated by the same character that isn't one.
+*/
+static bool refParseMAC (unsigned char ucMAC [6], const unsigned *pc, size_t len)
+{
+	unsigned	uiSep	= 0;
+	size_t		i		= 0;
+	size_t		f, n;
+
+	if (12 == len || (14 == len && '.' == pc [4] && '.' == pc [9]))
+	{
+		unsigned	uiDigits [12];
+		size_t		d		= 0;
+
+		for (i = 0; i < len; ++ i)
+		{
+			if (14 == len && (4 == i || 9 == i))
+				continue;
+			if (refHexValue (pc [i]) < 0)
+				break;
+			uiDigits [d ++] = pc [i];
+		}
+		if (12 == d)
+		{
+			for (n = 0; n < 6; ++ n)
+			{
+				ucMAC [n] = (unsigned char)
+							(
+									refHexValue (uiDigits [2 * n]) << 4
+								|	refHexValue (uiDigits [2 * n + 1])
+							);
+			}
+			return true;
+		}
+		i = 0;
+	}
+	for (f = 0; f < 6; ++ f)
+	{
+		unsigned v = 0;
+
+		for (n = 0; i < len && refHexValue (pc [i]) >= 0; ++ n, ++ i)
+			v = v << 4 | (unsigned) refHexValue (pc [i]);
+		if (0 == n || n > 2)
+			return false;
+		ucMAC [f] = (unsigned char) v;
+		if (5 == f)
+			break;
+		if (i == len || (uiSep && pc [i] != uiSep))
+			return false;
+		uiSep = pc [i ++];
+	}
+	return i == len;
+}
+
+/*
+	makeMAC
+
+	Writes a random address in one of the notations, sometimes with a character changed,
+	removed, or added, to pc and returns its length. bWide allows separators and changes
+	above 0xFF. No character is NUL.
+*/
+static size_t makeMAC (unsigned *pc, bool bWide)
+{
+	static const unsigned	uiSeps []	=
+	{
+		':', '-', '.', ' ', '_', '/', 'g', 'x', 0xE9, 0x2010, 0xFF1A
+	};
+	unsigned char			ucMAC [6];
+	unsigned				uiSep		= uiSeps [rnd (bWide ? 11 : 9)];
+	unsigned				uiNotation	= rnd (4);
+	size_t					n			= 0;
+	size_t					i;
+
+	for (i = 0; i < 6; ++ i)
+		ucMAC [i] = (unsigned char) (rnd (4) ? rnd (256) : rnd (16));
+	for (i = 0; i < 6; ++ i)
+	{
+		unsigned	hi	= ucMAC [i] >> 4;
+		unsigned	lo	= ucMAC [i] & 0x0F;
+		unsigned	a	= rnd (2) ? 'a' : 'A';
+
+		// One digit per field if the high one is 0, sometimes.
+		if (uiNotation > 1 || hi || rnd (2))
+			pc [n ++] = hi < 10 ? '0' + hi : a + hi - 10;
+		pc [n ++] = lo < 10 ? '0' + lo : a + lo - 10;
+		if (5 == i)
+			break;
+		if (0 == uiNotation || 1 == uiNotation)
+			pc [n ++] = uiSep;
+		else
+		if (2 == uiNotation && (1 == i || 3 == i))
+			pc [n ++] = '.';
+	}
+	switch (rnd (8))
+	{
+		case 0:
+			pc [rnd ((unsigned) n)] = 1 + rnd (bWide ? 0xFFFF : 0xFF);
+			break;
+		case 1:
+			i = rnd ((unsigned) n);
+			memmove (pc + i, pc + i + 1, (n - i - 1) * sizeof (unsigned));
+			-- n;
+			break;
+		case 2:
+			i = rnd ((unsigned) n + 1);
+			memmove (pc + i + 1, pc + i, (n - i) * sizeof (unsigned));
+			pc [i] = rnd (2) ? uiSep : '0' + rnd (10);
+			++ n;
+			break;
+	}
+	return n;
+}
+
+/*
+	testMAC
+
+	Returns the amount of mismatches.
+*/
+static unsigned long testMAC (unsigned char *pPage)
+{
+	unsigned long	nBad	= 0;
+	unsigned		i;
+	size_t			n, j;
+
+	for (i = 0; i < TEST_NUM_CASES; ++ i)
+	{
+		bool			bWide	= i & 1;
+		unsigned		uiMAC [32];
+		unsigned char	uc1 [6]	= { 0 };
+		unsigned char	uc2 [6]	= { 0 };
+		bool			b1, b2;
+
+		n	= makeMAC (uiMAC, bWide);
+		b2	= refParseMAC (uc2, uiMAC, n);
+		if (bWide)
+		{
+			wchar_t *pw = (wchar_t *) (pPage + TEST_PAGE_SIZ) - n;
+			for (j = 0; j < n; ++ j)
+				pw [j] = (wchar_t) uiMAC [j];
+			b1 = parseWOLmacW (uc1, pw, n);
+		} else
+		{
+			char *pc = (char *) (pPage + TEST_PAGE_SIZ) - n;
+			for (j = 0; j < n; ++ j)
+				pc [j] = (char) uiMAC [j];
+			b1 = parseWOLmacU8 (uc1, pc, n);
+		}
+		if (b1 != b2 || (b1 && memcmp (uc1, uc2, 6)))
+			++ nBad;
+	}
+	printf ("MAC addresses: %u cases, %lu mismatches.\n", TEST_NUM_CASES, nBad);
+	return nBad;
+}
+
+/*
+	benchMAC
+
+	A million valid addresses in all four notations, one after the other like the lines
+	of an inventory file.
+*/
+static void benchMAC (void)
+{
+	char			*pc		= malloc ((size_t) TEST_BENCH_MACS * 17);
+	wchar_t			*pw		= malloc ((size_t) TEST_BENCH_MACS * 17 * sizeof (wchar_t));
+	uint32_t		*puiOfs	= malloc (((size_t) TEST_BENCH_MACS + 1) * sizeof (uint32_t));
+	unsigned		*pui	= malloc ((size_t) TEST_BENCH_MACS * 17 * sizeof (unsigned));
+	volatile size_t	nGood	= 0;
+	unsigned char	ucMAC [6];
+	unsigned		i;
+	size_t			n		= 0;
+	clock_t			c;
+	double			d [3];
+
+	if (!pc || !pw || !puiOfs || !pui)
+		return;
+	for (i = 0; i < TEST_BENCH_MACS; )
+	{
+		unsigned	uiMAC [32];
+		size_t		len		= makeMAC (uiMAC, false);
+		size_t		j;
+
+		if (!refParseMAC (ucMAC, uiMAC, len))
+			continue;
+		puiOfs [i ++] = (uint32_t) n;
+		for (j = 0; j < len; ++ j, ++ n)
+		{
+			pc [n]	= (char) uiMAC [j];
+			pw [n]	= (wchar_t) uiMAC [j];
+			pui [n]	= uiMAC [j];
+		}
+	}
+	puiOfs [TEST_BENCH_MACS] = (uint32_t) n;
+
+	c = clock ();
+	for (i = 0; i < TEST_BENCH_MACS; ++ i)
+		nGood += parseWOLmacU8 (ucMAC, pc + puiOfs [i], puiOfs [i + 1] - puiOfs [i]);
+	d [0] = nsPerCall (c, TEST_BENCH_MACS);
+	c = clock ();
+	for (i = 0; i < TEST_BENCH_MACS; ++ i)
+		nGood += parseWOLmacW (ucMAC, pw + puiOfs [i], puiOfs [i + 1] - puiOfs [i]);
+	d [1] = nsPerCall (c, TEST_BENCH_MACS);
+	c = clock ();
+	for (i = 0; i < TEST_BENCH_MACS; ++ i)
+		nGood += refParseMAC (ucMAC, pui + puiOfs [i], puiOfs [i + 1] - puiOfs [i]);
+	d [2] = nsPerCall (c, TEST_BENCH_MACS);
+	printf	(
+				"%u addresses, million addresses per second: parseWOLmacU8 %.1f, "
+				"parseWOLmacW %.1f, reference %.1f\n",
+				TEST_BENCH_MACS, 1e3 / d [0], 1e3 / d [1], 1e3 / d [2]
+			);
+	free (pc);
+	free (pw);
+	free (puiOfs);
+	free (pui);
+}
+
+int main (int argc, char *argv [])
+{
+	unsigned char	*pPage	= guardedPage ();
+	unsigned long	nBad;
+
+	if (NULL == pPage)
+	{
+		puts ("Can't allocate the guard page.");
+		return EXIT_FAILURE;
+	}
+	nBad = testMAC (pPage);
+	if (argc > 1 && 0 == strcmp (argv [1], "bench"))
+		benchMAC ();
+	puts (nBad ? "FAILED." : "Passed.");
+	return nBad ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,1146 @@
+/****************************************************************************************
+
+File		TestWinRuntimeReplacements.c
+Why:		Differential tests and benchmarks for WinRuntimeReplacements.c.
+OS:			Windows, or any platform with gcc or clang. See readme.md.
+Created:	2026-10-17
+
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2026-10-17	Thomas			Created.
+
+****************************************************************************************/
+
+/*
+	This file is maintained as part of OnOffMate. See https://github.com/ThomasPGH/OnOffMate .
+*/
+
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Copyright (c) 2026 Thomas
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	Unlike OnOffMate itself, this driver links to the C runtime library. The functions of
+	WinRuntimeReplacements.c are compared against plain one-character-at-a-time reference
+	implementations below, or against the C runtime library, on random and edge case input.
+
+	Strings are parsed at the very end of a page that is followed by an inaccessible page,
+	so that a parser reading past the NUL terminator crashes the test.
+
+	With the argument "bench" the driver also outputs nanoseconds per call for the new
+	and the reference functions.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+	#include <iconv.h>
+#endif
+
+#include "./TestCommon.h"
+#include "./../src/c/WinRuntimeReplacements.h"
+
+#define TEST_NUM_CASES		(2000000)
+#define TEST_BENCH_CALLS	(20000000)
+
+/*
+	A value with a random amount of significant bits, so that all lengths are tested.
+*/
+static uint64_t rndValue (void)
+{
+	return rnd64 () >> rnd (64);
+}
+
+/*
+	The reference implementations.
+*/
+static bool refUint64FromStrW (uint64_t *ui, const WCHAR *wcStr)
+{
+	uint64_t	u	= 0;
+	unsigned	c;
+
+	if (L'+' == *wcStr)
+		++ wcStr;
+	while (*wcStr >= L'0' && *wcStr <= L'9')
+	{
+		c = (unsigned) (*wcStr - L'0');
+		if (u > UINT64_MAX / 10 || u * 10 > UINT64_MAX - c)
+			return false;
+		u = u * 10 + c;
+		++ wcStr;
+	}
+	*ui = u;
+	return true;
+}
+
+static size_t refWstrFromUint64 (WCHAR *wcResult, uint64_t ui64)
+{
+	WCHAR		wc [UBF_UINT64_LEN];
+	size_t		n	= 0;
+	size_t		i;
+
+	do
+	{
+		wc [n ++] = (WCHAR) (L'0' + ui64 % 10);
+		ui64 /= 10;
+	} while (ui64);
+	for (i = 0; i < n; ++ i)
+		wcResult [i] = wc [n - 1 - i];
+	wcResult [n] = L'\0';
+	return n;
+}
+
+static void refHexFromDwordW (WCHAR *pc, uint32_t ui)
+{
+	unsigned	i;
+
+	for (i = 0; i < 8; ++ i)
+		pc [i] = (WCHAR) "0123456789ABCDEF" [(ui >> (28 - 4 * i)) & 0x0F];
+}
+
+static int refHexValueW (WCHAR wc)
+{
+	if (wc >= L'0' && wc <= L'9')
+		return wc - L'0';
+	if (wc >= L'a' && wc <= L'f')
+		return wc - L'a' + 10;
+	if (wc >= L'A' && wc <= L'F')
+		return wc - L'A' + 10;
+	return -1;
+}
+
+static bool refDwordFromHexW (uint32_t *pui, const WCHAR *pc)
+{
+	uint32_t	ui	= 0;
+	unsigned	i;
+
+	for (i = 0; i < 8; ++ i)
+	{
+		if (refHexValueW (pc [i]) < 0)
+			return false;
+		ui = ui << 4 | (uint32_t) refHexValueW (pc [i]);
+	}
+	*pui = ui;
+	return true;
+}
+
+/*
+	makeNumberStringW
+
+	Writes a random candidate for ubf_uint64_from_strW () to wc, including its NUL, and
+	returns its length in WCHARs, including the NUL. The string may start with '+', can
+	have up to 29 digits, is sometimes close to UINT64_MAX, and may be followed by
+	characters that are not digits.
+*/
+static size_t makeNumberStringW (WCHAR *wc)
+{
+	static const WCHAR	wcTail []	= { L'/', L':', 0x0661, L'a' };
+	size_t				n			= 0;
+	unsigned			nDigits		= rnd (30);
+	unsigned			nTail		= rnd (3);
+	unsigned			i;
+
+	if (0 == rnd (4))
+		wc [n ++] = L'+';
+	if (nDigits && 0 == rnd (4))
+	{	// Around UINT64_MAX, or one digit above it.
+		n += wstr_from_uint64 (wc + n, UINT64_MAX - rnd (3));
+		if (rnd (2))
+			wc [n - 1] = (WCHAR) (wc [n - 1] + rnd (2));
+	} else
+	{
+		for (i = 0; i < nDigits; ++ i)
+			wc [n ++] = (WCHAR) (L'0' + rnd (10));
+	}
+	for (i = 0; i < nTail; ++ i)
+		wc [n ++] = wcTail [rnd (4)];
+	wc [n ++] = L'\0';
+	return n;
+}
+
+/*
+	testNumbers
+
+	Returns the amount of mismatches.
+*/
+static unsigned long testNumbers (unsigned char *pPage)
+{
+	static const uint64_t	uiEdges []	=
+	{
+		0, 9, 10, 99, 100, 99999999, 100000000, 4294967295u, 4294967296ull,
+		UINT64_MAX / 10, 9999999999999999999ull, 10000000000000000000ull,
+		18446744073709551610ull, UINT64_MAX - 1, UINT64_MAX
+	};
+	const unsigned	nEdges		= sizeof (uiEdges) / sizeof (uiEdges [0]);
+	WCHAR			*pwcEnd		= (WCHAR *) (pPage + TEST_PAGE_SIZ);
+	unsigned long	nBad		= 0;
+	unsigned		i, j;
+
+	for (i = 0; i < TEST_NUM_CASES; ++ i)
+	{
+		uint64_t	ui		= i < nEdges ? uiEdges [i] : rndValue ();
+		WCHAR		wc1 [64];
+		WCHAR		wc2 [64];
+		WCHAR		*pwc;
+		size_t		n1, n2;
+		uint32_t	ui1, ui2;
+		bool		b1, b2;
+		uint64_t	u1		= 111;
+		uint64_t	u2		= 111;
+
+		// Decimal output.
+		n1 = wstr_from_uint64 (wc1, ui);
+		n2 = refWstrFromUint64 (wc2, ui);
+		if (n1 != n2 || memcmp (wc1, wc2, (n1 + 1) * sizeof (WCHAR)))
+			++ nBad;
+
+		// Hex output, and reading it back with random case.
+		asc_hex_from_dword_W (wc1, (uint32_t) ui);
+		refHexFromDwordW (wc2, (uint32_t) ui);
+		if (memcmp (wc1, wc2, 8 * sizeof (WCHAR)))
+			++ nBad;
+		for (j = 0; j < 8; ++ j)
+		{
+			if (wc1 [j] > L'9' && rnd (2))
+				wc1 [j] |= 0x20;
+		}
+		ui1 = 0;
+		if (!dword_from_asc_hex_W (&ui1, wc1) || (uint32_t) ui != ui1)
+			++ nBad;
+
+		// Hex input with characters that are not hexadecimal.
+		for (j = 0; j < 8; ++ j)
+		{
+			unsigned r = rnd (40);
+			wc1 [j] =	(WCHAR)
+						(
+							r < 30	? (unsigned) "0123456789abcdefABCDEF" [rnd (22)]
+									: r < 39 ? rnd (0x80) : rnd (0x10000)
+						);
+		}
+		ui1 = ui2	= 12345;
+		b1			= dword_from_asc_hex_W (&ui1, wc1);
+		b2			= refDwordFromHexW (&ui2, wc1);
+		if (b1 != b2 || ui1 != ui2)
+			++ nBad;
+
+		// Decimal input, ending at the guard page or shortly before.
+		n1	= makeNumberStringW (wc1);
+		pwc	= pwcEnd - n1 - (rnd (2) ? 0 : rnd (10));
+		memcpy (pwc, wc1, n1 * sizeof (WCHAR));
+		b1	= ubf_uint64_from_strW (&u1, pwc);
+		b2	= refUint64FromStrW (&u2, pwc);
+		if (b1 != b2 || u1 != u2)
+			++ nBad;
+	}
+	printf ("Numbers: %u cases, %lu mismatches.\n", TEST_NUM_CASES, nBad);
+	return nBad;
+}
+
+static void benchNumbers (void)
+{
+	static uint64_t		uiValues	[4096];
+	static WCHAR		wcDec		[4096][UBF_UINT64_SIZ];
+	static WCHAR		wcHex		[4096][8];
+	volatile uint64_t	uiSink		= 0;
+	WCHAR				wc [UBF_UINT64_SIZ];
+	uint64_t			u;
+	uint32_t			ui;
+	clock_t				c;
+	double				d1, d2;
+	unsigned			i;
+
+	for (i = 0; i < 4096; ++ i)
+	{
+		uiValues [i] = rndValue ();
+		wstr_from_uint64 (wcDec [i], uiValues [i]);
+		asc_hex_from_dword_W (wcHex [i], (uint32_t) uiValues [i]);
+	}
+	printf ("%-22s %10s %10s (ns/call)\n", "", "new", "reference");
+
+	c = clock ();
+	for (i = 0; i < TEST_BENCH_CALLS; ++ i)
+		uiSink += wstr_from_uint64 (wc, uiValues [i & 4095]);
+	d1 = nsPerCall (c, TEST_BENCH_CALLS);
+	c = clock ();
+	for (i = 0; i < TEST_BENCH_CALLS; ++ i)
+		uiSink += refWstrFromUint64 (wc, uiValues [i & 4095]);
+	d2 = nsPerCall (c, TEST_BENCH_CALLS);
+	printf ("%-22s %10.1f %10.1f\n", "wstr_from_uint64", d1, d2);
+
+	c = clock ();
+	for (i = 0; i < TEST_BENCH_CALLS; ++ i)
+	{
+		ubf_uint64_from_strW (&u, wcDec [i & 4095]);
+		uiSink += u;
+	}
+	d1 = nsPerCall (c, TEST_BENCH_CALLS);
+	c = clock ();
+	for (i = 0; i < TEST_BENCH_CALLS; ++ i)
+	{
+		refUint64FromStrW (&u, wcDec [i & 4095]);
+		uiSink += u;
+	}
+	d2 = nsPerCall (c, TEST_BENCH_CALLS);
+	printf ("%-22s %10.1f %10.1f\n", "ubf_uint64_from_strW", d1, d2);
+
+	c = clock ();
+	for (i = 0; i < TEST_BENCH_CALLS; ++ i)
+	{
+		asc_hex_from_dword_W (wc, (uint32_t) uiValues [i & 4095]);
+		uiSink += wc [3];
+	}
+	d1 = nsPerCall (c, TEST_BENCH_CALLS);
+	c = clock ();
+	for (i = 0; i < TEST_BENCH_CALLS; ++ i)
+	{
+		refHexFromDwordW (wc, (uint32_t) uiValues [i & 4095]);
+		uiSink += wc [3];
+	}
+	d2 = nsPerCall (c, TEST_BENCH_CALLS);
+	printf ("%-22s %10.1f %10.1f\n", "asc_hex_from_dword_W", d1, d2);
+
+	c = clock ();
+	for (i = 0; i < TEST_BENCH_CALLS; ++ i)
+	{
+		dword_from_asc_hex_W (&ui, wcHex [i & 4095]);
+		uiSink += ui;
+	}
+	d1 = nsPerCall (c, TEST_BENCH_CALLS);
+	c = clock ();
+	for (i = 0; i < TEST_BENCH_CALLS; ++ i)
+	{
+		refDwordFromHexW (&ui, wcHex [i & 4095]);
+		uiSink += ui;
+	}
+	d2 = nsPerCall (c, TEST_BENCH_CALLS);
+	printf ("%-22s %10.1f %10.1f\n", "dword_from_asc_hex_W", d1, d2);
+}
+
+static int signOf (int i)
+{
+	return i < 0 ? -1 : i > 0;
+}
+
+/*
+	testMemory
+
+	Compares memcpyU (), memsetU (), and memcmpU () against memcpy (), memset (), and
+	memcmp () for all alignments of source and destination, and memcpyU () against
+	memmove () for overlapping buffers with dest below src, which the line reader relies
+	on. Every source also ends at the guard page once. Returns the amount of mismatches.
+*/
+static unsigned long testMemory (unsigned char *pPage)
+{
+	const size_t	sizBuf	= 70000 + 256;
+	unsigned char	*pSrc	= malloc (sizBuf);
+	unsigned char	*pD1	= malloc (sizBuf);
+	unsigned char	*pD2	= malloc (sizBuf);
+	unsigned char	*pCmp	= malloc (sizBuf);
+	unsigned long	nBad	= 0;
+	unsigned		i;
+
+	if (!pSrc || !pD1 || !pD2 || !pCmp)
+	{
+		puts ("Out of memory.");
+		return 1;
+	}
+	for (i = 0; i < TEST_NUM_CASES / 5; ++ i)
+	{
+		size_t			n		= rnd (i % 4 ? 300 : 70000);
+		size_t			os		= rnd (64);
+		size_t			od		= rnd (64);
+		size_t			sh		= 1 + rnd (40);
+		unsigned char	ch		= (unsigned char) rnd (256);
+		unsigned char	*pEnd;
+		size_t			j;
+
+		for (j = 0; j < n + 64; ++ j)
+			pSrc [j] = (unsigned char) rnd (256);
+		memset (pD1, 0x5A, n + 128);
+		memset (pD2, 0x5A, n + 128);
+
+		memcpyU (pD1 + od, pSrc + os, n);
+		memcpy (pD2 + od, pSrc + os, n);
+		if (memcmp (pD1, pD2, n + 128))
+			++ nBad;
+
+		memsetU (pD1 + od, ch, n);
+		memset (pD2 + od, ch, n);
+		if (memcmp (pD1, pD2, n + 128))
+			++ nBad;
+
+		// Equal, or different in one random octet.
+		memcpy (pCmp + od, pSrc + os, n);
+		if (n && rnd (2))
+			pCmp [od + rnd ((unsigned) n)] ^= (unsigned char) (1 + rnd (255));
+		if (signOf (memcmpU (pSrc + os, pCmp + od, n)) != signOf (memcmp (pSrc + os, pCmp + od, n)))
+			++ nBad;
+
+		// Overlapping, with dest below src.
+		memcpy (pD1, pSrc, n + sh);
+		memcpy (pD2, pSrc, n + sh);
+		memcpyU (pD1, pD1 + sh, n);
+		memmove (pD2, pD2 + sh, n);
+		if (memcmp (pD1, pD2, n + sh))
+			++ nBad;
+
+		// Source ending at the guard page.
+		if (n <= TEST_PAGE_SIZ)
+		{
+			pEnd = pPage + TEST_PAGE_SIZ - n;
+			memcpy (pEnd, pSrc, n);
+			memcpyU (pD1 + od, pEnd, n);
+			if (memcmp (pD1 + od, pSrc, n) || 0 != memcmpU (pEnd, pSrc, n))
+				++ nBad;
+		}
+	}
+	printf ("Memory: %u cases, %lu mismatches.\n", TEST_NUM_CASES / 5, nBad);
+	free (pSrc);
+	free (pD1);
+	free (pD2);
+	free (pCmp);
+	return nBad;
+}
+
+static void benchMemory (void)
+{
+	static const size_t	sizes []	=
+	{
+		1, 3, 8, 15, 16, 31, 64, 102, 256, 1024, 4096, 16384, 65536
+	};
+	unsigned char		*pSrc		= calloc (65536 + 64, 1);
+	unsigned char		*pDst		= calloc (65536 + 64, 1);
+	unsigned char		*pCmp		= calloc (65536 + 64, 1);
+	volatile int		iSink		= 0;
+	double				d [6];
+	clock_t				c;
+	unsigned			s, r, nCalls;
+
+	if (!pSrc || !pDst || !pCmp)
+		return;
+	printf	(
+				"%8s %10s %10s %10s %10s %10s %10s (ns/call)\n",
+				"Octets", "memcpyU", "memcpy", "memsetU", "memset", "memcmpU", "memcmp"
+			);
+	for (s = 0; s < sizeof (sizes) / sizeof (sizes [0]); ++ s)
+	{
+		size_t n	= sizes [s];
+
+		nCalls = (unsigned) (TEST_BENCH_CALLS * 10 / (n + 32));
+		c = clock ();
+		for (r = 0; r < nCalls; ++ r)
+			iSink += *(unsigned char *) memcpyU (pDst + 1, pSrc, n);
+		d [0] = nsPerCall (c, nCalls);
+		c = clock ();
+		for (r = 0; r < nCalls; ++ r)
+			iSink += *(unsigned char *) memcpy (pDst + 1, pSrc, n);
+		d [1] = nsPerCall (c, nCalls);
+		c = clock ();
+		for (r = 0; r < nCalls; ++ r)
+			iSink += *(unsigned char *) memsetU (pDst + 1, (uint8_t) r, n);
+		d [2] = nsPerCall (c, nCalls);
+		c = clock ();
+		for (r = 0; r < nCalls; ++ r)
+			iSink += *(unsigned char *) memset (pDst + 1, (int) r, n);
+		d [3] = nsPerCall (c, nCalls);
+		c = clock ();
+		for (r = 0; r < nCalls; ++ r)
+			iSink += memcmpU (pSrc, pCmp, n);
+		d [4] = nsPerCall (c, nCalls);
+		c = clock ();
+		for (r = 0; r < nCalls; ++ r)
+			iSink += memcmp (pSrc, pCmp, n);
+		d [5] = nsPerCall (c, nCalls);
+		printf	(
+					"%8u %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+					(unsigned) n, d [0], d [1], d [2], d [3], d [4], d [5]
+				);
+	}
+	free (pSrc);
+	free (pDst);
+	free (pCmp);
+}
+
+/*
+	String references. They fold like toupperW (), which only maps a to z.
+*/
+static size_t refStrlenW (const WCHAR *pwc)
+{
+	size_t n = 0;
+
+	while (pwc [n])
+		++ n;
+	return n;
+}
+
+static size_t refStrlenU (const char *sz)
+{
+	size_t n = 0;
+
+	while (sz [n])
+		++ n;
+	return n;
+}
+
+static WCHAR *refStrrchrW (WCHAR *pwc, WCHAR wc)
+{
+	WCHAR *pLast = NULL;
+
+	if (L'\0' == wc)
+		return NULL;
+	for (; *pwc; ++ pwc)
+	{
+		if (wc == *pwc)
+			pLast = pwc;
+	}
+	return pLast;
+}
+
+static WCHAR refToupperW (WCHAR wc)
+{
+	return (WCHAR) (wc >= L'a' && wc <= L'z' ? wc - 0x20 : wc);
+}
+
+static int refStricmpW (const WCHAR *wc1, const WCHAR *wc2, size_t count)
+{
+	size_t i;
+
+	for (i = 0; i < count; ++ i)
+	{
+		if (refToupperW (wc1 [i]) != refToupperW (wc2 [i]))
+			return refToupperW (wc1 [i]) < refToupperW (wc2 [i]) ? -1 : 1;
+	}
+	return 0;
+}
+
+static bool refIsEqualW (const WCHAR *wc1, const WCHAR *wc2, bool bIgnoreCase)
+{
+	for (;; ++ wc1, ++ wc2)
+	{
+		WCHAR c1 = bIgnoreCase ? refToupperW (*wc1) : *wc1;
+		WCHAR c2 = bIgnoreCase ? refToupperW (*wc2) : *wc2;
+		if (c1 != c2)
+			return false;
+		if (L'\0' == c1)
+			return true;
+	}
+}
+
+/*
+	A code unit that isn't NUL: mostly ASCII letters of both cases, the characters next
+	to a to z and A to Z, Latin-1, and code units from 0x8000 upwards, surrogates included.
+*/
+static WCHAR rndCharW (void)
+{
+	static const WCHAR	wcEdges []	=
+	{
+		L'@', L'[', L'`', L'{', L'\\', 0x00C4, 0x00E4, 0x00FF, 0x7FFF, 0x8000, 0xD800,
+		0xDBFF, 0xDC00, 0xDFFF, 0xFF41, 0xFFFF
+	};
+	unsigned			r			= rnd (8);
+
+	if (r < 3)
+		return (WCHAR) (L'a' + rnd (26));
+	if (r < 6)
+		return (WCHAR) (L'A' + rnd (26));
+	if (r < 7)
+		return wcEdges [rnd (sizeof (wcEdges) / sizeof (wcEdges [0]))];
+	return (WCHAR) (1 + rnd (0xFFFF));
+}
+
+/*
+	Copies the n code units at pwc to the end of the page pPage, or a few code units
+	before it, and returns the copy.
+*/
+static WCHAR *atPageEndW (unsigned char *pPage, const WCHAR *pwc, size_t n)
+{
+	WCHAR *pw = (WCHAR *) (pPage + TEST_PAGE_SIZ) - n - (rnd (2) ? 0 : rnd (16));
+
+	memcpy (pw, pwc, n * sizeof (WCHAR));
+	return pw;
+}
+
+/*
+	testStrings
+
+	Compares strlenW (), strlenU (), strrchrW (), stricmpW (), isEqualW (), and
+	isEqualIgnoreCaseW () against the references above. Every string ends at one of the
+	two guard pages, or a few code units before it, which also gives it a random
+	alignment. Returns the amount of mismatches.
+*/
+static unsigned long testStrings (unsigned char *pPage1, unsigned char *pPage2)
+{
+	unsigned long	nBad	= 0;
+	unsigned		i;
+
+	for (i = 0; i < TEST_NUM_CASES / 5; ++ i)
+	{
+		WCHAR		wc1 [1024];
+		WCHAR		wc2 [1024];
+		char		sz [1024];
+		size_t		len		= rnd (8) ? rnd (80) : rnd (1000);
+		size_t		j;
+		WCHAR		*pw1, *pw2;
+		char		*pc;
+		WCHAR		wc;
+
+		for (j = 0; j < len; ++ j)
+		{
+			wc1 [j]	= rndCharW ();
+			sz [j]	= (char) (1 + rnd (255));
+		}
+		wc1 [len]	= L'\0';
+		sz [len]	= '\0';
+
+		pw1	= atPageEndW (pPage1, wc1, len + 1);
+		if (strlenW (pw1) != refStrlenW (pw1))
+			++ nBad;
+		pc	= (char *) pPage2 + TEST_PAGE_SIZ - (len + 1) - (rnd (2) ? 0 : rnd (16));
+		memcpy (pc, sz, len + 1);
+		if (strlenU (pc) != refStrlenU (pc))
+			++ nBad;
+
+		// A character of the string, or one that probably isn't in it.
+		wc	= len && rnd (4) ? pw1 [rnd ((unsigned) len)] : rndCharW ();
+		if (strrchrW (pw1, wc) != refStrrchrW (pw1, wc) || NULL != strrchrW (pw1, L'\0'))
+			++ nBad;
+
+		// The same string with random case, and sometimes one code unit changed, or
+		// shortened.
+		for (j = 0; j <= len; ++ j)
+			wc2 [j] = (WCHAR) (rnd (2) && refToupperW (wc1 [j]) != wc1 [j] ? refToupperW (wc1 [j]) : wc1 [j]);
+		if (len && rnd (2))
+			wc2 [rnd ((unsigned) len)] = rnd (2) ? rndCharW () : L'\0';
+		pw2	= atPageEndW (pPage2, wc2, len + 1);
+		if (isEqualIgnoreCaseW (pw1, pw2) != refIsEqualW (pw1, pw2, true))
+			++ nBad;
+		if (isEqualW (pw1, pw2) != refIsEqualW (pw1, pw2, false))
+			++ nBad;
+		if (isEqualW (pw1, pw1) != true || isEqualIgnoreCaseW (pw2, pw2) != true)
+			++ nBad;
+
+		// stricmpW () compares len code units, NULs included.
+		if	(
+				signOf (stricmpW ((const unsigned short *) pw1, (const unsigned short *) pw2, len))
+			!=	refStricmpW (pw1, pw2, len)
+			)
+			++ nBad;
+	}
+	printf ("Strings: %u cases, %lu mismatches.\n", TEST_NUM_CASES / 5, nBad);
+	return nBad;
+}
+
+/*
+	benchStrings
+
+	A command token, a path of MAX_PATH characters, and a path of the maximum length of
+	32767 characters.
+*/
+static void benchStrings (void)
+{
+	static const size_t	lens []	= { 13, 260, 32767 };
+	WCHAR				*pw1	= malloc ((32767 + 1) * sizeof (WCHAR));
+	WCHAR				*pw2	= malloc ((32767 + 1) * sizeof (WCHAR));
+	char				*sz		= malloc (32767 + 1);
+	volatile size_t		uiSink	= 0;
+	double				d [10];
+	clock_t				c;
+	unsigned			l, r, nCalls;
+	size_t				j;
+
+	if (!pw1 || !pw2 || !sz)
+		return;
+	printf	(
+				"%8s %18s %18s %18s %18s %18s (ns/call, new / reference)\n", "Units",
+				"strlenW", "strlenU", "strrchrW", "stricmpW", "isEqualIgnoreCaseW"
+			);
+	for (l = 0; l < sizeof (lens) / sizeof (lens [0]); ++ l)
+	{
+		size_t len = lens [l];
+
+		// C:\Segment\Segment\... in both cases, with the backslash near the start.
+		for (j = 0; j < len; ++ j)
+		{
+			pw1 [j]	= (WCHAR) (j % 9 ? L'a' + j % 26 : L'\\');
+			pw2 [j]	= refToupperW (pw1 [j]);
+			sz [j]	= (char) pw1 [j];
+		}
+		pw1 [len] = pw2 [len] = L'\0';
+		sz [len] = '\0';
+		pw1 [0] = pw2 [0] = L'\\';
+		for (j = 1; j < len; ++ j)
+		{
+			if (L'\\' == pw1 [j])
+				pw1 [j] = pw2 [j] = sz [j] = L'_';
+		}
+		nCalls = (unsigned) (TEST_BENCH_CALLS * 2 / (len + 16));
+
+		#define TEST_BENCH(i, expr)									\
+			c = clock ();											\
+			for (r = 0; r < nCalls; ++ r)							\
+				uiSink += (size_t) (expr);							\
+			d [i] = nsPerCall (c, nCalls);
+		TEST_BENCH (0, strlenW (pw1))
+		TEST_BENCH (1, refStrlenW (pw1))
+		TEST_BENCH (2, strlenU (sz))
+		TEST_BENCH (3, refStrlenU (sz))
+		TEST_BENCH (4, strrchrW (pw1, L'\\'))
+		TEST_BENCH (5, refStrrchrW (pw1, L'\\'))
+		TEST_BENCH (6, stricmpW ((const unsigned short *) pw1, (const unsigned short *) pw2, len))
+		TEST_BENCH (7, refStricmpW (pw1, pw2, len))
+		TEST_BENCH (8, isEqualIgnoreCaseW (pw1, pw2))
+		TEST_BENCH (9, refIsEqualW (pw1, pw2, true))
+		#undef TEST_BENCH
+		printf	(
+					"%8u %8.1f / %7.1f %8.1f / %7.1f %8.1f / %7.1f %8.1f / %7.1f %8.1f / %7.1f\n",
+					(unsigned) len, d [0], d [1], d [2], d [3], d [4], d [5], d [6], d [7],
+					d [8], d [9]
+				);
+	}
+	free (pw1);
+	free (pw2);
+	free (sz);
+}
+
+/*
+	UTF references. Unpaired surrogates and every maximal subpart of an invalid UTF-8
+	sequence become U+FFFD, like Python's codecs with errors='replace'.
+*/
+static size_t refUTF8fromU16 (unsigned char *pu8, const WCHAR *pw, size_t len, bool *pbValid)
+{
+	size_t		n	= 0;
+	size_t		i;
+	uint32_t	cp;
+
+	*pbValid = true;
+	for (i = 0; i < len; ++ i)
+	{
+		cp = pw [i];
+		if (cp >= 0xD800 && cp <= 0xDBFF && i + 1 < len && pw [i + 1] >= 0xDC00 && pw [i + 1] <= 0xDFFF)
+			cp = 0x10000 + ((cp - 0xD800) << 10) + (pw [++ i] - 0xDC00);
+		else
+		if (cp >= 0xD800 && cp <= 0xDFFF)
+		{
+			cp			= 0xFFFD;
+			*pbValid	= false;
+		}
+		if (cp < 0x80)
+			pu8 [n ++] = (unsigned char) cp;
+		else
+		if (cp < 0x800)
+		{
+			pu8 [n ++] = (unsigned char) (0xC0 | cp >> 6);
+			pu8 [n ++] = (unsigned char) (0x80 | (cp & 0x3F));
+		} else
+		if (cp < 0x10000)
+		{
+			pu8 [n ++] = (unsigned char) (0xE0 | cp >> 12);
+			pu8 [n ++] = (unsigned char) (0x80 | (cp >> 6 & 0x3F));
+			pu8 [n ++] = (unsigned char) (0x80 | (cp & 0x3F));
+		} else
+		{
+			pu8 [n ++] = (unsigned char) (0xF0 | cp >> 18);
+			pu8 [n ++] = (unsigned char) (0x80 | (cp >> 12 & 0x3F));
+			pu8 [n ++] = (unsigned char) (0x80 | (cp >> 6 & 0x3F));
+			pu8 [n ++] = (unsigned char) (0x80 | (cp & 0x3F));
+		}
+	}
+	return n;
+}
+
+static size_t refU16fromUTF8 (WCHAR *pw, const unsigned char *pu8, size_t len, bool *pbValid)
+{
+	size_t		n	= 0;
+	size_t		i	= 0;
+	size_t		j, k, nCont;
+	uint32_t	cp;
+	unsigned	lo, hi;
+
+	*pbValid = true;
+	while (i < len)
+	{
+		cp = pu8 [i];
+		if (cp < 0x80)
+		{
+			pw [n ++] = (WCHAR) cp;
+			++ i;
+			continue;
+		}
+		// The number of continuation octets and the valid range of the first one.
+		lo		= 0x80;
+		hi		= 0xBF;
+		if (cp >= 0xC2 && cp <= 0xDF)
+			nCont = 1;
+		else
+		if (cp >= 0xE0 && cp <= 0xEF)
+		{
+			nCont = 2;
+			lo = 0xE0 == cp ? 0xA0 : 0x80;
+			hi = 0xED == cp ? 0x9F : 0xBF;
+		} else
+		if (cp >= 0xF0 && cp <= 0xF4)
+		{
+			nCont = 3;
+			lo = 0xF0 == cp ? 0x90 : 0x80;
+			hi = 0xF4 == cp ? 0x8F : 0xBF;
+		} else
+			nCont = 0;
+		cp &= 0x3F >> nCont;
+		for (j = i + 1, k = 0; k < nCont; ++ j, ++ k)
+		{
+			if (j >= len || pu8 [j] < lo || pu8 [j] > hi)
+				break;
+			cp	= cp << 6 | (pu8 [j] & 0x3Fu);
+			lo	= 0x80;
+			hi	= 0xBF;
+		}
+		if (0 == nCont || k < nCont)
+		{	// The maximal subpart from i to j is replaced by a single U+FFFD.
+			pw [n ++]	= 0xFFFD;
+			*pbValid	= false;
+			i			= j;
+			continue;
+		}
+		if (cp >= 0x10000)
+		{
+			pw [n ++] = (WCHAR) (0xD800 + ((cp - 0x10000) >> 10));
+			pw [n ++] = (WCHAR) (0xDC00 + ((cp - 0x10000) & 0x3FF));
+		} else
+			pw [n ++] = (WCHAR) cp;
+		i = j;
+	}
+	return n;
+}
+
+/*
+	Random UTF-16 with runs of ASCII around the 16 characters of an SSE2 block, characters
+	that need 2, 3, and 4 octets, and unpaired surrogates. Returns the amount of code units.
+*/
+static size_t makeU16 (WCHAR *pw, size_t maxLen)
+{
+	size_t		n	= 0;
+	unsigned	r, k, run;
+
+	while (n + 20 < maxLen && rnd (12))
+	{
+		r = rnd (10);
+		if (r < 4)
+		{	// A run of 15, 16, or 17 ASCII characters, or a random one.
+			run = r < 3 ? 15 + r : rnd (40);
+			for (k = 0; k < run && n < maxLen - 2; ++ k)
+				pw [n ++] = (WCHAR) (1 + rnd (0x7F));
+		} else
+		if (r < 5)
+			pw [n ++] = (WCHAR) (0x80 + rnd (0x780));
+		else
+		if (r < 6)
+			pw [n ++] = (WCHAR) (0x800 + rnd (0xD000));
+		else
+		if (r < 7)
+			pw [n ++] = (WCHAR) (0xE000 + rnd (0x2000));
+		else
+		if (r < 8)
+		{
+			pw [n ++] = (WCHAR) (0xD800 + rnd (0x400));
+			pw [n ++] = (WCHAR) (0xDC00 + rnd (0x400));
+		} else
+			pw [n ++] = (WCHAR) (0xD800 + rnd (0x800));	// Probably unpaired.
+	}
+	return n;
+}
+
+/*
+	Random UTF-8: the UTF-8 of makeU16 (), with some octets changed, removed, or inserted,
+	and sometimes overlong forms, encoded surrogates, or code points above U+10FFFF.
+	Returns the amount of octets.
+*/
+static size_t makeUTF8 (unsigned char *pu8, size_t maxLen)
+{
+	static const char	*szBad []	=
+	{
+		"\xC0\x80", "\xC1\xBF", "\xE0\x80\x80", "\xE0\x9F\xBF", "\xF0\x80\x80\x80",
+		"\xF0\x8F\xBF\xBF", "\xED\xA0\x80", "\xED\xBF\xBF", "\xF4\x90\x80\x80",
+		"\xF5\x80\x80\x80", "\xFF", "\xFE", "\x80", "\xBF", "\xE2\x82", "\xF0\x9F\x98",
+		"\xF0\x9F", "\xC3"
+	};
+	WCHAR				wc [256];
+	bool				b;
+	size_t				n			= refUTF8fromU16 (pu8, wc, makeU16 (wc, maxLen / 4), &b);
+	unsigned			nChanges	= rnd (4);
+	unsigned			k;
+	size_t				i, l;
+	const char			*sz;
+
+	for (k = 0; k < nChanges && n; ++ k)
+	{
+		i = rnd ((unsigned) n);
+		switch (rnd (4))
+		{
+			case 0:
+				pu8 [i] = (unsigned char) (1 + rnd (255));
+				break;
+			case 1:
+				memmove (pu8 + i, pu8 + i + 1, n - i - 1);
+				-- n;
+				break;
+			default:
+				sz	= szBad [rnd (sizeof (szBad) / sizeof (szBad [0]))];
+				l	= strlen (sz);
+				if (n + l <= maxLen)
+				{
+					memmove (pu8 + i + l, pu8 + i, n - i);
+					memcpy (pu8 + i, sz, l);
+					n += l;
+				}
+				break;
+		}
+	}
+	return n;
+}
+
+/*
+	testUTF
+
+	Compares UTF8_from_U16 () and U16_from_UTF8 () against the references above. The input
+	ends at the guard page, with and without a NUL for USE_STRLEN. Some conversions are
+	repeated with every buffer size below the required one, which must still return the
+	required size, write only complete characters, and never write past the buffer.
+	Returns the amount of mismatches.
+*/
+static unsigned long testUTF (unsigned char *pPage)
+{
+	static WCHAR			wcIn	[1024];
+	static WCHAR			wcRef	[1024];
+	static WCHAR			wcOut	[1024 + 1];
+	static unsigned char	u8In	[1024];
+	static unsigned char	u8Ref	[4096];
+	static unsigned char	u8Out	[4096 + 1];
+	unsigned long			nBad	= 0;
+	unsigned				i;
+
+	for (i = 0; i < TEST_NUM_CASES / 10; ++ i)
+	{
+		bool		bNul		= 0 == rnd (4);
+		bool		bSizes		= 0 == i % 16;
+		bool		bRef, bNew;
+		size_t		n, nRef, nNew, s, k;
+		WCHAR		*pw;
+		char		*pc;
+
+		// UTF-16 to UTF-8.
+		n = makeU16 (wcIn, 1000);
+		if (bNul)
+			wcIn [n ++] = L'\0';
+		nRef	= refUTF8fromU16 (u8Ref, wcIn, n, &bRef);
+		pw		= (WCHAR *) (pPage + TEST_PAGE_SIZ) - n;
+		memcpy (pw, wcIn, n * sizeof (WCHAR));
+		nNew	= UTF8_from_U16 ((char *) u8Out, nRef, pw, bNul ? USE_STRLEN : n, &bNew);
+		if (nNew != nRef || bNew != bRef || memcmp (u8Out, u8Ref, nRef))
+			++ nBad;
+		if (UTF8_from_U16 (NULL, 0, pw, n, NULL) != nRef)
+			++ nBad;
+		for (s = 0; bSizes && s < nRef; ++ s)
+		{
+			memset (u8Out, 0xFF, s + 1);
+			if (UTF8_from_U16 ((char *) u8Out, s, pw, n, NULL) != nRef || 0xFF != u8Out [s])
+				++ nBad;
+			// A prefix of the result, and 0xFF, which UTF-8 doesn't have, after it. A
+			// buffer that has been filled must end with a complete character.
+			for (k = 0; k < s && u8Out [k] == u8Ref [k]; ++ k)
+				;
+			while (k < s && 0xFF == u8Out [k])
+				++ k;
+			if (k < s || (s && 0xFF != u8Out [s - 1] && 0x80 == (u8Ref [s] & 0xC0)))
+				++ nBad;
+		}
+
+		// UTF-8 to UTF-16.
+		n = makeUTF8 (u8In, 1000);
+		if (bNul)
+		{
+			for (k = 0; k < n; ++ k)
+			{
+				if ('\0' == u8In [k])
+					u8In [k] = 'x';
+			}
+			u8In [n ++] = '\0';
+		}
+		nRef	= refU16fromUTF8 (wcRef, u8In, n, &bRef);
+		pc		= (char *) pPage + TEST_PAGE_SIZ - n;
+		memcpy (pc, u8In, n);
+		nNew	= U16_from_UTF8 (wcOut, nRef, pc, bNul ? USE_STRLEN : n, &bNew);
+		if (nNew != nRef || bNew != bRef || memcmp (wcOut, wcRef, nRef * sizeof (WCHAR)))
+			++ nBad;
+		if (U16_from_UTF8 (NULL, 0, pc, n, NULL) != nRef)
+			++ nBad;
+		for (s = 0; bSizes && s < nRef; ++ s)
+		{
+			// 0xDEAD is an unpaired surrogate, which the result can't have.
+			for (k = 0; k <= s; ++ k)
+				wcOut [k] = 0xDEAD;
+			if (U16_from_UTF8 (wcOut, s, pc, n, NULL) != nRef || 0xDEAD != wcOut [s])
+				++ nBad;
+			for (k = 0; k < s && wcOut [k] == wcRef [k]; ++ k)
+				;
+			while (k < s && 0xDEAD == wcOut [k])
+				++ k;
+			if (k < s)
+				++ nBad;
+		}
+	}
+	printf ("UTF: %u cases, %lu mismatches.\n", TEST_NUM_CASES / 10, nBad);
+	return nBad;
+}
+
+/*
+	benchUTF
+
+	Throughput for 1 MiB of ASCII host names and of mixed script, against iconv (), or
+	WideCharToMultiByte () and MultiByteToWideChar () on Windows.
+*/
+static void benchUTF (void)
+{
+	static const char	*szPieces []	=
+	{
+		"host-01.lab.example.com ", "switch-rack-42 ",
+		"Gr\xC3\xBC\xC3\x9F" "e aus K\xC3\xB6ln, ",
+		"\xD0\x9F\xD1\x80\xD0\xB8\xD0\xB2\xD0\xB5\xD1\x82, \xD0\xBC\xD0\xB8\xD1\x80! ",
+		"\xE6\x9D\xB1\xE4\xBA\xAC\xE9\x83\xBD ", "\xCE\xBB\xCF\x8C\xCE\xB3\xCE\xBF\xCF\x82 ",
+		"\xF0\x9F\x96\xA5\xF0\x9F\x94\x8C ", "\xD9\x85\xD8\xB1\xD8\xAD\xD8\xA8\xD8\xA7 ",
+		"00:1A:2B:3C:4D:5E "
+	};
+	const size_t		sizCorpus		= 1 << 20;
+	const unsigned		nRounds			= 200;
+	char				*pu8			= malloc (sizCorpus + 64);
+	char				*pu8Out			= malloc (sizCorpus + 64);
+	WCHAR				*pw				= malloc ((sizCorpus + 64) * sizeof (WCHAR));
+	WCHAR				*pwOut			= malloc ((sizCorpus + 64) * sizeof (WCHAR));
+	size_t				n8, n16, l;
+	unsigned			c, k, r;
+	clock_t				cl;
+	double				d [4];
+
+	if (!pu8 || !pu8Out || !pw || !pwOut)
+		return;
+	printf	(
+				"%-18s %12s %12s %12s %12s (MB of UTF-8 per second)\n", "Corpus",
+				"UTF8_from_U16", "U16_from_UTF8", "system U8", "system U16"
+			);
+	for (c = 0; c < 2; ++ c)
+	{
+		for (n8 = 0, k = 0; ; k = (k * 7 + 3) % 1000)
+		{
+			const char *sz = szPieces [c ? k % 9 : k % 2];
+			l = strlen (sz);
+			if (n8 + l > sizCorpus)
+				break;
+			memcpy (pu8 + n8, sz, l);
+			n8 += l;
+		}
+		n16 = U16_from_UTF8 (pw, sizCorpus, pu8, n8, NULL);
+
+		cl = clock ();
+		for (r = 0; r < nRounds; ++ r)
+			UTF8_from_U16 (pu8Out, sizCorpus, pw, n16, NULL);
+		d [0] = (double) (clock () - cl) / CLOCKS_PER_SEC;
+		cl = clock ();
+		for (r = 0; r < nRounds; ++ r)
+			U16_from_UTF8 (pwOut, sizCorpus, pu8, n8, NULL);
+		d [1] = (double) (clock () - cl) / CLOCKS_PER_SEC;
+		#ifdef _WIN32
+			cl = clock ();
+			for (r = 0; r < nRounds; ++ r)
+				WideCharToMultiByte (CP_UTF8, 0, pw, (int) n16, pu8Out, (int) sizCorpus, NULL, NULL);
+			d [2] = (double) (clock () - cl) / CLOCKS_PER_SEC;
+			cl = clock ();
+			for (r = 0; r < nRounds; ++ r)
+				MultiByteToWideChar (CP_UTF8, 0, pu8, (int) n8, pwOut, (int) sizCorpus);
+			d [3] = (double) (clock () - cl) / CLOCKS_PER_SEC;
+		#else
+			iconv_t cd8		= iconv_open ("UTF-8", "UTF-16LE");
+			iconv_t cd16	= iconv_open ("UTF-16LE", "UTF-8");
+			cl = clock ();
+			for (r = 0; r < nRounds; ++ r)
+			{
+				char	*pIn	= (char *) pw;
+				char	*pOut	= pu8Out;
+				size_t	lIn		= n16 * sizeof (WCHAR);
+				size_t	lOut	= sizCorpus;
+				iconv (cd8, &pIn, &lIn, &pOut, &lOut);
+			}
+			d [2] = (double) (clock () - cl) / CLOCKS_PER_SEC;
+			cl = clock ();
+			for (r = 0; r < nRounds; ++ r)
+			{
+				char	*pIn	= pu8;
+				char	*pOut	= (char *) pwOut;
+				size_t	lIn		= n8;
+				size_t	lOut	= sizCorpus * sizeof (WCHAR);
+				iconv (cd16, &pIn, &lIn, &pOut, &lOut);
+			}
+			d [3] = (double) (clock () - cl) / CLOCKS_PER_SEC;
+			iconv_close (cd8);
+			iconv_close (cd16);
+		#endif
+		printf	(
+					"%-18s %12.0f %12.0f %12.0f %12.0f\n", c ? "Mixed script" : "ASCII host names",
+					n8 / 1e6 * nRounds / d [0], n8 / 1e6 * nRounds / d [1],
+					n8 / 1e6 * nRounds / d [2], n8 / 1e6 * nRounds / d [3]
+				);
+	}
+	free (pu8);
+	free (pu8Out);
+	free (pw);
+	free (pwOut);
+}
+
+int main (int argc, char *argv [])
+{
+	unsigned char	*pPage	= guardedPage ();
+	unsigned char	*pPage2	= guardedPage ();
+	unsigned long	nBad	= 0;
+
+	if (NULL == pPage || NULL == pPage2)
+	{
+		puts ("Can't allocate the guard pages.");
+		return EXIT_FAILURE;
+	}
+	nBad += testNumbers (pPage);
+	nBad += testMemory (pPage);
+	nBad += testStrings (pPage, pPage2);
+	nBad += testUTF (pPage);
+	if (argc > 1 && 0 == strcmp (argv [1], "bench"))
+	{
+		benchNumbers ();
+		benchMemory ();
+		benchStrings ();
+		benchUTF ();
+	}
+	puts (nBad ? "FAILED." : "Passed.");
+	return nBad ? EXIT_FAILURE : EXIT_SUCCESS;
+}
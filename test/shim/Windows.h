@@ -0,0 +1,31 @@
+/*
+	Windows.h
+
+	The few definitions src/c/WinRuntimeReplacements.c needs to be compiled by gcc or clang
+	on other platforms, for the tests in this folder only. Not used on Windows.
+*/
+
+#ifndef TEST_SHIM_WINDOWS_H
+#define TEST_SHIM_WINDOWS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef unsigned short		WCHAR;
+typedef int					BOOL;
+typedef unsigned long		DWORD;
+
+#ifndef TRUE
+#define TRUE				1
+#endif
+#ifndef FALSE
+#define FALSE				0
+#endif
+#ifndef UNALIGNED
+#define UNALIGNED
+#endif
+#ifndef _ASSERT
+#define _ASSERT(x)
+#endif
+
+#endif														// Of #ifndef TEST_SHIM_WINDOWS_H.
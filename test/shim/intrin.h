@@ -0,0 +1,27 @@
+/*
+	intrin.h
+
+	_BitScanForward () and _BitScanReverse () for gcc and clang, for the tests in this
+	folder only. Not used on Windows.
+*/
+
+#ifndef TEST_SHIM_INTRIN_H
+#define TEST_SHIM_INTRIN_H
+
+static inline unsigned char _BitScanForward (unsigned long *pIndex, unsigned long mask)
+{
+	if (0 == mask)
+		return 0;
+	*pIndex = (unsigned long) __builtin_ctzl (mask);
+	return 1;
+}
+
+static inline unsigned char _BitScanReverse (unsigned long *pIndex, unsigned long mask)
+{
+	if (0 == mask)
+		return 0;
+	*pIndex = (unsigned long) (sizeof (unsigned long) * 8 - 1 - __builtin_clzl (mask));
+	return 1;
+}
+
+#endif														// Of #ifndef TEST_SHIM_INTRIN_H.